@@ -4,6 +4,9 @@
 
 #include "base/bitset.h"
 
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 #include <string>
@@ -119,6 +122,49 @@ static inline size_t bit_position(size_t idx, size_t offset) {
 
 const size_t BitSet::npos;
 
+BitSet::Blocks::Blocks(const Blocks &rhs) : size_(0), capacity_(1) {
+    inline_ = 0;
+    *this = rhs;
+}
+
+BitSet::Blocks::~Blocks() {
+    if (on_heap())
+        delete [] heap_;
+}
+
+//
+// Copy the blocks from rhs, reusing the existing storage if it's big enough.
+//
+BitSet::Blocks &BitSet::Blocks::operator=(const Blocks &rhs) {
+    if (this == &rhs)
+        return *this;
+    size_ = 0;
+    resize(rhs.size_);
+    std::copy(rhs.data(), rhs.data() + rhs.size_, data());
+    return *this;
+}
+
+//
+// Resize the array, moving to heap storage if the inline block isn't big
+// enough.  The capacity is doubled when growing so that a bitset that is
+// built by setting increasing bit positions doesn't reallocate every time
+// it grows by a block.
+//
+void BitSet::Blocks::resize(size_t size) {
+    if (size > capacity_) {
+        size_t capacity = std::max(size, 2 * static_cast<size_t>(capacity_));
+        uint64_t *heap = new uint64_t[capacity];
+        std::copy(data(), data() + size_, heap);
+        if (on_heap())
+            delete [] heap_;
+        heap_ = heap;
+        capacity_ = capacity;
+    }
+    if (size > size_)
+        std::fill(data() + size_, data() + size, 0);
+    size_ = size;
+}
+
 //
 // Set bit at given position, growing the vector if needed.
 //
@@ -543,6 +589,32 @@ bool BitSet::Contains(const BitSet &rhs) const {
     return true;
 }
 
+//
+// Compare with rhs.  Defines a total order that is only meant to be used for
+// keeping bitsets in sorted containers.
+//
+int BitSet::CompareTo(const BitSet &rhs) const {
+    if (blocks_.size() != rhs.blocks_.size())
+        return (blocks_.size() < rhs.blocks_.size() ? -1 : 1);
+    for (size_t idx = 0; idx < blocks_.size(); idx++) {
+        if (blocks_[idx] != rhs.blocks_[idx])
+            return (blocks_[idx] < rhs.blocks_[idx] ? -1 : 1);
+    }
+    return 0;
+}
+
+//
+// Return a hash of the set bits.  Equal bitsets have the same hash since the
+// blocks are always compacted.
+//
+size_t BitSet::Hash() const {
+    size_t hash = 0;
+    for (size_t idx = 0; idx < blocks_.size(); idx++) {
+        boost::hash_combine(hash, blocks_[idx]);
+    }
+    return hash;
+}
+
 //
 // Returns string representation of the bitset. A character in the string is
 // '1' if the corresponding bit is set, and '0' if it is not.  The character
@@ -12,7 +12,11 @@
 //
 // BitSet automatically resizes the bit set when needed and allows for
 // logical operations between bitsets of different sizes.  Implemented
-// using a vector of uint64_t as the underlying storage.
+// using an array of uint64_t as the underlying storage.
+//
+// The first block is stored inline, so bitsets with no bits beyond position
+// 63 don't need any heap allocation.  This is the common case for most users
+// e.g. RibOuts with a small number of peers.
 //
 class BitSet {
 public:
@@ -46,6 +50,8 @@ public:
     void BuildComplement(const BitSet &lhs, const BitSet &rhs);
     void BuildIntersection(const BitSet &lhs, const BitSet &rhs);
     bool Contains(const BitSet &rhs) const;
+    int CompareTo(const BitSet &rhs) const;
+    size_t Hash() const;
     std::string ToString() const;
     void FromString(std::string str);
     std::string ToNumberedString() const;
@@ -53,10 +59,44 @@ public:
 private:
     friend class BitSetTest;
 
+    //
+    // Resizable array of blocks with inline storage for a single block.
+    // Supports the subset of the std::vector interface used by BitSet.
+    //
+    // Newly added blocks are always 0.  The heap storage, once allocated,
+    // is retained when the array shrinks, just like a std::vector.
+    //
+    class Blocks {
+    public:
+        Blocks() : size_(0), capacity_(1) { inline_ = 0; }
+        Blocks(const Blocks &rhs);
+        ~Blocks();
+        Blocks &operator=(const Blocks &rhs);
+
+        size_t size() const { return size_; }
+        void resize(size_t size);
+        void clear() { size_ = 0; }
+
+        uint64_t &operator[](size_t idx) { return data()[idx]; }
+        const uint64_t &operator[](size_t idx) const { return data()[idx]; }
+
+    private:
+        bool on_heap() const { return capacity_ > 1; }
+        uint64_t *data() { return on_heap() ? heap_ : &inline_; }
+        const uint64_t *data() const { return on_heap() ? heap_ : &inline_; }
+
+        uint32_t size_;
+        uint32_t capacity_;
+        union {
+            uint64_t inline_;
+            uint64_t *heap_;
+        };
+    };
+
     void compact();
     void check_invariants();
 
-    std::vector<uint64_t> blocks_;
+    Blocks blocks_;
 };
 
 #endif
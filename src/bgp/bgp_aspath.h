@@ -133,6 +133,7 @@ public:
 private:
     friend int intrusive_ptr_add_ref(const AsPath *cpath);
     friend int intrusive_ptr_del_ref(const AsPath *cpath);
+    friend bool intrusive_ptr_add_ref_if_live(const AsPath *cpath);
     friend void intrusive_ptr_release(const AsPath *cpath);
 
     mutable tbb::atomic<int> refcount_;
@@ -148,6 +149,10 @@ inline int intrusive_ptr_del_ref(const AsPath *cpath) {
     return cpath->refcount_.fetch_and_decrement();
 }
 
+inline bool intrusive_ptr_add_ref_if_live(const AsPath *cpath) {
+    return BgpAttrAddRefIfLive(cpath->refcount_);
+}
+
 inline void intrusive_ptr_release(const AsPath *cpath) {
     int prev = cpath->refcount_.fetch_and_decrement();
     if (prev == 1) {
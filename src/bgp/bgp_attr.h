@@ -201,6 +201,7 @@ public:
 private:
     friend int intrusive_ptr_add_ref(const ClusterList *ccluster_list);
     friend int intrusive_ptr_del_ref(const ClusterList *ccluster_list);
+    friend bool intrusive_ptr_add_ref_if_live(const ClusterList *ccluster_list);
     friend void intrusive_ptr_release(const ClusterList *ccluster_list);
     friend class ClusterListDB;
 
@@ -217,6 +218,10 @@ inline int intrusive_ptr_del_ref(const ClusterList *ccluster_list) {
     return ccluster_list->refcount_.fetch_and_decrement();
 }
 
+inline bool intrusive_ptr_add_ref_if_live(const ClusterList *ccluster_list) {
+    return BgpAttrAddRefIfLive(ccluster_list->refcount_);
+}
+
 inline void intrusive_ptr_release(const ClusterList *ccluster_list) {
     int prev = ccluster_list->refcount_.fetch_and_decrement();
     if (prev == 1) {
@@ -353,6 +358,7 @@ public:
 private:
     friend int intrusive_ptr_add_ref(const PmsiTunnel *cpmsi_tunnel);
     friend int intrusive_ptr_del_ref(const PmsiTunnel *cpmsi_tunnel);
+    friend bool intrusive_ptr_add_ref_if_live(const PmsiTunnel *cpmsi_tunnel);
     friend void intrusive_ptr_release(const PmsiTunnel *cpmsi_tunnel);
     friend class PmsiTunnelDB;
 
@@ -373,6 +379,10 @@ inline int intrusive_ptr_del_ref(const PmsiTunnel *cpmsi_tunnel) {
     return cpmsi_tunnel->refcount_.fetch_and_decrement();
 }
 
+inline bool intrusive_ptr_add_ref_if_live(const PmsiTunnel *cpmsi_tunnel) {
+    return BgpAttrAddRefIfLive(cpmsi_tunnel->refcount_);
+}
+
 inline void intrusive_ptr_release(const PmsiTunnel *cpmsi_tunnel) {
     int prev = cpmsi_tunnel->refcount_.fetch_and_decrement();
     if (prev == 1) {
@@ -461,6 +471,7 @@ public:
 private:
     friend int intrusive_ptr_add_ref(const EdgeDiscovery *ediscovery);
     friend int intrusive_ptr_del_ref(const EdgeDiscovery *ediscovery);
+    friend bool intrusive_ptr_add_ref_if_live(const EdgeDiscovery *ediscovery);
     friend void intrusive_ptr_release(const EdgeDiscovery *ediscovery);
     friend class EdgeDiscoveryDB;
 
@@ -477,6 +488,10 @@ inline int intrusive_ptr_del_ref(const EdgeDiscovery *cediscovery) {
     return cediscovery->refcount_.fetch_and_decrement();
 }
 
+inline bool intrusive_ptr_add_ref_if_live(const EdgeDiscovery *cediscovery) {
+    return BgpAttrAddRefIfLive(cediscovery->refcount_);
+}
+
 inline void intrusive_ptr_release(const EdgeDiscovery *cediscovery) {
     int prev = cediscovery->refcount_.fetch_and_decrement();
     if (prev == 1) {
@@ -568,6 +583,8 @@ public:
 private:
     friend int intrusive_ptr_add_ref(const EdgeForwarding *ceforwarding);
     friend int intrusive_ptr_del_ref(const EdgeForwarding *ceforwarding);
+    friend bool intrusive_ptr_add_ref_if_live(
+        const EdgeForwarding *ceforwarding);
     friend void intrusive_ptr_release(const EdgeForwarding *ceforwarding);
     friend class EdgeForwardingDB;
 
@@ -584,6 +601,10 @@ inline int intrusive_ptr_del_ref(const EdgeForwarding *ceforwarding) {
     return ceforwarding->refcount_.fetch_and_decrement();
 }
 
+inline bool intrusive_ptr_add_ref_if_live(const EdgeForwarding *ceforwarding) {
+    return BgpAttrAddRefIfLive(ceforwarding->refcount_);
+}
+
 inline void intrusive_ptr_release(const EdgeForwarding *ceforwarding) {
     int prev = ceforwarding->refcount_.fetch_and_decrement();
     if (prev == 1) {
@@ -682,6 +703,7 @@ public:
 private:
     friend int intrusive_ptr_add_ref(const BgpOList *colist);
     friend int intrusive_ptr_del_ref(const BgpOList *colist);
+    friend bool intrusive_ptr_add_ref_if_live(const BgpOList *colist);
     friend void intrusive_ptr_release(const BgpOList *colist);
     friend class BgpOListDB;
 
@@ -699,6 +721,10 @@ inline int intrusive_ptr_del_ref(const BgpOList *colist) {
     return colist->refcount_.fetch_and_decrement();
 }
 
+inline bool intrusive_ptr_add_ref_if_live(const BgpOList *colist) {
+    return BgpAttrAddRefIfLive(colist->refcount_);
+}
+
 inline void intrusive_ptr_release(const BgpOList *colist) {
     int prev = colist->refcount_.fetch_and_decrement();
     if (prev == 1) {
@@ -869,6 +895,7 @@ private:
     friend class BgpAttrTest;
     friend int intrusive_ptr_add_ref(const BgpAttr *cattrp);
     friend int intrusive_ptr_del_ref(const BgpAttr *cattrp);
+    friend bool intrusive_ptr_add_ref_if_live(const BgpAttr *cattrp);
     friend void intrusive_ptr_release(const BgpAttr *cattrp);
 
     mutable tbb::atomic<int> refcount_;
@@ -905,6 +932,10 @@ inline int intrusive_ptr_del_ref(const BgpAttr *cattrp) {
     return cattrp->refcount_.fetch_and_decrement();
 }
 
+inline bool intrusive_ptr_add_ref_if_live(const BgpAttr *cattrp) {
+    return BgpAttrAddRefIfLive(cattrp->refcount_);
+}
+
 inline void intrusive_ptr_release(const BgpAttr *cattrp) {
     int prev = cattrp->refcount_.fetch_and_decrement();
     if (prev == 1) {
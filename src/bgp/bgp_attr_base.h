@@ -7,7 +7,8 @@
 
 #include <boost/functional/hash.hpp>
 #include <boost/scoped_array.hpp>
-#include <tbb/mutex.h>
+#include <tbb/atomic.h>
+#include <tbb/spin_rw_mutex.h>
 
 #include <set>
 #include <string>
@@ -104,41 +105,74 @@ struct BgpProtoPrefix : public ParseObject {
     uint8_t type;
 };
 
+//
+// Take a reference on an attribute only if its refcount has not already
+// dropped to 0. Attribute types use this to implement
+// intrusive_ptr_add_ref_if_live() for BgpPathAttributeDB.
+//
+template <typename T>
+inline bool BgpAttrAddRefIfLive(tbb::atomic<T> &refcount) {
+    while (true) {
+        T prev = refcount;
+        if (prev == 0)
+            return false;
+        if (refcount.compare_and_swap(prev + 1, prev) == prev)
+            return true;
+    }
+}
+
 //
 // Base class to manage BGP Path Attributes database. This class provides
 // thread safe access to the data base.
 //
-// Lock contention can be tuned by varying the hash table size passed to the
-// constructor.
+// The database is split into a number of shards based on a hash of the
+// attribute contents. Each shard is protected by a reader-writer lock, so
+// lookups of attributes that are already present in the database proceed
+// concurrently and only insertion/removal of entries needs exclusive access
+// to a shard. The number of shards defaults to the number of hardware
+// threads and can be overridden via BGP_PATH_ATTRIBUTE_DB_HASH_SIZE.
 //
 // Attribute contents must be hashable via hash_value() and hashed using
 // boost::hash_combine() to partition the attribute database.
 //
+// Attribute types must provide intrusive_ptr_add_ref_if_live(), which takes
+// a reference only if the refcount has not already dropped to 0. An entry
+// whose refcount has dropped to 0 is about to be removed from the database
+// by the thread that released the last reference, and must not be revived.
+//// BgpAttrAddRefIfLive() implements this for a tbb::atomic refcount.
+//
 template <class Type, class TypePtr, class TypeSpec, typename TypeCompare,
           class TypeDB>
 class BgpPathAttributeDB {
 public:
     explicit BgpPathAttributeDB(int hash_size = GetHashSize())
-        : hash_size_(hash_size),
-          set_(new Set[hash_size]),
-          mutex_(new tbb::mutex[hash_size]) {
+        : hash_size_(hash_size > 0 ? hash_size : 1),
+          shards_(new Shard[hash_size_]) {
     }
 
     size_t Size() {
         size_t size = 0;
 
         for (size_t i = 0; i < hash_size_; i++) {
-            tbb::mutex::scoped_lock lock(mutex_[i]);
-            size += set_[i].size();
+            tbb::spin_rw_mutex::scoped_lock lock(shards_[i].rw_mutex, false);
+            size += shards_[i].set.size();
         }
         return size;
     }
 
+    // Remove the attribute from the database. Called when the last reference
+    // to the attribute is released.
+    //
+    // The attribute is erased only if it is still the entry in the database.
+    // A concurrent Locate may already have replaced it with a new attribute
+    // with identical contents, which must not be removed.
     void Delete(Type *attr) {
-        size_t hash = HashCompute(attr);
+        Shard &shard = shards_[HashCompute(attr)];
 
-        tbb::mutex::scoped_lock lock(mutex_[hash]);
-        set_[hash].erase(attr);
+        tbb::spin_rw_mutex::scoped_lock lock(shard.rw_mutex, true);
+        typename Set::iterator it = shard.set.find(attr);
+        if (it != shard.set.end() && *it == attr)
+            shard.set.erase(it);
     }
 
     // Locate passed in attribute in the data base based on the attr ptr.
@@ -152,7 +186,16 @@ public:
         return LocateInternal(attr);
     }
 
+    size_t hash_size() const { return hash_size_; }
+
 private:
+    typedef std::set<Type *, TypeCompare> Set;
+
+    struct Shard {
+        tbb::spin_rw_mutex rw_mutex;
+        Set set;
+    };
+
     const size_t HashCompute(Type *attr) const {
         if (hash_size_ <= 1) return 0;
 
@@ -164,8 +207,9 @@ private:
     static size_t GetHashSize() {
         char *str = getenv("BGP_PATH_ATTRIBUTE_DB_HASH_SIZE");
 
-        // Use just one bucket for now.
-        if (!str) return 1;
+        // Use one shard per hardware thread by default.
+        if (!str)
+            return TaskScheduler::GetInstance()->HardwareThreadCount();
         return strtoul(str, NULL, 0);
     }
 
@@ -176,66 +220,57 @@ private:
     // existing entry is returned.
     TypePtr LocateInternal(Type *attr) {
         // Hash attribute contents to to avoid potential mutex contention.
-        size_t hash = HashCompute(attr);
-        while (true) {
-            // Grab mutex to keep db access thread safe.
-            tbb::mutex::scoped_lock lock(mutex_[hash]);
-            std::pair<typename Set::iterator, bool> ret;
-
-            // Try to insert the passed entry into the database.
-            ret = set_[hash].insert(attr);
-
-            // Take a reference to prevent this entry from getting deleted.
-            // Counter is automatically incremented, hence we get thread safety
-            // here.
-            int prev = intrusive_ptr_add_ref(*ret.first);
-
-            // Check if passed in entry did get into the data base.
-            if (ret.second) {
-                // Take intrusive pointer, thereby incrementing the refcount.
-                TypePtr ptr = TypePtr(*ret.first);
-
-                // Release redundant refcount taken above to protect this entry
-                // from getting deleted, as we have now bumped up refcount above
-                intrusive_ptr_del_ref(*ret.first);
-                return ptr;
-            }
+        Shard &shard = shards_[HashCompute(attr)];
+
+        // Common case - the entry is already present and alive. Look it up
+        // with the shard locked for read, so that concurrent lookups in the
+        // same shard do not serialize.
+        {
+            tbb::spin_rw_mutex::scoped_lock lock(shard.rw_mutex, false);
+            typename Set::iterator it = shard.set.find(attr);
+            if (it != shard.set.end() && intrusive_ptr_add_ref_if_live(*it)) {
+                Type *existing = *it;
+                lock.release();
 
-            // Make sure that this entry, though in the database is not
-            // undergoing deletion. This can happen because attribute intrusive
-            // pointer is released without taking the mutex.
-            //
-            // If the previous refcount is 0, it implies that this entry is
-            // about to get deleted (after we release the mutex). In such
-            // cases, we retry inserting the passed attribute pointer into the
-            // data base.
-            if (prev > 0) {
                 // Free passed in attribute, as it is already in the database.
+                // Reference has already been taken above, so don't take one
+                // more when creating the intrusive pointer.
                 delete attr;
-
-                // Take intrusive pointer, thereby incrementing the refcount.
-                TypePtr ptr = TypePtr(*ret.first);
-
-                // Release redundant refcount taken above to protect this entry
-                // from getting deleted, as we have now bumped up refcount above
-                intrusive_ptr_del_ref(*ret.first);
-                return ptr;
+                return TypePtr(existing, false);
             }
+        }
 
-            // Decrement the counter bumped up above as we can't use this entry
-            // which is about to be deleted. Instead, retry inserting the passed
-            // entry again, into the database.
-            intrusive_ptr_del_ref(*ret.first);
+        // Grab the shard for write to insert the passed entry.
+        tbb::spin_rw_mutex::scoped_lock lock(shard.rw_mutex, true);
+        std::pair<typename Set::iterator, bool> ret = shard.set.insert(attr);
+
+        // Check if passed in entry did get into the data base.
+        if (ret.second)
+            return TypePtr(attr);
+
+        // Another thread inserted an identical entry after we released the
+        // read lock. Use it if it's still alive.
+        if (intrusive_ptr_add_ref_if_live(*ret.first)) {
+            Type *existing = *ret.first;
+            lock.release();
+            delete attr;
+            return TypePtr(existing, false);
         }
 
-        assert(false);
-        return NULL;
+        // The existing entry is undergoing deletion. This can happen because
+        // attribute intrusive pointer is released without holding the lock.
+        // Replace it with the passed entry instead of waiting for the thread
+        // that is deleting it to remove it from the database. Delete() will
+        // notice that the entry has been replaced and leave the new one be.
+        typename Set::iterator hint = ret.first;
+        ++hint;
+        shard.set.erase(ret.first);
+        shard.set.insert(hint, attr);
+        return TypePtr(attr);
     }
 
-    typedef std::set<Type *, TypeCompare> Set;
     size_t hash_size_;
-    boost::scoped_array<Set> set_;
-    boost::scoped_array<tbb::mutex> mutex_;
+    boost::scoped_array<Shard> shards_;
 };
 
 #endif  // SRC_BGP_BGP_ATTR_BASE_H_
@@ -7,6 +7,7 @@
 
 #include <boost/intrusive_ptr.hpp>
 
+#include <algorithm>
 #include <list>
 #include <string>
 #include <utility>
@@ -36,4 +37,41 @@ typedef std::vector<RoutingPolicyAttachInfo> RoutingPolicyConfigList;
 typedef std::pair<RoutingPolicyPtr, uint32_t> RoutingPolicyInfo;
 typedef std::list<RoutingPolicyInfo> RoutingPolicyAttachList;
 
+//
+// Timing and counters for one stage of config processing, used to tell how
+// long it takes to ingest the config snapshot after a restart. Timestamps
+// are UTC in usecs. Only runs that had something to do are accounted for.
+//
+struct BgpConfigPhaseStats {
+    BgpConfigPhaseStats()
+        : first_at(0), last_at(0), busy_usec(0), processed(0), skipped(0) {
+    }
+
+    void Update(uint64_t start, uint64_t end,
+                uint64_t processed_count, uint64_t skipped_count) {
+        if (!first_at)
+            first_at = start;
+        last_at = end;
+        busy_usec += end - start;
+        processed += processed_count;
+        skipped += skipped_count;
+    }
+
+    void Merge(const BgpConfigPhaseStats &rhs) {
+        if (!rhs.first_at)
+            return;
+        first_at = first_at ? std::min(first_at, rhs.first_at) : rhs.first_at;
+        last_at = std::max(last_at, rhs.last_at);
+        busy_usec += rhs.busy_usec;
+        processed += rhs.processed;
+        skipped += rhs.skipped;
+    }
+
+    uint64_t first_at;
+    uint64_t last_at;
+    uint64_t busy_usec;
+    uint64_t processed;
+    uint64_t skipped;
+};
+
 #endif  // SRC_BGP_BGP_COMMON_H_
@@ -7,6 +7,7 @@
 
 #include <boost/intrusive_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <tbb/atomic.h>
 #include <tbb/mutex.h>
 
 #include <map>
@@ -103,9 +104,16 @@ typedef boost::intrusive_ptr<ConditionMatch> ConditionMatchPtr;
 // ConditionMatchState
 // Base class for meta data that Condition Match adds against BgpRoute
 //
+// The update_pending flag is used by modules that post add/change requests
+// for the route to a WorkQueue. It's set when an add/change request is in
+// the queue so that further add/changes for the route before the request
+// is processed can be coalesced into it. Since the request is processed
+// based on the state of the route at that time, nothing gets lost.
+//
 class ConditionMatchState {
 public:
-    ConditionMatchState() : refcount_(0), deleted_(false) {
+    ConditionMatchState()
+        : refcount_(0), deleted_(false), update_pending_(false) {
     }
     virtual ~ConditionMatchState() {
     }
@@ -128,10 +136,58 @@ public:
         assert(refcount_);
         refcount_--;
     }
+    bool update_pending() const { return update_pending_; }
+    void set_update_pending() { update_pending_ = true; }
+    void reset_update_pending() { update_pending_ = false; }
 
 private:
     uint32_t refcount_;
     bool deleted_;
+    bool update_pending_;
+};
+
+//
+// ConditionMatchQueueStats
+// Statistics for the WorkQueue used by a module to process the results of
+// condition matches.
+//
+// Enqueues and coalesced add/changes are counted in the db::DBTable task,
+// possibly from multiple partitions at the same time. The processed count
+// and latency are updated only in the task that drains the queue.
+//
+class ConditionMatchQueueStats {
+public:
+    ConditionMatchQueueStats()
+        : processed_(0), total_latency_usec_(0), max_latency_usec_(0) {
+        enqueued_ = 0;
+        coalesced_ = 0;
+    }
+
+    void RecordEnqueue() { enqueued_++; }
+    void RecordCoalesced() { coalesced_++; }
+    void RecordProcessed(uint64_t latency_usec) {
+        processed_++;
+        total_latency_usec_ += latency_usec;
+        if (latency_usec > max_latency_usec_)
+            max_latency_usec_ = latency_usec;
+    }
+
+    uint64_t enqueued() const { return enqueued_; }
+    uint64_t coalesced() const { return coalesced_; }
+    uint64_t processed() const { return processed_; }
+    uint64_t average_latency_usec() const {
+        return processed_ ? total_latency_usec_ / processed_ : 0;
+    }
+    uint64_t max_latency_usec() const { return max_latency_usec_; }
+
+private:
+    tbb::atomic<uint64_t> enqueued_;
+    tbb::atomic<uint64_t> coalesced_;
+    uint64_t processed_;
+    uint64_t total_latency_usec_;
+    uint64_t max_latency_usec_;
+
+    DISALLOW_COPY_AND_ASSIGN(ConditionMatchQueueStats);
 };
 
 //
@@ -720,6 +720,10 @@ public:
     void Notify(const BgpConfigObject *, EventType);
 
     const BgpServer *server() { return server_; }
+    const BgpConfigPhaseStats &config_stats() const { return config_stats_; }
+
+protected:
+    BgpConfigPhaseStats config_stats_;
 
 private:
     BgpServer *server_;
@@ -10,6 +10,7 @@
 
 #include "base/string_util.h"
 #include "base/task_annotations.h"
+#include "base/time_util.h"
 #include "bgp/bgp_common.h"
 #include "bgp/bgp_config_listener.h"
 #include "bgp/bgp_log.h"
@@ -22,6 +23,7 @@
 using std::auto_ptr;
 using std::find;
 using std::make_pair;
+using std::map;
 using std::pair;
 using std::set;
 using std::sort;
@@ -2329,6 +2331,87 @@ void BgpIfmapConfigManager::ProcessChanges(const ChangeList &change_list) {
     }
 }
 
+//
+// Order in which BgpConfigDeltas are processed after they are coalesced.
+// Identifier types that are not in the list are processed at the end.
+//
+static const char *kConfigDeltaTypeOrder[] = {
+    "global-system-config",
+    "global-qos-config",
+    "routing-policy",
+    "routing-instance",
+    "bgp-router",
+    "routing-policy-routing-instance",
+    "bgp-peering",
+};
+static const size_t kConfigDeltaTypeCount =
+    sizeof(kConfigDeltaTypeOrder) / sizeof(kConfigDeltaTypeOrder[0]);
+
+static size_t ConfigDeltaRank(const string &id_type) {
+    for (size_t rank = 0; rank < kConfigDeltaTypeCount; ++rank) {
+        if (id_type == kConfigDeltaTypeOrder[rank])
+            return rank;
+    }
+    return kConfigDeltaTypeCount;
+}
+
+//
+// Collapse multiple BgpConfigDeltas for the same object into one.
+//
+// The same object is typically added to the change list several times when
+// the config snapshot is read after a restart e.g. a routing-instance gets
+// added once for the node itself and once for each of its instance-target
+// and connection links. The handlers look at the current state of the node
+// and not at the delta, so processing the object once is sufficient. The
+// contents of the delta are taken from the last occurrence since they are
+// the latest. This also takes care of an object that is deleted and added
+// again, or vice versa, in the same change list.
+//
+// Processing an object only once is safe only if the objects it depends on
+// have been processed before it. Without coalescing, a later duplicate would
+// take care of a dependency that was processed out of order, e.g. the link
+// between a routing-instance and a routing-policy is ignored by its handler
+// if either the BgpIfmapInstanceConfig or the BgpIfmapRoutingPolicyConfig
+// does not exist yet, and observers of a routing-instance look up the
+// routing-policies by name when the instance is created. Hence the coalesced
+// deltas are ordered by identifier type as per kConfigDeltaTypeOrder, so that
+// routing-policies, routing-instances and the local bgp-router are processed
+// before the links and bgp-peerings that refer to them. Deltas of the same
+// type are kept in the order in which they were first seen. The order does
+// not matter for deletes since the handlers for both ends of a dependency
+// call DeleteIfEmpty.
+//
+void BgpIfmapConfigManager::CoalesceChanges(ChangeList *change_list) {
+    typedef map<pair<string, string>, size_t> DeltaIndexMap;
+
+    if (change_list->size() < 2)
+        return;
+
+    DeltaIndexMap index_map;
+    size_t count = 0;
+    for (size_t idx = 0; idx < change_list->size(); ++idx) {
+        const BgpConfigDelta &delta = (*change_list)[idx];
+        pair<DeltaIndexMap::iterator, bool> result = index_map.insert(
+            make_pair(make_pair(delta.id_type, delta.id_name), count));
+        size_t position = result.first->second;
+        if (result.second)
+            count++;
+        if (position != idx)
+            (*change_list)[position] = delta;
+    }
+    change_list->resize(count);
+
+    vector<ChangeList> rank_lists(kConfigDeltaTypeCount + 1);
+    BOOST_FOREACH(const BgpConfigDelta &delta, *change_list) {
+        rank_lists[ConfigDeltaRank(delta.id_type)].push_back(delta);
+    }
+    change_list->clear();
+    BOOST_FOREACH(const ChangeList &rank_list, rank_lists) {
+        change_list->insert(change_list->end(),
+            rank_list.begin(), rank_list.end());
+    }
+}
+
 //
 // Build and process the change list of BgpConfigDeltas.  The logic to build
 // the list is in BgpConfigListener and BgpConfigListener::DependencyTracker.
@@ -2336,9 +2419,16 @@ void BgpIfmapConfigManager::ProcessChanges(const ChangeList &change_list) {
 bool BgpIfmapConfigManager::ConfigHandler() {
     CHECK_CONCURRENCY("bgp::Config");
 
+    uint64_t start = UTCTimestampUsec();
     BgpConfigListener::ChangeList change_list;
     listener_->GetChangeList(&change_list);
+    size_t delta_count = change_list.size();
+    CoalesceChanges(&change_list);
     ProcessChanges(change_list);
+    if (delta_count) {
+        config_stats_.Update(start, UTCTimestampUsec(), change_list.size(),
+            delta_count - change_list.size());
+    }
     return true;
 }
 
@@ -500,6 +500,7 @@ private:
     void IdentifierMapInit();
     void DefaultConfig();
 
+    static void CoalesceChanges(ChangeList *change_list);
     void ProcessChanges(const ChangeList &change_list);
     void ProcessRoutingInstance(const BgpConfigDelta &change);
     void ProcessRoutingPolicyLink(const BgpConfigDelta &change);
@@ -245,8 +245,14 @@ UpdateInfo *EvpnLocalMcastNode::GetUpdateInfo() {
     uint32_t local_ethernet_tag = route_->GetPrefix().tag();
 
     // Go through list of EvpnRemoteMcastNodes and build the BgpOList.
+    // If we support edge replication, only the remote nodes that don't are
+    // of interest and they are all in the regular node list.
     BgpOListSpec olist_spec(BgpAttribute::OList);
-    BOOST_FOREACH(EvpnMcastNode *node, partition_->remote_mcast_node_list()) {
+    const EvpnManagerPartition::EvpnMcastNodeList &remote_node_list =
+        edge_replication_not_supported_ ?
+            partition_->remote_mcast_node_list() :
+            partition_->regular_node_list();
+    BOOST_FOREACH(EvpnMcastNode *node, remote_node_list) {
         uint32_t remote_ethernet_tag = node->route()->GetPrefix().tag();
 
         if (node->address() == address_)
@@ -355,18 +361,35 @@ void EvpnManagerPartition::NotifyReplicatorNodeRoutes() {
     }
 }
 
+//
+// Go through all replicator EvpnMcastNodes with the given address and notify
+// associated Broadcast MAC route. Used when a leaf with the given replicator
+// address joins or leaves.
+//
+void EvpnManagerPartition::NotifyReplicatorNodeRoutes(
+    const Ip4Address &address) {
+    DBTablePartition *tbl_partition = GetTablePartition();
+    BOOST_FOREACH(EvpnMcastNode *node, replicator_node_list_) {
+        if (node->address() != address)
+            continue;
+        tbl_partition->Notify(node->route());
+    }
+}
+
 //
 // Go through all ingress replication client EvpnMcastNodes and notify the
 // associated Broadcast MAC route.
 //
+// If exclude_edge_replication_supported is true, only the nodes that do not
+// support edge replication need to be notified. These are kept in a separate
+// list so that we don't need to skip over the others.
+//
 void EvpnManagerPartition::NotifyIrClientNodeRoutes(
     bool exclude_edge_replication_supported) {
     DBTablePartition *tbl_partition = GetTablePartition();
-    BOOST_FOREACH(EvpnMcastNode *node, ir_client_node_list_) {
-        if (exclude_edge_replication_supported &&
-            !node->edge_replication_not_supported()) {
-            continue;
-        }
+    const EvpnMcastNodeList &node_list = exclude_edge_replication_supported ?
+        regular_ir_client_node_list_ : ir_client_node_list_;
+    BOOST_FOREACH(EvpnMcastNode *node, node_list) {
         tbl_partition->Notify(node->route());
     }
 }
@@ -379,14 +402,17 @@ void EvpnManagerPartition::AddMcastNode(EvpnMcastNode *node) {
         local_mcast_node_list_.insert(node);
         if (node->assisted_replication_supported())
             replicator_node_list_.insert(node);
-        if (!node->assisted_replication_leaf())
+        if (!node->assisted_replication_leaf()) {
             ir_client_node_list_.insert(node);
+            if (node->edge_replication_not_supported())
+                regular_ir_client_node_list_.insert(node);
+        }
         NotifyNodeRoute(node);
     } else {
         remote_mcast_node_list_.insert(node);
         if (node->assisted_replication_leaf()) {
             leaf_node_list_.insert(node);
-            NotifyReplicatorNodeRoutes();
+            NotifyReplicatorNodeRoutes(node->replicator_address());
         } else if (node->edge_replication_not_supported()) {
             regular_node_list_.insert(node);
             NotifyIrClientNodeRoutes(false);
@@ -404,14 +430,16 @@ void EvpnManagerPartition::DeleteMcastNode(EvpnMcastNode *node) {
         local_mcast_node_list_.erase(node);
         replicator_node_list_.erase(node);
         ir_client_node_list_.erase(node);
+        regular_ir_client_node_list_.erase(node);
     } else {
         remote_mcast_node_list_.erase(node);
+        bool was_regular = regular_node_list_.erase(node) > 0;
         if (leaf_node_list_.erase(node) > 0) {
-            NotifyReplicatorNodeRoutes();
-        } else {
+            NotifyReplicatorNodeRoutes(node->replicator_address());
+        } else if (!was_regular) {
             NotifyIrClientNodeRoutes(true);
         }
-        if (regular_node_list_.erase(node) > 0)
+        if (was_regular)
             NotifyIrClientNodeRoutes(false);
     }
     if (empty())
@@ -430,8 +458,12 @@ void EvpnManagerPartition::UpdateMcastNode(EvpnMcastNode *node) {
         if (node->assisted_replication_supported())
             replicator_node_list_.insert(node);
         ir_client_node_list_.erase(node);
-        if (!node->assisted_replication_leaf())
+        regular_ir_client_node_list_.erase(node);
+        if (!node->assisted_replication_leaf()) {
             ir_client_node_list_.insert(node);
+            if (node->edge_replication_not_supported())
+                regular_ir_client_node_list_.insert(node);
+        }
         NotifyNodeRoute(node);
     } else {
         bool was_leaf = leaf_node_list_.erase(node) > 0;
@@ -462,6 +494,7 @@ bool EvpnManagerPartition::empty() const {
     assert(replicator_node_list_.empty());
     assert(regular_node_list_.empty());
     assert(ir_client_node_list_.empty());
+    assert(regular_ir_client_node_list_.empty());
     return true;
 }
 
@@ -142,6 +142,26 @@ private:
 // track of local and remote EvpnMcastNodes that belong to the partition. The
 // partition is determined on the ethernet tag in the EvpnRoute.
 //
+// Besides the complete lists of local and remote EvpnMcastNodes, subsets of
+// the nodes are kept in separate lists so that a join or leave of a node only
+// notifies the Broadcast MAC routes of the EvpnLocalMcastNodes whose OList is
+// affected, and so that building the OList for an EvpnLocalMcastNode doesn't
+// need to look at nodes that never make it to the OList. This matters in a
+// large L2 VN, where most nodes are vRouters that support edge replication:
+//
+// - replicator_node_list_ has local nodes that support assisted replication.
+// - ir_client_node_list_ has local nodes that are not assisted replication
+//   leafs. These get an ingress replication OList.
+// - regular_ir_client_node_list_ has the nodes in ir_client_node_list_ that
+//   don't support edge replication. Only these need an update when a remote
+//   node that supports edge replication joins or leaves.
+// - leaf_node_list_ has remote nodes that are assisted replication leafs.
+//   Only the replicator with the leaf's replicator address needs an update
+//   when a leaf joins or leaves.
+// - regular_node_list_ has remote nodes that are not leafs and don't support
+//   edge replication. These are the only remote nodes that are added to the
+//   OList of a local node that supports edge replication.
+//
 class EvpnManagerPartition {
 public:
     typedef std::set<EvpnMcastNode *> EvpnMcastNodeList;
@@ -152,6 +172,7 @@ public:
     DBTablePartition *GetTablePartition();
     void NotifyNodeRoute(EvpnMcastNode *node);
     void NotifyReplicatorNodeRoutes();
+    void NotifyReplicatorNodeRoutes(const Ip4Address &address);
     void NotifyIrClientNodeRoutes(bool exclude_edge_replication_supported);
     void AddMcastNode(EvpnMcastNode *node);
     void DeleteMcastNode(EvpnMcastNode *node);
@@ -167,6 +188,9 @@ public:
     const EvpnMcastNodeList &leaf_node_list() const {
         return leaf_node_list_;
     }
+    const EvpnMcastNodeList &regular_node_list() const {
+        return regular_node_list_;
+    }
     BgpServer *server();
     const EvpnTable *table() const;
 
@@ -181,6 +205,7 @@ private:
     EvpnMcastNodeList leaf_node_list_;
     EvpnMcastNodeList regular_node_list_;
     EvpnMcastNodeList ir_client_node_list_;
+    EvpnMcastNodeList regular_ir_client_node_list_;
 
     DISALLOW_COPY_AND_ASSIGN(EvpnManagerPartition);
 };
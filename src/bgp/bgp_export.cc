@@ -6,15 +6,26 @@
 
 #include <boost/bind.hpp>
 
+#include "base/util.h"
 #include "bgp/bgp_ribout_updates.h"
 #include "bgp/bgp_route.h"
+#include "bgp/bgp_server.h"
 #include "bgp/bgp_table.h"
 #include "bgp/bgp_update.h"
 #include "bgp/bgp_update_monitor.h"
 #include "bgp/bgp_update_sender.h"
+#include "bgp/routing-instance/rtarget_group_mgr.h"
 
 BgpExport::BgpExport(RibOut *ribout)
     : ribout_(ribout) {
+    for (int idx = 0; idx < DB::PartitionCount(); ++idx) {
+        rtarget_indexes_.push_back(new RTargetInterestIndex);
+    }
+    rtarget_filtered_count_ = 0;
+}
+
+BgpExport::~BgpExport() {
+    STLDeleteValues(&rtarget_indexes_);
 }
 
 //
@@ -28,9 +39,74 @@ static bool IsDuplicate(const RouteUpdate *rt_update,
     return rt_update->CompareUpdateInfo(*uinfo_slist);
 }
 
+//
+// Attach shared string representations from the RibOutAttrReprCache of the
+// table partition to the UpdateInfos for reachable routes.  This lets all
+// xmpp RibOuts for the table share a single formatted version of the route
+// with the same RibOutAttr instead of formatting it once per RibOut.
+//
+// Multicast routes are sent to exactly one xmpp peer, so there's no point
+// in sharing the string representation.
+//
+static void LocateSharedRepr(RibOut *ribout, int part_id,
+        const BgpRoute *route, UpdateInfoSList &uinfo_slist) {
+    BgpTable *table = ribout->table();
+    if (!ribout->IsEncodingXmpp() || !table->IsReprCacheEnabled())
+        return;
+    if (table->family() == Address::ERMVPN)
+        return;
+
+    RibOutAttrReprCache *cache = table->repr_cache(part_id);
+    for (UpdateInfoSList::List::iterator iter = uinfo_slist->begin();
+         iter != uinfo_slist->end(); ++iter) {
+        if (!iter->roattr.IsReachable())
+            continue;
+        iter->roattr.set_shared_repr(cache->Locate(route, iter->roattr));
+    }
+}
+
+//
+// Return true if none of the peers in the RibOut are interested in any of
+// the route targets of the route. The route doesn't need to go through the
+// export policy in that case since BgpTable::Export would drop it as part
+// of route target filtering.
+//
+// This only applies to VPN tables with BGP encoding, where route target
+// filtering is done for both iBGP and eBGP RibOuts. The export policy can
+// only drop the route before it gets to the route target filtering, so
+// skipping the policy doesn't change the result.
+//
+bool BgpExport::IsRouteTargetFiltered(int part_id, const BgpRoute *route) {
+    if (!ribout_->IsEncodingBgp())
+        return false;
+
+    BgpTable *table = ribout_->table();
+    Address::Family family = table->family();
+    if (family != Address::INETVPN && family != Address::INET6VPN &&
+        family != Address::EVPN && family != Address::ERMVPN) {
+        return false;
+    }
+
+    const BgpPath *path = route->BestPath();
+    if (!path || !path->GetAttr()->ext_community())
+        return false;
+
+    RTargetGroupMgr *mgr = table->server()->rtarget_group_mgr();
+    RTargetInterestIndex *index = rtarget_indexes_[part_id];
+    if (!index->IsCurrent(mgr->interest_generation(), ribout_->PeerSet()))
+        mgr->BuildInterestIndex(ribout_, index);
+    if (index->MayBeInterested(path->GetAttr()->ext_community()))
+        return false;
+
+    rtarget_filtered_count_++;
+    return true;
+}
+
 //
 // Export Processing.
 // 1. Calculate the desired attributes (UpdateInfo list) via BgpTable::Export.
+//    Skip this for routes that no peer in the RibOut wants based on route
+//    target filtering.
 // 2. Dequeue the existing update if present.
 //    a) If the current update is the same as desired update then the operation
 //    is a NOP.
@@ -47,7 +123,8 @@ void BgpExport::Export(DBTablePartBase *root, DBEntryBase *db_entry) {
     // Calculate attributes by running through export policy.
     BgpRoute *route = static_cast<BgpRoute *>(db_entry);
     bool reach = false;
-    if (!db_entry->IsDeleted() && !ribout_->PeerSet().empty()) {
+    if (!db_entry->IsDeleted() && !ribout_->PeerSet().empty() &&
+        !IsRouteTargetFiltered(root->index(), route)) {
         reach = ribout_->table()->Export(ribout_, route, ribout_->PeerSet(),
                 uinfo_slist);
     }
@@ -163,6 +240,7 @@ void BgpExport::Export(DBTablePartBase *root, DBEntryBase *db_entry) {
     // Associate the new UpdateInfos we want to send with the RouteUpdate
     // and enqueue the RouteUpdate.
     assert(!uinfo_slist->empty());
+    LocateSharedRepr(ribout_, root->index(), route, uinfo_slist);
     rt_update->SetUpdateInfo(uinfo_slist);
     updates->Enqueue(db_entry, rt_update);
 }
@@ -210,6 +288,7 @@ bool BgpExport::Join(DBTablePartBase *root, const RibPeerSet &mjoin,
     }
 
     // Create a new update.
+    LocateSharedRepr(ribout_, root->index(), route, uinfo_slist);
     RouteUpdate *rt_update = new RouteUpdate(route, RibOutUpdates::QBULK);
     rt_update->SetUpdateInfo(uinfo_slist);
 
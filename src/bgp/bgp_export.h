@@ -5,17 +5,23 @@
 #ifndef SRC_BGP_BGP_EXPORT_H_
 #define SRC_BGP_BGP_EXPORT_H_
 
+#include <tbb/atomic.h>
+
 #include <memory>
+#include <vector>
 
+class BgpRoute;
 class BgpTable;
 class DBEntryBase;
 class DBTablePartBase;
 class RibOut;
 class RibPeerSet;
+class RTargetInterestIndex;
 
 class BgpExport {
 public:
     explicit BgpExport(RibOut *ribout);
+    ~BgpExport();
 
     void Export(DBTablePartBase *root, DBEntryBase *db_entry);
 
@@ -32,8 +38,15 @@ public:
     bool Leave(DBTablePartBase *root, const RibPeerSet &mleave,
                DBEntryBase *db_entry);
 
+    // Number of routes skipped because no peer wants their route targets.
+    uint64_t rtarget_filtered_count() const { return rtarget_filtered_count_; }
+
 private:
+    bool IsRouteTargetFiltered(int part_id, const BgpRoute *route);
+
     RibOut *ribout_;
+    std::vector<RTargetInterestIndex *> rtarget_indexes_;
+    tbb::atomic<uint64_t> rtarget_filtered_count_;
 };
 
 #endif  // SRC_BGP_BGP_EXPORT_H_
@@ -6,8 +6,11 @@
 
 #include <boost/foreach.hpp>
 
+#include <algorithm>
+
 #include "base/task_annotations.h"
 #include "base/task_trigger.h"
+#include "base/time_util.h"
 #include "bgp/bgp_export.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_peer_types.h"
@@ -15,6 +18,8 @@
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_update_sender.h"
 #include "bgp/routing-instance/routing_instance.h"
+#include "db/db.h"
+#include "db/db_table_partition.h"
 
 using std::list;
 using std::make_pair;
@@ -32,6 +37,11 @@ BgpMembershipManager::BgpMembershipManager(BgpServer *server)
           boost::bind(&BgpMembershipManager::EventCallback, this, _1))) {
     current_jobs_count_ = 0;
     total_jobs_count_ = 0;
+    walk_count_ = 0;
+    walk_time_usec_ = 0;
+    walk_path_count_ = 0;
+    walk_path_change_count_ = 0;
+    walk_join_count_ = 0;
 }
 
 //
@@ -824,6 +834,12 @@ BgpMembershipManager::RibState::RibState(BgpMembershipManager *manager,
       table_(table),
       request_count_(0),
       walk_count_(0),
+      join_count_(0),
+      walk_peer_count_max_(0),
+      walk_time_usec_(0),
+      walk_time_usec_last_(0),
+      walk_path_count_(0),
+      walk_path_change_count_(0),
       table_delete_ref_(this, table->deleter()) {
 }
 
@@ -866,6 +882,19 @@ bool BgpMembershipManager::RibState::RemovePeerRibState(PeerRibState *prs) {
     return peer_rib_list_.empty();
 }
 
+//
+// Update statistics for a walk of the BgpTable that just finished.
+//
+void BgpMembershipManager::RibState::UpdateWalkStats(uint64_t walk_time_usec,
+    size_t peer_count, uint64_t path_count, uint64_t path_change_count) {
+    walk_time_usec_ += walk_time_usec;
+    walk_time_usec_last_ = walk_time_usec;
+    walk_path_count_ += path_count;
+    walk_path_change_count_ += path_change_count;
+    if (peer_count > walk_peer_count_max_)
+        walk_peer_count_max_ = peer_count;
+}
+
 //
 // Fill introspect information.
 //
@@ -874,6 +903,15 @@ void BgpMembershipManager::RibState::FillRoutingInstanceTableInfo(
     ShowTableMembershipInfo stmi;
     stmi.set_requests(request_count_);
     stmi.set_walks(walk_count_);
+    stmi.set_pending_requests(pending_peer_rib_list_.size());
+    stmi.set_joins(join_count_);
+    stmi.set_walk_time_usec(walk_time_usec_);
+    stmi.set_last_walk_time_usec(walk_time_usec_last_);
+    stmi.set_walk_paths(walk_path_count_);
+    stmi.set_walk_paths_changed(walk_path_change_count_);
+    stmi.set_walk_paths_per_sec(walk_time_usec_ ?
+        walk_path_count_ * 1000000 / walk_time_usec_ : 0);
+    stmi.set_walk_peers_max(walk_peer_count_max_);
     vector<ShowMembershipPeerInfo> peers;
     for (PeerRibList::const_iterator it = peer_rib_list_.begin();
          it != peer_rib_list_.end(); ++it) {
@@ -1005,6 +1043,170 @@ void BgpMembershipManager::PeerRibState::FillMembershipInfo(
     smpi->set_generation_id(subscription_gen_id_);
 }
 
+//
+// A group of PeerRibStates that are serviced together in a table walk.
+//
+// peer_rib_list_ is used to create and enqueue events when the table walk
+// finishes.
+// peer_list_ is the list of IPeers to be notified about BgpPaths added by
+// them for RibIn processing. It's kept sorted so that the IPeer for a BgpPath
+// can be looked up with a binary search of a contiguous array. This matters
+// when a large number of peers go down at the same time and get handled in a
+// single walk e.g. when a rack of agents loses power.
+// ribout_state_map_ is a map of RibOutStates that need to be processed for
+// each route and ribout_state_list_ is a list of the same RibOutStates. The
+// list allows simpler traversal when each DBEntry is processed.
+//
+// A RibOutState is created for each unique RibOut in the PeerRibStates in
+// peer_rib_list_. It's join and leave bitsets are based on the action in
+// the PeerRibStates.
+//
+class BgpMembershipManager::Walker::PeerRibGroup {
+public:
+    PeerRibGroup() : ribout_state_list_size_(0) { }
+    ~PeerRibGroup() { Clear(); }
+
+    void Insert(PeerRibState *prs);
+    void Finalize();
+    void ProcessRibOuts(DBTablePartBase *tpart, DBEntryBase *db_entry);
+    void TriggerCompleteEvents(BgpMembershipManager *manager, BgpTable *table);
+    void Clear();
+
+    bool empty() const { return peer_rib_list_.empty(); }
+    bool HasPeer(const IPeer *peer) const {
+        return std::binary_search(peer_list_.begin(), peer_list_.end(), peer);
+    }
+    bool HasRibIns() const { return !peer_list_.empty(); }
+    bool HasRibOuts() const { return !ribout_state_map_.empty(); }
+    size_t peer_list_size() const { return peer_list_.size(); }
+    size_t peer_rib_list_size() const { return peer_rib_list_.size(); }
+    size_t ribout_state_list_size() const { return ribout_state_list_size_; }
+
+private:
+    RibOutState *LocateRibOutState(RibOut *ribout);
+
+    PeerRibList peer_rib_list_;
+    PeerList peer_list_;
+    RibOutStateMap ribout_state_map_;
+    RibOutStateList ribout_state_list_;
+    size_t ribout_state_list_size_;
+
+    DISALLOW_COPY_AND_ASSIGN(PeerRibGroup);
+};
+
+//
+// Find or create the RibOutState for given RibOut.
+//
+BgpMembershipManager::Walker::RibOutState *
+BgpMembershipManager::Walker::PeerRibGroup::LocateRibOutState(RibOut *ribout) {
+    RibOutStateMap::iterator loc = ribout_state_map_.find(ribout);
+    if (loc == ribout_state_map_.end()) {
+        RibOutState *ros = new RibOutState(ribout);
+        ribout_state_map_.insert(make_pair(ribout, ros));
+        ribout_state_list_.push_back(ros);
+        ribout_state_list_size_++;
+        return ros;
+    } else {
+        return loc->second;
+    }
+}
+
+//
+// Add the given PeerRibState to the group.
+// Update PeerList for RIBIN actions and RibOutStateMap for RIBOUT actions.
+//
+void BgpMembershipManager::Walker::PeerRibGroup::Insert(PeerRibState *prs) {
+    peer_rib_list_.insert(prs);
+
+    switch (prs->action()) {
+    case RIBOUT_ADD: {
+        RibOutState *ros = LocateRibOutState(prs->ribout());
+        ros->JoinPeer(prs->ribout_index());
+        break;
+    }
+    case RIBIN_DELETE:
+    case RIBIN_WALK: {
+        IPeer *peer = prs->peer_state()->peer();
+        peer_list_.push_back(peer);
+        break;
+    }
+    case RIBIN_WALK_RIBOUT_DELETE:
+    case RIBIN_DELETE_RIBOUT_DELETE: {
+        IPeer *peer = prs->peer_state()->peer();
+        peer_list_.push_back(peer);
+        RibOutState *ros = LocateRibOutState(prs->ribout());
+        ros->LeavePeer(prs->ribout_index());
+        break;
+    }
+    default: {
+        assert(false);
+        break;
+    }
+    }
+}
+
+//
+// Sort the PeerList so that HasPeer can do a binary search. There are no
+// duplicates since a peer has a single PeerRibState per RibState.
+//
+void BgpMembershipManager::Walker::PeerRibGroup::Finalize() {
+    std::sort(peer_list_.begin(), peer_list_.end());
+}
+
+//
+// Handle join/leave processing for all RibOutStates.
+//
+void BgpMembershipManager::Walker::PeerRibGroup::ProcessRibOuts(
+    DBTablePartBase *tpart, DBEntryBase *db_entry) {
+    for (RibOutStateList::iterator it = ribout_state_list_.begin();
+         it != ribout_state_list_.end(); ++it) {
+        RibOutState *ros = *it;
+        RibOut *ribout = ros->ribout();
+        ribout->bgp_export()->Join(tpart, ros->join_bitset(), db_entry);
+        ribout->bgp_export()->Leave(tpart, ros->leave_bitset(), db_entry);
+    }
+}
+
+//
+// Trigger the completion Event for all PeerRibStates in the group.
+//
+void BgpMembershipManager::Walker::PeerRibGroup::TriggerCompleteEvents(
+    BgpMembershipManager *manager, BgpTable *table) {
+    for (PeerRibList::iterator it = peer_rib_list_.begin();
+         it != peer_rib_list_.end(); ++it) {
+        PeerRibState *prs = *it;
+        IPeer *peer = prs->peer_state()->peer();
+
+        switch (prs->action()) {
+        case RIBOUT_ADD:
+            manager->TriggerRegisterRibCompleteEvent(peer, table);
+            break;
+        case RIBIN_DELETE:
+        case RIBIN_WALK:
+            manager->TriggerWalkRibCompleteEvent(peer, table);
+            break;
+        case RIBIN_WALK_RIBOUT_DELETE:
+        case RIBIN_DELETE_RIBOUT_DELETE:
+            manager->TriggerUnregisterRibCompleteEvent(peer, table);
+            break;
+        default:
+            assert(false);
+            break;
+        }
+    }
+}
+
+//
+// Clear all state in the group.
+//
+void BgpMembershipManager::Walker::PeerRibGroup::Clear() {
+    peer_rib_list_.clear();
+    peer_list_.clear();
+    ribout_state_list_.clear();
+    ribout_state_list_size_ = 0;
+    STLDeleteElements(&ribout_state_map_);
+}
+
 //
 // Constructor.
 //
@@ -1017,8 +1219,11 @@ BgpMembershipManager::Walker::Walker(BgpMembershipManager *manager)
       walk_started_(false),
       walk_completed_(false),
       rs_(NULL),
-      rib_state_list_size_(0),
-      ribout_state_list_size_(0) {
+      group_(new PeerRibGroup),
+      late_group_(new PeerRibGroup),
+      late_state_(LATE_NONE),
+      walk_start_usec_(0),
+      rib_state_list_size_(0) {
 }
 
 //
@@ -1030,15 +1235,17 @@ BgpMembershipManager::Walker::~Walker() {
     assert(!postpone_walk_);
     assert(!rs_);
     assert(walk_ref_ == NULL);
-    assert(peer_rib_list_.empty());
-    assert(peer_list_.empty());
-    assert(ribout_state_map_.empty());
-    assert(ribout_state_list_.empty());
+    assert(group_->empty());
+    assert(late_group_->empty());
+    assert(late_state_ == LATE_NONE);
+    assert(late_cursors_.empty());
 }
 
 //
 // Add the given RibState to the RibStateList if it's not already present.
 // Trigger processing of the RibStateList if a walk is not already in progress.
+// If a walk is in progress for the same RibState, trigger processing so that
+// the new requests can join the ongoing walk.
 //
 void BgpMembershipManager::Walker::Enqueue(RibState *rs) {
     if (rib_state_set_.find(rs) != rib_state_set_.end())
@@ -1046,7 +1253,7 @@ void BgpMembershipManager::Walker::Enqueue(RibState *rs) {
     rib_state_set_.insert(rs);
     rib_state_list_.push_back(rs);
     rib_state_list_size_++;
-    if (!walk_started_)
+    if (!walk_started_ || (rs == rs_ && late_state_ == LATE_NONE))
         trigger_->Set();
 }
 
@@ -1058,20 +1265,35 @@ bool BgpMembershipManager::Walker::IsQueueEmpty() const {
 }
 
 //
-// Find or create the RibOutState for given RibOut.
+// Return true if the late group needs to be processed for the DBEntry.
 //
-BgpMembershipManager::Walker::RibOutState *
-BgpMembershipManager::Walker::LocateRibOutState(RibOut *ribout) {
-    RibOutStateMap::iterator loc = ribout_state_map_.find(ribout);
-    if (loc == ribout_state_map_.end()) {
-        RibOutState *ros = new RibOutState(ribout);
-        ribout_state_map_.insert(make_pair(ribout, ros));
-        ribout_state_list_.push_back(ros);
-        ribout_state_list_size_++;
-        return ros;
-    } else {
-        return loc->second;
+// When the late group joins an ongoing walk, the first DBEntry visited in a
+// DBTablePartition that needs a tail walk is saved as the cursor. During the
+// tail walk, the late group is processed for all DBEntries that precede the
+// cursor. The cursor is NULL if the DBTablePartition finished the walk before
+// visiting any DBEntry after the late group joined, in which case the tail
+// walk processes the late group for all the DBEntries.
+//
+bool BgpMembershipManager::Walker::IsLateGroupActive(DBTablePartBase *tpart,
+    DBEntryBase *db_entry) {
+    int part_id = tpart->index();
+    if (late_state_ == LATE_JOIN) {
+        if (!late_started_[part_id]) {
+            late_started_[part_id] = 1;
+            if (late_tail_needed_[part_id]) {
+                DBEntry *entry = static_cast<DBEntry *>(db_entry);
+                late_cursors_[part_id] = rs_->table()->AllocEntry(
+                    entry->GetDBRequestKey().get()).release();
+            }
+        }
+        return true;
+    } else if (late_state_ == LATE_TAIL) {
+        if (!late_tail_needed_[part_id])
+            return false;
+        const DBEntry *cursor = late_cursors_[part_id];
+        return (!cursor || static_cast<DBEntry *>(db_entry)->IsLess(*cursor));
     }
+    return false;
 }
 
 //
@@ -1081,21 +1303,22 @@ bool BgpMembershipManager::Walker::WalkCallback(DBTablePartBase *tpart,
     DBEntryBase *db_entry) {
     CHECK_CONCURRENCY("db::DBTable");
 
-    // Walk all RibOutStates and handle join/leave processing.
-    for (RibOutStateList::iterator it = ribout_state_list_.begin();
-         it != ribout_state_list_.end(); ++it) {
-        RibOutState *ros = *it;
-        RibOut *ribout = ros->ribout();
-        ribout->bgp_export()->Join(tpart, ros->join_bitset(), db_entry);
-        ribout->bgp_export()->Leave(tpart, ros->leave_bitset(), db_entry);
-    }
+    entry_counts_[tpart->index()]++;
+    bool late = IsLateGroupActive(tpart, db_entry);
+
+    // Handle join/leave processing for all RibOutStates.
+    group_->ProcessRibOuts(tpart, db_entry);
+    if (late)
+        late_group_->ProcessRibOuts(tpart, db_entry);
 
     // Bail if there's no peers that need RibIn processing.
-    if (peer_list_.empty())
+    if (!group_->HasRibIns() && !(late && late_group_->HasRibIns()))
         return true;
 
     // Walk through all eligible paths and notify the source peer if needed.
     bool notify = false;
+    uint64_t path_count = 0;
+    uint64_t path_change_count = 0;
     BgpRoute *route = static_cast<BgpRoute *>(db_entry);
     for (Route::PathList::iterator it = route->GetPathList().begin(), next = it;
          it != route->GetPathList().end(); it = next) {
@@ -1113,12 +1336,20 @@ bool BgpMembershipManager::Walker::WalkCallback(DBTablePartBase *tpart,
             continue;
 
         // Skip if there's no walk requested for this IPeer.
-        if (!peer || peer_list_.find(peer) == peer_list_.end())
+        if (!peer)
+            continue;
+        if (!group_->HasPeer(peer) && !(late && late_group_->HasPeer(peer)))
             continue;
 
-        notify |= peer->MembershipPathCallback(tpart, route, path);
+        path_count++;
+        if (peer->MembershipPathCallback(tpart, route, path)) {
+            path_change_count++;
+            notify = true;
+        }
     }
 
+    path_counts_[tpart->index()] += path_count;
+    path_change_counts_[tpart->index()] += path_change_count;
     rs_->table()->InputCommonPostProcess(tpart, route, notify);
     return true;
 }
@@ -1144,10 +1375,8 @@ void BgpMembershipManager::Walker::WalkStart() {
 
     assert(walk_ref_ == NULL);
     assert(!rs_);
-    assert(peer_rib_list_.empty());
-    assert(peer_list_.empty());
-    assert(ribout_state_map_.empty());
-    assert(ribout_state_list_.empty());
+    assert(group_->empty());
+    assert(late_state_ == LATE_NONE || late_state_ == LATE_TAIL);
     assert(rib_state_list_size_ == rib_state_set_.size());
 
     // Bail if the list if empty.
@@ -1161,46 +1390,24 @@ void BgpMembershipManager::Walker::WalkStart() {
     assert(rib_state_set_.erase(rs_) == 1);
 
     // Process all pending PeerRibStates for chosen RibState.
-    // Insert the PeerRibStates into PeerRibList for post processing when
+    // Insert the PeerRibStates into PeerRibGroup for post processing when
     // table walk is complete.
     for (RibState::iterator it = rs_->begin(); it != rs_->end(); ++it) {
-        PeerRibState *prs = *it;
-        peer_rib_list_.insert(prs);
-
-        // Update PeerList for RIBIN actions and RibOutStateMap for RIBOUT
-        // actions.
-        switch (prs->action()) {
-        case RIBOUT_ADD: {
-            RibOutState *ros = LocateRibOutState(prs->ribout());
-            ros->JoinPeer(prs->ribout_index());
-            break;
-        }
-        case RIBIN_DELETE:
-        case RIBIN_WALK: {
-            IPeer *peer = prs->peer_state()->peer();
-            peer_list_.insert(peer);
-            break;
-        }
-        case RIBIN_WALK_RIBOUT_DELETE:
-        case RIBIN_DELETE_RIBOUT_DELETE: {
-            IPeer *peer = prs->peer_state()->peer();
-            peer_list_.insert(peer);
-            RibOutState *ros = LocateRibOutState(prs->ribout());
-            ros->LeavePeer(prs->ribout_index());
-            break;
-        }
-        default: {
-            assert(false);
-            break;
-        }
-        }
+        group_->Insert(*it);
     }
+    group_->Finalize();
+    assert(!group_->empty() || late_state_ == LATE_TAIL);
 
     // Clear the pending PeerRibStates in the RibState.
     // This allows the RibState to accumulate new PeerRibStates for a future
     // walk of it's BgpTable.
     rs_->ClearPeerRibStateList();
 
+    // Reset per partition state.
+    entry_counts_.assign(DB::PartitionCount(), 0);
+    path_counts_.assign(DB::PartitionCount(), 0);
+    path_change_counts_.assign(DB::PartitionCount(), 0);
+
     // Start the walk.
     rs_->increment_walk_count();
     BgpTable *table = rs_->table();
@@ -1208,10 +1415,55 @@ void BgpMembershipManager::Walker::WalkStart() {
         boost::bind(&BgpMembershipManager::Walker::WalkCallback, this, _1, _2),
         boost::bind(&BgpMembershipManager::Walker::WalkDoneCallback, this, _2));
     walk_started_ = true;
+    walk_start_usec_ = ClockMonotonicUsec();
     if (!postpone_walk_)
         table->WalkTable(walk_ref_);
 }
 
+//
+// Add pending PeerRibStates for the RibState being walked to the late group
+// so that they get serviced by the ongoing walk and possibly a tail walk.
+//
+// Note the DBTablePartitions that have already visited some DBEntries since
+// they need a tail walk for the late group. A DBTablePartition that has not
+// visited any DBEntry may not have started or may have finished while empty.
+// The two can't be told apart here, so the latter case is handled when the
+// walk finishes, based on whether the late group visited the partition.
+//
+void BgpMembershipManager::Walker::WalkJoin() {
+    CHECK_CONCURRENCY("bgp::PeerMembership");
+
+    assert(walk_started_);
+    assert(!walk_completed_);
+    if (late_state_ != LATE_NONE)
+        return;
+    if (rib_state_set_.find(rs_) == rib_state_set_.end())
+        return;
+
+    // Remove the RibState from the RibStateList since all it's pending
+    // PeerRibStates are going to be serviced now.
+    rib_state_set_.erase(rs_);
+    rib_state_list_.remove(rs_);
+    rib_state_list_size_--;
+
+    for (RibState::iterator it = rs_->begin(); it != rs_->end(); ++it) {
+        late_group_->Insert(*it);
+        rs_->increment_join_count();
+        manager_->walk_join_count_++;
+    }
+    late_group_->Finalize();
+    assert(!late_group_->empty());
+    rs_->ClearPeerRibStateList();
+
+    late_state_ = LATE_JOIN;
+    late_started_.assign(DB::PartitionCount(), 0);
+    late_tail_needed_.assign(DB::PartitionCount(), 0);
+    late_cursors_.assign(DB::PartitionCount(), NULL);
+    for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
+        late_tail_needed_[part_id] = (entry_counts_[part_id] != 0);
+    }
+}
+
 //
 // Finish processing of the walk of BgpTable for current RibState.
 //
@@ -1224,42 +1476,77 @@ void BgpMembershipManager::Walker::WalkFinish() {
 
     assert(walk_ref_ != NULL);
     assert(rs_);
-    assert(!peer_rib_list_.empty());
-    assert(!peer_list_.empty() || !ribout_state_map_.empty());
+    assert(!group_->empty() || !late_group_->empty());
+    assert(group_->HasRibIns() || group_->HasRibOuts() ||
+           late_group_->HasRibIns() || late_group_->HasRibOuts());
     assert(rib_state_list_size_ == rib_state_set_.size());
-    assert(ribout_state_list_size_ == ribout_state_map_.size());
 
-    BgpTable *table = rs_->table();
-    for (PeerRibList::iterator it = peer_rib_list_.begin();
-         it != peer_rib_list_.end(); ++it) {
-        PeerRibState *prs = *it;
-        IPeer *peer = prs->peer_state()->peer();
+    // Update walk statistics.
+    uint64_t walk_time_usec = ClockMonotonicUsec() - walk_start_usec_;
+    uint64_t path_count = 0;
+    uint64_t path_change_count = 0;
+    for (size_t idx = 0; idx < path_counts_.size(); ++idx) {
+        path_count += path_counts_[idx];
+        path_change_count += path_change_counts_[idx];
+    }
+    size_t peer_count = group_->peer_list_size();
+    if (late_state_ == LATE_JOIN)
+        peer_count += late_group_->peer_list_size();
+    rs_->UpdateWalkStats(walk_time_usec, peer_count, path_count,
+        path_change_count);
+    manager_->walk_count_++;
+    manager_->walk_time_usec_ += walk_time_usec;
+    manager_->walk_path_count_ += path_count;
+    manager_->walk_path_change_count_ += path_change_count;
 
-        switch (prs->action()) {
-        case RIBOUT_ADD:
-            manager_->TriggerRegisterRibCompleteEvent(peer, table);
-            break;
-        case RIBIN_DELETE:
-        case RIBIN_WALK:
-            manager_->TriggerWalkRibCompleteEvent(peer, table);
-            break;
-        case RIBIN_WALK_RIBOUT_DELETE:
-        case RIBIN_DELETE_RIBOUT_DELETE:
-            manager_->TriggerUnregisterRibCompleteEvent(peer, table);
-            break;
-        default:
-            assert(false);
-            break;
+    BgpTable *table = rs_->table();
+    group_->TriggerCompleteEvents(manager_, table);
+    group_->Clear();
+
+    // A DBTablePartition in which the late group did not visit any DBEntry
+    // had already finished the walk when the late group joined, or it was
+    // empty. It needs a tail walk if it has DBEntries now, since they were
+    // not processed for the late group. The cursor for such a partition is
+    // NULL, so the tail walk processes the late group for all DBEntries.
+    //
+    // The late group is done if this was the tail walk or if no tail walk is
+    // needed. Otherwise schedule the tail walk ahead of all other RibStates.
+    bool tail_needed = false;
+    if (late_state_ == LATE_JOIN) {
+        for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
+            if (late_started_[part_id])
+                continue;
+            DBTablePartition *tpart = static_cast<DBTablePartition *>(
+                table->GetTablePartition(part_id));
+            if (tpart->size() != 0)
+                late_tail_needed_[part_id] = 1;
         }
+        tail_needed = std::find(late_tail_needed_.begin(),
+            late_tail_needed_.end(), 1) != late_tail_needed_.end();
+    }
+    if (late_state_ != LATE_NONE && !tail_needed) {
+        late_group_->TriggerCompleteEvents(manager_, table);
+        late_group_->Clear();
+        late_state_ = LATE_NONE;
+        late_started_.clear();
+        late_tail_needed_.clear();
+        STLDeleteValues(&late_cursors_);
+    } else if (tail_needed) {
+        late_state_ = LATE_TAIL;
+        if (rib_state_set_.find(rs_) == rib_state_set_.end()) {
+            rib_state_set_.insert(rs_);
+            rib_state_list_size_++;
+        } else {
+            rib_state_list_.remove(rs_);
+        }
+        rib_state_list_.push_front(rs_);
     }
 
     table->ReleaseWalker(walk_ref_);
     rs_ = NULL;
-    peer_rib_list_.clear();
-    peer_list_.clear();
-    ribout_state_list_.clear();
-    ribout_state_list_size_ = 0;
-    STLDeleteElements(&ribout_state_map_);
+    entry_counts_.clear();
+    path_counts_.clear();
+    path_change_counts_.clear();
 
     walk_started_ = false;
     walk_completed_ = false;
@@ -1268,7 +1555,7 @@ void BgpMembershipManager::Walker::WalkFinish() {
 //
 // Handler for TaskTrigger.
 // Start a new walk or finish processing for the current walk and start a new
-// one.
+// one. Let new requests join the current walk if it's still in progress.
 //
 bool BgpMembershipManager::Walker::WalkTrigger() {
     CHECK_CONCURRENCY("bgp::PeerMembership");
@@ -1279,6 +1566,8 @@ bool BgpMembershipManager::Walker::WalkTrigger() {
     } else if (walk_completed_) {
         WalkFinish();
         WalkStart();
+    } else {
+        WalkJoin();
     }
     return true;
 }
@@ -1296,6 +1585,34 @@ void BgpMembershipManager::Walker::SetQueueDisable(bool value) {
     }
 }
 
+//
+// Testing only.
+//
+size_t BgpMembershipManager::Walker::GetPeerListSize() const {
+    return group_->peer_list_size();
+}
+
+//
+// Testing only.
+//
+size_t BgpMembershipManager::Walker::GetPeerRibListSize() const {
+    return group_->peer_rib_list_size();
+}
+
+//
+// Testing only.
+//
+size_t BgpMembershipManager::Walker::GetRibOutStateListSize() const {
+    return group_->ribout_state_list_size();
+}
+
+//
+// Testing only.
+//
+size_t BgpMembershipManager::Walker::GetLatePeerRibListSize() const {
+    return late_group_->peer_rib_list_size();
+}
+
 //
 // Force the Walker to trigger walks that are postponed.
 // Testing only.
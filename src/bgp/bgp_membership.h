@@ -125,6 +125,13 @@ public:
     size_t GetMembershipCount() const;
     uint64_t current_jobs_count() const { return current_jobs_count_; }
     uint64_t total_jobs_count() const { return total_jobs_count_; }
+    uint64_t walk_count() const { return walk_count_; }
+    uint64_t walk_join_count() const { return walk_join_count_; }
+    uint64_t walk_time_usec() const { return walk_time_usec_; }
+    uint64_t walk_path_count() const { return walk_path_count_; }
+    uint64_t walk_path_change_count() const {
+        return walk_path_change_count_;
+    }
 
 protected:
     struct Event;
@@ -210,6 +217,11 @@ private:
     BgpServer *server_;
     tbb::atomic<uint64_t> current_jobs_count_;
     tbb::atomic<uint64_t> total_jobs_count_;
+    tbb::atomic<uint64_t> walk_count_;
+    tbb::atomic<uint64_t> walk_time_usec_;
+    tbb::atomic<uint64_t> walk_path_count_;
+    tbb::atomic<uint64_t> walk_path_change_count_;
+    tbb::atomic<uint64_t> walk_join_count_;
     RibStateMap rib_state_map_;
     PeerStateMap peer_state_map_;
     boost::scoped_ptr<Walker> walker_;
@@ -288,6 +300,10 @@ private:
 // The regular PeerRibList contains all the PeerRibStates for this RibState.
 // It is used only for introspect.
 //
+// Statistics for the walks of the BgpTable are updated by the Walker when a
+// walk finishes. The time and path counts allow computation of the rate at
+// which paths are processed when peers go down or complete graceful restart.
+//
 class BgpMembershipManager::RibState {
 public:
     typedef BgpMembershipManager::PeerRibState PeerRibState;
@@ -311,12 +327,21 @@ public:
 
     BgpTable *table() const { return table_; }
     void increment_walk_count() { walk_count_++; }
+    void increment_join_count() { join_count_++; }
+    void UpdateWalkStats(uint64_t walk_time_usec, size_t peer_count,
+        uint64_t path_count, uint64_t path_change_count);
 
 private:
     BgpMembershipManager *manager_;
     BgpTable *table_;
     uint32_t request_count_;
     uint32_t walk_count_;
+    uint32_t join_count_;
+    uint32_t walk_peer_count_max_;
+    uint64_t walk_time_usec_;
+    uint64_t walk_time_usec_last_;
+    uint64_t walk_path_count_;
+    uint64_t walk_path_change_count_;
     PeerRibList peer_rib_list_;
     PeerRibList pending_peer_rib_list_;
     LifetimeRef<RibState> table_delete_ref_;
@@ -414,23 +439,38 @@ private:
 //
 // - walk_ref_ is the walker for the current walk
 // - rs_ is the RibState for which the walk was started
-// - peer_rib_list_ is the list of PeerRibStates for the current RibState
+// - group_ is the PeerRibGroup for the PeerRibStates of the current RibState
 //   that have a pending action. The pending list in RibState is logically
 //   moved to this field. This allows the RibState to accumulate a new set
 //   of pending PeerRibStates that can be serviced in a subsequent walk.
-//   The peer_rib_list_ is used to create and enqueue events when the table
-//   walk finishes.
-// - peer_list_ is the list of IPeers to be notified about BgpPaths added
-//   by them for RibIn processing.
-// - ribout_state_map_ is a map of RibOutStates that need to be processed
-//   for each route.
-// - ribout_state_list_ is a list of same RibOutStates as ribout_state_map_.
-//   It allows simpler traversal compared to the ribout_state_map_ when each
-//   DBEntry is processed.
+// - entry_counts_, path_counts_ and path_change_counts_ have an entry per
+//   DBTablePartition and keep track of the number of DBEntries visited, the
+//   number of BgpPaths passed to the IPeers and the number that were modified
+//   or deleted by the IPeers. Each entry is only updated from the db::DBTable
+//   task for the partition, so no locking is needed.
+// - walk_start_usec_ is the time at which the walk was started.
 //
-// A RibOutState is created for each unique RibOut in the PeerRibStates in
-// peer_rib_list_. It's join and leave bitsets are based on the action in
-// the PeerRibStates.
+// Requests for a RibState that arrive while it's BgpTable is being walked
+// join the ongoing walk instead of waiting for a subsequent walk. This keeps
+// the number of walks down when a large number of peers subscribe to the
+// same tables at about the same time e.g. when all agents reconnect after
+// a restart. The joining PeerRibStates are moved to late_group_ from the
+// bgp::PeerMembership task, which is mutually exclusive with db::DBTable.
+// A DBTablePartition that has not visited any DBEntry yet processes the late
+// group for all it's DBEntries. A DBTablePartition that's partially done
+// saves the key of the first DBEntry for which it processes the late group
+// in late_cursors_ and then processes the late group for the remaining
+// DBEntries. A DBTablePartition that's already done doesn't process the late
+// group at all, so it needs a tail walk if it has any DBEntries by the time
+// the walk finishes. This includes partitions that finished while empty and
+// then got new DBEntries. If any DBTablePartition needs it, a tail walk of the
+// BgpTable is done right after the current one, during which the late group
+// is only processed for DBEntries that precede the saved key in the partition
+// or for all DBEntries if there's no saved key. The tail walk can also
+// service regular pending requests for the RibState.
+//
+// Only one late group is allowed at a time. Requests that arrive while the
+// late group is not empty are handled in a subsequent walk as usual.
 //
 // A TaskTrigger that runs in context of bgp::PeerMembership task is used to
 // handle start and finish of table walks. This avoids concurrency issues in
@@ -468,6 +508,14 @@ private:
         DISALLOW_COPY_AND_ASSIGN(RibOutState);
     };
 
+    class PeerRibGroup;
+
+    enum LateState {
+        LATE_NONE,
+        LATE_JOIN,
+        LATE_TAIL
+    };
+
     typedef BgpMembershipManager::Event Event;
     typedef BgpMembershipManager::RibState RibState;
     typedef BgpMembershipManager::PeerRibState PeerRibState;
@@ -476,21 +524,23 @@ private:
     typedef std::list<RibState *> RibStateList;
     typedef std::map<RibOut *, RibOutState *> RibOutStateMap;
     typedef std::list<RibOutState *> RibOutStateList;
-    typedef std::set<const IPeer *> PeerList;
+    typedef std::vector<const IPeer *> PeerList;
 
-    RibOutState *LocateRibOutState(RibOut *ribout);
     bool WalkCallback(DBTablePartBase *tpart, DBEntryBase *db_entry);
     void WalkDoneCallback(DBTableBase *table);
+    bool IsLateGroupActive(DBTablePartBase *tpart, DBEntryBase *db_entry);
     void WalkStart();
     void WalkFinish();
+    void WalkJoin();
     bool WalkTrigger();
 
     // Testing only.
     void SetQueueDisable(bool value);
     size_t GetQueueSize() const { return rib_state_list_size_; }
-    size_t GetPeerListSize() const { return peer_list_.size(); }
-    size_t GetPeerRibListSize() const { return peer_rib_list_.size(); }
-    size_t GetRibOutStateListSize() const { return ribout_state_list_size_; }
+    size_t GetPeerListSize() const;
+    size_t GetPeerRibListSize() const;
+    size_t GetRibOutStateListSize() const;
+    size_t GetLatePeerRibListSize() const;
     void PostponeWalk();
     void ResumeWalk();
 
@@ -504,12 +554,17 @@ private:
     bool walk_completed_;
     DBTable::DBTableWalkRef walk_ref_;
     RibState *rs_;
-    PeerRibList peer_rib_list_;
-    PeerList peer_list_;
-    RibOutStateMap ribout_state_map_;
-    RibOutStateList ribout_state_list_;
+    boost::scoped_ptr<PeerRibGroup> group_;
+    boost::scoped_ptr<PeerRibGroup> late_group_;
+    LateState late_state_;
+    std::vector<uint8_t> late_tail_needed_;
+    std::vector<uint8_t> late_started_;
+    std::vector<DBEntry *> late_cursors_;
+    std::vector<uint64_t> entry_counts_;
+    std::vector<uint64_t> path_counts_;
+    std::vector<uint64_t> path_change_counts_;
+    uint64_t walk_start_usec_;
     size_t rib_state_list_size_;
-    size_t ribout_state_list_size_;
 
     DISALLOW_COPY_AND_ASSIGN(Walker);
 };
@@ -57,7 +57,8 @@ McastForwarder::McastForwarder(McastSGEntry *sg_entry, ErmVpnRoute *route)
       label_(0),
       address_(0),
       rd_(route->GetPrefix().route_distinguisher()),
-      router_id_(route->GetPrefix().router_id()) {
+      router_id_(route->GetPrefix().router_id()),
+      tree_index_(-1) {
     const BgpPath *path = route->BestPath();
     const BgpAttr *attr = path->GetAttr();
 
@@ -361,11 +362,15 @@ McastSGEntry::McastSGEntry(McastManagerPartition *partition,
       forest_node_(NULL),
       local_tree_route_(NULL),
       tree_result_route_(NULL),
-      on_work_queue_(false) {
+      on_work_queue_(false),
+      link_change_count_(0),
+      label_allocation_count_(0) {
     for (int level = McastTreeManager::LevelFirst;
          level < McastTreeManager::LevelCount; ++level) {
         ForwarderSet *forwarders = new ForwarderSet;
         forwarder_sets_.push_back(forwarders);
+        pending_sets_.push_back(new ForwarderSet);
+        tree_lists_.push_back(McastForwarderList());
         update_needed_.push_back(false);
     }
 }
@@ -374,6 +379,7 @@ McastSGEntry::McastSGEntry(McastManagerPartition *partition,
 // Destructor for McastSGEntry.
 //
 McastSGEntry::~McastSGEntry() {
+    STLDeleteValues(&pending_sets_);
     STLDeleteValues(&forwarder_sets_);
 }
 
@@ -391,6 +397,7 @@ std::string McastSGEntry::ToString() const {
 void McastSGEntry::AddForwarder(McastForwarder *forwarder) {
     uint8_t level = forwarder->level();
     forwarder_sets_[level]->insert(forwarder);
+    pending_sets_[level]->insert(forwarder);
     update_needed_[level] = true;
     partition_->EnqueueSGEntry(this);
 }
@@ -404,6 +411,7 @@ void McastSGEntry::AddForwarder(McastForwarder *forwarder) {
 //
 void McastSGEntry::ChangeForwarder(McastForwarder *forwarder) {
     uint8_t level = forwarder->level();
+    pending_sets_[level]->insert(forwarder);
     update_needed_[level] = true;
     partition_->EnqueueSGEntry(this);
 }
@@ -412,11 +420,17 @@ void McastSGEntry::ChangeForwarder(McastForwarder *forwarder) {
 // Delete the given McastForwarder from this McastSGEntry and trigger update
 // of the distribution tree.
 //
+// The McastForwarder is removed from the distribution tree right away since
+// the caller is going to destroy it.
+//
 void McastSGEntry::DeleteForwarder(McastForwarder *forwarder) {
     if (forwarder == forest_node_)
         forest_node_ = NULL;
+    if (forwarder->tree_index() >= 0)
+        DeleteTreeNode(forwarder);
     uint8_t level = forwarder->level();
     forwarder_sets_[level]->erase(forwarder);
+    pending_sets_[level]->erase(forwarder);
     update_needed_[level] = true;
     partition_->EnqueueSGEntry(this);
 }
@@ -451,19 +465,12 @@ void McastSGEntry::AddLocalTreeRoute() {
     assert(!forest_node_);
     assert(!local_tree_route_);
 
-    // Select last usable leaf in the distribution tree as the forest node.
-    // A leaf is considered usable if it has a valid label i.e. it has not
-    // run out of labels.
-    uint8_t level = McastTreeManager::LevelNative;
-    ForwarderSet *forwarders = forwarder_sets_[level];
-    for (ForwarderSet::reverse_iterator rit = forwarders->rbegin();
-         rit != forwarders->rend(); ++rit) {
-        McastForwarder *forwarder = *rit;
-        if (forwarder->label()) {
-            forest_node_ = forwarder;
-            break;
-        }
-    }
+    // Select last leaf in the distribution tree as the forest node. All
+    // McastForwarders in the tree have a valid label.
+    const McastForwarderList &tree =
+        tree_lists_[McastTreeManager::LevelNative];
+    if (!tree.empty())
+        forest_node_ = tree.back();
 
     // Bail if we couldn't designate a forest node.
     if (!forest_node_)
@@ -551,10 +558,26 @@ void McastSGEntry::UpdateLocalTreeRoute() {
 //
 // Update relevant [Local|Global]TreeRoutes for the McastSGEntry.
 //
-void McastSGEntry::UpdateRoutes(uint8_t level) {
+// The LocalTreeRoute is left alone if the forest node is still the last leaf
+// of the Native tree and hasn't changed. Otherwise the previous and the new
+// forest nodes get notified since only the forest node's BgpOList includes
+// the edges from the GlobalTreeRoute.
+//
+void McastSGEntry::UpdateRoutes(uint8_t level, bool forest_node_changed) {
     if (level == McastTreeManager::LevelNative) {
+        const McastForwarderList &tree = tree_lists_[level];
+        McastForwarder *forest_node = tree.empty() ? NULL : tree.back();
+        if (forest_node_ && forest_node_ == forest_node &&
+            local_tree_route_ && !forest_node_changed) {
+            return;
+        }
+        McastForwarder *prev_forest_node = forest_node_;
         DeleteLocalTreeRoute();
         AddLocalTreeRoute();
+        if (prev_forest_node)
+            NotifyForwarder(prev_forest_node);
+        if (forest_node_ && forest_node_ != prev_forest_node)
+            NotifyForwarder(forest_node_);
     } else {
         ForwarderSet *forwarders = forwarder_sets_[level];
         for (ForwarderSet::iterator it = forwarders->begin();
@@ -585,79 +608,185 @@ bool McastSGEntry::IsTreeBuilder(uint8_t level) const {
 }
 
 //
+// Get the degree of the k-ary distribution tree for the given level.  The
+// Local level tree has a smaller degree since the forest node of each Local
+// McastForwarder already has a link in the Native tree.
 //
-// Update specified distribution tree for the McastSGEntry.  We traverse all
-// McastForwarders in sorted order and arrange them in breadth first fashion
-// in a k-ary tree.  Building the tree in this manner guarantees that we get
-// the same tree for a given set of forwarders, independent of the order in
-// in which they joined. This predictability is deemed to be more important
-// than other criteria such as minimizing disruption of traffic, minimizing
-// the cost/weight of the tree etc.
+int McastSGEntry::GetDegree(uint8_t level) const {
+    if (level == McastTreeManager::LevelNative)
+        return McastTreeManager::kDegree;
+    return McastTreeManager::kDegree - 1;
+}
+
 //
-void McastSGEntry::UpdateTree(uint8_t level) {
-    CHECK_CONCURRENCY("db::DBTable");
+// Enqueue the ErmVpnRoute associated with the McastForwarder for notification
+// so that its BgpOList gets rebuilt. Note that DBListeners will not get
+// invoked until after the distribution tree has been updated.
+//
+void McastSGEntry::NotifyForwarder(McastForwarder *forwarder) {
+    partition_->GetTablePartition()->Notify(forwarder->route());
+}
 
-    if (!update_needed_[level])
+//
+// Remove all links to and from the McastForwarder and notify the other end
+// of each of the links.
+//
+void McastSGEntry::UnlinkForwarder(McastForwarder *forwarder) {
+    const McastForwarderList &links = forwarder->tree_links();
+    for (McastForwarderList::const_iterator it = links.begin();
+         it != links.end(); ++it) {
+        NotifyForwarder(*it);
+    }
+    link_change_count_ += links.size();
+    forwarder->FlushLinks();
+}
+
+//
+// Link the McastForwarder at the given index in the distribution tree to
+// its parent in the k-ary tree.
+//
+void McastSGEntry::LinkParent(uint8_t level, size_t idx) {
+    if (idx == 0)
         return;
-    update_needed_[level] = false;
 
-    int degree;
-    if (level == McastTreeManager::LevelNative) {
-        degree = McastTreeManager::kDegree;
-    } else {
-        degree = McastTreeManager::kDegree - 1;
+    const McastForwarderList &tree = tree_lists_[level];
+    McastForwarder *forwarder = tree[idx];
+    McastForwarder *parent_forwarder = tree[(idx - 1) / GetDegree(level)];
+    forwarder->AddLink(parent_forwarder);
+    parent_forwarder->AddLink(forwarder);
+    link_change_count_++;
+    NotifyForwarder(forwarder);
+    NotifyForwarder(parent_forwarder);
+}
+
+//
+// Add the McastForwarder to the distribution tree as the last leaf.
+//
+void McastSGEntry::AddTreeNode(McastForwarder *forwarder) {
+    assert(forwarder->tree_index() < 0);
+    uint8_t level = forwarder->level();
+    McastForwarderList &tree = tree_lists_[level];
+    forwarder->set_tree_index(tree.size());
+    tree.push_back(forwarder);
+    LinkParent(level, tree.size() - 1);
+    NotifyForwarder(forwarder);
+}
+
+//
+// Remove the McastForwarder from the distribution tree.
+//
+// The last leaf in the tree takes over the position of the McastForwarder
+// and gets linked to its parent and children. Other links are not affected.
+//
+void McastSGEntry::DeleteTreeNode(McastForwarder *forwarder) {
+    uint8_t level = forwarder->level();
+    McastForwarderList &tree = tree_lists_[level];
+    size_t idx = forwarder->tree_index();
+    assert(idx < tree.size() && tree[idx] == forwarder);
+    UnlinkForwarder(forwarder);
+    forwarder->set_tree_index(-1);
+
+    McastForwarder *last_forwarder = tree.back();
+    tree.pop_back();
+    if (last_forwarder == forwarder)
+        return;
+
+    UnlinkForwarder(last_forwarder);
+    last_forwarder->set_tree_index(idx);
+    tree[idx] = last_forwarder;
+    LinkParent(level, idx);
+    size_t degree = GetDegree(level);
+    for (size_t child_idx = idx * degree + 1;
+         child_idx <= idx * degree + degree && child_idx < tree.size();
+         ++child_idx) {
+        LinkParent(level, child_idx);
     }
+    NotifyForwarder(last_forwarder);
+}
 
-    // First get rid of the previous distribution tree and enqueue all the
-    // associated ErmVpnRoutes for notification. Note that DBListeners will
-    // not get invoked until after this routine is done.
-    ForwarderSet *forwarders = forwarder_sets_[level];
-    for (ForwarderSet::iterator it = forwarders->begin();
-         it != forwarders->end(); ++it) {
-       (*it)->FlushLinks();
-       (*it)->ReleaseLabel();
-       partition_->GetTablePartition()->Notify((*it)->route());
+//
+// Get rid of the distribution tree for the given level.  All McastForwarders
+// release their labels and become pending so that the tree gets rebuilt from
+// scratch if we become the tree builder again.
+//
+void McastSGEntry::FlushTree(uint8_t level) {
+    McastForwarderList &tree = tree_lists_[level];
+    ForwarderSet *pending = pending_sets_[level];
+    for (McastForwarderList::iterator it = tree.begin();
+         it != tree.end(); ++it) {
+        McastForwarder *forwarder = *it;
+        UnlinkForwarder(forwarder);
+        forwarder->ReleaseLabel();
+        forwarder->set_tree_index(-1);
+        NotifyForwarder(forwarder);
+        pending->insert(forwarder);
     }
+    tree.clear();
+}
+
+//
+// Update specified distribution tree for the McastSGEntry.
+//
+// Only the pending McastForwarders i.e. the ones that have been added or
+// changed since the last update are examined. They are processed in sorted
+// order, so that a tree built from scratch is the same as before and does
+// not depend on the order in which McastForwarders joined. Once built, the
+// tree is modified incrementally to minimize disruption of traffic and label
+// churn. Only the ErmVpnRoutes for McastForwarders whose links or neighbors
+// have changed are notified.
+//
+// A McastForwarder for which we can't allocate a label stays pending and we
+// try again on the next update.
+//
+void McastSGEntry::UpdateTree(uint8_t level) {
+    CHECK_CONCURRENCY("db::DBTable");
+
+    if (!update_needed_[level])
+        return;
+    update_needed_[level] = false;
 
     // Bail if we're not the tree builder.
     if (!IsTreeBuilder(level)) {
-        UpdateRoutes(level);
+        FlushTree(level);
+        UpdateRoutes(level, false);
         return;
     }
 
-    // Create a vector of pointers to the McastForwarders in sorted order.
-    // We do this because std::set doesn't support random access iterators.
-    // Skip if we can't allocate a label for the McastForwarder.
-    McastForwarderList vec;
-    vec.reserve(forwarders->size());
-    for (ForwarderSet::iterator it = forwarders->begin();
-         it != forwarders->end(); ++it) {
+    ForwarderSet *pending = pending_sets_[level];
+    bool forest_node_changed =
+        forest_node_ && pending->find(forest_node_) != pending->end();
+    for (ForwarderSet::iterator it = pending->begin(); it != pending->end();) {
         McastForwarder *forwarder = *it;
-        forwarder->AllocateLabel();
-        if (!forwarder->label())
-            continue;
-        vec.push_back(forwarder);
-    }
+        if (!forwarder->label()) {
+            forwarder->AllocateLabel();
+            label_allocation_count_++;
+        }
 
-    // Go through each McastForwarder in the vector and link it to it's parent
-    // McastForwarder in the k-ary tree. We also add a link from the parent to
-    // the entry in question.
-    for (McastForwarderList::iterator it = vec.begin(); it != vec.end(); ++it) {
-        int idx = it - vec.begin();
-        if (idx == 0)
+        if (forwarder->tree_index() < 0) {
+            if (!forwarder->label()) {
+                ++it;
+                continue;
+            }
+            AddTreeNode(forwarder);
+        } else if (!forwarder->label()) {
+            DeleteTreeNode(forwarder);
+            ++it;
             continue;
-
-        int parent_idx = (idx - 1) / degree;
-        McastForwarderList::iterator parent_it = vec.begin() + parent_idx;
-        assert(parent_it != vec.end());
-        McastForwarder *forwarder = *it;
-        McastForwarder *parent_forwarder = *parent_it;
-        forwarder->AddLink(parent_forwarder);
-        parent_forwarder->AddLink(forwarder);
+        } else {
+            // The address, label or encap of an existing McastForwarder
+            // has changed, so the BgpOLists of its neighbors need updates.
+            const McastForwarderList &links = forwarder->tree_links();
+            for (McastForwarderList::const_iterator link_it = links.begin();
+                 link_it != links.end(); ++link_it) {
+                NotifyForwarder(*link_it);
+            }
+            NotifyForwarder(forwarder);
+        }
+        pending->erase(it++);
     }
 
     // Update [Local|Global]TreeRoutes.
-    UpdateRoutes(level);
+    UpdateRoutes(level, forest_node_changed);
 }
 
 //
@@ -72,6 +72,11 @@ typedef std::vector<McastForwarder *> McastForwarderList;
 // distribution tree. Thus the label can be stored in the McastForwarder itself
 // and does not need to be part of the link information.
 //
+// The tree_index_ is the position of the McastForwarder in the breadth first
+// ordering of the distribution tree, or -1 if it's not part of the tree. It's
+// maintained by the McastSGEntry and allows a McastForwarder to be removed
+// from the tree without a search.
+//
 // If this control-node is elected as the tree builder for the (G,S), a global
 // distribution tree of all Local McastForwarders is built.  Relevant edges of
 // this global distribution tree are advertised to each control-node by adding
@@ -108,6 +113,9 @@ public:
     ErmVpnRoute *route() { return route_; }
     const RouteDistinguisher &route_distinguisher() const { return rd_; }
     Ip4Address router_id() const { return router_id_; }
+    const McastForwarderList &tree_links() const { return tree_links_; }
+    int tree_index() const { return tree_index_; }
+    void set_tree_index(int tree_index) { tree_index_ = tree_index; }
 
     bool empty() { return tree_links_.empty(); }
 
@@ -129,6 +137,7 @@ private:
     Ip4Address router_id_;
     std::vector<std::string> encap_;
     McastForwarderList tree_links_;
+    int tree_index_;
 
     DISALLOW_COPY_AND_ASSIGN(McastForwarder);
 };
@@ -177,6 +186,15 @@ struct McastForwarderCompare {
 // are advertising their local subtree's candidate edges via a LocalTreeRoute.
 // The sets are keyed by the RD and RouterId of the McastForwarders.
 //
+// The distribution tree for each level is a k-ary tree kept as a list of
+// McastForwarders in breadth first order, so the parent of the entry at a
+// given index is implied by the index. The tree is maintained incrementally.
+// A new McastForwarder gets appended as a leaf and a departing McastForwarder
+// is replaced by the last leaf in the tree. Hence a join or leave changes at
+// most kDegree + 2 links and McastForwarders keep their labels. McastForwarders
+// that have been added or changed since the last update of the tree are kept
+// in a pending set for the level.
+//
 // A local distribution tree of all Native McastForwarders is built and the
 // last leaf in the tree is designated as the forest node.  The forest_node_
 // is used to keep track of this McastForwarder.  A LocalTreeRoute is added to
@@ -232,6 +250,9 @@ public:
     void set_on_work_queue() { on_work_queue_ = true; }
     void clear_on_work_queue() { on_work_queue_ = false; }
 
+    uint64_t link_change_count() const { return link_change_count_; }
+    uint64_t label_allocation_count() const { return label_allocation_count_; }
+
     bool empty() const;
 
 private:
@@ -241,8 +262,15 @@ private:
     typedef std::set<McastForwarder *, McastForwarderCompare> ForwarderSet;
 
     bool IsTreeBuilder(uint8_t level) const;
+    int GetDegree(uint8_t level) const;
+    void NotifyForwarder(McastForwarder *forwarder);
+    void UnlinkForwarder(McastForwarder *forwarder);
+    void LinkParent(uint8_t level, size_t idx);
+    void AddTreeNode(McastForwarder *forwarder);
+    void DeleteTreeNode(McastForwarder *forwarder);
+    void FlushTree(uint8_t level);
     void UpdateTree(uint8_t level);
-    void UpdateRoutes(uint8_t level);
+    void UpdateRoutes(uint8_t level, bool forest_node_changed);
 
     McastManagerPartition *partition_;
     Ip4Address group_, source_;
@@ -250,8 +278,12 @@ private:
     ErmVpnRoute *local_tree_route_;
     ErmVpnRoute *tree_result_route_;
     std::vector<ForwarderSet *> forwarder_sets_;
+    std::vector<ForwarderSet *> pending_sets_;
+    std::vector<McastForwarderList> tree_lists_;
     std::vector<bool> update_needed_;
     bool on_work_queue_;
+    uint64_t link_change_count_;
+    uint64_t label_allocation_count_;
 
     DISALLOW_COPY_AND_ASSIGN(McastSGEntry);
 };
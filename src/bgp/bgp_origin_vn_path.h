@@ -69,6 +69,7 @@ public:
 private:
     friend int intrusive_ptr_add_ref(const OriginVnPath *covnpath);
     friend int intrusive_ptr_del_ref(const OriginVnPath *covnpath);
+    friend bool intrusive_ptr_add_ref_if_live(const OriginVnPath *covnpath);
     friend void intrusive_ptr_release(const OriginVnPath *covnpath);
     friend class OriginVnPathDB;
     friend class BgpAttrTest;
@@ -88,6 +89,10 @@ inline int intrusive_ptr_del_ref(const OriginVnPath *covnpath) {
     return covnpath->refcount_.fetch_and_decrement();
 }
 
+inline bool intrusive_ptr_add_ref_if_live(const OriginVnPath *covnpath) {
+    return BgpAttrAddRefIfLive(covnpath->refcount_);
+}
+
 inline void intrusive_ptr_release(const OriginVnPath *covnpath) {
     int prev = covnpath->refcount_.fetch_and_decrement();
     if (prev == 1) {
@@ -21,6 +21,8 @@
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_session.h"
 #include "bgp/bgp_session_manager.h"
+#include "bgp/bgp_update_recorder.h"
+#include "bgp/bgp_update_sender.h"
 #include "bgp/bgp_peer_types.h"
 #include "bgp/ermvpn/ermvpn_table.h"
 #include "bgp/evpn/evpn_table.h"
@@ -1568,17 +1570,20 @@ bool BgpPeer::MpNlriAllowed(uint16_t afi, uint8_t safi) {
 
 template <typename TableT, typename PrefixT>
 void BgpPeer::ProcessNlri(Address::Family family, DBRequest::DBOperation oper,
-    const BgpMpNlri *nlri, BgpAttrPtr attr, uint32_t flags) {
+    BgpProto::UpdateView::PrefixIterator nlri, BgpAttrPtr attr,
+    uint32_t flags) {
     TableT *table = static_cast<TableT *>(rtinstance_->GetTable(family));
     assert(table);
 
-    for (vector<BgpProtoPrefix *>::const_iterator it = nlri->nlri.begin();
-         it != nlri->nlri.end(); ++it) {
+    BgpProto::UpdateView::Prefix view_prefix;
+    BgpProtoPrefix proto_prefix;
+    while (nlri.Next(&view_prefix)) {
+        view_prefix.ToProtoPrefix(&proto_prefix);
         PrefixT prefix;
         BgpAttrPtr new_attr(attr);
         uint32_t label = 0;
         uint32_t l3_label = 0;
-        int result = PrefixT::FromProtoPrefix(server_, **it,
+        int result = PrefixT::FromProtoPrefix(server_, proto_prefix,
             (oper == DBRequest::DB_ENTRY_ADD_CHANGE ? attr.get() : NULL),
             &prefix, &new_attr, &label, &l3_label);
         if (result) {
@@ -1648,7 +1653,10 @@ uint32_t BgpPeer::GetLocalPrefFromMed(uint32_t med) const {
     return numeric_limits<uint32_t>::max() - med;
 }
 
-void BgpPeer::ProcessUpdate(const BgpProto::Update *msg, size_t msgsize) {
+//
+// Build the BgpAttr for the path attributes in an update message.
+//
+BgpAttrPtr BgpPeer::LocateUpdateAttr(const BgpProto::Update *msg) {
     BgpAttrPtr attr = server_->attr_db()->Locate(msg->path_attributes);
 
     uint32_t local_pref = GetLocalPrefFromMed(attr->med());
@@ -1662,10 +1670,47 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg, size_t msgsize) {
         attr = server_->attr_db()->ReplaceOriginAndLocate(attr.get(),
                                                        origin_override_.origin);
     }
+    return attr;
+}
+
+//
+// Process an update message from the peer.
+//
+// The withdrawn routes and NLRI, including the ones in MpReachNlri and
+// MpUnreachNlri, are walked in place with an UpdateView over the message as
+// received. An update that doesn't have the raw message i.e. one that was
+// fully decoded or built locally, is encoded first.
+//
+// The BgpAttr is located only when the message has reachable routes that get
+// accepted. Withdraw only messages and EndOfRib markers don't need it, so we
+// skip building the attribute and looking it up in the BgpAttrDB.
+//
+void BgpPeer::ProcessUpdate(const BgpProto::Update *msg, size_t msgsize) {
+    uint8_t buffer[BgpProto::kMaxMessageSize];
+    const uint8_t *data = NULL;
+    size_t size = 0;
+    if (!msg->raw_msg.empty()) {
+        data = &msg->raw_msg[0];
+        size = msg->raw_msg.size();
+    } else {
+        int result = BgpProto::Encode(msg, buffer, sizeof(buffer));
+        if (result > 0) {
+            data = buffer;
+            size = result;
+        }
+    }
+
+    BgpProto::UpdateView view;
+    if (!data || !view.Parse(data, size)) {
+        BGP_LOG_PEER_WARNING(Message, this, BGP_LOG_FLAG_ALL, BGP_PEER_DIR_IN,
+            "Cannot walk update message of size " << msgsize);
+        return;
+    }
 
+    BgpAttrPtr attr;
     uint32_t reach_count = 0, unreach_count = 0;
     RoutingInstance *instance = GetRoutingInstance();
-    if (msg->nlri.size() || msg->withdrawn_routes.size()) {
+    if (view.has_nlri() || view.has_withdrawn_routes()) {
         InetTable *table =
             static_cast<InetTable *>(instance->GetTable(Address::INET));
         if (!table) {
@@ -1674,12 +1719,15 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg, size_t msgsize) {
             return;
         }
 
-        unreach_count += msg->withdrawn_routes.size();
-        for (vector<BgpProtoPrefix *>::const_iterator it =
-             msg->withdrawn_routes.begin(); it != msg->withdrawn_routes.end();
-             ++it) {
+        BgpProto::UpdateView::Prefix view_prefix;
+        BgpProtoPrefix proto_prefix;
+        BgpProto::UpdateView::PrefixIterator withdrawn_it =
+            view.withdrawn_routes();
+        while (withdrawn_it.Next(&view_prefix)) {
+            unreach_count++;
+            view_prefix.ToProtoPrefix(&proto_prefix);
             Ip4Prefix prefix;
-            int result = Ip4Prefix::FromProtoPrefix((**it), &prefix);
+            int result = Ip4Prefix::FromProtoPrefix(proto_prefix, &prefix);
             if (result) {
                 BGP_LOG_PEER_WARNING(Message, this,
                     BGP_LOG_FLAG_ALL, BGP_PEER_DIR_IN,
@@ -1694,12 +1742,16 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg, size_t msgsize) {
             table->Enqueue(&req);
         }
 
-        uint32_t flags = GetPathFlags(Address::INET, attr.get());
-        reach_count += msg->nlri.size();
-        for (vector<BgpProtoPrefix *>::const_iterator it = msg->nlri.begin();
-             it != msg->nlri.end(); ++it) {
+        if (view.has_nlri() && !attr)
+            attr = LocateUpdateAttr(msg);
+        uint32_t flags =
+            attr ? GetPathFlags(Address::INET, attr.get()) : 0;
+        BgpProto::UpdateView::PrefixIterator nlri_it = view.nlri();
+        while (nlri_it.Next(&view_prefix)) {
+            reach_count++;
+            view_prefix.ToProtoPrefix(&proto_prefix);
             Ip4Prefix prefix;
-            int result = Ip4Prefix::FromProtoPrefix((**it), &prefix);
+            int result = Ip4Prefix::FromProtoPrefix(proto_prefix, &prefix);
             if (result) {
                 BGP_LOG_PEER_WARNING(Message, this,
                     BGP_LOG_FLAG_ALL, BGP_PEER_DIR_IN,
@@ -1715,37 +1767,38 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg, size_t msgsize) {
         }
     }
 
-    for (vector<BgpAttribute *>::const_iterator ait =
-            msg->path_attributes.begin();
-            ait != msg->path_attributes.end(); ++ait) {
+    BgpProto::UpdateView::Attribute view_attr;
+    BgpProto::UpdateView::AttributeIterator ait = view.path_attributes();
+    while (ait.Next(&view_attr)) {
         DBRequest::DBOperation oper;
-        if ((*ait)->code == BgpAttribute::MPReachNlri) {
+        if (view_attr.code == BgpAttribute::MPReachNlri) {
             oper = DBRequest::DB_ENTRY_ADD_CHANGE;
-        } else if ((*ait)->code == BgpAttribute::MPUnreachNlri) {
+        } else if (view_attr.code == BgpAttribute::MPUnreachNlri) {
             oper = DBRequest::DB_ENTRY_DELETE;
         } else {
             continue;
         }
 
-        BgpMpNlri *nlri = static_cast<BgpMpNlri *>(*ait);
-        assert(nlri);
+        // The afi, safi and nexthop were validated by UpdateView::Parse.
+        BgpProto::UpdateView::MpNlri nlri;
+        BgpProto::UpdateView::ParseMpNlri(view_attr, &nlri);
         if (oper == DBRequest::DB_ENTRY_ADD_CHANGE) {
-            reach_count += nlri->nlri.size();
+            reach_count += nlri.nlri.Count();
         } else {
-            unreach_count += nlri->nlri.size();
+            unreach_count += nlri.nlri.Count();
         }
 
-        Address::Family family = BgpAf::AfiSafiToFamily(nlri->afi, nlri->safi);
+        Address::Family family = BgpAf::AfiSafiToFamily(nlri.afi, nlri.safi);
         if (!IsFamilyNegotiated(family)) {
             BGP_LOG_PEER_NOTICE(Message, this,
                 BGP_LOG_FLAG_ALL, BGP_PEER_DIR_IN,
-                "AFI "<< nlri->afi << " SAFI " << (int) nlri->safi <<
+                "AFI "<< nlri.afi << " SAFI " << (int) nlri.safi <<
                 " not allowed");
             continue;
         }
 
         // Handle EndOfRib marker.
-        if (oper == DBRequest::DB_ENTRY_DELETE && nlri->nlri.empty()) {
+        if (oper == DBRequest::DB_ENTRY_DELETE && nlri.nlri.empty()) {
             inc_rx_end_of_rib();
             BGP_LOG_PEER(Message, this, SandeshLevel::SYS_INFO,
                          BGP_LOG_FLAG_SYSLOG, BGP_PEER_DIR_IN,
@@ -1757,7 +1810,9 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg, size_t msgsize) {
         }
 
         uint32_t flags = 0;
-        if ((*ait)->code == BgpAttribute::MPReachNlri) {
+        if (oper == DBRequest::DB_ENTRY_ADD_CHANGE) {
+            if (!attr)
+                attr = LocateUpdateAttr(msg);
             flags = GetPathFlags(family, attr.get());
             attr = GetMpNlriNexthop(nlri, attr);
         }
@@ -1765,31 +1820,31 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg, size_t msgsize) {
         switch (family) {
         case Address::INET:
             ProcessNlri<InetTable, Ip4Prefix>(
-                family, oper, nlri, attr, flags);
+                family, oper, nlri.nlri, attr, flags);
             break;
         case Address::INETVPN:
             ProcessNlri<InetVpnTable, InetVpnPrefix>(
-                family, oper, nlri, attr, flags);
+                family, oper, nlri.nlri, attr, flags);
             break;
         case Address::INET6:
             ProcessNlri<Inet6Table, Inet6Prefix>(
-                family, oper, nlri, attr, flags);
+                family, oper, nlri.nlri, attr, flags);
             break;
         case Address::INET6VPN:
             ProcessNlri<Inet6VpnTable, Inet6VpnPrefix>(
-                family, oper, nlri, attr, flags);
+                family, oper, nlri.nlri, attr, flags);
             break;
         case Address::EVPN:
             ProcessNlri<EvpnTable, EvpnPrefix>(
-                family, oper, nlri, attr, flags);
+                family, oper, nlri.nlri, attr, flags);
             break;
         case Address::ERMVPN:
             ProcessNlri<ErmVpnTable, ErmVpnPrefix>(
-                family, oper, nlri, attr, flags);
+                family, oper, nlri.nlri, attr, flags);
             break;
         case Address::RTARGET:
             ProcessNlri<RTargetTable, RTargetPrefix>(
-                family, oper, nlri, attr, flags);
+                family, oper, nlri.nlri, attr, flags);
             break;
         default:
             break;
@@ -1981,7 +2036,7 @@ string BgpPeer::BytesToHexString(const u_int8_t *msg, size_t size) {
 bool BgpPeer::ReceiveMsg(BgpSession *session, const u_int8_t *msg,
                          size_t size) {
     ParseErrorContext ec;
-    BgpProto::BgpMessage *minfo = BgpProto::Decode(msg, size, &ec);
+    BgpProto::BgpMessage *minfo = BgpProto::DecodeLazy(msg, size, &ec);
 
     if (minfo == NULL) {
         BGP_TRACE_PEER_PACKET(this, msg, size, SandeshLevel::SYS_WARN);
@@ -1996,44 +2051,50 @@ bool BgpPeer::ReceiveMsg(BgpSession *session, const u_int8_t *msg,
     if (minfo->type != BgpProto::KEEPALIVE)
         BGP_TRACE_PEER_PACKET(this, msg, size, Sandesh::LoggingUtLevel());
 
+    // Record the UPDATE exactly as received so that it can be replayed.
+    if (minfo->type == BgpProto::UPDATE) {
+        BgpUpdateRecorder *recorder = server_->update_recorder();
+        if (recorder->enabled())
+            recorder->RecordBgpUpdate(this, msg, size);
+    }
+
     state_machine_->OnMessage(session, minfo, size);
     return true;
 }
 
 //
-// Extract nexthop address from BgpMpNlri if appropriate and return updated
+// Extract nexthop address from MpReachNlri if appropriate and return updated
 // BgpAttrPtr. The original attribute is returned for cases where there's no
-// nexthop attribute in the BgpMpNlri.
+// nexthop attribute in the MpReachNlri.
 //
-BgpAttrPtr BgpPeer::GetMpNlriNexthop(BgpMpNlri *nlri, BgpAttrPtr attr) {
+BgpAttrPtr BgpPeer::GetMpNlriNexthop(const BgpProto::UpdateView::MpNlri &nlri,
+    BgpAttrPtr attr) {
     bool update_nh = false;
     IpAddress addr;
 
-    if (nlri->afi == BgpAf::IPv4) {
-        if (nlri->safi == BgpAf::Unicast || nlri->safi == BgpAf::RTarget) {
+    if (nlri.afi == BgpAf::IPv4) {
+        if (nlri.safi == BgpAf::Unicast || nlri.safi == BgpAf::RTarget) {
             Ip4Address::bytes_type bt = { { 0 } };
-            copy(nlri->nexthop.begin(),
-                nlri->nexthop.begin() + sizeof(bt), bt.begin());
+            copy(nlri.nexthop, nlri.nexthop + sizeof(bt), bt.begin());
             addr = Ip4Address(bt);
             update_nh = true;
-        } else if (nlri->safi == BgpAf::Vpn) {
+        } else if (nlri.safi == BgpAf::Vpn) {
             Ip4Address::bytes_type bt = { { 0 } };
             size_t rdsize = RouteDistinguisher::kSize;
-            copy(nlri->nexthop.begin() + rdsize,
-                nlri->nexthop.begin() + rdsize + sizeof(bt), bt.begin());
+            copy(nlri.nexthop + rdsize,
+                nlri.nexthop + rdsize + sizeof(bt), bt.begin());
             addr = Ip4Address(bt);
             update_nh = true;
         }
-    } else if (nlri->afi == BgpAf::L2Vpn) {
-        if (nlri->safi == BgpAf::EVpn) {
+    } else if (nlri.afi == BgpAf::L2Vpn) {
+        if (nlri.safi == BgpAf::EVpn) {
             Ip4Address::bytes_type bt = { { 0 } };
-            copy(nlri->nexthop.begin(),
-                nlri->nexthop.begin() + sizeof(bt), bt.begin());
+            copy(nlri.nexthop, nlri.nexthop + sizeof(bt), bt.begin());
             addr = Ip4Address(bt);
             update_nh = true;
         }
-    } else if (nlri->afi == BgpAf::IPv6) {
-        if (nlri->safi == BgpAf::Unicast) {
+    } else if (nlri.afi == BgpAf::IPv6) {
+        if (nlri.safi == BgpAf::Unicast) {
             // There could be either 1 or 2 v6 addresses in the nexthop field.
             // The first one is supposed to be global and the optional second
             // one, if present, is link local. We will be liberal and find the
@@ -2042,10 +2103,10 @@ BgpAttrPtr BgpPeer::GetMpNlriNexthop(BgpMpNlri *nlri, BgpAttrPtr attr) {
             // address as the nexthop.
             for (int idx = 0; idx < 2; ++idx) {
                 Ip6Address::bytes_type bt = { { 0 } };
-                if ((idx + 1) * sizeof(bt) > nlri->nexthop.size())
+                if ((idx + 1) * sizeof(bt) > nlri.nexthop_size)
                     break;
-                copy(nlri->nexthop.begin() + idx * sizeof(bt),
-                    nlri->nexthop.begin() + (idx + 1) * sizeof(bt), bt.begin());
+                copy(nlri.nexthop + idx * sizeof(bt),
+                    nlri.nexthop + (idx + 1) * sizeof(bt), bt.begin());
                 Ip6Address v6_addr(bt);
                 if (v6_addr.is_v4_mapped()) {
                     addr = Address::V4FromV4MappedV6(v6_addr);
@@ -2058,11 +2119,11 @@ BgpAttrPtr BgpPeer::GetMpNlriNexthop(BgpMpNlri *nlri, BgpAttrPtr attr) {
                     break;
                 }
             }
-        } else if (nlri->safi == BgpAf::Vpn) {
+        } else if (nlri.safi == BgpAf::Vpn) {
             Ip6Address::bytes_type bt = { { 0 } };
             size_t rdsize = RouteDistinguisher::kSize;
-            copy(nlri->nexthop.begin() + rdsize,
-                nlri->nexthop.begin() + rdsize + sizeof(bt), bt.begin());
+            copy(nlri.nexthop + rdsize,
+                nlri.nexthop + rdsize + sizeof(bt), bt.begin());
             Ip6Address v6_addr(bt);
             if (v6_addr.is_v4_mapped()) {
                 addr = Address::V4FromV4MappedV6(v6_addr);
@@ -2273,6 +2334,7 @@ void BgpPeer::FillNeighborInfo(const BgpSandeshContext *bsc,
     FillBgpNeighborDebugState(bnr, peer_stats_.get());
     BgpMembershipManager *mgr = server_->membership_mgr();
     mgr->FillPeerMembershipInfo(this, bnr);
+    server_->update_sender()->FillPeerBlockedInfo(this, bnr);
     bnr->set_routing_instances(vector<BgpNeighborRoutingInstance>());
     FillCloseInfo(bnr);
 }
@@ -397,10 +397,13 @@ private:
     uint32_t GetPathFlags(Address::Family family, const BgpAttr *attr) const;
     uint32_t GetLocalPrefFromMed(uint32_t med) const;
     virtual bool MpNlriAllowed(uint16_t afi, uint8_t safi);
-    BgpAttrPtr GetMpNlriNexthop(BgpMpNlri *nlri, BgpAttrPtr attr);
+    BgpAttrPtr GetMpNlriNexthop(const BgpProto::UpdateView::MpNlri &nlri,
+                                BgpAttrPtr attr);
+    BgpAttrPtr LocateUpdateAttr(const BgpProto::Update *msg);
     template <typename TableT, typename PrefixT>
     void ProcessNlri(Address::Family family, DBRequest::DBOperation oper,
-        const BgpMpNlri *nlri, BgpAttrPtr attr, uint32_t flags);
+        BgpProto::UpdateView::PrefixIterator nlri, BgpAttrPtr attr,
+        uint32_t flags);
 
     bool GetBestAuthKey(AuthenticationKey *auth_key, KeyType *key_type) const;
     bool ProcessAuthKeyChainConfig(const BgpNeighborConfig *config);
@@ -395,6 +395,19 @@ struct BgpAttrCodeCompare {
 // Returns 0 if message is OK
 // Returns one of the values from enum UpdateMsgSubCode if an error is detected
 //
+//
+// Return true if the update has inet NLRI, whether they were decoded or are
+// only present in the raw message.
+//
+bool BgpProto::Update::HasNlri() const {
+    if (!nlri.empty())
+        return true;
+    if (raw_msg.empty())
+        return false;
+    UpdateView view;
+    return view.Parse(&raw_msg[0], raw_msg.size()) && view.has_nlri();
+}
+
 int BgpProto::Update::Validate(const BgpPeer *peer, string *data) {
     BgpAttrCodeCompare comp;
     std::sort(path_attributes.begin(), path_attributes.end(), comp);
@@ -437,13 +450,14 @@ int BgpProto::Update::Validate(const BgpPeer *peer, string *data) {
     BGP_LOG_PEER(Message, const_cast<BgpPeer *>(peer),
                  SandeshLevel::SYS_DEBUG, BGP_LOG_FLAG_TRACE,
                  BGP_PEER_DIR_IN, rxed_attr);
-    if (nlri.size() > 0 && !nh) {
+    bool has_nlri = HasNlri();
+    if (has_nlri && !nh) {
         // next-hop attribute must be present if IPv4 NLRI is present
         char attrib_type = BgpAttribute::NextHop;
         *data = string(&attrib_type, 1);
         return BgpProto::Notification::MissingWellKnownAttrib;
     }
-    if (nlri.size() > 0 || mp_reach_nlri) {
+    if (has_nlri || mp_reach_nlri) {
         // origin and as_path must be present if any NLRI is present
         if (!origin) {
             char attrib_type = BgpAttribute::Origin;
@@ -493,6 +507,244 @@ int BgpProto::Update::CompareTo(const BgpProto::Update &rhs) const {
     return 0;
 }
 
+BgpProto::UpdateView::PrefixIterator::PrefixIterator()
+    : data_(NULL), size_(0), offset_(0), typed_(false), error_(false) {
+}
+
+BgpProto::UpdateView::PrefixIterator::PrefixIterator(const uint8_t *data,
+    size_t size, bool typed)
+    : data_(data), size_(size), offset_(0), typed_(typed), error_(false) {
+}
+
+//
+// Fill in the next prefix and return true. Return false when there are no
+// more prefixes or if the prefix doesn't fit in the remaining data.
+//
+bool BgpProto::UpdateView::PrefixIterator::Next(Prefix *prefix) {
+    if (error_ || offset_ == size_)
+        return false;
+
+    size_t header_size = typed_ ? 2 : 1;
+    if (offset_ + header_size > size_) {
+        error_ = true;
+        return false;
+    }
+
+    const uint8_t *data = data_ + offset_;
+    if (typed_) {
+        prefix->type = data[0];
+        prefix->size = data[1];
+        prefix->prefixlen = data[1] * 8;
+    } else {
+        prefix->type = 0;
+        prefix->prefixlen = data[0];
+        prefix->size = (data[0] + 7) / 8;
+    }
+    if (offset_ + header_size + prefix->size > size_) {
+        error_ = true;
+        return false;
+    }
+
+    prefix->data = data + header_size;
+    offset_ += header_size + prefix->size;
+    return true;
+}
+
+//
+// Return the number of prefixes that remain to be walked.
+//
+size_t BgpProto::UpdateView::PrefixIterator::Count() const {
+    PrefixIterator it(*this);
+    Prefix prefix;
+    size_t count = 0;
+    while (it.Next(&prefix)) {
+        count++;
+    }
+    return count;
+}
+
+//
+// Fill in a BgpProtoPrefix so that it can be handed to the FromProtoPrefix
+// methods of the various prefix types. The caller should reuse the same
+// BgpProtoPrefix for all prefixes so that the prefix vector doesn't need to
+// be reallocated.
+//
+void BgpProto::UpdateView::Prefix::ToProtoPrefix(
+    BgpProtoPrefix *proto_prefix) const {
+    proto_prefix->type = type;
+    proto_prefix->prefixlen = prefixlen;
+    proto_prefix->prefix.assign(data, data + size);
+}
+
+BgpProto::UpdateView::AttributeIterator::AttributeIterator(
+    const uint8_t *data, size_t size)
+    : data_(data), size_(size), offset_(0), error_(false) {
+}
+
+//
+// Fill in the next attribute and return true. Return false when there are
+// no more attributes or if the attribute doesn't fit in the remaining data.
+//
+bool BgpProto::UpdateView::AttributeIterator::Next(Attribute *attr) {
+    if (error_ || offset_ == size_)
+        return false;
+
+    if (offset_ + 3 > size_) {
+        error_ = true;
+        return false;
+    }
+
+    const uint8_t *data = data_ + offset_;
+    attr->flags = data[0];
+    attr->code = data[1];
+    size_t header_size = 3;
+    if (attr->flags & BgpAttribute::ExtendedLength) {
+        header_size = 4;
+        if (offset_ + header_size > size_) {
+            error_ = true;
+            return false;
+        }
+        attr->size = get_short(data + 2);
+    } else {
+        attr->size = data[2];
+    }
+    if (offset_ + header_size + attr->size > size_) {
+        error_ = true;
+        return false;
+    }
+
+    attr->data = data + header_size;
+    offset_ += header_size + attr->size;
+    return true;
+}
+
+BgpProto::UpdateView::UpdateView()
+    : withdrawn_(NULL), withdrawn_size_(0),
+      attributes_(NULL), attributes_size_(0),
+      nlri_(NULL), nlri_size_(0) {
+}
+
+//
+// Validate the framing of the UPDATE message in the buffer and remember
+// where the withdrawn routes, path attributes and NLRI are.
+//
+// Return false if the buffer does not contain exactly one well formed UPDATE
+// message. The contents of the attributes are not validated, except for the
+// afi, safi and nexthop of MpReachNlri/MpUnreachNlri, which are needed to
+// walk the prefixes in them.
+//
+bool BgpProto::UpdateView::Parse(const uint8_t *data, size_t size) {
+    if (size < static_cast<size_t>(kMinMessageSize) + 4)
+        return false;
+    for (int idx = 0; idx < 16; ++idx) {
+        if (data[idx] != 0xff)
+            return false;
+    }
+    size_t msg_size = get_short(data + 16);
+    if (msg_size != size || msg_size > static_cast<size_t>(kMaxMessageSize))
+        return false;
+    if (data[18] != UPDATE)
+        return false;
+
+    size_t offset = kMinMessageSize;
+    withdrawn_size_ = get_short(data + offset);
+    offset += 2;
+    if (offset + withdrawn_size_ + 2 > msg_size)
+        return false;
+    withdrawn_ = data + offset;
+    offset += withdrawn_size_;
+
+    attributes_size_ = get_short(data + offset);
+    offset += 2;
+    if (offset + attributes_size_ > msg_size)
+        return false;
+    attributes_ = data + offset;
+    offset += attributes_size_;
+
+    nlri_ = data + offset;
+    nlri_size_ = msg_size - offset;
+
+    Prefix prefix;
+    PrefixIterator withdrawn_it = withdrawn_routes();
+    while (withdrawn_it.Next(&prefix)) {
+    }
+    PrefixIterator nlri_it = nlri();
+    while (nlri_it.Next(&prefix)) {
+    }
+    Attribute attr;
+    AttributeIterator attr_it = path_attributes();
+    while (attr_it.Next(&attr)) {
+        if (attr.code != BgpAttribute::MPReachNlri &&
+            attr.code != BgpAttribute::MPUnreachNlri) {
+            continue;
+        }
+        MpNlri mp_nlri;
+        if (!ParseMpNlri(attr, &mp_nlri))
+            return false;
+        while (mp_nlri.nlri.Next(&prefix)) {
+        }
+        if (mp_nlri.nlri.error())
+            return false;
+    }
+    return !withdrawn_it.error() && !nlri_it.error() && !attr_it.error();
+}
+
+BgpProto::UpdateView::PrefixIterator
+BgpProto::UpdateView::withdrawn_routes() const {
+    return PrefixIterator(withdrawn_, withdrawn_size_, false);
+}
+
+BgpProto::UpdateView::AttributeIterator
+BgpProto::UpdateView::path_attributes() const {
+    return AttributeIterator(attributes_, attributes_size_);
+}
+
+BgpProto::UpdateView::PrefixIterator BgpProto::UpdateView::nlri() const {
+    return PrefixIterator(nlri_, nlri_size_, false);
+}
+
+bool BgpProto::UpdateView::IsTypedPrefix(uint16_t afi, uint8_t safi) {
+    return ((afi == BgpAf::L2Vpn && safi == BgpAf::EVpn) ||
+            (afi == BgpAf::IPv4 && safi == BgpAf::ErmVpn));
+}
+
+//
+// Parse the afi, safi and nexthop of a MpReachNlri or MpUnreachNlri path
+// attribute and set up an iterator over the prefixes in it.
+//
+bool BgpProto::UpdateView::ParseMpNlri(const Attribute &attr,
+    MpNlri *mp_nlri) {
+    if (attr.code != BgpAttribute::MPReachNlri &&
+        attr.code != BgpAttribute::MPUnreachNlri) {
+        return false;
+    }
+    if (attr.size < 3)
+        return false;
+
+    mp_nlri->afi = get_short(attr.data);
+    mp_nlri->safi = attr.data[2];
+    size_t offset = 3;
+    if (attr.code == BgpAttribute::MPReachNlri) {
+        if (offset + 1 > attr.size)
+            return false;
+        mp_nlri->nexthop_size = attr.data[offset];
+        offset++;
+
+        // Skip over the reserved byte after the nexthop.
+        if (offset + mp_nlri->nexthop_size + 1 > attr.size)
+            return false;
+        mp_nlri->nexthop = attr.data + offset;
+        offset += mp_nlri->nexthop_size + 1;
+    } else {
+        mp_nlri->nexthop = NULL;
+        mp_nlri->nexthop_size = 0;
+    }
+
+    mp_nlri->nlri = PrefixIterator(attr.data + offset, attr.size - offset,
+        IsTypedPrefix(mp_nlri->afi, mp_nlri->safi));
+    return true;
+}
+
 class BgpMarker : public ProtoElement<BgpMarker> {
 public:
     static const int kSize = 16;
@@ -1748,6 +2000,70 @@ BgpProto::BgpMessage *BgpProto::Decode(const uint8_t *data, size_t size,
     return static_cast<BgpMessage *>(context.release());
 }
 
+//
+// Same as Decode, except that the withdrawn routes and NLRI of an UPDATE are
+// not decoded into BgpProtoPrefix objects.
+//
+// The framing of the UPDATE, including that of all prefixes, is validated
+// with an UpdateView. The path attributes are then decoded with the regular
+// decoder, so that they get the same validation and error reporting as in
+// Decode. This is done over a copy of the message that has no withdrawn
+// routes or NLRI, and in which each MpReachNlri/MpUnreachNlri is cut short
+// after the nexthop. The message itself is kept in Update::raw_msg and the
+// prefixes get walked over it with an UpdateView when the update is processed.
+//
+// Use the regular decoder for other messages and for an UPDATE that doesn't
+// pass these checks, so that errors are reported exactly as in Decode.
+//
+BgpProto::BgpMessage *BgpProto::DecodeLazy(const uint8_t *data, size_t size,
+                                           ParseErrorContext *ec) {
+    UpdateView view;
+    if (!view.Parse(data, size))
+        return Decode(data, size, ec);
+
+    uint8_t buffer[kMaxMessageSize];
+    memcpy(buffer, data, kMinMessageSize);
+    size_t offset = kMinMessageSize;
+    put_value(buffer + offset, 2, 0);
+    offset += 2;
+    size_t attributes_offset = offset;
+    offset += 2;
+
+    UpdateView::Attribute attr;
+    UpdateView::AttributeIterator it = view.path_attributes();
+    while (it.Next(&attr)) {
+        size_t attr_size = attr.size;
+        if (attr.code == BgpAttribute::MPReachNlri ||
+            attr.code == BgpAttribute::MPUnreachNlri) {
+            UpdateView::MpNlri mp_nlri;
+            UpdateView::ParseMpNlri(attr, &mp_nlri);
+            attr_size = (attr.code == BgpAttribute::MPReachNlri) ?
+                3 + 1 + mp_nlri.nexthop_size + 1 : 3;
+        }
+
+        // Copy the flags and code, and then the length and the value.
+        buffer[offset++] = attr.flags;
+        buffer[offset++] = attr.code;
+        if (attr.flags & BgpAttribute::ExtendedLength) {
+            put_value(buffer + offset, 2, attr_size);
+            offset += 2;
+        } else {
+            buffer[offset++] = attr_size;
+        }
+        memcpy(buffer + offset, attr.data, attr_size);
+        offset += attr_size;
+    }
+    put_value(buffer + attributes_offset, 2, offset - attributes_offset - 2);
+    put_value(buffer + 16, 2, offset);
+
+    BgpMessage *msg = Decode(buffer, offset, NULL);
+    if (!msg)
+        return Decode(data, size, ec);
+    Update *update = static_cast<Update *>(msg);
+    update->raw_msg.assign(data, data + size);
+    return update;
+}
+
 int BgpProto::Encode(const BgpMessage *msg, uint8_t *data, size_t size,
                      EncodeOffsets *offsets) {
     EncodeContext ctx;
@@ -429,19 +429,122 @@ public:
         ~Update();
         int Validate(const BgpPeer *, std::string *data);
         int CompareTo(const Update &rhs) const;
+        bool HasNlri() const;
         static BgpProto::Update *Decode(const uint8_t *data, size_t size);
 
         std::vector <BgpProtoPrefix *> withdrawn_routes;
         std::vector <BgpAttribute *> path_attributes;
         std::vector <BgpProtoPrefix *> nlri;
+
+        // Copy of the message as received, set by BgpProto::DecodeLazy.
+        // The withdrawn routes and NLRI, including the prefixes in any
+        // MpReachNlri/MpUnreachNlri, are then only available through an
+        // UpdateView over this buffer.
+        std::vector <uint8_t> raw_msg;
         static int EncodeData(Update *msg, uint8_t *data, size_t size);
     };
 
+    //
+    // View of an UPDATE message in its wire format.
+    //
+    // Parse validates the framing of the message in place i.e. the header
+    // and the lengths of the withdrawn routes, path attributes, prefixes and
+    // NLRI, without allocating anything. Prefixes and attributes can then be
+    // walked over the original buffer and are decoded only if the caller
+    // needs them. The buffer must outlive the view.
+    //
+    class UpdateView {
+    public:
+        struct Prefix {
+            Prefix() : type(0), prefixlen(0), data(NULL), size(0) { }
+            void ToProtoPrefix(BgpProtoPrefix *proto_prefix) const;
+            uint8_t type;
+            int prefixlen;
+            const uint8_t *data;
+            size_t size;
+        };
+
+        struct Attribute {
+            Attribute() : flags(0), code(0), data(NULL), size(0) { }
+            uint8_t flags;
+            uint8_t code;
+            const uint8_t *data;
+            size_t size;
+        };
+
+        //
+        // Iterator over a list of prefixes. Prefixes are encoded either as
+        // a length in bits followed by the prefix, or as a type and length
+        // in bytes followed by the prefix (evpn and ermvpn).
+        //
+        class PrefixIterator {
+        public:
+            PrefixIterator();
+            PrefixIterator(const uint8_t *data, size_t size, bool typed);
+            bool Next(Prefix *prefix);
+            size_t Count() const;
+            bool empty() const { return size_ == 0; }
+            bool error() const { return error_; }
+
+        private:
+            const uint8_t *data_;
+            size_t size_;
+            size_t offset_;
+            bool typed_;
+            bool error_;
+        };
+
+        class AttributeIterator {
+        public:
+            AttributeIterator(const uint8_t *data, size_t size);
+            bool Next(Attribute *attr);
+            bool error() const { return error_; }
+
+        private:
+            const uint8_t *data_;
+            size_t size_;
+            size_t offset_;
+            bool error_;
+        };
+
+        struct MpNlri {
+            MpNlri() : afi(0), safi(0), nexthop(NULL), nexthop_size(0) { }
+            uint16_t afi;
+            uint8_t safi;
+            const uint8_t *nexthop;
+            size_t nexthop_size;
+            PrefixIterator nlri;
+        };
+
+        UpdateView();
+        bool Parse(const uint8_t *data, size_t size);
+
+        PrefixIterator withdrawn_routes() const;
+        AttributeIterator path_attributes() const;
+        PrefixIterator nlri() const;
+        bool has_withdrawn_routes() const { return withdrawn_size_ != 0; }
+        bool has_nlri() const { return nlri_size_ != 0; }
+
+        static bool ParseMpNlri(const Attribute &attr, MpNlri *mp_nlri);
+
+    private:
+        static bool IsTypedPrefix(uint16_t afi, uint8_t safi);
+
+        const uint8_t *withdrawn_;
+        size_t withdrawn_size_;
+        const uint8_t *attributes_;
+        size_t attributes_size_;
+        const uint8_t *nlri_;
+        size_t nlri_size_;
+    };
+
     static const int kMinMessageSize = 19;
     static const int kMaxMessageSize = 4096;
 
     static BgpMessage *Decode(const uint8_t *data, size_t size,
                               ParseErrorContext *ec = NULL);
+    static BgpMessage *DecodeLazy(const uint8_t *data, size_t size,
+                                  ParseErrorContext *ec = NULL);
 
     static int Encode(const BgpMessage *msg, uint8_t *data, size_t size,
                       EncodeOffsets *offsets = NULL);
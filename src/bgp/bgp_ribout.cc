@@ -5,8 +5,10 @@
 #include "bgp/bgp_ribout.h"
 
 #include <boost/bind.hpp>
+#include <boost/pool/singleton_pool.hpp>
 
 #include <algorithm>
+#include <new>
 
 #include "sandesh/sandesh_trace.h"
 #include "base/string_util.h"
@@ -25,6 +27,37 @@
 
 using std::find;
 
+//
+// Pools for RouteState and AdvertiseInfo.  Memory in the pools is never
+// returned to the system, but it gets reused when new entries are created
+// e.g. when routes are re-advertised after flapping.
+//
+// Live entry counts are tracked so that we can report the memory used to
+// keep track of advertised routes. The pools are shared by all BgpServers
+// in the process, and so are the counts.
+//
+struct RouteStatePoolTag { };
+typedef boost::singleton_pool<RouteStatePoolTag, sizeof(RouteState),
+    boost::default_user_allocator_new_delete, tbb::spin_mutex,
+    1024, 0> RouteStatePool;
+
+struct AdvertiseInfoPoolTag { };
+typedef boost::singleton_pool<AdvertiseInfoPoolTag, sizeof(AdvertiseInfo),
+    boost::default_user_allocator_new_delete, tbb::spin_mutex,
+    1024, 0> AdvertiseInfoPool;
+
+static tbb::atomic<uint64_t> route_state_count;
+static tbb::atomic<uint64_t> advertise_info_count;
+static tbb::atomic<uint64_t> advertise_peerset_count;
+static tbb::atomic<uint64_t> advertise_peerset_bytes;
+
+//
+// Heap memory used by a RibPeerSet. The first 64 bits are stored inline.
+//
+static size_t PeerSetHeapBytes(const RibPeerSet &peerset) {
+    return peerset.size() > 64 ? peerset.size() / 8 : 0;
+}
+
 RibOutAttr::NextHop::NextHop(const BgpTable *table, IpAddress address,
     const MacAddress &mac, uint32_t label, uint32_t l3_label,
     const ExtCommunity *ext_community, bool vrf_originated)
@@ -232,9 +265,250 @@ void RibOutAttr::set_attr(const BgpTable *table, const BgpAttrPtr &attrp,
     attr_out_ = attrp;
 }
 
+//
+// Return the cached string representation, if any.
+//
+const std::string &RibOutAttr::repr() const {
+    static const std::string kEmptyRepr;
+    return repr_ ? repr_->repr() : kEmptyRepr;
+}
+
+//
+// Cache the substring of the given string starting at pos as the string
+// representation. Update the shared RibOutAttrRepr if there's one, else
+// allocate a private one.
+//
+void RibOutAttr::set_repr(const std::string &repr, size_t pos) const {
+    if (!repr_)
+        repr_ = new RibOutAttrRepr;
+    repr_->repr_.clear();
+    repr_->repr_.append(repr, pos, std::string::npos);
+}
+
+bool RibOutAttr::is_repr_shared() const {
+    return repr_ && repr_->is_shared();
+}
+
+RibOutAttrRepr::RibOutAttrRepr()
+    : cache_(NULL), route_(NULL) {
+    refcount_ = 0;
+}
+
+RibOutAttrRepr::RibOutAttrRepr(RibOutAttrReprCache *cache,
+    const BgpRoute *route, const RibOutAttr &roattr)
+    : cache_(cache), route_(route), roattr_(roattr) {
+    refcount_ = 0;
+}
+
+void intrusive_ptr_add_ref(RibOutAttrRepr *repr) {
+    repr->refcount_.fetch_and_increment();
+}
+
+//
+// Shared RibOutAttrReprs are released with the cache mutex held so that the
+// RibOutAttrReprCache never hands out an entry whose refcount dropped to 0.
+//
+void intrusive_ptr_release(RibOutAttrRepr *repr) {
+    if (repr->cache_) {
+        repr->cache_->Release(repr);
+        return;
+    }
+    if (repr->refcount_.fetch_and_decrement() == 1)
+        delete repr;
+}
+
+RibOutAttrReprCache::RibOutAttrReprCache() {
+}
+
+RibOutAttrReprCache::~RibOutAttrReprCache() {
+    assert(repr_map_.empty());
+}
+
+//
+// Find or create the shared RibOutAttrRepr for the route and RibOutAttr.
+//
+RibOutAttrReprPtr RibOutAttrReprCache::Locate(const BgpRoute *route,
+    const RibOutAttr &roattr) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    std::pair<ReprMap::iterator, ReprMap::iterator> range =
+        repr_map_.equal_range(route);
+    for (ReprMap::iterator it = range.first; it != range.second; ++it) {
+        if (it->second->roattr_ == roattr)
+            return RibOutAttrReprPtr(it->second);
+    }
+
+    RibOutAttrRepr *repr = new RibOutAttrRepr(this, route, roattr);
+    repr_map_.insert(range.second, std::make_pair(route, repr));
+    return RibOutAttrReprPtr(repr);
+}
+
+size_t RibOutAttrReprCache::size() const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    return repr_map_.size();
+}
+
+void RibOutAttrReprCache::Release(RibOutAttrRepr *repr) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (repr->refcount_.fetch_and_decrement() != 1)
+        return;
+
+    std::pair<ReprMap::iterator, ReprMap::iterator> range =
+        repr_map_.equal_range(repr->route_);
+    for (ReprMap::iterator it = range.first; it != range.second; ++it) {
+        if (it->second == repr) {
+            repr_map_.erase(it);
+            break;
+        }
+    }
+    lock.release();
+    delete repr;
+}
+
+//
+// Only interned AdvertisePeerSets are accounted for. Private copies are
+// transient and may be modified in place.
+//
+AdvertisePeerSet::AdvertisePeerSet(AdvertisePeerSetDB *peerset_db,
+    const RibPeerSet &peerset, bool interned)
+    : peerset_db_(peerset_db), interned_(interned), peerset_(peerset) {
+    refcount_ = 0;
+    if (interned_) {
+        advertise_peerset_count++;
+        advertise_peerset_bytes += PeerSetHeapBytes(peerset_);
+    }
+}
+
+AdvertisePeerSet::~AdvertisePeerSet() {
+    if (interned_) {
+        advertise_peerset_count--;
+        advertise_peerset_bytes -= PeerSetHeapBytes(peerset_);
+    }
+}
+
+void AdvertisePeerSet::Remove() {
+    if (interned_)
+        peerset_db_->Delete(this);
+}
+
+AdvertisePeerSetDB::AdvertisePeerSetDB() {
+}
+
+//
+// A private RibPeerSet is never shared, so the copy gets its own.
+//
+AdvertiseInfo::AdvertiseInfo(const AdvertiseInfo &rhs)
+    : peerset(rhs.peerset), roattr(rhs.roattr) {
+    if (peerset && !peerset->interned()) {
+        peerset.reset(new AdvertisePeerSet(
+            peerset->peerset_db(), peerset->peerset(), false));
+    }
+}
+
+void *AdvertiseInfo::operator new(size_t size) {
+    assert(size == sizeof(AdvertiseInfo));
+    void *ptr = AdvertiseInfoPool::malloc();
+    if (!ptr)
+        throw std::bad_alloc();
+    advertise_info_count++;
+    return ptr;
+}
+
+void AdvertiseInfo::operator delete(void *ptr) {
+    if (!ptr)
+        return;
+    advertise_info_count--;
+    AdvertiseInfoPool::free(ptr);
+}
+
+//
+// Return the set of peers to which the prefix has been advertised.
+//
+const RibPeerSet &AdvertiseInfo::bitset() const {
+    static const RibPeerSet empty_peerset;
+    return peerset ? peerset->peerset() : empty_peerset;
+}
+
+//
+// Update the set of peers to which the prefix has been advertised.
+//
+void AdvertiseInfo::set_bitset(AdvertisePeerSetDB *peerset_db,
+    const RibPeerSet &bitset) {
+    if (bitset == this->bitset())
+        return;
+    if (bitset.empty()) {
+        peerset.reset();
+    } else {
+        peerset = peerset_db->Locate(bitset);
+    }
+}
+
+//
+// Return a private copy of the set of peers to which the prefix has been
+// advertised, creating it if needed. The copy can be modified in place any
+// number of times and is located in the AdvertisePeerSetDB only once, when
+// Intern is called.
+//
+RibPeerSet *AdvertiseInfo::mutable_bitset(AdvertisePeerSetDB *peerset_db) {
+    if (!peerset || peerset->interned()) {
+        peerset.reset(new AdvertisePeerSet(peerset_db, bitset(), false));
+    }
+    AdvertisePeerSet *private_peerset =
+        const_cast<AdvertisePeerSet *>(peerset.get());
+    return &private_peerset->peerset_;
+}
+
+//
+// Replace the private copy of the set of peers, if any, with the interned
+// one.
+//
+void AdvertiseInfo::Intern() {
+    if (!peerset || peerset->interned())
+        return;
+    if (peerset->peerset().empty()) {
+        peerset.reset();
+    } else {
+        peerset = peerset->peerset_db()->Locate(peerset->peerset());
+    }
+}
+
+//
+// Intern the private RibPeerSets of all AdvertiseInfos in the list.
+//
+void AdvertiseSList::Intern() {
+    for (List::iterator iter = list_.begin(); iter != list_.end(); ++iter) {
+        iter->Intern();
+    }
+}
+
 RouteState::RouteState() {
 }
 
+void *RouteState::operator new(size_t size) {
+    assert(size == sizeof(RouteState));
+    void *ptr = RouteStatePool::malloc();
+    if (!ptr)
+        throw std::bad_alloc();
+    route_state_count++;
+    return ptr;
+}
+
+void RouteState::operator delete(void *ptr) {
+    if (!ptr)
+        return;
+    route_state_count--;
+    RouteStatePool::free(ptr);
+}
+
+//
+// Swap the history in the RouteState with the given AdvertiseSList. Any
+// private RibPeerSets in the new history are interned, since a RouteState
+// may stay around for a long time.
+//
+void RouteState::SwapHistory(AdvertiseSList &history) {
+    advertised_.swap(history);
+    advertised_.Intern();
+}
+
 //
 // Move history from RouteState to RouteUpdate.
 //
@@ -277,13 +551,39 @@ bool RouteState::CompareUpdateInfo(const UpdateInfoSList &uinfo_slist) const {
     for (UpdateInfoSList::List::const_iterator iter = uinfo_slist->begin();
          iter != uinfo_slist->end(); ++iter) {
         const AdvertiseInfo *ainfo = FindHistory(iter->roattr);
-        if (!ainfo || iter->target != ainfo->bitset)
+        if (!ainfo || iter->target != ainfo->bitset())
             return false;
     }
 
     return true;
 }
 
+//
+// Fill memory usage for RouteStates, AdvertiseInfos and interned peer sets.
+// The pools and counters are shared by all RibOuts of all BgpServers in the
+// process, so the information is neither per RibOut nor per BgpServer.
+//
+// The per route number is an average over all RouteStates i.e. all routes
+// that are advertised and don't have pending updates.
+//
+void RouteState::FillMemoryStatisticsInfo(
+    ShowRouteStateMemoryStatistics *srsms) {
+    uint64_t route_states = route_state_count;
+    uint64_t advertise_infos = advertise_info_count;
+    uint64_t peersets = advertise_peerset_count;
+    uint64_t peerset_bytes = advertise_peerset_bytes;
+    uint64_t bytes = route_states * sizeof(RouteState) +
+        advertise_infos * sizeof(AdvertiseInfo) +
+        peersets * sizeof(AdvertisePeerSet) + peerset_bytes;
+
+    srsms->set_route_states(route_states);
+    srsms->set_advertise_infos(advertise_infos);
+    srsms->set_peersets(peersets);
+    srsms->set_peerset_bytes(peerset_bytes);
+    srsms->set_bytes(bytes);
+    srsms->set_bytes_per_route(route_states ? bytes / route_states : 0);
+}
+
 //
 // Create a new RibOut based on the BgpTable and RibExportPolicy.
 //
@@ -442,7 +742,7 @@ int RibOut::RouteAdvertiseCount(const BgpRoute *rt) const {
         for (AdvertiseSList::List::const_iterator iter =
              rstate->Advertised()->begin();
              iter != rstate->Advertised()->end(); ++iter) {
-            count += iter->bitset.count();
+            count += iter->bitset().count();
         }
         return count;
     }
@@ -453,7 +753,7 @@ int RibOut::RouteAdvertiseCount(const BgpRoute *rt) const {
         for (AdvertiseSList::List::const_iterator iter =
              rt_update->History()->begin();
              iter != rt_update->History()->end(); ++iter) {
-            count += iter->bitset.count();
+            count += iter->bitset().count();
         }
         return count;
     }
@@ -464,7 +764,7 @@ int RibOut::RouteAdvertiseCount(const BgpRoute *rt) const {
         for (AdvertiseSList::List::const_iterator iter =
              uplist->History()->begin();
              iter != uplist->History()->end(); ++iter) {
-            count += iter->bitset.count();
+            count += iter->bitset().count();
         }
         return count;
     }
@@ -566,6 +866,12 @@ void RibOut::FillStatisticsInfo(vector<ShowRibOutStatistics> *sros_list) const {
         sros.set_marker_splits(stats.marker_split_count_);
         sros.set_marker_merges(stats.marker_merge_count_);
         sros.set_marker_moves(stats.marker_move_count_);
+        sros.set_prefixes_built(stats.prefixes_built_count_);
+        sros.set_prefixes_per_message(stats.messages_built_count_ ?
+            stats.prefixes_built_count_ / stats.messages_built_count_ : 0);
+        sros.set_messages_full(stats.message_full_count_);
+        if (qid == RibOutUpdates::QUPDATE)
+            sros.set_rtarget_filtered(bgp_export_->rtarget_filtered_count());
         sros_list->push_back(sros);
     }
 }
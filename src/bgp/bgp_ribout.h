@@ -5,10 +5,15 @@
 #ifndef SRC_BGP_BGP_RIBOUT_H_
 #define SRC_BGP_BGP_RIBOUT_H_
 
+#include <boost/intrusive_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/intrusive/slist.hpp>
+#include <tbb/atomic.h>
+#include <tbb/mutex.h>
+#include <tbb/spin_mutex.h>
 
 #include <algorithm>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -24,12 +29,20 @@ class IPeer;
 class IPeerUpdate;
 class RibOutUpdates;
 class ShowRibOutStatistics;
+class ShowRouteStateMemoryStatistics;
 class BgpTable;
 class BgpExport;
 class BgpRoute;
+class BgpServer;
 class BgpUpdateSender;
 class RouteUpdate;
 class UpdateInfoSList;
+class RibOutAttrRepr;
+class RibOutAttrReprCache;
+
+void intrusive_ptr_add_ref(RibOutAttrRepr *repr);
+void intrusive_ptr_release(RibOutAttrRepr *repr);
+typedef boost::intrusive_ptr<RibOutAttrRepr> RibOutAttrReprPtr;
 
 //
 // This class represents the attributes for a ribout entry, including the
@@ -115,10 +128,11 @@ public:
     }
     bool is_xmpp() const { return is_xmpp_; }
     bool vrf_originated() const { return vrf_originated_; }
-    const std::string &repr() const { return repr_; }
-    void set_repr(const std::string &repr, size_t pos = 0) const {
-        repr_.clear();
-        repr_.append(repr, pos, std::string::npos);
+    const std::string &repr() const;
+    void set_repr(const std::string &repr, size_t pos = 0) const;
+    bool is_repr_shared() const;
+    void set_shared_repr(const RibOutAttrReprPtr &repr) const {
+        repr_ = repr;
     }
 
 private:
@@ -130,7 +144,75 @@ private:
     uint32_t l3_label_;
     bool is_xmpp_;
     bool vrf_originated_;
-    mutable std::string repr_;
+    mutable RibOutAttrReprPtr repr_;
+};
+
+//
+// This class represents the formatted (xmpp) string representation of a
+// RibOutAttr for a given route.
+//
+// A RibOutAttrRepr is either private to a RibOutAttr or is shared by all
+// RibOutAttrs with identical contents for the same route in all RibOuts of
+// a BgpTable. Shared instances are kept in a RibOutAttrReprCache and they
+// allow the route to be formatted once and then be reused in all RibOuts,
+// rather than once per RibOut.
+//
+class RibOutAttrRepr {
+public:
+    RibOutAttrRepr();
+    RibOutAttrRepr(RibOutAttrReprCache *cache, const BgpRoute *route,
+        const RibOutAttr &roattr);
+
+    const std::string &repr() const { return repr_; }
+    bool is_shared() const { return cache_ != NULL; }
+
+private:
+    friend class RibOutAttr;
+    friend class RibOutAttrReprCache;
+    friend void intrusive_ptr_add_ref(RibOutAttrRepr *repr);
+    friend void intrusive_ptr_release(RibOutAttrRepr *repr);
+
+    tbb::atomic<int> refcount_;
+    RibOutAttrReprCache *cache_;
+    const BgpRoute *route_;
+    RibOutAttr roattr_;
+    std::string repr_;
+
+    DISALLOW_COPY_AND_ASSIGN(RibOutAttrRepr);
+};
+
+//
+// This class is a cache of shared RibOutAttrReprs for a partition of a
+// BgpTable, keyed by the route and the contents of the RibOutAttr.
+//
+// Entries are located when the UpdateInfos for xmpp RibOuts are enqueued
+// and are removed when the last UpdateInfo referring to them goes away.
+// Since the RibOutAttr is part of the key, any change to the route results
+// in a new entry, so stale representations are never reused. An entry also
+// keeps the route from being reused for a different prefix since it cannot
+// outlive the UpdateInfo which holds DBState on the route.
+//
+// The mutex protects the map. The representation itself is only accessed
+// from the bgp::SendUpdate task for the partition.
+//
+class RibOutAttrReprCache {
+public:
+    RibOutAttrReprCache();
+    ~RibOutAttrReprCache();
+
+    RibOutAttrReprPtr Locate(const BgpRoute *route, const RibOutAttr &roattr);
+    size_t size() const;
+
+private:
+    friend void intrusive_ptr_release(RibOutAttrRepr *repr);
+    typedef std::multimap<const BgpRoute *, RibOutAttrRepr *> ReprMap;
+
+    void Release(RibOutAttrRepr *repr);
+
+    mutable tbb::mutex mutex_;
+    ReprMap repr_map_;
+
+    DISALLOW_COPY_AND_ASSIGN(RibOutAttrReprCache);
 };
 
 //
@@ -141,6 +223,97 @@ private:
 class RibPeerSet : public BitSet {
 };
 
+class AdvertisePeerSetDB;
+
+//
+// This class represents a RibPeerSet that has been advertised to. It is
+// immutable and interned in the AdvertisePeerSetDB, so all AdvertiseInfos
+// with an identical set of peers share the same AdvertisePeerSet.
+//
+// With a large number of peers in a RibOut, the vast majority of prefixes
+// end up being advertised to the same few sets of peers. Interning avoids
+// keeping a separate copy of a potentially large bitmap for each of them.
+//
+// An AdvertisePeerSet that is not interned is a private copy owned by a
+// single AdvertiseInfo. It's used to accumulate changes while the history
+// is on a RouteUpdate or UpdateList, so that the final RibPeerSet is only
+// located in the AdvertisePeerSetDB once.
+//
+class AdvertisePeerSet {
+public:
+    AdvertisePeerSet(AdvertisePeerSetDB *peerset_db,
+                     const RibPeerSet &peerset, bool interned = true);
+    ~AdvertisePeerSet();
+    void Remove();
+
+    int CompareTo(const AdvertisePeerSet &rhs) const {
+        return peerset_.CompareTo(rhs.peerset_);
+    }
+    const RibPeerSet &peerset() const { return peerset_; }
+    bool interned() const { return interned_; }
+    AdvertisePeerSetDB *peerset_db() const { return peerset_db_; }
+
+    friend std::size_t hash_value(const AdvertisePeerSet &peerset) {
+        return peerset.peerset_.Hash();
+    }
+
+private:
+    friend int intrusive_ptr_add_ref(const AdvertisePeerSet *cpeerset);
+    friend int intrusive_ptr_del_ref(const AdvertisePeerSet *cpeerset);
+    friend bool intrusive_ptr_add_ref_if_live(
+        const AdvertisePeerSet *cpeerset);
+    friend void intrusive_ptr_release(const AdvertisePeerSet *cpeerset);
+    friend struct AdvertiseInfo;
+
+    mutable tbb::atomic<int> refcount_;
+    AdvertisePeerSetDB *peerset_db_;
+    bool interned_;
+    RibPeerSet peerset_;
+
+    DISALLOW_COPY_AND_ASSIGN(AdvertisePeerSet);
+};
+
+inline int intrusive_ptr_add_ref(const AdvertisePeerSet *cpeerset) {
+    return cpeerset->refcount_.fetch_and_increment();
+}
+
+inline int intrusive_ptr_del_ref(const AdvertisePeerSet *cpeerset) {
+    return cpeerset->refcount_.fetch_and_decrement();
+}
+
+inline bool intrusive_ptr_add_ref_if_live(const AdvertisePeerSet *cpeerset) {
+    return BgpAttrAddRefIfLive(cpeerset->refcount_);
+}
+
+inline void intrusive_ptr_release(const AdvertisePeerSet *cpeerset) {
+    int prev = cpeerset->refcount_.fetch_and_decrement();
+    if (prev == 1) {
+        AdvertisePeerSet *peerset = const_cast<AdvertisePeerSet *>(cpeerset);
+        peerset->Remove();
+        assert(peerset->refcount_ == 0);
+        delete peerset;
+    }
+}
+
+typedef boost::intrusive_ptr<const AdvertisePeerSet> AdvertisePeerSetPtr;
+
+struct AdvertisePeerSetCompare {
+    bool operator()(const AdvertisePeerSet *lhs,
+                    const AdvertisePeerSet *rhs) const {
+        return lhs->CompareTo(*rhs) < 0;
+    }
+};
+
+class AdvertisePeerSetDB : public BgpPathAttributeDB<
+    AdvertisePeerSet, AdvertisePeerSetPtr, RibPeerSet,
+    AdvertisePeerSetCompare, AdvertisePeerSetDB> {
+public:
+    AdvertisePeerSetDB();
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(AdvertisePeerSetDB);
+};
+
 //
 // This class represents information for a particular prefix that has been
 // advertised to a set of peers.
@@ -151,17 +324,31 @@ class RibPeerSet : public BitSet {
 // attributes.  This representation allows us to keep track of a different
 // set of attributes for each set of peers.
 //
+// The RibPeerSet is interned in the AdvertisePeerSetDB of the BgpServer and
+// hence can't be modified in place. Use set_bitset to change it, or use
+// mutable_bitset to make a private copy that is modified in place and then
+// interned later via Intern.
+//
+// AdvertiseInfos are allocated from a pool since there's at least one for
+// every prefix that's advertised by every RibOut.
+//
 struct AdvertiseInfo {
     AdvertiseInfo() { }
     explicit AdvertiseInfo(const RibOutAttr *roattr) : roattr(*roattr) { }
-    AdvertiseInfo(const AdvertiseInfo &rhs)
-        : bitset(rhs.bitset), roattr(rhs.roattr) {
-    }
+    AdvertiseInfo(const AdvertiseInfo &rhs);
+
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr);
+
+    const RibPeerSet &bitset() const;
+    void set_bitset(AdvertisePeerSetDB *peerset_db, const RibPeerSet &bitset);
+    RibPeerSet *mutable_bitset(AdvertisePeerSetDB *peerset_db);
+    void Intern();
 
     // Intrusive slist node for RouteState.
     boost::intrusive::slist_member_hook<> slist_node;
 
-    RibPeerSet bitset;
+    AdvertisePeerSetPtr peerset;
     RibOutAttr roattr;
 };
 
@@ -198,6 +385,7 @@ public:
     const List *operator->() const { return &list_; }
     const List &list() const { return list_; }
     void swap(AdvertiseSList &adv_slist) { list_.swap(adv_slist.list_); }
+    void Intern();
 
 private:
     List list_;
@@ -215,23 +403,28 @@ private:
 //
 // A RouteState maintains a singly linked list of AdvertiseInfo entries
 // to keep track of the attributes that have been advertised to each set
-// of peers.
+// of peers.  The RibPeerSets in these entries are always interned.
 //
 class RouteState : public DBState {
 public:
     RouteState();
 
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr);
+
     void SetHistory(AdvertiseSList &history) {
         assert(advertised_->empty());
         advertised_.swap(history);
+        advertised_.Intern();
     }
-    void SwapHistory(AdvertiseSList &history) {
-        advertised_.swap(history);
-    }
+    void SwapHistory(AdvertiseSList &history);
     void MoveHistory(RouteUpdate *rt_update);
     const AdvertiseInfo *FindHistory(const RibOutAttr &roattr) const;
     bool CompareUpdateInfo(const UpdateInfoSList &uinfo_slist) const;
 
+    static void FillMemoryStatisticsInfo(
+        ShowRouteStateMemoryStatistics *srsms);
+
     const AdvertiseSList &Advertised() const { return advertised_; }
     AdvertiseSList &Advertised() { return advertised_; }
 
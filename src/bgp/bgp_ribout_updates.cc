@@ -178,6 +178,8 @@ bool RibOutUpdates::DequeueCommon(UpdateQueue *queue, UpdateMarker *marker,
         if (msg_built) {
             UpdatePack(queue_id, message, uinfo, msgset);
             message->Finish();
+            stats_[queue_id].prefixes_built_count_ +=
+                message->num_reach_routes() + message->num_unreach_routes();
             UpdateSend(queue_id, message, msgset, &msg_blocked);
         }
 
@@ -430,6 +432,7 @@ void RibOutUpdates::UpdatePack(int queue_id, Message *message,
         // get included in another update message.
         bool success = message->AddRoute(update->route(), &uinfo->roattr);
         if (!success) {
+            stats_[queue_id].message_full_count_++;
             break;
         }
 
@@ -693,4 +696,6 @@ void RibOutUpdates::AddStatisticsInfo(int queue_id, Stats *stats) const {
     stats->marker_split_count_   += stats_[queue_id].marker_split_count_;
     stats->marker_merge_count_   += stats_[queue_id].marker_merge_count_;
     stats->marker_move_count_    += stats_[queue_id].marker_move_count_;
+    stats->prefixes_built_count_ += stats_[queue_id].prefixes_built_count_;
+    stats->message_full_count_   += stats_[queue_id].message_full_count_;
 }
@@ -55,9 +55,7 @@ void BgpRoute::InsertPath(BgpPath *path) {
         RoutingInstance *rtinstance = table->routing_instance();
         rtinstance->ProcessRoutingPolicy(this, path);
     }
-    insert(path);
-
-    Sort(&BgpTable::PathSelection, prev_front);
+    InsertSorted(path, &BgpTable::PathSelection, prev_front);
 
     // Update counters.
     if (table)
@@ -71,8 +69,7 @@ void BgpRoute::InsertPath(BgpPath *path) {
 void BgpRoute::DeletePath(BgpPath *path) {
     const Path *prev_front = front();
 
-    remove(path);
-    Sort(&BgpTable::PathSelection, prev_front);
+    RemoveSorted(path, prev_front);
 
     // Update counters.
     BgpTable *table = static_cast<BgpTable *>(get_table());
@@ -8,11 +8,13 @@
 #include <boost/foreach.hpp>
 #include <sandesh/request_pipeline.h>
 
+#include "bgp/bgp_config.h"
 #include "bgp/bgp_multicast.h"
 #include "bgp/bgp_peer.h"
 #include "bgp/bgp_peer_internal_types.h"
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_session_manager.h"
+#include "bgp/bgp_show_route.h"
 #include "bgp/ermvpn/ermvpn_table.h"
 #include "bgp/inet/inet_table.h"
 #include "bgp/routing-instance/peer_manager.h"
@@ -399,6 +401,19 @@ void ShowRouteVrfReq::HandleRequest() const {
 
 class ShowBgpServerHandler {
 public:
+    static void FillConfigPhaseInfo(const string &name,
+            const BgpConfigPhaseStats &stats,
+            vector<BgpConfigPhaseInfo> *config_phases) {
+        BgpConfigPhaseInfo info;
+        info.set_name(name);
+        info.set_first_at(stats.first_at);
+        info.set_last_at(stats.last_at);
+        info.set_busy_usec(stats.busy_usec);
+        info.set_processed(stats.processed);
+        info.set_skipped(stats.skipped);
+        config_phases->push_back(info);
+    }
+
     static bool CallbackS1(const Sandesh *sr,
             const RequestPipeline::PipeSpec ps, int stage, int instNum,
             RequestPipeline::InstData *data) {
@@ -415,6 +430,14 @@ public:
         bsc->bgp_server->session_manager()->GetTxSocketStats(&peer_socket_stats);
         resp->set_tx_socket_stats(peer_socket_stats);
 
+        vector<BgpConfigPhaseInfo> config_phases;
+        FillConfigPhaseInfo("config",
+            bsc->bgp_server->config_manager()->config_stats(), &config_phases);
+        FillConfigPhaseInfo("routing-instance",
+            bsc->bgp_server->routing_instance_mgr()->GetInstanceConfigStats(),
+            &config_phases);
+        resp->set_config_phases(config_phases);
+
         resp->set_context(req->context());
         resp->Response();
         return true;
@@ -440,7 +463,11 @@ BgpSandeshContext::BgpSandeshContext()
       xmpp_peer_manager(NULL),
       test_mode_(false),
       page_limit_(0),
-      iter_limit_(0) {
+      iter_limit_(0),
+      show_route_cursor_mgr_(new ShowRouteCursorMgr) {
+}
+
+BgpSandeshContext::~BgpSandeshContext() {
 }
 
 void BgpSandeshContext::SetNeighborShowExtensions(
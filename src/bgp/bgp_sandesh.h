@@ -6,6 +6,7 @@
 #define SRC_BGP_BGP_SANDESH_H_
 
 #include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <sandesh/sandesh.h>
 
 #include <string>
@@ -19,6 +20,7 @@ class ShowBgpNeighborSummaryReq;
 class ShowNeighborStatisticsReq;
 class ShowBgpPeeringConfigReq;
 class ShowBgpPeeringConfigReqIterate;
+class ShowRouteCursorMgr;
 
 struct BgpSandeshContext : public SandeshContext {
     typedef boost::function<bool(const BgpSandeshContext *, bool,
@@ -34,6 +36,7 @@ struct BgpSandeshContext : public SandeshContext {
         const ShowBgpPeeringConfigReqIterate *)> PeeringReqIterateHandler;
 
     BgpSandeshContext();
+    ~BgpSandeshContext();
 
     void SetNeighborShowExtensions(
         const NeighborListExtension &show_neighbor,
@@ -53,6 +56,10 @@ struct BgpSandeshContext : public SandeshContext {
     void ShowNeighborStatisticsExtension(size_t *count,
         const ShowNeighborStatisticsReq *req) const;
 
+    ShowRouteCursorMgr *show_route_cursor_mgr() const {
+        return show_route_cursor_mgr_.get();
+    }
+
     void PeeringShowReqHandler(const ShowBgpPeeringConfigReq *req);
     void PeeringShowReqIterateHandler(
         const ShowBgpPeeringConfigReqIterate *req_iterate);
@@ -73,6 +80,7 @@ private:
     NeighborStatisticsExtension show_neighbor_statistics_ext_;
     PeeringReqHandler show_peering_req_handler_;
     PeeringReqIterateHandler show_peering_req_iterate_handler_;
+    boost::scoped_ptr<ShowRouteCursorMgr> show_route_cursor_mgr_;
 };
 
 #endif  // SRC_BGP_BGP_SANDESH_H_
@@ -19,6 +19,7 @@
 #include "bgp/bgp_ribout_updates.h"
 #include "bgp/rtarget/rtarget_table.h"
 #include "bgp/bgp_session_manager.h"
+#include "bgp/bgp_update_recorder.h"
 #include "bgp/bgp_update_sender.h"
 #include "bgp/peer_stats.h"
 #include "bgp/routing-instance/iservice_chain_mgr.h"
@@ -74,6 +75,7 @@ public:
     void ProcessGlobalSystemConfig(const BgpGlobalSystemConfig *new_config,
             BgpConfigManager::EventType event) {
         bool clear_peers = false;
+        bool sort_paths = false;
 
         if (server_->global_config()->gr_enable() != new_config->gr_enable()) {
             server_->global_config()->set_gr_enable(new_config->gr_enable());
@@ -100,12 +102,15 @@ public:
             clear_peers = true;
         }
 
-        // Clear peers if there's a change in always-compare-med knob.
+        // Clear peers and sort paths of all routes again if there's a change
+        // in always-compare-med knob. Clearing peers does not affect paths
+        // from xmpp peers, so their order has to be fixed up explicitly.
         if (server_->global_config()->always_compare_med() !=
             new_config->always_compare_med()) {
             server_->global_config()->set_always_compare_med(
                 new_config->always_compare_med());
             clear_peers = true;
+            sort_paths = true;
         }
 
         bool clear_bgpaas_peers = false;
@@ -134,10 +139,28 @@ public:
             peer_manager->ClearAllPeers();
         }
 
+        if (sort_paths)
+            SortAllPaths();
+
         if (clear_peers || clear_bgpaas_peers)
             server_->ClearBgpaaSPeers();
     }
 
+    void SortAllPaths() {
+        RoutingInstanceMgr *ri_mgr = server_->routing_instance_mgr();
+        for (RoutingInstanceMgr::RoutingInstanceIterator rit = ri_mgr->begin();
+             rit != ri_mgr->end(); ++rit) {
+            if (rit->deleted())
+                continue;
+            RoutingInstance::RouteTableList const rt_list = rit->GetTables();
+            for (RoutingInstance::RouteTableList::const_iterator it =
+                 rt_list.begin(); it != rt_list.end(); ++it) {
+                BgpTable *table = it->second;
+                table->SortAllPaths();
+            }
+        }
+    }
+
     void ProcessProtocolConfig(const BgpProtocolConfig *protocol_config,
                                BgpConfigManager::EventType event) {
         const string &instance_name = protocol_config->instance_name();
@@ -422,8 +445,10 @@ BgpServer::BgpServer(EventManager *evm)
       ovnpath_db_(new OriginVnPathDB(this)),
       pmsi_tunnel_db_(new PmsiTunnelDB(this)),
       attr_db_(new BgpAttrDB(this)),
+      peerset_db_(new AdvertisePeerSetDB()),
       session_mgr_(BgpObjectFactory::Create<BgpSessionManager>(evm, this)),
       update_sender_(new BgpUpdateSender(this)),
+      update_recorder_(new BgpUpdateRecorder),
       inst_mgr_(BgpObjectFactory::Create<RoutingInstanceMgr>(this)),
       policy_mgr_(BgpObjectFactory::Create<RoutingPolicyMgr>(this)),
       rtarget_group_mgr_(BgpObjectFactory::Create<RTargetGroupMgr>(this)),
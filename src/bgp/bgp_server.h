@@ -23,6 +23,7 @@
 #include "io/tcp_session.h"
 #include "net/address.h"
 
+class AdvertisePeerSetDB;
 class AsPathDB;
 class BgpAttrDB;
 class BgpConditionListener;
@@ -34,6 +35,7 @@ class BgpOListDB;
 class BgpPeer;
 class BgpRouterState;
 class BgpSessionManager;
+class BgpUpdateRecorder;
 class BgpUpdateSender;
 class ClusterListDB;
 class CommunityDB;
@@ -90,6 +92,7 @@ public:
     // accessors
     BgpSessionManager *session_manager() { return session_mgr_; }
     BgpUpdateSender *update_sender() { return update_sender_.get(); }
+    BgpUpdateRecorder *update_recorder() { return update_recorder_.get(); }
     LifetimeManager *lifetime_manager() { return lifetime_manager_.get(); }
     BgpConfigManager *config_manager() { return config_mgr_.get(); }
     const BgpConfigManager *config_manager() const { return config_mgr_.get(); }
@@ -163,6 +166,7 @@ public:
     ExtCommunityDB *extcomm_db() { return extcomm_db_.get(); }
     OriginVnPathDB *ovnpath_db() { return ovnpath_db_.get(); }
     PmsiTunnelDB *pmsi_tunnel_db() { return pmsi_tunnel_db_.get(); }
+    AdvertisePeerSetDB *peerset_db() { return peerset_db_.get(); }
 
     bool IsDeleted() const;
     bool IsReadyForDeletion();
@@ -332,10 +336,12 @@ private:
     boost::scoped_ptr<OriginVnPathDB> ovnpath_db_;
     boost::scoped_ptr<PmsiTunnelDB> pmsi_tunnel_db_;
     boost::scoped_ptr<BgpAttrDB> attr_db_;
+    boost::scoped_ptr<AdvertisePeerSetDB> peerset_db_;
 
     // sessions and state managers
     BgpSessionManager *session_mgr_;
     boost::scoped_ptr<BgpUpdateSender> update_sender_;
+    boost::scoped_ptr<BgpUpdateRecorder> update_recorder_;
     boost::scoped_ptr<RoutingInstanceMgr> inst_mgr_;
     boost::scoped_ptr<RoutingPolicyMgr> policy_mgr_;
     boost::scoped_ptr<RTargetGroupMgr> rtarget_group_mgr_;
@@ -7,6 +7,7 @@
 #include <boost/regex.hpp>
 
 #include "bgp/bgp_peer_internal_types.h"
+#include "bgp/bgp_ribout.h"
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_table.h"
 #include "bgp/routing-instance/routing_instance.h"
@@ -65,12 +66,18 @@ bool BgpShowHandler<ShowRibOutStatisticsReq, ShowRibOutStatisticsReqIterate,
 //
 // Specialization of BgpShowHandler<>::FillShowList.
 //
+// Also fill in the memory used to keep track of advertised routes. This is
+// process wide rather than per RibOut, so it's reported once per response.
+//
 template <>
 void BgpShowHandler<ShowRibOutStatisticsReq, ShowRibOutStatisticsReqIterate,
     ShowRibOutStatisticsResp, ShowRibOutStatistics>::FillShowList(
     ShowRibOutStatisticsResp *resp,
     const vector<ShowRibOutStatistics> &show_list) {
     resp->set_ribouts(show_list);
+    ShowRouteStateMemoryStatistics srsms;
+    RouteState::FillMemoryStatisticsInfo(&srsms);
+    resp->set_route_state_memory(srsms);
 }
 
 //
@@ -9,6 +9,10 @@
 #include <boost/regex.hpp>
 #include <sandesh/request_pipeline.h>
 
+#include <stdlib.h>
+
+#include "base/string_util.h"
+#include "base/task_annotations.h"
 #include "bgp/bgp_peer_internal_types.h"
 #include "bgp/bgp_route.h"
 #include "bgp/bgp_server.h"
@@ -19,6 +23,7 @@ using boost::assign::list_of;
 using boost::regex;
 using boost::regex_search;
 using std::auto_ptr;
+using std::make_pair;
 using std::string;
 using std::vector;
 
@@ -636,3 +641,293 @@ void ShowRouteReqIterate::HandleRequest() const {
     ps.stages_= list_of(s1)(s2);
     RequestPipeline rp(ps);
 }
+
+ShowRouteCursorMgr::ShowRouteCursorMgr() : next_id_(1) {
+}
+
+//
+// Save the cursor and return the token for it.
+//
+// The cursor for an existing token is updated in place so that the token
+// stays the same for the entire walk.
+//
+string ShowRouteCursorMgr::Save(const string &token, const Cursor &cursor) {
+    CHECK_CONCURRENCY("bgp::ShowCommand");
+    if (!token.empty()) {
+        CursorMap::iterator loc =
+            cursors_.find(strtoull(token.c_str(), NULL, 10));
+        if (loc != cursors_.end()) {
+            loc->second = cursor;
+            return token;
+        }
+    }
+
+    while (cursors_.size() >= kMaxCursors) {
+        cursors_.erase(cursors_.begin());
+    }
+    uint64_t id = next_id_++;
+    cursors_.insert(make_pair(id, cursor));
+    return integerToString(id);
+}
+
+const ShowRouteCursorMgr::Cursor *ShowRouteCursorMgr::Find(
+    const string &token) const {
+    CHECK_CONCURRENCY("bgp::ShowCommand");
+    if (token.empty())
+        return NULL;
+    CursorMap::const_iterator loc =
+        cursors_.find(strtoull(token.c_str(), NULL, 10));
+    return (loc != cursors_.end() ? &loc->second : NULL);
+}
+
+void ShowRouteCursorMgr::Delete(const string &token) {
+    CHECK_CONCURRENCY("bgp::ShowCommand");
+    if (token.empty())
+        return;
+    cursors_.erase(strtoull(token.c_str(), NULL, 10));
+}
+
+uint32_t ShowRouteStreamHandler::GetMaxCount(const BgpSandeshContext *bsc,
+    uint32_t count) {
+    uint32_t max_count = bsc->test_mode() ? kUnitTestMaxCount : kMaxCount;
+    if (!count || count > max_count)
+        return max_count;
+    return count;
+}
+
+RequestPipeline::InstData *ShowRouteStreamHandler::CreateData(int stage) {
+    if (stage == 0)
+        return static_cast<RequestPipeline::InstData *>(new CursorData);
+    if (stage == 1)
+        return static_cast<RequestPipeline::InstData *>(new PartitionData);
+    return NULL;
+}
+
+//
+// Build a new cursor for ShowRouteStreamReq or look up the existing one for
+// ShowRouteStreamReqIterate.
+//
+bool ShowRouteStreamHandler::CallbackS1(const Sandesh *sr,
+    const RequestPipeline::PipeSpec ps, int stage, int instNum,
+    RequestPipeline::InstData *data) {
+    CursorData *mydata = static_cast<CursorData *>(data);
+    const Sandesh *request = ps.snhRequest_.get();
+    BgpSandeshContext *bsc =
+        static_cast<BgpSandeshContext *>(request->client_context());
+    ShowRouteCursorMgr *cursor_mgr = bsc->show_route_cursor_mgr();
+
+    const ShowRouteStreamReqIterate *req_iterate =
+        dynamic_cast<const ShowRouteStreamReqIterate *>(request);
+    if (req_iterate) {
+        const ShowRouteCursorMgr::Cursor *cursor =
+            cursor_mgr->Find(req_iterate->get_route_info());
+        if (!cursor)
+            return true;
+        mydata->valid = true;
+        mydata->token = req_iterate->get_route_info();
+        mydata->cursor = *cursor;
+        return true;
+    }
+
+    const ShowRouteStreamReq *req =
+        static_cast<const ShowRouteStreamReq *>(request);
+    DB *db = bsc->bgp_server->database();
+    if (!db->FindTable(req->get_routing_table()))
+        return true;
+
+    ShowRouteCursorMgr::Cursor *cursor = &mydata->cursor;
+    cursor->routing_table = req->get_routing_table();
+    cursor->prefix = req->get_prefix();
+    cursor->source = req->get_source();
+    cursor->protocol = req->get_protocol();
+    cursor->count = GetMaxCount(bsc, req->get_count());
+    cursor->longer_match = req->get_longer_match();
+    cursor->shorter_match = req->get_shorter_match();
+    cursor->next_prefix.resize(db->PartitionCount());
+    cursor->done.resize(db->PartitionCount(), false);
+    mydata->valid = true;
+    return true;
+}
+
+static bool MatchStreamPrefix(const ShowRouteCursorMgr::Cursor &cursor,
+    const regex &prefix_expr, BgpRoute *route) {
+    if (cursor.prefix.empty())
+        return true;
+    if (!cursor.longer_match && !cursor.shorter_match)
+        return regex_search(route->ToString(), prefix_expr);
+    if (cursor.longer_match && route->IsMoreSpecific(cursor.prefix))
+        return true;
+    if (cursor.shorter_match && route->IsLessSpecific(cursor.prefix))
+        return true;
+    return false;
+}
+
+//
+// Walk one partition of the table, starting at the position in the cursor.
+//
+// Return false to get called again after visiting kChunkSize routes, so
+// that other db::DBTable work gets a chance to run. The position is kept as
+// a prefix rather than a BgpRoute pointer since the route can get deleted
+// while the walk is yielding.
+//
+bool ShowRouteStreamHandler::CallbackS2(const Sandesh *sr,
+    const RequestPipeline::PipeSpec ps, int stage, int instNum,
+    RequestPipeline::InstData *data) {
+    PartitionData *mydata = static_cast<PartitionData *>(data);
+    int inst_id = ps.stages_[stage].instances_[instNum];
+    const CursorData &cursor_data =
+        static_cast<const CursorData &>(ps.GetStageData(0)->at(0));
+    if (!cursor_data.valid)
+        return true;
+
+    const ShowRouteCursorMgr::Cursor &cursor = cursor_data.cursor;
+    if (mydata->init) {
+        mydata->init = false;
+        mydata->next_prefix = cursor.next_prefix[inst_id];
+        mydata->done = cursor.done[inst_id];
+    }
+    if (mydata->done)
+        return true;
+
+    const Sandesh *request = ps.snhRequest_.get();
+    BgpSandeshContext *bsc =
+        static_cast<BgpSandeshContext *>(request->client_context());
+    DB *db = bsc->bgp_server->database();
+    BgpTable *table =
+        static_cast<BgpTable *>(db->FindTable(cursor.routing_table));
+    if (!table || inst_id >= table->PartitionCount()) {
+        mydata->done = true;
+        return true;
+    }
+
+    DBTablePartition *partition =
+        static_cast<DBTablePartition *>(table->GetTablePartition(inst_id));
+    BgpRoute *route = NULL;
+    if (mydata->next_prefix.empty()) {
+        route = static_cast<BgpRoute *>(partition->GetFirst());
+    } else {
+        auto_ptr<DBEntry> key = table->AllocEntryStr(mydata->next_prefix);
+        route = static_cast<BgpRoute *>(partition->lower_bound(key.get()));
+    }
+
+    uint32_t partition_count = db->PartitionCount();
+    uint32_t max_count = (cursor.count + partition_count - 1) / partition_count;
+    regex prefix_expr(cursor.prefix);
+    for (uint32_t idx = 0; route && idx < kChunkSize &&
+         mydata->count < max_count;
+         route = static_cast<BgpRoute *>(partition->GetNext(route)), ++idx) {
+        if (!MatchStreamPrefix(cursor, prefix_expr, route))
+            continue;
+        mydata->routes.push_back(ShowRoute());
+        route->FillRouteInfo(table, &mydata->routes.back(), cursor.source,
+                             cursor.protocol);
+        if (mydata->routes.back().get_paths().empty()) {
+            mydata->routes.pop_back();
+        } else {
+            mydata->count++;
+        }
+    }
+
+    if (!route) {
+        mydata->done = true;
+        mydata->next_prefix.clear();
+        return true;
+    }
+    mydata->next_prefix = route->ToString();
+    return (mydata->count >= max_count);
+}
+
+//
+// Send the routes collected from each partition and save the cursor if the
+// walk isn't done.
+//
+bool ShowRouteStreamHandler::CallbackS3(const Sandesh *sr,
+    const RequestPipeline::PipeSpec ps, int stage, int instNum,
+    RequestPipeline::InstData *data) {
+    const Sandesh *request = ps.snhRequest_.get();
+    BgpSandeshContext *bsc =
+        static_cast<BgpSandeshContext *>(request->client_context());
+    ShowRouteCursorMgr *cursor_mgr = bsc->show_route_cursor_mgr();
+    const CursorData &cursor_data =
+        static_cast<const CursorData &>(ps.GetStageData(0)->at(0));
+
+    ShowRouteStreamResp *resp = new ShowRouteStreamResp;
+    if (!cursor_data.valid) {
+        resp->set_context(request->context());
+        resp->set_more(false);
+        resp->Response();
+        return true;
+    }
+
+    ShowRouteCursorMgr::Cursor cursor = cursor_data.cursor;
+    const RequestPipeline::StageData *sd = ps.GetStageData(1);
+    bool done = true;
+    for (size_t idx = 0; idx < sd->size(); ++idx) {
+        PartitionData &partition_data = const_cast<PartitionData &>(
+            static_cast<const PartitionData &>(sd->at(idx)));
+        cursor.next_prefix[idx] = partition_data.next_prefix;
+        cursor.done[idx] = partition_data.done;
+        if (!partition_data.done)
+            done = false;
+        if (partition_data.routes.empty())
+            continue;
+
+        // Hand off the routes to the response instead of copying them.
+        ShowRouteStreamResp *partition_resp = new ShowRouteStreamResp;
+        partition_resp->set_routing_table_name(cursor.routing_table);
+        partition_resp->routes.swap(partition_data.routes);
+        partition_resp->set_context(request->context());
+        partition_resp->set_more(true);
+        partition_resp->Response();
+    }
+
+    resp->set_routing_table_name(cursor.routing_table);
+    if (done) {
+        cursor_mgr->Delete(cursor_data.token);
+    } else {
+        resp->set_next_batch(cursor_mgr->Save(cursor_data.token, cursor));
+    }
+    resp->set_context(request->context());
+    resp->set_more(false);
+    resp->Response();
+    return true;
+}
+
+void ShowRouteStreamHandler::HandleRequest(const Sandesh *sr,
+    const BgpSandeshContext *bsc) {
+    RequestPipeline::PipeSpec ps(sr);
+    RequestPipeline::StageSpec s1, s2, s3;
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+
+    s1.taskId_ = scheduler->GetTaskId("bgp::ShowCommand");
+    s1.allocFn_ = ShowRouteStreamHandler::CreateData;
+    s1.cbFn_ = ShowRouteStreamHandler::CallbackS1;
+    s1.instances_.push_back(0);
+
+    s2.taskId_ = scheduler->GetTaskId("db::DBTable");
+    s2.allocFn_ = ShowRouteStreamHandler::CreateData;
+    s2.cbFn_ = ShowRouteStreamHandler::CallbackS2;
+    for (int i = 0; i < bsc->bgp_server->database()->PartitionCount(); ++i) {
+        s2.instances_.push_back(i);
+    }
+
+    s3.taskId_ = scheduler->GetTaskId("bgp::ShowCommand");
+    s3.allocFn_ = ShowRouteStreamHandler::CreateData;
+    s3.cbFn_ = ShowRouteStreamHandler::CallbackS3;
+    s3.instances_.push_back(0);
+
+    ps.stages_= list_of(s1)(s2)(s3);
+    RequestPipeline rp(ps);
+}
+
+// handler for 'show route stream'
+void ShowRouteStreamReq::HandleRequest() const {
+    BgpSandeshContext *bsc = static_cast<BgpSandeshContext *>(client_context());
+    ShowRouteStreamHandler::HandleRequest(this, bsc);
+}
+
+// handler for 'show route stream' that continues the walk for a cursor
+void ShowRouteStreamReqIterate::HandleRequest() const {
+    BgpSandeshContext *bsc = static_cast<BgpSandeshContext *>(client_context());
+    ShowRouteStreamHandler::HandleRequest(this, bsc);
+}
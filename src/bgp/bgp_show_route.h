@@ -6,13 +6,22 @@
 #define SRC_BGP_BGP_SHOW_ROUTE_H__
 
 #include <boost/regex.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/util.h"
 #include "bgp/bgp_peer_types.h"
 #include "sandesh/request_pipeline.h"
 
 class BgpRoute;
+class BgpSandeshContext;
 class BgpTable;
 class ShowRouteReq;
 class ShowRouteReqIterate;
+class ShowRouteStreamReq;
+class ShowRouteStreamReqIterate;
 
 class ShowRouteHandler {
 public:
@@ -69,4 +78,113 @@ private:
     boost::regex prefix_expr_;
 };
 
+//
+// Server side cursors for streaming show route requests.
+//
+// A cursor remembers the parameters of the original request and the prefix
+// of the next route to be visited in each DB partition of the table. The
+// user gets a compact token that refers to the cursor and can be used to
+// resume the walk, instead of a next_batch string that encodes all of the
+// request parameters and the position.
+//
+// The number of cursors is bounded. The least recently created cursor gets
+// removed when a new one is needed and the limit has been reached, so that
+// abandoned walks don't hold on to memory forever.
+//
+// All access happens in the context of the bgp::ShowCommand task.
+//
+class ShowRouteCursorMgr {
+public:
+    static const size_t kMaxCursors = 64;
+
+    struct Cursor {
+        Cursor() : count(0), longer_match(false), shorter_match(false) {
+        }
+
+        std::string routing_table;
+        std::string prefix;
+        std::string source;
+        std::string protocol;
+        uint32_t count;
+        bool longer_match;
+        bool shorter_match;
+        std::vector<std::string> next_prefix;
+        std::vector<bool> done;
+    };
+
+    ShowRouteCursorMgr();
+
+    std::string Save(const std::string &token, const Cursor &cursor);
+    const Cursor *Find(const std::string &token) const;
+    void Delete(const std::string &token);
+    size_t size() const { return cursors_.size(); }
+
+private:
+    typedef std::map<uint64_t, Cursor> CursorMap;
+
+    CursorMap cursors_;
+    uint64_t next_id_;
+
+    DISALLOW_COPY_AND_ASSIGN(ShowRouteCursorMgr);
+};
+
+//
+// Streaming version of show route for dumping large tables.
+//
+// The request pipeline has 3 stages:
+//
+// - The first stage runs in bgp::ShowCommand and either looks up the cursor
+//   for the token in an iterate request or builds a new one.
+// - The second stage has one instance per DB partition and runs in the
+//   db::DBTable task. Each instance walks its partition starting at the
+//   position in the cursor and fills ShowRoutes in place in the list that
+//   gets handed off to the response. It processes at most kChunkSize routes
+//   in one run of the task and then yields, so that a large walk doesn't
+//   hold up update processing for long.
+// - The last stage runs in bgp::ShowCommand and sends one response per DB
+//   partition followed by a final response with the token for the next
+//   batch. The routes are handed off to the responses without a merge sort
+//   or a copy, hence they are only sorted within a response.
+//
+class ShowRouteStreamHandler {
+public:
+    static const uint32_t kChunkSize = 64;
+    static const uint32_t kUnitTestMaxCount = 100;
+    static const uint32_t kMaxCount = 10000;
+
+    struct CursorData : public RequestPipeline::InstData {
+        CursorData() : valid(false) { }
+
+        bool valid;
+        std::string token;
+        ShowRouteCursorMgr::Cursor cursor;
+    };
+
+    struct PartitionData : public RequestPipeline::InstData {
+        PartitionData() : init(true), done(false), count(0) { }
+
+        bool init;
+        bool done;
+        uint32_t count;
+        std::string next_prefix;
+        std::vector<ShowRoute> routes;
+    };
+
+    static void HandleRequest(const Sandesh *sr, const BgpSandeshContext *bsc);
+    static uint32_t GetMaxCount(const BgpSandeshContext *bsc,
+                                uint32_t count);
+
+private:
+    static RequestPipeline::InstData *CreateData(int stage);
+    static bool CallbackS1(const Sandesh *sr,
+            const RequestPipeline::PipeSpec ps, int stage, int instNum,
+            RequestPipeline::InstData *data);
+    static bool CallbackS2(const Sandesh *sr,
+            const RequestPipeline::PipeSpec ps, int stage, int instNum,
+            RequestPipeline::InstData *data);
+    static bool CallbackS3(const Sandesh *sr,
+            const RequestPipeline::PipeSpec ps, int stage, int instNum,
+            RequestPipeline::InstData *data);
+};
+
 #endif  // SRC_BGP_BGP_SHOW_HANDLER_H__
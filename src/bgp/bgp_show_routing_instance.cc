@@ -72,12 +72,19 @@ static void FillRoutingInstanceInfo(ShowRoutingInstance *sri,
     sri->set_allow_transit(rtinstance->virtual_network_allow_transit());
     sri->set_pbb_evpn_enable(rtinstance->virtual_network_pbb_evpn_enable());
 
+    const RoutingInstance::RouteTableList &tables = rtinstance->GetTables();
+    uint64_t table_memory = 0;
+    for (RoutingInstance::RouteTableList::const_iterator it =
+        tables.begin(); it != tables.end(); ++it) {
+        table_memory += it->second->GetTableMemory();
+    }
+    sri->set_table_memory(table_memory);
+
     if (summary)
         return;
 
     const BgpMembershipManager *bmm = bsc->bgp_server->membership_mgr();
     vector<ShowRoutingInstanceTable> srit_list;
-    const RoutingInstance::RouteTableList &tables = rtinstance->GetTables();
     for (RoutingInstance::RouteTableList::const_iterator it =
         tables.begin(); it != tables.end(); ++it) {
         ShowRoutingInstanceTable srit;
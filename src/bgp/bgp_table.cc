@@ -4,6 +4,7 @@
 
 #include "bgp/bgp_table.h"
 
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 
 #include "sandesh/sandesh_trace.h"
@@ -20,12 +21,15 @@
 #include "bgp/routing-instance/path_resolver.h"
 #include "bgp/routing-instance/routing_instance.h"
 #include "bgp/routing-instance/rtarget_group_mgr.h"
+#include "db/db.h"
+#include "db/db_table_partition.h"
 #include "net/community_type.h"
 
 using std::map;
 using std::make_pair;
 using std::ostringstream;
 using std::string;
+using std::vector;
 
 class BgpTable::DeleteActor : public LifetimeActor {
   public:
@@ -64,6 +68,9 @@ BgpTable::BgpTable(DB *db, const string &name)
     infeasible_path_count_ = 0;
     stale_path_count_ = 0;
     llgr_stale_path_count_ = 0;
+    xmpp_ribout_count_ = 0;
+    repr_cache_count_ = 0;
+    repr_cache_.resize(DB::PartitionCount());
 }
 
 //
@@ -74,6 +81,7 @@ BgpTable::BgpTable(DB *db, const string &name)
 BgpTable::~BgpTable() {
     assert(path_resolver_ == NULL),
     instance_delete_ref_.Reset(NULL);
+    STLDeleteValues(&repr_cache_);
 }
 
 void BgpTable::set_routing_instance(RoutingInstance *rtinstance) {
@@ -110,6 +118,8 @@ RibOut *BgpTable::RibOutLocate(BgpUpdateSender *sender,
     if (loc == ribout_map_.end()) {
         RibOut *ribout = new RibOut(this, sender, policy);
         ribout_map_.insert(make_pair(policy, ribout));
+        if (ribout->IsEncodingXmpp())
+            xmpp_ribout_count_++;
         return ribout;
     }
     return loc->second;
@@ -122,10 +132,43 @@ RibOut *BgpTable::RibOutLocate(BgpUpdateSender *sender,
 void BgpTable::RibOutDelete(const RibExportPolicy &policy) {
     RibOutMap::iterator loc = ribout_map_.find(policy);
     assert(loc != ribout_map_.end());
+    if (loc->second->IsEncodingXmpp())
+        xmpp_ribout_count_--;
     delete loc->second;
     ribout_map_.erase(loc);
 }
 
+//
+// Get the RibOutAttrReprCache for the given partition, creating it if needed.
+//
+// The cache is created on first use since most tables, particularly those in
+// routing instances without any routes, never have more than one xmpp RibOut.
+// This is called from the db::DBTable task for the partition, so there's no
+// need for a lock. The number of caches is kept separately so that it can be
+// read from other tasks.
+//
+RibOutAttrReprCache *BgpTable::repr_cache(int part_id) {
+    if (!repr_cache_[part_id]) {
+        repr_cache_[part_id] = new RibOutAttrReprCache;
+        repr_cache_count_++;
+    }
+    return repr_cache_[part_id];
+}
+
+//
+// Approximate number of bytes used by the table data structures, excluding
+// the routes and paths. This gives an idea of the fixed cost of a table in a
+// routing instance, regardless of the number of routes in it.
+//
+size_t BgpTable::GetTableMemory() const {
+    size_t memory = sizeof(*this);
+    memory += PartitionCount() * sizeof(DBTablePartition);
+    memory += repr_cache_.size() * sizeof(RibOutAttrReprCache *);
+    memory += repr_cache_count_ * sizeof(RibOutAttrReprCache);
+    memory += ribout_map_.size() * sizeof(RibOut);
+    return memory;
+}
+
 //
 // Process Remove Private information.
 //
@@ -393,6 +436,71 @@ bool BgpTable::PathSelection(const Path &path1, const Path &path2) {
     return res;
 }
 
+//
+// Concurrency: called from bgp::Config task.
+//
+// Sort the paths of all routes in the table again. Paths are inserted at
+// their sorted position, so this is needed when the result of PathSelection
+// changes for existing paths e.g. when the always-compare-med knob changes.
+//
+// If the walk is already running, it is allowed to complete and WalkAgain API
+// is invoked to trigger walk on current walk completion.
+//
+void BgpTable::SortAllPaths() {
+    CHECK_CONCURRENCY("bgp::Config");
+
+    if (empty())
+        return;
+
+    if (sort_walk_ref_ == NULL) {
+        sort_walk_ref_ = AllocWalker(
+            boost::bind(&BgpTable::SortPathsWalkCallback, this, _1, _2),
+            boost::bind(&BgpTable::SortPathsWalkDone, this, _2));
+        WalkTable(sort_walk_ref_);
+    } else {
+        WalkAgain(sort_walk_ref_);
+    }
+}
+
+//
+// Callback for table walk triggered by SortAllPaths.
+//
+// Notify the route only if the order of its paths changed.
+//
+bool BgpTable::SortPathsWalkCallback(DBTablePartBase *tpart,
+                                     DBEntryBase *entry) {
+    CHECK_CONCURRENCY("db::DBTable");
+
+    BgpRoute *route = static_cast<BgpRoute *>(entry);
+    if (route->IsDeleted() || route->count() < 2)
+        return true;
+
+    vector<const Path *> prev_paths;
+    for (Route::PathList::const_iterator it = route->GetPathList().begin();
+         it != route->GetPathList().end(); ++it) {
+        prev_paths.push_back(it.operator->());
+    }
+
+    route->Sort(&BgpTable::PathSelection, prev_paths.front());
+
+    vector<const Path *>::const_iterator prev_it = prev_paths.begin();
+    for (Route::PathList::const_iterator it = route->GetPathList().begin();
+         it != route->GetPathList().end(); ++it, ++prev_it) {
+        if (it.operator->() != *prev_it) {
+            tpart->Notify(route);
+            break;
+        }
+    }
+    return true;
+}
+
+//
+// Callback for completion of table walk triggered by SortAllPaths.
+//
+void BgpTable::SortPathsWalkDone(DBTableBase *table) {
+    sort_walk_ref_.reset();
+}
+
 bool BgpTable::DeletePath(DBTablePartBase *root, BgpRoute *rt, BgpPath *path) {
     return InputCommon(root, rt, path, path->GetPeer(), NULL,
         DBRequest::DB_ENTRY_DELETE, NULL, path->GetPathId(), 0, 0, 0);
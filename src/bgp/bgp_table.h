@@ -24,6 +24,7 @@ class IPeer;
 class Path;
 class PathResolver;
 class RibOut;
+class RibOutAttrReprCache;
 class RibPeerSet;
 class Route;
 class RoutingInstance;
@@ -100,6 +101,12 @@ public:
                          const RibExportPolicy &policy);
     void RibOutDelete(const RibExportPolicy &policy);
 
+    // The RibOutAttrReprCache for a partition is shared by all xmpp RibOuts
+    // of the table. It is used only if there's more than one xmpp RibOut.
+    RibOutAttrReprCache *repr_cache(int part_id);
+    bool IsReprCacheEnabled() const { return xmpp_ribout_count_ > 1; }
+    size_t GetTableMemory() const;
+
     virtual bool Export(RibOut *ribout, Route *route,
                         const RibPeerSet &peerset,
                         UpdateInfoSList &uinfo_slist) = 0;
@@ -177,6 +184,8 @@ public:
     void FillRibOutStatisticsInfo(
         std::vector<ShowRibOutStatistics> *sros_list) const;
 
+    void SortAllPaths();
+
 private:
     friend class BgpTableTest;
 
@@ -187,10 +196,16 @@ private:
                           BgpAttr *attr, bool llgr_stale_comm);
     virtual BgpRoute *TableFind(DBTablePartition *rtp,
             const DBRequestKey *prefix) = 0;
+    bool SortPathsWalkCallback(DBTablePartBase *tpart, DBEntryBase *entry);
+    void SortPathsWalkDone(DBTableBase *table);
 
     RoutingInstance *rtinstance_;
     PathResolver *path_resolver_;
     RibOutMap ribout_map_;
+    std::vector<RibOutAttrReprCache *> repr_cache_;
+    tbb::atomic<int> repr_cache_count_;
+    tbb::atomic<int> xmpp_ribout_count_;
+    DBTableWalkRef sort_walk_ref_;
 
     boost::scoped_ptr<DeleteActor> deleter_;
     LifetimeRef<BgpTable> instance_delete_ref_;
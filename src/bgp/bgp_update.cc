@@ -5,6 +5,7 @@
 #include "bgp/bgp_update.h"
 
 #include "bgp/bgp_route.h"
+#include "bgp/bgp_server.h"
 #include "bgp/bgp_table.h"
 
 //
@@ -126,7 +127,7 @@ bool RouteUpdate::CompareUpdateInfo(const UpdateInfoSList &uinfo_slist) const {
         RibPeerSet withdraw_peerset = updates_->begin()->target;
         for (AdvertiseSList::List::const_iterator iter = history_->begin();
              iter != history_->end(); ++iter) {
-            if (!withdraw_peerset.Contains(iter->bitset))
+            if (!withdraw_peerset.Contains(iter->bitset()))
                 return false;
         }
         return true;
@@ -139,7 +140,7 @@ bool RouteUpdate::CompareUpdateInfo(const UpdateInfoSList &uinfo_slist) const {
     RibPeerSet old_peerset, new_peerset;
     for (AdvertiseSList::List::const_iterator iter = history_->begin();
          iter != history_->end(); ++iter) {
-        old_peerset.Set(iter->bitset);
+        old_peerset.Set(iter->bitset());
     }
     for (UpdateInfoSList::List::const_iterator iter = uinfo_slist->begin();
          iter != uinfo_slist->end(); ++iter) {
@@ -161,7 +162,7 @@ bool RouteUpdate::CompareUpdateInfo(const UpdateInfoSList &uinfo_slist) const {
             attr_peerset.Set(uinfo->target);
         const AdvertiseInfo *ainfo = FindHistory(iter->roattr);
         if (ainfo)
-            attr_peerset.Set(ainfo->bitset);
+            attr_peerset.Set(ainfo->bitset());
         if (iter->target != attr_peerset)
             return false;
     }
@@ -220,7 +221,7 @@ void RouteUpdate::BuildNegativeUpdateInfo(UpdateInfoSList &uinfo_slist) const {
     // Build the bitset of peers to which we previously advertised something.
     for (AdvertiseSList::List::const_iterator iter = history_->begin();
          iter != history_->end(); ++iter) {
-        peerset.Set(iter->bitset);
+        peerset.Set(iter->bitset());
     }
 
     // Remove the peers to which we are going to send updated state.
@@ -259,7 +260,7 @@ void RouteUpdate::TrimRedundantUpdateInfo(UpdateInfoSList &uinfo_slist) const {
             // Found one with matching attributes.  Reset the target bits in
             // the UpdateInfo. Get rid of the UpdateInfo if the target is now
             // empty.
-            iter->target.Reset(ainfo->bitset);
+            iter->target.Reset(ainfo->bitset());
             if (iter->target.empty()) {
                 uinfo_slist->erase_and_dispose(iter, UpdateInfoDisposer());
             }
@@ -316,12 +317,18 @@ const AdvertiseInfo *RouteUpdate::FindHistory(const RibOutAttr &roattr) const {
 // AdvertiseInfo or the creation of a new one, as well as possible deletion
 // of an existing one.
 //
+// This gets called for every set of peers that the update is sent to, so
+// the RibPeerSets are modified in private copies instead of being located
+// in the AdvertisePeerSetDB each time. They get interned once, when the
+// history is moved to a RouteState.
+//
 void RouteUpdate::UpdateHistory(RibOut *ribout, const RibOutAttr *roattr,
         const RibPeerSet &bits) {
     // The history information may reside in the RouteUpdate itself or in
     // the associated UpdateList if the RouteUpdate in on an UpdateList.
     AdvertiseSList &adv_slist =
         (OnUpdateList() ? GetUpdateList(ribout)->History() : history_);
+    AdvertisePeerSetDB *peerset_db = ribout->table()->server()->peerset_db();
 
     // Traipse through all the AdvertiseInfo elements in the history.  We
     // obviously need to find one with a matching RibOutAttr if it exists
@@ -345,8 +352,13 @@ void RouteUpdate::UpdateHistory(RibOut *ribout, const RibOutAttr *roattr,
 
         // Reset the bits in the current element.  If the RibPeerSet in the
         // element becomes empty, get rid of it.
-        iter->bitset.Reset(bits);
-        if (iter->bitset.empty()) {
+        if (!iter->bitset().intersects(bits)) {
+            ++iter;
+            continue;
+        }
+        RibPeerSet *bitset = iter->mutable_bitset(peerset_db);
+        bitset->Reset(bits);
+        if (bitset->empty()) {
             AdvertiseSList::List::iterator prev_iter = iter++;
             adv_slist->erase_and_dispose(prev_iter, AdvertiseInfoDisposer());
         } else {
@@ -361,7 +373,7 @@ void RouteUpdate::UpdateHistory(RibOut *ribout, const RibOutAttr *roattr,
             ainfo = new AdvertiseInfo(roattr);
             adv_slist->push_front(*ainfo);
         }
-        ainfo->bitset |= bits;
+        *ainfo->mutable_bitset(peerset_db) |= bits;
     } else {
         assert(ainfo == NULL);
     }
@@ -6,6 +6,7 @@
 
 #include "base/task_annotations.h"
 #include "bgp/bgp_ribout_updates.h"
+#include "bgp/bgp_server.h"
 #include "bgp/bgp_table.h"
 #include "bgp/bgp_update_queue.h"
 
@@ -183,7 +184,7 @@ static void RouteStateCurrent(const RouteState *rstate,
     const AdvertiseSList &adv_slist = rstate->Advertised();
     for (AdvertiseSList::List::const_iterator iter = adv_slist->begin();
          iter != adv_slist->end(); ++iter) {
-        mcurrent->Set(iter->bitset);
+        mcurrent->Set(iter->bitset());
     }
 }
 
@@ -201,7 +202,7 @@ static void RouteUpdateCurrentAndScheduled(const RouteUpdate *rt_update,
     const AdvertiseSList &adv_slist = rt_update->History();
     for (AdvertiseSList::List::const_iterator iter = adv_slist->begin();
          iter != adv_slist->end(); ++iter) {
-        mcurrent->Set(iter->bitset);
+        mcurrent->Set(iter->bitset());
     }
 
     if (queue_id != RibOutUpdates::QCOUNT && queue_id != rt_update->queue_id())
@@ -226,7 +227,7 @@ static void UpdateListCurrentAndScheduled(const UpdateList *uplist,
     const AdvertiseSList &adv_slist = uplist->History();
     for (AdvertiseSList::List::const_iterator iter = adv_slist->begin();
          iter != adv_slist->end(); ++iter) {
-        mcurrent->Set(iter->bitset);
+        mcurrent->Set(iter->bitset());
     }
 
     const UpdateList::List *list = uplist->GetList();
@@ -434,14 +435,23 @@ bool RibUpdateMonitor::MergeUpdate(DBEntryBase *db_entry,
 // RibPeerSet. If the RibPeerSet in an element becomes empty, remove it from
 // the list container and get rid of the element.
 //
+// The RibPeerSets are modified in private copies. The caller must intern
+// them if the list belongs to a RouteState.
+//
 void RibUpdateMonitor::AdvertiseSListClearBits(AdvertiseSList &adv_slist,
         const RibPeerSet &clear) {
     CHECK_CONCURRENCY("db::DBTable");
 
+    AdvertisePeerSetDB *peerset_db = ribout_->table()->server()->peerset_db();
     for (AdvertiseSList::List::iterator iter = adv_slist->begin();
          iter != adv_slist->end(); ) {
-        iter->bitset.Reset(clear);
-        if (iter->bitset.empty()) {
+        if (!iter->bitset().intersects(clear)) {
+            iter++;
+            continue;
+        }
+        RibPeerSet *bitset = iter->mutable_bitset(peerset_db);
+        bitset->Reset(clear);
+        if (bitset->empty()) {
             iter = adv_slist->erase_and_dispose(iter, AdvertiseInfoDisposer());
         } else {
             iter++;
@@ -482,8 +492,10 @@ void RibUpdateMonitor::RouteStateClearPeerSet(DBEntryBase *db_entry,
         RouteState *rstate, const RibPeerSet &mleave) {
     CHECK_CONCURRENCY("db::DBTable");
 
-    // Clear the bits for each element in the AdvertiseSList.
+    // Clear the bits for each element in the AdvertiseSList and intern
+    // the resulting RibPeerSets.
     AdvertiseSListClearBits(rstate->Advertised(), mleave);
+    rstate->Advertised().Intern();
 
     // Get rid of the RouteState itself if it's empty.
     if (rstate->Advertised()->empty()) {
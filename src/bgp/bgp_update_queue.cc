@@ -121,22 +121,25 @@ void UpdateQueue::AttrDequeue(UpdateInfo *current_uinfo) {
 // with different BgpAttrs in the same message given that each item is self
 // contained.
 //
-// Also return NULL if the next UpdateInfo is for the same RouteUpdate. This
-// can happen in corner cases where the label (or the set for ecmp nexthops
-// in case of an XMPP ribout) for a route changes between Join operations for
-// 2 different sets of IPeerUpdates. Returning such an UpdateInfo results in
-// data corruption.
+// Skip over any UpdateInfos for the same RouteUpdate. This can happen in
+// corner cases where the label (or the set for ecmp nexthops in case of an
+// XMPP ribout) for a route changes between Join operations for 2 different
+// sets of IPeerUpdates. Returning such an UpdateInfo results in data
+// corruption. Such UpdateInfos are always adjacent in the set container,
+// so skipping them, instead of terminating the traversal, ensures that the
+// remaining UpdateInfos with the same BgpAttr still get packed.
 //
 UpdateInfo *UpdateQueue::AttrNext(UpdateInfo *current_uinfo) {
     UpdatesByAttr::iterator iter = attr_set_.iterator_to(*current_uinfo);
     ++iter;
+    while (iter != attr_set_.end() &&
+           iter->update == current_uinfo->update) {
+        ++iter;
+    }
     if (iter == attr_set_.end()) {
         return NULL;
     }
     UpdateInfo *next_uinfo = iter.operator->();
-    if (next_uinfo->update == current_uinfo->update) {
-        return NULL;
-    }
     if (encoding_is_xmpp_) {
         const RibOutAttr &next_roattr = next_uinfo->roattr;
         const RibOutAttr &current_roattr = current_uinfo->roattr;
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/bgp_update_recorder.h"
+
+#include <string.h>
+
+#include "base/parse_object.h"
+#include "base/time_util.h"
+#include "bgp/bgp_log.h"
+#include "bgp/bgp_peer.h"
+
+using std::string;
+
+const char BgpUpdateRecorder::kMagic[] = "BGPUREC1";
+const size_t BgpUpdateRecorder::kMagicSize;
+const size_t BgpUpdateRecorder::kHeaderSize;
+const size_t BgpUpdateRecorder::kMaxPeers;
+
+// Sanity limit for the size of data in a record when reading a file.
+static const size_t kMaxRecordDataSize = 16 * 1024 * 1024;
+
+BgpUpdateRecorder::BgpUpdateRecorder()
+    : file_(NULL), start_time_(0) {
+    enabled_ = false;
+    record_count_ = 0;
+}
+
+BgpUpdateRecorder::~BgpUpdateRecorder() {
+    Close();
+}
+
+bool BgpUpdateRecorder::Open(const string &filename) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    assert(!file_);
+    file_ = fopen(filename.c_str(), "wb");
+    if (!file_) {
+        BGP_LOG_WARNING_STR(BgpConfig, BGP_LOG_FLAG_ALL,
+            "Cannot open update record file " << filename);
+        return false;
+    }
+    if (fwrite(kMagic, 1, kMagicSize, file_) != kMagicSize) {
+        fclose(file_);
+        file_ = NULL;
+        return false;
+    }
+    start_time_ = ClockMonotonicUsec();
+    peer_index_map_.clear();
+    record_count_ = 0;
+    enabled_ = true;
+    return true;
+}
+
+void BgpUpdateRecorder::Close() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    enabled_ = false;
+    if (!file_)
+        return;
+    fclose(file_);
+    file_ = NULL;
+}
+
+bool BgpUpdateRecorder::Write(uint8_t type, uint16_t index,
+    uint64_t timestamp, const uint8_t *data, size_t size) {
+    uint8_t header[kHeaderSize];
+    put_value(header, 1, type);
+    put_value(header + 1, 2, index);
+    put_value(header + 3, 8, timestamp);
+    put_value(header + 11, 4, size);
+    if (fwrite(header, 1, kHeaderSize, file_) != kHeaderSize ||
+        fwrite(data, 1, size, file_) != size) {
+        BGP_LOG_WARNING_STR(BgpConfig, BGP_LOG_FLAG_ALL,
+            "Failed to write update record file, recording stopped");
+        enabled_ = false;
+        fclose(file_);
+        file_ = NULL;
+        return false;
+    }
+    record_count_++;
+    return true;
+}
+
+//
+// Find the index for the given peer, writing a PEER record if this is the
+// first time we see it.
+//
+bool BgpUpdateRecorder::LocatePeer(uint8_t peer_type, uint32_t peer_as,
+    const string &name, uint64_t timestamp, uint16_t *index) {
+    PeerKey key = std::make_pair(peer_type, name);
+    PeerIndexMap::const_iterator loc = peer_index_map_.find(key);
+    if (loc != peer_index_map_.end()) {
+        *index = loc->second;
+        return true;
+    }
+    if (peer_index_map_.size() >= kMaxPeers)
+        return false;
+
+    *index = peer_index_map_.size();
+    string data(5, '\0');
+    uint8_t *ptr = reinterpret_cast<uint8_t *>(&data[0]);
+    put_value(ptr, 1, peer_type);
+    put_value(ptr + 1, 4, peer_as);
+    data += name;
+    if (!Write(PEER, *index, timestamp,
+        reinterpret_cast<const uint8_t *>(data.data()), data.size())) {
+        return false;
+    }
+    peer_index_map_.insert(std::make_pair(key, *index));
+    return true;
+}
+
+void BgpUpdateRecorder::RecordBgpUpdate(const BgpPeer *peer,
+    const uint8_t *msg, size_t size) {
+    uint64_t timestamp = ClockMonotonicUsec();
+
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (!file_)
+        return;
+    timestamp = timestamp > start_time_ ? timestamp - start_time_ : 0;
+    uint16_t index;
+    if (!LocatePeer(BGP_PEER, peer->peer_as(), peer->peer_name(), timestamp,
+        &index)) {
+        return;
+    }
+    Write(BGP_UPDATE, index, timestamp, msg, size);
+}
+
+void BgpUpdateRecorder::RecordXmppMessage(const string &peer,
+    const string &msg) {
+    uint64_t timestamp = ClockMonotonicUsec();
+
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (!file_)
+        return;
+    timestamp = timestamp > start_time_ ? timestamp - start_time_ : 0;
+    uint16_t index;
+    if (!LocatePeer(XMPP_PEER, 0, peer, timestamp, &index))
+        return;
+    Write(XMPP_MESSAGE, index, timestamp,
+        reinterpret_cast<const uint8_t *>(msg.data()), msg.size());
+}
+
+BgpUpdateRecorder::Reader::Reader() : file_(NULL) {
+}
+
+BgpUpdateRecorder::Reader::~Reader() {
+    Close();
+}
+
+bool BgpUpdateRecorder::Reader::Open(const string &filename) {
+    assert(!file_);
+    file_ = fopen(filename.c_str(), "rb");
+    if (!file_)
+        return false;
+    char magic[kMagicSize];
+    if (fread(magic, 1, kMagicSize, file_) != kMagicSize ||
+        memcmp(magic, kMagic, kMagicSize) != 0) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void BgpUpdateRecorder::Reader::Close() {
+    if (!file_)
+        return;
+    fclose(file_);
+    file_ = NULL;
+}
+
+//
+// Read the next record. Returns false at the end of the file or if the file
+// is truncated or corrupt.
+//
+bool BgpUpdateRecorder::Reader::Next(Record *record) {
+    if (!file_)
+        return false;
+    uint8_t header[kHeaderSize];
+    if (fread(header, 1, kHeaderSize, file_) != kHeaderSize)
+        return false;
+    record->type = get_value(header, 1);
+    record->peer_index = get_value(header + 1, 2);
+    record->timestamp = get_value(header + 3, 8);
+    size_t size = get_value(header + 11, 4);
+    if (record->type == INVALID || record->type > XMPP_MESSAGE ||
+        size > kMaxRecordDataSize) {
+        return false;
+    }
+    record->data.resize(size);
+    if (size && fread(&record->data[0], 1, size, file_) != size)
+        return false;
+    return true;
+}
+
+bool BgpUpdateRecorder::Reader::ParsePeer(const Record &record,
+    uint8_t *peer_type, uint32_t *peer_as, string *name) {
+    if (record.type != PEER || record.data.size() < 5)
+        return false;
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(record.data.data());
+    *peer_type = get_value(data, 1);
+    *peer_as = get_value(data + 1, 4);
+    *name = record.data.substr(5);
+    return true;
+}
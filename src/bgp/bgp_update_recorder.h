@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_BGP_UPDATE_RECORDER_H_
+#define SRC_BGP_BGP_UPDATE_RECORDER_H_
+
+#include <tbb/atomic.h>
+#include <tbb/mutex.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "base/util.h"
+
+class BgpPeer;
+
+//
+// This class records route updates received by a BgpServer into a file so
+// that they can be replayed offline, e.g. to validate performance changes
+// against production churn.
+//
+// BGP UPDATE messages are recorded as received in BgpPeer::ReceiveMsg and
+// XMPP iq stanzas are recorded when they get to the receive callback in
+// BgpXmppChannel. The latter include subscribe/unsubscribe requests since
+// route publishes for a routing instance require a subscription.
+//
+// The file starts with kMagic and is followed by a sequence of records. All
+// integers are in network byte order. Each record has a fixed size header:
+//
+//     type (1), peer index (2), timestamp in usec (8), data length (4)
+//
+// followed by the data. The timestamp is relative to the time when the file
+// was opened. A PEER record is written the first time a given peer is seen.
+// Its data has the peer type (1) and the peer AS (4) followed by the name of
+// the peer. Subsequent records for the peer refer to it by index.
+//
+// The data for a BGP_UPDATE record is the raw UPDATE message as received
+// from the peer while the data for an XMPP_MESSAGE record is the text for
+// the xml stanza.
+//
+// Each BgpServer has its own recorder. Recording is enabled by calling Open
+// with the name of the file e.g. based on the update_record_file option of
+// the control-node. A mutex is used to serialize writes from the receive
+// paths of multiple BGP sessions and xmpp::StateMachine tasks. The enabled
+// check is lock free so that the receive path doesn't pay anything when
+// recording is turned off.
+//
+class BgpUpdateRecorder {
+public:
+    enum RecordType {
+        INVALID,
+        PEER,
+        BGP_UPDATE,
+        XMPP_MESSAGE,
+    };
+
+    enum PeerType {
+        BGP_PEER = 1,
+        XMPP_PEER = 2,
+    };
+
+    struct Record {
+        Record() : type(INVALID), peer_index(0), timestamp(0) { }
+        uint8_t type;
+        uint16_t peer_index;
+        uint64_t timestamp;
+        std::string data;
+    };
+
+    //
+    // Reads records from a file written by BgpUpdateRecorder.
+    //
+    class Reader {
+    public:
+        Reader();
+        ~Reader();
+
+        bool Open(const std::string &filename);
+        bool Next(Record *record);
+        void Close();
+
+        static bool ParsePeer(const Record &record, uint8_t *peer_type,
+            uint32_t *peer_as, std::string *name);
+
+    private:
+        FILE *file_;
+
+        DISALLOW_COPY_AND_ASSIGN(Reader);
+    };
+
+    static const char kMagic[];
+    static const size_t kMagicSize = 8;
+    static const size_t kHeaderSize = 15;
+    static const size_t kMaxPeers = 65535;
+
+    BgpUpdateRecorder();
+    ~BgpUpdateRecorder();
+
+    bool Open(const std::string &filename);
+    void Close();
+
+    bool enabled() const { return enabled_; }
+    uint64_t record_count() const { return record_count_; }
+
+    void RecordBgpUpdate(const BgpPeer *peer, const uint8_t *msg,
+        size_t size);
+    void RecordXmppMessage(const std::string &peer, const std::string &msg);
+
+private:
+    typedef std::pair<uint8_t, std::string> PeerKey;
+    typedef std::map<PeerKey, uint16_t> PeerIndexMap;
+
+    bool LocatePeer(uint8_t peer_type, uint32_t peer_as,
+        const std::string &name, uint64_t timestamp, uint16_t *index);
+    bool Write(uint8_t type, uint16_t index, uint64_t timestamp,
+        const uint8_t *data, size_t size);
+
+    tbb::mutex mutex_;
+    tbb::atomic<bool> enabled_;
+    FILE *file_;
+    uint64_t start_time_;
+    PeerIndexMap peer_index_map_;
+    tbb::atomic<uint64_t> record_count_;
+
+    DISALLOW_COPY_AND_ASSIGN(BgpUpdateRecorder);
+};
+
+#endif  // SRC_BGP_BGP_UPDATE_RECORDER_H_
@@ -7,11 +7,14 @@
 #include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 
+#include <algorithm>
 #include <map>
 #include <string>
 
 #include "base/task_annotations.h"
+#include "base/time_util.h"
 #include "bgp/ipeer.h"
+#include "bgp/bgp_peer_types.h"
 #include "bgp/bgp_ribout.h"
 #include "bgp/bgp_ribout_updates.h"
 #include "db/db.h"
@@ -22,6 +25,40 @@ using std::map;
 using std::string;
 using std::vector;
 
+const int BgpSenderPartition::kSendWindowInitial = 64;
+const int BgpSenderPartition::kSendWindowMin = 8;
+const int BgpSenderPartition::kSendWindowMax = 1024;
+
+const uint64_t BgpSenderPartition::BlockedStats::kBlockedBucketUsecs[] = {
+    1000, 10000, 100000, 1000000, 10000000
+};
+
+BgpSenderPartition::BlockedStats::BlockedStats()
+    : count(0), duration_usecs(0), max_duration_usecs(0) {
+    for (int idx = 0; idx < kBucketCount; ++idx) {
+        buckets[idx] = 0;
+    }
+}
+
+void BgpSenderPartition::BlockedStats::Add(const BlockedStats &rhs) {
+    count += rhs.count;
+    duration_usecs += rhs.duration_usecs;
+    max_duration_usecs = std::max(max_duration_usecs, rhs.max_duration_usecs);
+    for (int idx = 0; idx < kBucketCount; ++idx) {
+        buckets[idx] += rhs.buckets[idx];
+    }
+}
+
+//
+// Return a printable name for the bucket e.g. "<1ms" or ">=10s".
+//
+string BgpSenderPartition::BlockedStats::BucketName(int bucket) {
+    static const char *names[kBucketCount] = {
+        "<1ms", "<10ms", "<100ms", "<1s", "<10s", ">=10s"
+    };
+    return names[bucket];
+}
+
 //
 // This struct represents RibOut specific state for a PeerState.  There's one
 // instance of this for each RibOut that an IPeerUpdate has joined.
@@ -62,6 +99,14 @@ struct BgpSenderPartition::PeerRibState {
 // A (RibOut, QueueId) pair is considered to be active if the PeerState isn't
 // send_ready and there's RouteUpdates for the pair.
 //
+// The PeerState also records the time at which it stopped being send_ready
+// and keeps a histogram of the blocked durations.  The send_ready state gets
+// cleared in the bgp::SendUpdate task and set in the bgp::SendReadyTask, so
+// the blocked timestamp is always written before send_ready_ is cleared and
+// read only after it's observed to be clear.
+//
+// The send window is only used in the bgp::SendUpdate task.
+//
 class BgpSenderPartition::PeerState {
 public:
     typedef map<size_t, PeerRibState> Map;
@@ -141,11 +186,18 @@ public:
     explicit PeerState(IPeerUpdate *peer)
         : key_(peer), index_(-1),
         qactive_cnt_(RibOutUpdates::QCOUNT),
-        in_sync_(true), rib_iterator_(BitSet::npos) {
+        in_sync_(true), rib_iterator_(BitSet::npos),
+        send_window_(kSendWindowInitial), blocked_at_(0) {
         send_ready_ = true;
         for (int i = 0; i < RibOutUpdates::QCOUNT; i++) {
             qactive_cnt_[i] = 0;
         }
+        blocked_count_ = 0;
+        blocked_usecs_ = 0;
+        blocked_max_usecs_ = 0;
+        for (int i = 0; i < BlockedStats::kBucketCount; i++) {
+            blocked_buckets_[i] = 0;
+        }
     }
 
     void Add(RibState *rs);
@@ -212,7 +264,25 @@ public:
     void SetSync();
 
     bool send_ready() const { return send_ready_; }
-    void set_send_ready(bool toggle) { send_ready_ = toggle; }
+    void set_send_ready(bool toggle) {
+        if (!toggle && send_ready_) {
+            blocked_at_ = ClockMonotonicUsec();
+        } else if (toggle && !send_ready_) {
+            UpdateBlockedStats(ClockMonotonicUsec() - blocked_at_);
+        }
+        send_ready_ = toggle;
+    }
+
+    int send_window() const { return send_window_; }
+    void set_send_window(int send_window) { send_window_ = send_window; }
+    void IncreaseSendWindow() {
+        send_window_ = std::min(2 * send_window_, kSendWindowMax);
+    }
+    void DecreaseSendWindow() {
+        send_window_ = std::max(send_window_ / 2, kSendWindowMin);
+    }
+
+    void GetBlockedStats(BlockedStats *stats) const;
 
     bool empty() const { return rib_set_.empty(); }
 
@@ -224,6 +294,8 @@ public:
     }
 
 private:
+    void UpdateBlockedStats(uint64_t usecs);
+
     IPeerUpdate *key_;
     size_t index_;          // assigned from PeerStateMap
     Map rib_set_;           // list of RibOuts advertised by the peer.
@@ -232,6 +304,12 @@ private:
     bool in_sync_;          // whether the peer may dequeue tail markers.
     tbb::atomic<bool> send_ready_;    // whether the peer may send updates.
     size_t rib_iterator_;   // index of last processed rib.
+    int send_window_;       // max queues to drain per WorkPeer.
+    uint64_t blocked_at_;   // when send_ready_ was last cleared.
+    tbb::atomic<uint64_t> blocked_count_;
+    tbb::atomic<uint64_t> blocked_usecs_;
+    tbb::atomic<uint64_t> blocked_max_usecs_;
+    tbb::atomic<uint64_t> blocked_buckets_[BlockedStats::kBucketCount];
 
     DISALLOW_COPY_AND_ASSIGN(PeerState);
 };
@@ -364,6 +442,35 @@ void BgpSenderPartition::PeerState::SetSync() {
     in_sync_ = true;
 }
 
+//
+// Account for the peer having been send blocked for the given duration.
+// Called from the bgp::SendReadyTask, which is the only writer.
+//
+void BgpSenderPartition::PeerState::UpdateBlockedStats(uint64_t usecs) {
+    int bucket = 0;
+    while (bucket < BlockedStats::kBucketCount - 1 &&
+           usecs >= BlockedStats::kBlockedBucketUsecs[bucket]) {
+        bucket++;
+    }
+    blocked_buckets_[bucket]++;
+    blocked_count_++;
+    blocked_usecs_ += usecs;
+    if (usecs > blocked_max_usecs_)
+        blocked_max_usecs_ = usecs;
+}
+
+void BgpSenderPartition::PeerState::GetBlockedStats(
+    BlockedStats *stats) const {
+    BlockedStats peer_stats;
+    peer_stats.count = blocked_count_;
+    peer_stats.duration_usecs = blocked_usecs_;
+    peer_stats.max_duration_usecs = blocked_max_usecs_;
+    for (int i = 0; i < BlockedStats::kBucketCount; i++) {
+        peer_stats.buckets[i] = blocked_buckets_[i];
+    }
+    stats->Add(peer_stats);
+}
+
 RibOut &BgpSenderPartition::PeerState::iterator::dereference() const {
     return *indexmap_.At(index_)->ribout();
 }
@@ -530,6 +637,18 @@ bool BgpSenderPartition::PeerInSync(IPeerUpdate *peer) const {
     return (ps ? ps->in_sync() : false);
 }
 
+//
+// Add the blocked statistics for the IPeer to the provided BlockedStats.
+//
+void BgpSenderPartition::GetPeerBlockedStats(IPeerUpdate *peer,
+    BlockedStats *stats) const {
+    CHECK_CONCURRENCY("bgp::PeerMembership", "bgp::ShowCommand");
+
+    PeerState *ps = peer_state_imap_.Find(peer);
+    if (ps)
+        ps->GetBlockedStats(stats);
+}
+
 //
 // Create a Worker if warranted and enqueue it to the TaskScheduler.
 // Assumes that the caller holds the BgpSenderPartition mutex.
@@ -582,6 +701,27 @@ void BgpSenderPartition::set_disabled(bool disabled) {
     MaybeStartWorker();
 }
 
+//
+// Set the send window for the IPeerUpdate.
+// For unit testing.
+//
+void BgpSenderPartition::SetPeerSendWindow(IPeerUpdate *peer,
+    int send_window) {
+    PeerState *ps = peer_state_imap_.Find(peer);
+    assert(ps);
+    ps->set_send_window(send_window);
+}
+
+//
+// Get the send window for the IPeerUpdate.
+// For unit testing.
+//
+int BgpSenderPartition::PeerSendWindow(IPeerUpdate *peer) const {
+    PeerState *ps = peer_state_imap_.Find(peer);
+    assert(ps);
+    return ps->send_window();
+}
+
 //
 // Enqueue a WorkPeer to the work queue.
 //
@@ -813,10 +953,13 @@ void BgpSenderPartition::UpdateRibOut(RibOut *ribout, int queue_id) {
 // is up-to date or it becomes blocked. If it's blocked, select the next RibOut
 // to be processed when the IPeerUpdate becomes send ready.
 //
-// Return false if the IPeerUpdate got blocked.
+// Each RibOut that gets drained consumes one credit. If we run out of credits,
+// select the next RibOut to be processed when the WorkPeer gets re-enqueued.
+//
+// Return false if the IPeerUpdate got blocked or ran out of credits.
 //
 bool BgpSenderPartition::UpdatePeerQueue(IPeerUpdate *peer, PeerState *ps,
-    int queue_id) {
+    int queue_id, int *credits) {
     CHECK_CONCURRENCY("bgp::SendUpdate");
 
     for (PeerState::circular_iterator it = ps->circular_begin(rib_state_imap_);
@@ -825,6 +968,13 @@ bool BgpSenderPartition::UpdatePeerQueue(IPeerUpdate *peer, PeerState *ps,
         if (!BitIsSet(it.peer_rib_state().qactive, queue_id))
             continue;
 
+        // Yield if the send window has been used up.
+        if (*credits == 0) {
+            ps->SetIteratorStart(it.index());
+            return false;
+        }
+        (*credits)--;
+
         // Drain the queue till we can do no more.
         RibOut *ribout = it.operator->();
         RibOutUpdates *updates = ribout->updates(index_);
@@ -877,12 +1027,22 @@ void BgpSenderPartition::UpdatePeer(IPeerUpdate *peer) {
     }
 
     // Go through all queues and drain them if there's anything on them.
+    // If the peer is still send ready after UpdatePeerQueue returns false,
+    // it used up its send window. Enqueue another WorkPeer to continue from
+    // where we left off, so that other work in the partition gets a chance
+    // to run in the meantime. The send window is left alone in that case,
+    // it only grows once the peer gets in sync without getting blocked.
+    int credits = ps->send_window();
     for (int queue_id = RibOutUpdates::QCOUNT - 1; queue_id >= 0; --queue_id) {
         if (ps->QueueCount(queue_id) == 0) {
             continue;
         }
-        if (!UpdatePeerQueue(peer, ps, queue_id)) {
-            assert(!ps->send_ready());
+        if (!UpdatePeerQueue(peer, ps, queue_id, &credits)) {
+            if (ps->send_ready()) {
+                WorkEnqueue(new WorkPeer(peer));
+            } else {
+                ps->DecreaseSendWindow();
+            }
             return;
         }
     }
@@ -892,11 +1052,15 @@ void BgpSenderPartition::UpdatePeer(IPeerUpdate *peer) {
     // Need to make sure that the IPeerUpdate that we are processing is still
     // send ready.
     if (!ps->send_ready()) {
+        ps->DecreaseSendWindow();
         return;
     }
 
-    // Mark the peer as being in sync across all tables.
+    // Mark the peer as being in sync across all tables. The peer drained
+    // all its queues without getting blocked, so let it do more work per
+    // WorkPeer the next time around.
     ps->SetSync();
+    ps->IncreaseSendWindow();
 
     // Mark all RibStates for the peer as being in sync. This triggers a tail
     // dequeue for the corresponding (RibOut, QueueId) if necessary. This in
@@ -1037,6 +1201,40 @@ bool BgpUpdateSender::PeerInSync(IPeerUpdate *peer) const {
     return true;
 }
 
+//
+// Get the blocked statistics for the IPeer, summed across all partitions.
+//
+void BgpUpdateSender::GetPeerBlockedStats(IPeerUpdate *peer,
+    BgpSenderPartition::BlockedStats *stats) const {
+    BOOST_FOREACH(BgpSenderPartition *partition, partitions_) {
+        partition->GetPeerBlockedStats(peer, stats);
+    }
+}
+
+//
+// Fill introspect information for the time the IPeer spent send blocked.
+//
+void BgpUpdateSender::FillPeerBlockedInfo(const IPeerUpdate *peer,
+    BgpNeighborResp *bnr) const {
+    BgpSenderPartition::BlockedStats stats;
+    GetPeerBlockedStats(const_cast<IPeerUpdate *>(peer), &stats);
+
+    PeerSendBlockedStats blocked_stats;
+    blocked_stats.set_blocked_count(stats.count);
+    blocked_stats.set_blocked_duration_usecs(stats.duration_usecs);
+    blocked_stats.set_max_blocked_duration_usecs(stats.max_duration_usecs);
+    vector<PeerSendBlockedBucket> histogram;
+    for (int idx = 0; idx < BgpSenderPartition::BlockedStats::kBucketCount;
+         ++idx) {
+        PeerSendBlockedBucket bucket;
+        bucket.set_duration(BgpSenderPartition::BlockedStats::BucketName(idx));
+        bucket.set_count(stats.buckets[idx]);
+        histogram.push_back(bucket);
+    }
+    blocked_stats.set_histogram(histogram);
+    bnr->set_send_blocked_stats(blocked_stats);
+}
+
 //
 // Callback to handle send ready notification for IPeerUpdate.  Processing it
 // in the context of bgp::SendeReadyTask ensures that there are no concurrency
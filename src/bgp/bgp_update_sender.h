@@ -7,12 +7,14 @@
 
 #include <boost/ptr_container/ptr_list.hpp>
 
+#include <string>
 #include <vector>
 
 #include "base/bitset.h"
 #include "base/index_map.h"
 #include "base/queue_task.h"
 
+class BgpNeighborResp;
 class BgpServer;
 class BgpUpdateSender;
 class IPeerUpdate;
@@ -45,8 +47,33 @@ class RibPeerSet;
 // WorkRibOut entry after adding a RouteUpdate to an empty UpdateQueue, and
 // IPeerUpdate class which creates a WorkPeer entry when it becomes unblocked.
 //
+// Each PeerState has a send window, which is the number of (RibOut, QueueId)
+// pairs that a WorkPeer is allowed to drain before it yields the partition.
+// A WorkPeer that uses up the window is re-enqueued at the end of the work
+// queue, so that a peer catching up on a large backlog does not stall tail
+// dequeues and other peers behind it.  The window grows when the peer gets
+// in sync without getting blocked and shrinks when the peer gets blocked.
+//
 class BgpSenderPartition {
 public:
+    //
+    // Histogram of the time a peer spent send blocked. The upper bound for
+    // each bucket except the last one is in kBlockedBucketUsecs.
+    //
+    struct BlockedStats {
+        static const int kBucketCount = 6;
+        static const uint64_t kBlockedBucketUsecs[kBucketCount - 1];
+
+        BlockedStats();
+        void Add(const BlockedStats &rhs);
+        static std::string BucketName(int bucket);
+
+        uint64_t count;
+        uint64_t duration_usecs;
+        uint64_t max_duration_usecs;
+        uint64_t buckets[kBucketCount];
+    };
+
     BgpSenderPartition(BgpUpdateSender *sender, int index);
     ~BgpSenderPartition();
 
@@ -59,6 +86,7 @@ public:
     bool PeerIsSendReady(IPeerUpdate *peer) const;
     bool PeerIsRegistered(IPeerUpdate *peer) const;
     bool PeerInSync(IPeerUpdate *peer) const;
+    void GetPeerBlockedStats(IPeerUpdate *peer, BlockedStats *stats) const;
 
     bool CheckInvariants() const;
 
@@ -67,11 +95,17 @@ public:
 
     // For unit testing.
     void set_disabled(bool disabled);
+    void SetPeerSendWindow(IPeerUpdate *peer, int send_window);
+    int PeerSendWindow(IPeerUpdate *peer) const;
 
 private:
     friend class BgpUpdateSenderTest;
     friend class RibOutUpdatesTest;
 
+    static const int kSendWindowInitial;
+    static const int kSendWindowMin;
+    static const int kSendWindowMax;
+
     struct WorkBase {
         enum Type {
             WPeer,
@@ -119,7 +153,8 @@ private:
     void UpdateRibOut(RibOut *ribout, int queue_id);
     void UpdatePeer(IPeerUpdate *peer);
 
-    bool UpdatePeerQueue(IPeerUpdate *peer, PeerState *ps, int queue_id);
+    bool UpdatePeerQueue(IPeerUpdate *peer, PeerState *ps, int queue_id,
+                         int *credits);
 
     void BuildSyncBitSet(const RibOut *ribout, RibState *rs, RibPeerSet *msync);
 
@@ -168,6 +203,10 @@ public:
     void PeerSendReady(IPeerUpdate *peer);
     bool PeerIsRegistered(IPeerUpdate *peer) const;
     bool PeerInSync(IPeerUpdate *peer) const;
+    void GetPeerBlockedStats(IPeerUpdate *peer,
+                             BgpSenderPartition::BlockedStats *stats) const;
+    void FillPeerBlockedInfo(const IPeerUpdate *peer,
+                             BgpNeighborResp *bnr) const;
 
     int task_id() const { return task_id_; }
     bool CheckInvariants() const;
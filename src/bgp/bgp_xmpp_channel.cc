@@ -8,6 +8,8 @@
 #include <boost/foreach.hpp>
 #include <boost/regex.hpp>
 
+#include <string.h>
+
 #include <limits>
 #include <sstream>
 #include <vector>
@@ -18,6 +20,7 @@
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_membership.h"
 #include "bgp/bgp_server.h"
+#include "bgp/bgp_update_recorder.h"
 #include "bgp/bgp_update_sender.h"
 #include "bgp/bgp_xmpp_peer_close.h"
 #include "bgp/inet/inet_table.h"
@@ -34,32 +37,17 @@
 #include "bgp/security_group/security_group.h"
 #include "bgp/tunnel_encap/tunnel_encap.h"
 #include "bgp/bgp_xmpp_rtarget_manager.h"
+#include "bgp/xmpp_enet_item.h"
+#include "bgp/xmpp_mcast_item.h"
+#include "bgp/xmpp_unicast_item.h"
 #include "control-node/sandesh/control_node_types.h"
 #include "net/community_type.h"
-#include "schema/xmpp_multicast_types.h"
-#include "schema/xmpp_enet_types.h"
 #include "xml/xml_pugi.h"
 #include "xmpp/xmpp_connection.h"
 #include "xmpp/xmpp_init.h"
 #include "xmpp/xmpp_server.h"
 #include "xmpp/sandesh/xmpp_peer_info_types.h"
 
-using autogen::EnetItemType;
-using autogen::EnetNextHopListType;
-using autogen::EnetSecurityGroupListType;
-using autogen::EnetTunnelEncapsulationListType;
-
-using autogen::McastItemType;
-using autogen::McastNextHopsType;
-using autogen::McastTunnelEncapsulationListType;
-
-using autogen::ItemType;
-using autogen::NextHopListType;
-using autogen::SecurityGroupListType;
-using autogen::CommunityTagListType;
-using autogen::TunnelEncapsulationListType;
-using autogen::TagListType;
-
 using boost::assign::list_of;
 using boost::regex;
 using boost::regex_search;
@@ -764,46 +752,42 @@ bool BgpXmppChannel::VerifyMembership(const string &vrf_name,
 
 bool BgpXmppChannel::ProcessMcastItem(string vrf_name,
     const pugi::xml_node &node, bool add_change) {
-    McastItemType item;
-    item.Clear();
-
-    if (!item.XmlParse(node)) {
+    XmppMcastItem item;
+    if (!item.Decode(node)) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
             BGP_LOG_FLAG_ALL, "Invalid multicast route message received");
         return false;
     }
 
-    if (item.entry.nlri.af != BgpAf::IPv4) {
+    if (item.af() != BgpAf::IPv4) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-            "Unsupported address family " << item.entry.nlri.af <<
+            "Unsupported address family " << item.af() <<
             " for multicast route");
         return false;
     }
 
-    if (item.entry.nlri.safi != BgpAf::Mcast) {
+    if (item.safi() != BgpAf::Mcast) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
             BGP_LOG_FLAG_ALL, "Unsupported subsequent address family " <<
-            item.entry.nlri.safi << " for multicast route");
+            item.safi() << " for multicast route");
         return false;
     }
 
     error_code error;
     IpAddress grp_address = IpAddress::from_string("0.0.0.0", error);
-    if (!item.entry.nlri.group.empty()) {
-        if (!XmppDecodeAddress(item.entry.nlri.af,
-            item.entry.nlri.group, &grp_address, false)) {
+    if (*item.group()) {
+        if (!XmppDecodeAddress(item.af(), item.group(), &grp_address, false)) {
             BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-                "Bad group address " << item.entry.nlri.group);
+                "Bad group address " << item.group());
             return false;
         }
     }
 
     IpAddress src_address = IpAddress::from_string("0.0.0.0", error);
-    if (!item.entry.nlri.source.empty()) {
-        if (!XmppDecodeAddress(item.entry.nlri.af,
-            item.entry.nlri.source, &src_address, true)) {
+    if (*item.source()) {
+        if (!XmppDecodeAddress(item.af(), item.source(), &src_address, true)) {
             BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-                "Bad source address " << item.entry.nlri.source);
+                "Bad source address " << item.source());
             return false;
         }
     }
@@ -834,9 +818,8 @@ bool BgpXmppChannel::ProcessMcastItem(string vrf_name,
     if (add_change) {
         req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
         vector<uint32_t> labels;
-        const McastNextHopsType &inh_list = item.entry.next_hops;
 
-        if (inh_list.next_hop.empty()) {
+        if (item.next_hop_count() == 0) {
             BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
                 BGP_LOG_FLAG_ALL, "Missing next-hop for multicast route " <<
                 mc_prefix.ToString());
@@ -844,16 +827,16 @@ bool BgpXmppChannel::ProcessMcastItem(string vrf_name,
         }
 
         // Agents should send only one next-hop in the item
-        if (inh_list.next_hop.size() != 1) {
+        if (item.next_hop_count() != 1) {
             BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
                 "More than one nexthop received for multicast route " <<
                 mc_prefix.ToString());
             return false;
         }
 
-        McastNextHopsType::const_iterator nit = inh_list.begin();
+        const XmppMcastItem::NextHop *nit = &item.next_hop();
 
-        // Label Allocation item.entry.label by parsing the range
+        // Label Allocation by parsing the range
         label_range = nit->label;
         if (!stringToIntegerList(label_range, "-", labels) ||
             labels.size() != 2) {
@@ -877,24 +860,22 @@ bool BgpXmppChannel::ProcessMcastItem(string vrf_name,
         attrs.push_back(&attr_label);
 
         // Next-hop ip address
-        IpAddress nh_address;
-        if (!XmppDecodeAddress(nit->af, nit->address, &nh_address)) {
-            BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
-                BGP_LOG_FLAG_ALL, "Bad nexthop address " << nit->address <<
+        if (!nit->address_valid) {
+            BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
+                "Bad nexthop address " << nit->address_str <<
                 " for multicast route " << mc_prefix.ToString());
             return false;
         }
+        IpAddress nh_address = nit->address;
         BgpAttrNextHop nexthop(nh_address.to_v4().to_ulong());
         attrs.push_back(&nexthop);
 
         // Process tunnel encapsulation list.
         bool no_tunnel_encap = true;
         bool no_valid_tunnel_encap = true;
-        for (McastTunnelEncapsulationListType::const_iterator eit =
-             nit->tunnel_encapsulation_list.begin();
-             eit != nit->tunnel_encapsulation_list.end(); ++eit) {
+        BOOST_FOREACH(TunnelEncapType::Encap encap, nit->tunnel_encaps) {
             no_tunnel_encap = false;
-            TunnelEncap tun_encap(*eit);
+            TunnelEncap tun_encap(encap);
             if (tun_encap.tunnel_encap() == TunnelEncapType::UNSPEC)
                 continue;
             no_valid_tunnel_encap = false;
@@ -933,8 +914,8 @@ bool BgpXmppChannel::ProcessMcastItem(string vrf_name,
     assert(table);
     BGP_LOG_PEER_INSTANCE(Peer(), vrf_name,
         SandeshLevel::SYS_DEBUG, BGP_LOG_FLAG_TRACE,
-        "Multicast group " << item.entry.nlri.group <<
-        " source " << item.entry.nlri.source <<
+        "Multicast group " << item.group() <<
+        " source " << item.source() <<
         " and label range " << label_range <<
         " enqueued for " << (add_change ? "add/change" : "delete"));
     table->Enqueue(&req);
@@ -943,32 +924,30 @@ bool BgpXmppChannel::ProcessMcastItem(string vrf_name,
 
 bool BgpXmppChannel::ProcessItem(string vrf_name,
     const pugi::xml_node &node, bool add_change) {
-    ItemType item;
-    item.Clear();
-
-    if (!item.XmlParse(node)) {
+    XmppUnicastItem item;
+    if (!item.Decode(node)) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Invalid inet route message received");
         return false;
     }
 
-    if (item.entry.nlri.af != BgpAf::IPv4) {
+    if (item.af() != BgpAf::IPv4) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-            "Unsupported address family " << item.entry.nlri.af <<
-            " for inet route " << item.entry.nlri.address);
+            "Unsupported address family " << item.af() <<
+            " for inet route " << item.address());
         return false;
     }
 
     error_code error;
     Ip4Prefix inet_prefix =
-        Ip4Prefix::FromString(item.entry.nlri.address, &error);
+        Ip4Prefix::FromString(item.address(), &error);
     if (error) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-            "Bad inet route " << item.entry.nlri.address);
+            "Bad inet route " << item.address());
         return false;
     }
 
-    if (add_change && item.entry.next_hops.next_hop.empty()) {
+    if (add_change && item.next_hop_count() == 0) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Missing next-hops for inet route " << inet_prefix.ToString());
         return false;
@@ -1012,10 +991,8 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
             req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
             BgpAttrSpec attrs;
 
-            const NextHopListType &inh_list = item.entry.next_hops;
-
             // Agents should send only one next-hop in the item.
-            if (inh_list.next_hop.size() != 1) {
+            if (item.next_hop_count() != 1) {
                 BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
                     BGP_LOG_FLAG_ALL,
                     "More than one nexthop received for inet route " <<
@@ -1023,13 +1000,11 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
                 return false;
             }
 
-            NextHopListType::const_iterator nit = inh_list.begin();
-
-            IpAddress nhop_address(Ip4Address(0));
-            if (!XmppDecodeAddress(nit->af, nit->address, &nhop_address)) {
+            const XmppUnicastItem::NextHop *nit = &item.next_hop();
+            if (!nit->address_valid) {
                 BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
                     BGP_LOG_FLAG_ALL,
-                    "Bad nexthop address " << nit->address <<
+                    "Bad nexthop address " << nit->address_str <<
                     " for inet route " << inet_prefix.ToString());
                 return false;
             }
@@ -1044,7 +1019,7 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
                 }
                 if (!nit->vni)
                     continue;
-                if (nit->mac.empty())
+                if (!*nit->mac)
                     continue;
 
                 MacAddress mac_addr =
@@ -1069,7 +1044,7 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
                     continue;
             }
 
-            nh_address = nhop_address;
+            nh_address = nit->address;
             if (family == Address::INET) {
                 label = nit->label;
             } else {
@@ -1079,11 +1054,9 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
             // Process tunnel encapsulation list.
             bool no_tunnel_encap = true;
             bool no_valid_tunnel_encap = true;
-            for (TunnelEncapsulationListType::const_iterator eit =
-                nit->tunnel_encapsulation_list.begin();
-                eit != nit->tunnel_encapsulation_list.end(); ++eit) {
+            BOOST_FOREACH(TunnelEncapType::Encap encap, nit->tunnel_encaps) {
                 no_tunnel_encap = false;
-                TunnelEncap tun_encap(*eit);
+                TunnelEncap tun_encap(encap);
                 if (tun_encap.tunnel_encap() == TunnelEncapType::UNSPEC)
                     continue;
                 if (family == Address::INET &&
@@ -1105,19 +1078,18 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
             }
 
             // Process tag list.
-            for (TagListType::const_iterator tit = nit->tag_list.begin();
-                tit != nit->tag_list.end(); ++tit) {
-                Tag tag(bgp_server_->autonomous_system(), *tit);
+            BOOST_FOREACH(uint32_t tag_value, nit->tags) {
+                Tag tag(bgp_server_->autonomous_system(), tag_value);
                 ext.communities.push_back(tag.GetExtCommunityValue());
             }
 
-            BgpAttrLocalPref local_pref(item.entry.local_preference);
+            BgpAttrLocalPref local_pref(item.local_preference());
             if (local_pref.local_pref != 0)
                 attrs.push_back(&local_pref);
 
             // If there's no explicit med, calculate it automatically from the
             // local pref.
-            uint32_t med_value = item.entry.med;
+            uint32_t med_value = item.med();
             if (!med_value)
                 med_value = GetMedFromLocalPref(local_pref.local_pref);
             BgpAttrMultiExitDisc med(med_value);
@@ -1125,17 +1097,7 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
                 attrs.push_back(&med);
 
             // Process community tags.
-            const CommunityTagListType &ict_list =
-                item.entry.community_tag_list;
-            for (CommunityTagListType::const_iterator cit = ict_list.begin();
-                cit != ict_list.end(); ++cit) {
-                error_code error;
-                uint32_t rt_community =
-                    CommunityType::CommunityFromString(*cit, &error);
-                if (error)
-                    continue;
-                comm.communities.push_back(rt_community);
-            }
+            comm.communities = item.communities();
 
             BgpAttrNextHop nexthop(nh_address.to_v4().to_ulong());
             attrs.push_back(&nexthop);
@@ -1146,25 +1108,22 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
                 attrs.push_back(&source_rd);
 
             // Process security group list.
-            const SecurityGroupListType &isg_list =
-                item.entry.security_group_list;
-            for (SecurityGroupListType::const_iterator sit = isg_list.begin();
-                sit != isg_list.end(); ++sit) {
-                SecurityGroup sg(bgp_server_->autonomous_system(), *sit);
+            BOOST_FOREACH(uint32_t sg_id, item.security_groups()) {
+                SecurityGroup sg(bgp_server_->autonomous_system(), sg_id);
                 ext.communities.push_back(sg.GetExtCommunityValue());
             }
 
-            if (item.entry.mobility.seqno) {
-                MacMobility mm(item.entry.mobility.seqno,
-                               item.entry.mobility.sticky);
+            if (item.mobility_seqno()) {
+                MacMobility mm(item.mobility_seqno(),
+                               item.mobility_sticky());
                 ext.communities.push_back(mm.GetExtCommunityValue());
-            } else if (item.entry.sequence_number) {
-                MacMobility mm(item.entry.sequence_number);
+            } else if (item.sequence_number()) {
+                MacMobility mm(item.sequence_number());
                 ext.communities.push_back(mm.GetExtCommunityValue());
             }
 
             // Process load-balance extended community.
-            LoadBalance load_balance(item.entry.load_balance);
+            const LoadBalance &load_balance = item.load_balance();
             if (!load_balance.IsDefault())
                 ext.communities.push_back(load_balance.GetExtCommunityValue());
 
@@ -1194,7 +1153,7 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
         assert(table);
         BGP_LOG_PEER_INSTANCE(Peer(), vrf_name,
             SandeshLevel::SYS_DEBUG, BGP_LOG_FLAG_TRACE,
-            "Inet route " << item.entry.nlri.address <<
+            "Inet route " << item.address() <<
             " with next-hop " << nh_address << " and label " << label <<
             " enqueued for " << (add_change ? "add/change" : "delete") <<
             " to table " << table->name());
@@ -1212,43 +1171,41 @@ bool BgpXmppChannel::ProcessItem(string vrf_name,
 
 bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
     const pugi::xml_node &node, bool add_change) {
-    ItemType item;
-    item.Clear();
-
-    if (!item.XmlParse(node)) {
+    XmppUnicastItem item;
+    if (!item.Decode(node)) {
         error_stats().incr_inet6_rx_bad_xml_token_count();
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Invalid inet6 route message received");
         return false;
     }
 
-    if (item.entry.nlri.af != BgpAf::IPv6) {
+    if (item.af() != BgpAf::IPv6) {
         error_stats().incr_inet6_rx_bad_afi_safi_count();
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-            "Unsupported address family " << item.entry.nlri.af <<
-            " for inet6 route " << item.entry.nlri.address);
+            "Unsupported address family " << item.af() <<
+            " for inet6 route " << item.address());
         return false;
     }
 
-    if (item.entry.nlri.safi != BgpAf::Unicast) {
+    if (item.safi() != BgpAf::Unicast) {
         error_stats().incr_inet6_rx_bad_afi_safi_count();
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-            "Unsupported subsequent address family " << item.entry.nlri.safi <<
-            " for inet6 route " << item.entry.nlri.address);
+            "Unsupported subsequent address family " << item.safi() <<
+            " for inet6 route " << item.address());
         return false;
     }
 
     error_code error;
     Inet6Prefix inet6_prefix =
-        Inet6Prefix::FromString(item.entry.nlri.address, &error);
+        Inet6Prefix::FromString(item.address(), &error);
     if (error) {
         error_stats().incr_inet6_rx_bad_prefix_count();
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-            "Bad inet6 route " << item.entry.nlri.address);
+            "Bad inet6 route " << item.address());
         return false;
     }
 
-    if (add_change && item.entry.next_hops.next_hop.empty()) {
+    if (add_change && item.next_hop_count() == 0) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Missing next-hops for inet6 route " << inet6_prefix.ToString());
         return false;
@@ -1292,10 +1249,8 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
             req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
             BgpAttrSpec attrs;
 
-            const NextHopListType &inh_list = item.entry.next_hops;
-
             // Agents should send only one next-hop in the item.
-            if (inh_list.next_hop.size() != 1) {
+            if (item.next_hop_count() != 1) {
                 BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
                     BGP_LOG_FLAG_ALL,
                     "More than one nexthop received for inet6 route " <<
@@ -1303,14 +1258,12 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
                 return false;
             }
 
-            NextHopListType::const_iterator nit = inh_list.begin();
-
-            IpAddress nhop_address(Ip4Address(0));
-            if (!XmppDecodeAddress(nit->af, nit->address, &nhop_address)) {
+            const XmppUnicastItem::NextHop *nit = &item.next_hop();
+            if (!nit->address_valid) {
                 error_stats().incr_inet6_rx_bad_nexthop_count();
                 BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
                     BGP_LOG_FLAG_ALL,
-                    "Bad nexthop address " << nit->address <<
+                    "Bad nexthop address " << nit->address_str <<
                     " for inet6 route " << inet6_prefix.ToString());
                 return false;
             }
@@ -1325,7 +1278,7 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
                 }
                 if (!nit->vni)
                     continue;
-                if (nit->mac.empty())
+                if (!*nit->mac)
                     continue;
 
                 MacAddress mac_addr =
@@ -1350,7 +1303,7 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
                     continue;
             }
 
-            nh_address = nhop_address;
+            nh_address = nit->address;
             if (family == Address::INET6) {
                 label = nit->label;
             } else {
@@ -1360,11 +1313,9 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
             // Process tunnel encapsulation list.
             bool no_tunnel_encap = true;
             bool no_valid_tunnel_encap = true;
-            for (TunnelEncapsulationListType::const_iterator eit =
-                nit->tunnel_encapsulation_list.begin();
-                eit != nit->tunnel_encapsulation_list.end(); ++eit) {
+            BOOST_FOREACH(TunnelEncapType::Encap encap, nit->tunnel_encaps) {
                 no_tunnel_encap = false;
-                TunnelEncap tun_encap(*eit);
+                TunnelEncap tun_encap(encap);
                 if (tun_encap.tunnel_encap() == TunnelEncapType::UNSPEC)
                     continue;
                 if (family == Address::INET6 &&
@@ -1386,19 +1337,18 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
             }
 
             // Process tag list.
-            for (TagListType::const_iterator tit = nit->tag_list.begin();
-                tit != nit->tag_list.end(); ++tit) {
-                Tag tag(bgp_server_->autonomous_system(), *tit);
+            BOOST_FOREACH(uint32_t tag_value, nit->tags) {
+                Tag tag(bgp_server_->autonomous_system(), tag_value);
                 ext.communities.push_back(tag.GetExtCommunityValue());
             }
 
-            BgpAttrLocalPref local_pref(item.entry.local_preference);
+            BgpAttrLocalPref local_pref(item.local_preference());
             if (local_pref.local_pref != 0)
                 attrs.push_back(&local_pref);
 
             // If there's no explicit med, calculate it automatically from the
             // local pref.
-            uint32_t med_value = item.entry.med;
+            uint32_t med_value = item.med();
             if (!med_value)
                 med_value = GetMedFromLocalPref(local_pref.local_pref);
             BgpAttrMultiExitDisc med(med_value);
@@ -1406,17 +1356,7 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
                 attrs.push_back(&med);
 
             // Process community tags.
-            const CommunityTagListType &ict_list =
-                item.entry.community_tag_list;
-            for (CommunityTagListType::const_iterator cit = ict_list.begin();
-                cit != ict_list.end(); ++cit) {
-                error_code error;
-                uint32_t rt_community =
-                    CommunityType::CommunityFromString(*cit, &error);
-                if (error)
-                    continue;
-                comm.communities.push_back(rt_community);
-            }
+            comm.communities = item.communities();
 
             BgpAttrNextHop nexthop(nh_address);
             attrs.push_back(&nexthop);
@@ -1430,25 +1370,22 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
             }
 
             // Process security group list.
-            const SecurityGroupListType &isg_list =
-                item.entry.security_group_list;
-            for (SecurityGroupListType::const_iterator sit = isg_list.begin();
-                sit != isg_list.end(); ++sit) {
-                SecurityGroup sg(bgp_server_->autonomous_system(), *sit);
+            BOOST_FOREACH(uint32_t sg_id, item.security_groups()) {
+                SecurityGroup sg(bgp_server_->autonomous_system(), sg_id);
                 ext.communities.push_back(sg.GetExtCommunityValue());
             }
 
-            if (item.entry.mobility.seqno) {
-                MacMobility mm(item.entry.mobility.seqno,
-                    item.entry.mobility.sticky);
+            if (item.mobility_seqno()) {
+                MacMobility mm(item.mobility_seqno(),
+                               item.mobility_sticky());
                 ext.communities.push_back(mm.GetExtCommunityValue());
-            } else if (item.entry.sequence_number) {
-                MacMobility mm(item.entry.sequence_number);
+            } else if (item.sequence_number()) {
+                MacMobility mm(item.sequence_number());
                 ext.communities.push_back(mm.GetExtCommunityValue());
             }
 
             // Process load-balance extended community.
-            LoadBalance load_balance(item.entry.load_balance);
+            const LoadBalance &load_balance = item.load_balance();
             if (!load_balance.IsDefault())
                 ext.communities.push_back(load_balance.GetExtCommunityValue());
 
@@ -1478,7 +1415,7 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
         assert(table);
         BGP_LOG_PEER_INSTANCE(Peer(), vrf_name,
             SandeshLevel::SYS_DEBUG, BGP_LOG_FLAG_TRACE,
-            "Inet6 route " << item.entry.nlri.address <<
+            "Inet6 route " << item.address() <<
             " with next-hop " << nh_address << " and label " << label <<
             " enqueued for " << (add_change ? "add/change" : "delete") <<
             " to table " << table->name());
@@ -1496,74 +1433,68 @@ bool BgpXmppChannel::ProcessInet6Item(string vrf_name,
 
 bool BgpXmppChannel::ProcessEnetItem(string vrf_name,
     const pugi::xml_node &node, bool add_change) {
-    EnetItemType item;
-    item.Clear();
-
-    if (!item.XmlParse(node)) {
+    XmppEnetItem item;
+    if (!item.Decode(node)) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
             "Invalid enet route message received");
         return false;
     }
 
-    if (item.entry.nlri.af != BgpAf::L2Vpn) {
+    if (item.af() != BgpAf::L2Vpn) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-            "Unsupported address family " << item.entry.nlri.af <<
-            " for enet route " << item.entry.nlri.address);
+            "Unsupported address family " << item.af() <<
+            " for enet route " << item.address());
         return false;
     }
 
-    if (item.entry.nlri.safi != BgpAf::Enet) {
+    if (item.safi() != BgpAf::Enet) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-            "Unsupported subsequent address family " << item.entry.nlri.safi <<
-            " for enet route " << item.entry.nlri.mac);
+            "Unsupported subsequent address family " << item.safi() <<
+            " for enet route " << item.mac());
         return false;
     }
 
     error_code error;
-    MacAddress mac_addr = MacAddress::FromString(item.entry.nlri.mac, &error);
+    MacAddress mac_addr = MacAddress::FromString(item.mac(), &error);
 
     if (error) {
         BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-            "Bad mac address " << item.entry.nlri.mac);
+            "Bad mac address " << item.mac());
         return false;
     }
 
     Ip4Prefix inet_prefix;
     Inet6Prefix inet6_prefix;
     IpAddress ip_addr;
-    if (!item.entry.nlri.address.empty()) {
-        size_t pos = item.entry.nlri.address.find('/');
-        if (pos == string::npos) {
+    const char *address = item.address();
+    if (*address) {
+        const char *plen_str = strchr(address, '/');
+        if (!plen_str) {
             BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-                "Missing / in address " << item.entry.nlri.address);
+                "Missing / in address " << address);
             return false;
         }
 
-        string plen_str = item.entry.nlri.address.substr(pos + 1);
-        if (plen_str == "32") {
-            inet_prefix =
-                Ip4Prefix::FromString(item.entry.nlri.address, &error);
+        plen_str++;
+        if (strcmp(plen_str, "32") == 0) {
+            inet_prefix = Ip4Prefix::FromString(address, &error);
             if (error || inet_prefix.prefixlen() != 32) {
                 BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
-                    BGP_LOG_FLAG_ALL,
-                    "Bad inet address " << item.entry.nlri.address);
+                    BGP_LOG_FLAG_ALL, "Bad inet address " << address);
                 return false;
             }
             ip_addr = inet_prefix.ip4_addr();
-        } else if (plen_str == "128") {
-            inet6_prefix =
-                Inet6Prefix::FromString(item.entry.nlri.address, &error);
+        } else if (strcmp(plen_str, "128") == 0) {
+            inet6_prefix = Inet6Prefix::FromString(address, &error);
             if (error || inet6_prefix.prefixlen() != 128) {
                 BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
-                    BGP_LOG_FLAG_ALL,
-                    "Bad inet6 address " << item.entry.nlri.address);
+                    BGP_LOG_FLAG_ALL, "Bad inet6 address " << address);
                 return false;
             }
             ip_addr = inet6_prefix.ip6_addr();
-        } else if (item.entry.nlri.address != "0.0.0.0/0") {
+        } else if (strcmp(address, "0.0.0.0/0") != 0) {
             BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name, BGP_LOG_FLAG_ALL,
-                "Bad prefix length in address " <<
-                item.entry.nlri.address);
+                "Bad prefix length in address " << address);
             return false;
         }
     }
@@ -1585,7 +1516,7 @@ bool BgpXmppChannel::ProcessEnetItem(string vrf_name,
         rd = RouteDistinguisher::kZeroRd;
     }
 
-    uint32_t ethernet_tag = item.entry.nlri.ethernet_tag;
+    uint32_t ethernet_tag = item.ethernet_tag();
     EvpnPrefix evpn_prefix(rd, ethernet_tag, mac_addr, ip_addr);
 
     DBRequest req;
@@ -1601,9 +1532,8 @@ bool BgpXmppChannel::ProcessEnetItem(string vrf_name,
     if (add_change) {
         req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
         BgpAttrSpec attrs;
-        const EnetNextHopListType &inh_list = item.entry.next_hops;
 
-        if (inh_list.next_hop.empty()) {
+        if (item.next_hop_count() == 0) {
             BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
                 BGP_LOG_FLAG_ALL, "Missing next-hops for enet route " <<
                                   evpn_prefix.ToXmppIdString());
@@ -1611,7 +1541,7 @@ bool BgpXmppChannel::ProcessEnetItem(string vrf_name,
         }
 
         // Agents should send only one next-hop in the item.
-        if (inh_list.next_hop.size() != 1) {
+        if (item.next_hop_count() != 1) {
             BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
                 BGP_LOG_FLAG_ALL,
                 "More than one nexthop received for enet route " <<
@@ -1619,21 +1549,18 @@ bool BgpXmppChannel::ProcessEnetItem(string vrf_name,
             return false;
         }
 
-        EnetNextHopListType::const_iterator nit = inh_list.begin();
-
-        IpAddress nhop_address(Ip4Address(0));
-
-        if (!XmppDecodeAddress(nit->af, nit->address, &nhop_address)) {
+        const XmppEnetItem::NextHop *nit = &item.next_hop();
+        if (!nit->address_valid) {
             BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
-                BGP_LOG_FLAG_ALL, "Bad nexthop address " << nit->address <<
+                BGP_LOG_FLAG_ALL, "Bad nexthop address " << nit->address_str <<
                 " for enet route " << evpn_prefix.ToXmppIdString());
             return false;
         }
 
-        nh_address = nhop_address;
+        nh_address = nit->address;
         label = nit->label;
         l3_label = nit->l3_label;
-        if (!nit->mac.empty()) {
+        if (*nit->mac) {
             MacAddress rmac_addr =
                 MacAddress::FromString(nit->mac, &error);
             if (error) {
@@ -1650,11 +1577,9 @@ bool BgpXmppChannel::ProcessEnetItem(string vrf_name,
         // Process tunnel encapsulation list.
         bool no_tunnel_encap = true;
         bool no_valid_tunnel_encap = true;
-        for (EnetTunnelEncapsulationListType::const_iterator eit =
-            nit->tunnel_encapsulation_list.begin();
-            eit != nit->tunnel_encapsulation_list.end(); ++eit) {
+        BOOST_FOREACH(TunnelEncapType::Encap encap, nit->tunnel_encaps) {
             no_tunnel_encap = false;
-            TunnelEncap tun_encap(*eit);
+            TunnelEncap tun_encap(encap);
             if (tun_encap.tunnel_encap() == TunnelEncapType::UNSPEC)
                 continue;
             no_valid_tunnel_encap = false;
@@ -1674,20 +1599,19 @@ bool BgpXmppChannel::ProcessEnetItem(string vrf_name,
         }
 
         // Process tag list.
-        for (TagListType::const_iterator tit = nit->tag_list.begin();
-            tit != nit->tag_list.end(); ++tit) {
-            Tag tag(bgp_server_->autonomous_system(), *tit);
+        BOOST_FOREACH(uint32_t tag_value, nit->tags) {
+            Tag tag(bgp_server_->autonomous_system(), tag_value);
             ext.communities.push_back(tag.GetExtCommunityValue());
         }
 
-        BgpAttrLocalPref local_pref(item.entry.local_preference);
+        BgpAttrLocalPref local_pref(item.local_preference());
         if (local_pref.local_pref != 0) {
             attrs.push_back(&local_pref);
         }
 
         // If there's no explicit med, calculate it automatically from the
         // local pref.
-        uint32_t med_value = item.entry.med;
+        uint32_t med_value = item.med();
         if (!med_value)
             med_value = GetMedFromLocalPref(local_pref.local_pref);
         BgpAttrMultiExitDisc med(med_value);
@@ -1702,24 +1626,20 @@ bool BgpXmppChannel::ProcessEnetItem(string vrf_name,
         attrs.push_back(&source_rd);
 
         // Process security group list.
-        const EnetSecurityGroupListType &isg_list =
-            item.entry.security_group_list;
-        for (EnetSecurityGroupListType::const_iterator sit = isg_list.begin();
-            sit != isg_list.end(); ++sit) {
-            SecurityGroup sg(bgp_server_->autonomous_system(), *sit);
+        BOOST_FOREACH(uint32_t sg_id, item.security_groups()) {
+            SecurityGroup sg(bgp_server_->autonomous_system(), sg_id);
             ext.communities.push_back(sg.GetExtCommunityValue());
         }
 
-        if (item.entry.mobility.seqno) {
-            MacMobility mm(item.entry.mobility.seqno,
-                item.entry.mobility.sticky);
+        if (item.mobility_seqno()) {
+            MacMobility mm(item.mobility_seqno(), item.mobility_sticky());
             ext.communities.push_back(mm.GetExtCommunityValue());
-        } else if (item.entry.sequence_number) {
-            MacMobility mm(item.entry.sequence_number);
+        } else if (item.sequence_number()) {
+            MacMobility mm(item.sequence_number());
             ext.communities.push_back(mm.GetExtCommunityValue());
         }
 
-        ETree etree(item.entry.etree_leaf);
+        ETree etree(item.etree_leaf());
         ext.communities.push_back(etree.GetExtCommunityValue());
 
         if (!ext.communities.empty())
@@ -1727,14 +1647,14 @@ bool BgpXmppChannel::ProcessEnetItem(string vrf_name,
 
         PmsiTunnelSpec pmsi_spec;
         if (mac_addr.IsBroadcast()) {
-            if (!item.entry.replicator_address.empty()) {
+            if (*item.replicator_address()) {
                 IpAddress replicator_address;
                 if (!XmppDecodeAddress(BgpAf::IPv4,
-                    item.entry.replicator_address, &replicator_address)) {
+                    item.replicator_address(), &replicator_address)) {
                     BGP_LOG_PEER_INSTANCE_WARNING(Peer(), vrf_name,
                         BGP_LOG_FLAG_ALL,
                         "Bad replicator address " <<
-                        item.entry.replicator_address <<
+                        item.replicator_address() <<
                         " for enet route " << evpn_prefix.ToXmppIdString());
                     return false;
                 }
@@ -1744,11 +1664,11 @@ bool BgpXmppChannel::ProcessEnetItem(string vrf_name,
                 pmsi_spec.SetIdentifier(replicator_address.to_v4());
             } else {
                 pmsi_spec.tunnel_type = PmsiTunnelSpec::IngressReplication;
-                if (item.entry.assisted_replication_supported) {
+                if (item.assisted_replication_supported()) {
                     pmsi_spec.tunnel_flags |= PmsiTunnelSpec::ARReplicator;
                     pmsi_spec.tunnel_flags |= PmsiTunnelSpec::LeafInfoRequired;
                 }
-                if (!item.entry.edge_replication_not_supported) {
+                if (!item.edge_replication_not_supported()) {
                     pmsi_spec.tunnel_flags |=
                         PmsiTunnelSpec::EdgeReplicationSupported;
                 }
@@ -2561,6 +2481,13 @@ void BgpXmppChannel::ReceiveUpdate(const XmppStanza::XmppMessage *msg) {
     assert(!peer_deleted());
 
     if (msg->type == XmppStanza::IQ_STANZA) {
+        BgpUpdateRecorder *recorder = bgp_server_->update_recorder();
+        if (recorder->enabled() && msg->dom.get()) {
+            ostringstream oss;
+            msg->dom->PrintDoc(oss);
+            recorder->RecordXmppMessage(ToString(), oss.str());
+        }
+
         const XmppStanza::XmppMessageIq *iq =
                    static_cast<const XmppStanza::XmppMessageIq *>(msg);
         if (iq->iq_type.compare("set") == 0) {
@@ -13,6 +13,7 @@
 #include "bgp/bgp_peer_internal_types.h"
 #include "bgp/bgp_sandesh.h"
 #include "bgp/bgp_server.h"
+#include "bgp/bgp_update_sender.h"
 #include "bgp/bgp_xmpp_channel.h"
 #include "xmpp/xmpp_connection.h"
 
@@ -68,6 +69,8 @@ static void FillXmppNeighborInfo(BgpNeighborResp *bnr,
     bnr->set_negotiated_address_families(vector<string>());
     const BgpMembershipManager *mgr = bsc->bgp_server->membership_mgr();
     mgr->FillPeerMembershipInfo(bx_channel->Peer(), bnr);
+    bsc->bgp_server->update_sender()->FillPeerBlockedInfo(
+        bx_channel->Peer(), bnr);
     bx_channel->FillTableMembershipInfo(bnr);
     bx_channel->FillInstanceMembershipInfo(bnr);
     bx_channel->FillCloseInfo(bnr);
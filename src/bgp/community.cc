@@ -7,6 +7,7 @@
 #include <boost/foreach.hpp>
 
 #include <algorithm>
+#include <iterator>
 #include <string>
 
 #include "base/string_util.h"
@@ -16,6 +17,9 @@
 #include "bgp/origin-vn/origin_vn.h"
 #include "net/community_type.h"
 
+using std::back_inserter;
+using std::lower_bound;
+using std::set_union;
 using std::sort;
 using std::string;
 using std::unique;
@@ -48,32 +52,59 @@ Community::Community(CommunityDB *comm_db, const CommunitySpec spec)
     vector<uint32_t>::iterator it =
         unique(communities_.begin(), communities_.end());
     communities_.erase(it, communities_.end());
+    UpdateHash();
 }
 
+//
+// Compare the cached hash first so that lookups in the CommunityDB don't
+// have to compare the full list of communities unless there's a match.
+//
 int Community::CompareTo(const Community &rhs) const {
+    KEY_COMPARE(hash_, rhs.hash_);
     KEY_COMPARE(communities_, rhs.communities_);
     return 0;
 }
 
+void Community::UpdateHash() {
+    hash_ = 0;
+    boost::hash_range(hash_, communities_.begin(), communities_.end());
+}
+
 size_t CommunitySpec::EncodeLength() const {
     return communities.size() * sizeof(uint32_t);
 }
 
+//
+// The list of communities is always kept sorted, so insert the value at
+// the right position instead of sorting the whole list again.
+//
 void Community::Append(uint32_t value) {
-    if (ContainsValue(value))
+    vector<uint32_t>::iterator it =
+        lower_bound(communities_.begin(), communities_.end(), value);
+    if (it != communities_.end() && *it == value)
         return;
-    communities_.push_back(value);
-    sort(communities_.begin(), communities_.end());
+    communities_.insert(it, value);
+    UpdateHash();
 }
 
+//
+// Sort the (typically short) list being appended and merge it with the
+// existing sorted list.
+//
 void Community::Append(const std::vector<uint32_t> &communities) {
-    BOOST_FOREACH(uint32_t community, communities) {
-        communities_.push_back(community);
-    }
-    sort(communities_.begin(), communities_.end());
+    vector<uint32_t> sorted_list(communities);
+    sort(sorted_list.begin(), sorted_list.end());
     vector<uint32_t>::iterator it =
-        unique(communities_.begin(), communities_.end());
-    communities_.erase(it, communities_.end());
+        unique(sorted_list.begin(), sorted_list.end());
+    sorted_list.erase(it, sorted_list.end());
+
+    vector<uint32_t> merged_list;
+    merged_list.reserve(communities_.size() + sorted_list.size());
+    set_union(communities_.begin(), communities_.end(),
+              sorted_list.begin(), sorted_list.end(),
+              back_inserter(merged_list));
+    communities_.swap(merged_list);
+    UpdateHash();
 }
 
 void Community::Set(const std::vector<uint32_t> &communities) {
@@ -81,6 +112,7 @@ void Community::Set(const std::vector<uint32_t> &communities) {
     BOOST_FOREACH(uint32_t community, communities) {
         communities_.push_back(community);
     }
+    UpdateHash();
 }
 
 void Community::Remove(const std::vector<uint32_t> &communities) {
@@ -89,6 +121,7 @@ void Community::Remove(const std::vector<uint32_t> &communities) {
                std::remove(communities_.begin(), communities_.end(), community),
                communities_.end());
     }
+    UpdateHash();
 }
 void Community::Remove() {
     comm_db_->Delete(this);
@@ -194,7 +227,12 @@ void ExtCommunitySpec::ToCanonical(BgpAttr *attr) {
     attr->set_ext_community(this);
 }
 
+//
+// Compare the cached hash first so that lookups in the ExtCommunityDB don't
+// have to compare the full list of communities unless there's a match.
+//
 int ExtCommunity::CompareTo(const ExtCommunity &rhs) const {
+    KEY_COMPARE(hash_, rhs.hash_);
     KEY_COMPARE(communities_.size(), rhs.communities_.size());
 
     ExtCommunityList::const_iterator i, j;
@@ -214,20 +252,59 @@ void ExtCommunity::Remove() {
     extcomm_db_->Delete(this);
 }
 
+void ExtCommunity::UpdateHash() {
+    hash_ = 0;
+    for (ExtCommunityList::const_iterator iter = communities_.begin();
+         iter != communities_.end(); ++iter) {
+        boost::hash_range(hash_, iter->begin(), iter->end());
+    }
+}
+
+//
+// Sort the (typically short) list being appended and merge it with the
+// existing sorted list instead of sorting the combined list.
+//
 void ExtCommunity::Append(const ExtCommunityList &list) {
-    communities_.insert(communities_.end(), list.begin(), list.end());
-    sort(communities_.begin(), communities_.end());
+    ExtCommunityList sorted_list(list);
+    sort(sorted_list.begin(), sorted_list.end());
     ExtCommunityList::iterator it =
-        unique(communities_.begin(), communities_.end());
-    communities_.erase(it, communities_.end());
+        unique(sorted_list.begin(), sorted_list.end());
+    sorted_list.erase(it, sorted_list.end());
+
+    ExtCommunityList merged_list;
+    merged_list.reserve(communities_.size() + sorted_list.size());
+    set_union(communities_.begin(), communities_.end(),
+              sorted_list.begin(), sorted_list.end(),
+              back_inserter(merged_list));
+    communities_.swap(merged_list);
+    UpdateHash();
 }
 
 void ExtCommunity::Append(const ExtCommunityValue &value) {
-    communities_.push_back(value);
-    sort(communities_.begin(), communities_.end());
     ExtCommunityList::iterator it =
-        unique(communities_.begin(), communities_.end());
+        lower_bound(communities_.begin(), communities_.end(), value);
+    if (it != communities_.end() && *it == value)
+        return;
+    communities_.insert(it, value);
+    UpdateHash();
+}
+
+//
+// Remove all values that match the predicate. Relative order of the
+// remaining values is preserved, so the list stays sorted.
+//
+void ExtCommunity::RemoveIf(ValuePredicate pred) {
+    ExtCommunityList::iterator it =
+        std::remove_if(communities_.begin(), communities_.end(), pred);
+    if (it == communities_.end())
+        return;
     communities_.erase(it, communities_.end());
+    UpdateHash();
+}
+
+bool ExtCommunity::ContainsAny(ValuePredicate pred) const {
+    return std::find_if(communities_.begin(), communities_.end(), pred) !=
+        communities_.end();
 }
 
 bool ExtCommunity::ContainsOriginVn(const ExtCommunityValue &val) const {
@@ -239,104 +316,6 @@ bool ExtCommunity::ContainsOriginVn(const ExtCommunityValue &val) const {
     return false;
 }
 
-void ExtCommunity::RemoveRTarget() {
-    for (ExtCommunityList::iterator it = communities_.begin();
-         it != communities_.end(); ) {
-        if (ExtCommunity::is_route_target(*it)) {
-            it = communities_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-void ExtCommunity::RemoveSGID() {
-    for (ExtCommunityList::iterator it = communities_.begin();
-         it != communities_.end(); ) {
-        if (ExtCommunity::is_security_group(*it)) {
-            it = communities_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-void ExtCommunity::RemoveTag() {
-    for (ExtCommunityList::iterator it = communities_.begin();
-         it != communities_.end(); ) {
-        if (ExtCommunity::is_tag(*it)) {
-            it = communities_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-void ExtCommunity::RemoveSiteOfOrigin() {
-    for (ExtCommunityList::iterator it = communities_.begin();
-         it != communities_.end(); ) {
-        if (ExtCommunity::is_site_of_origin(*it)) {
-            it = communities_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-void ExtCommunity::RemoveSourceAS() {
-    for (ExtCommunityList::iterator it = communities_.begin();
-         it != communities_.end(); ) {
-        if (ExtCommunity::is_source_as(*it)) {
-            it = communities_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-void ExtCommunity::RemoveVrfRouteImport() {
-    for (ExtCommunityList::iterator it = communities_.begin();
-         it != communities_.end(); ) {
-        if (ExtCommunity::is_vrf_route_import(*it)) {
-            it = communities_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-void ExtCommunity::RemoveOriginVn() {
-    for (ExtCommunityList::iterator it = communities_.begin();
-         it != communities_.end(); ) {
-        if (ExtCommunity::is_origin_vn(*it)) {
-            it = communities_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-void ExtCommunity::RemoveTunnelEncapsulation() {
-    for (ExtCommunityList::iterator it = communities_.begin();
-         it != communities_.end(); ) {
-        if (ExtCommunity::is_tunnel_encap(*it)) {
-            it = communities_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-void ExtCommunity::RemoveLoadBalance() {
-    for (ExtCommunityList::iterator it = communities_.begin();
-         it != communities_.end(); ) {
-        if (ExtCommunity::is_load_balance(*it)) {
-            it = communities_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
 vector<string> ExtCommunity::GetTunnelEncap() const {
     vector<string> encap_list;
     for (ExtCommunityList::const_iterator iter = communities_.begin();
@@ -412,6 +391,7 @@ ExtCommunity::ExtCommunity(ExtCommunityDB *extcomm_db,
     ExtCommunityList::iterator it =
         unique(communities_.begin(), communities_.end());
     communities_.erase(it, communities_.end());
+    UpdateHash();
 }
 
 ExtCommunityDB::ExtCommunityDB(BgpServer *server) {
@@ -437,8 +417,15 @@ ExtCommunityPtr ExtCommunityDB::AppendAndLocate(const ExtCommunity *src,
     return AppendAndLocate(src, list);
 }
 
-ExtCommunityPtr ExtCommunityDB::ReplaceRTargetAndLocate(const ExtCommunity *src,
-        const ExtCommunity::ExtCommunityList &export_list) {
+//
+// Remove all values that match the predicate. An interned src that doesn't
+// have any matching values is returned as is, without allocating a clone.
+//
+ExtCommunityPtr ExtCommunityDB::RemoveAndLocate(const ExtCommunity *src,
+        ExtCommunity::ValuePredicate pred) {
+    if (src && !src->ContainsAny(pred))
+        return ExtCommunityPtr(src);
+
     ExtCommunity *clone;
     if (src) {
         clone = new ExtCommunity(*src);
@@ -446,14 +433,16 @@ ExtCommunityPtr ExtCommunityDB::ReplaceRTargetAndLocate(const ExtCommunity *src,
         clone = new ExtCommunity(this);
     }
 
-    clone->RemoveRTarget();
-    clone->Append(export_list);
+    clone->RemoveIf(pred);
     return Locate(clone);
 }
 
-ExtCommunityPtr ExtCommunityDB::ReplaceSGIDListAndLocate(
-    const ExtCommunity *src,
-    const ExtCommunity::ExtCommunityList &sgid_list) {
+//
+// Replace all values that match the predicate with the given list.
+//
+ExtCommunityPtr ExtCommunityDB::ReplaceAndLocate(const ExtCommunity *src,
+        ExtCommunity::ValuePredicate pred,
+        const ExtCommunity::ExtCommunityList &list) {
     ExtCommunity *clone;
     if (src) {
         clone = new ExtCommunity(*src);
@@ -461,14 +450,14 @@ ExtCommunityPtr ExtCommunityDB::ReplaceSGIDListAndLocate(
         clone = new ExtCommunity(this);
     }
 
-    clone->RemoveSGID();
-    clone->Append(sgid_list);
+    clone->RemoveIf(pred);
+    clone->Append(list);
     return Locate(clone);
 }
 
-ExtCommunityPtr ExtCommunityDB::ReplaceTagListAndLocate(
-    const ExtCommunity *src,
-    const ExtCommunity::ExtCommunityList &tag_list) {
+ExtCommunityPtr ExtCommunityDB::ReplaceAndLocate(const ExtCommunity *src,
+        ExtCommunity::ValuePredicate pred,
+        const ExtCommunity::ExtCommunityValue &value) {
     ExtCommunity *clone;
     if (src) {
         clone = new ExtCommunity(*src);
@@ -476,93 +465,59 @@ ExtCommunityPtr ExtCommunityDB::ReplaceTagListAndLocate(
         clone = new ExtCommunity(this);
     }
 
-    clone->RemoveTag();
-    clone->Append(tag_list);
+    clone->RemoveIf(pred);
+    clone->Append(value);
     return Locate(clone);
 }
 
+ExtCommunityPtr ExtCommunityDB::ReplaceRTargetAndLocate(const ExtCommunity *src,
+        const ExtCommunity::ExtCommunityList &export_list) {
+    return ReplaceAndLocate(src, &ExtCommunity::is_route_target, export_list);
+}
+
+ExtCommunityPtr ExtCommunityDB::ReplaceSGIDListAndLocate(
+    const ExtCommunity *src,
+    const ExtCommunity::ExtCommunityList &sgid_list) {
+    return ReplaceAndLocate(src, &ExtCommunity::is_security_group, sgid_list);
+}
+
+ExtCommunityPtr ExtCommunityDB::ReplaceTagListAndLocate(
+    const ExtCommunity *src,
+    const ExtCommunity::ExtCommunityList &tag_list) {
+    return ReplaceAndLocate(src, &ExtCommunity::is_tag, tag_list);
+}
+
 ExtCommunityPtr ExtCommunityDB::RemoveSiteOfOriginAndLocate(
         const ExtCommunity *src) {
-    ExtCommunity *clone;
-    if (src) {
-        clone = new ExtCommunity(*src);
-    } else {
-        clone = new ExtCommunity(this);
-    }
-
-    clone->RemoveSiteOfOrigin();
-    return Locate(clone);
+    return RemoveAndLocate(src, &ExtCommunity::is_site_of_origin);
 }
 
 ExtCommunityPtr ExtCommunityDB::ReplaceSiteOfOriginAndLocate(
         const ExtCommunity *src,
         const ExtCommunity::ExtCommunityValue &soo) {
-    ExtCommunity *clone;
-    if (src) {
-        clone = new ExtCommunity(*src);
-    } else {
-        clone = new ExtCommunity(this);
-    }
-
-    clone->RemoveSiteOfOrigin();
-    clone->Append(soo);
-    return Locate(clone);
+    return ReplaceAndLocate(src, &ExtCommunity::is_site_of_origin, soo);
 }
 
 ExtCommunityPtr ExtCommunityDB::RemoveOriginVnAndLocate(
         const ExtCommunity *src) {
-    ExtCommunity *clone;
-    if (src) {
-        clone = new ExtCommunity(*src);
-    } else {
-        clone = new ExtCommunity(this);
-    }
-
-    clone->RemoveOriginVn();
-    return Locate(clone);
+    return RemoveAndLocate(src, &ExtCommunity::is_origin_vn);
 }
 
 ExtCommunityPtr ExtCommunityDB::ReplaceOriginVnAndLocate(
         const ExtCommunity *src,
         const ExtCommunity::ExtCommunityValue &origin_vn) {
-    ExtCommunity *clone;
-    if (src) {
-        clone = new ExtCommunity(*src);
-    } else {
-        clone = new ExtCommunity(this);
-    }
-
-    clone->RemoveOriginVn();
-    clone->Append(origin_vn);
-    return Locate(clone);
+    return ReplaceAndLocate(src, &ExtCommunity::is_origin_vn, origin_vn);
 }
 
 ExtCommunityPtr ExtCommunityDB::ReplaceTunnelEncapsulationAndLocate(
         const ExtCommunity *src,
         const ExtCommunity::ExtCommunityList &tunnel_encaps) {
-    ExtCommunity *clone;
-    if (src) {
-        clone = new ExtCommunity(*src);
-    } else {
-        clone = new ExtCommunity(this);
-    }
-
-    clone->RemoveTunnelEncapsulation();
-    clone->Append(tunnel_encaps);
-    return Locate(clone);
+    return ReplaceAndLocate(src, &ExtCommunity::is_tunnel_encap,
+                            tunnel_encaps);
 }
 
 ExtCommunityPtr ExtCommunityDB::ReplaceLoadBalanceAndLocate(
         const ExtCommunity *src,
         const ExtCommunity::ExtCommunityValue &lb) {
-    ExtCommunity *clone;
-    if (src) {
-        clone = new ExtCommunity(*src);
-    } else {
-        clone = new ExtCommunity(this);
-    }
-
-    clone->RemoveLoadBalance();
-    clone->Append(lb);
-    return Locate(clone);
+    return ReplaceAndLocate(src, &ExtCommunity::is_load_balance, lb);
 }
@@ -48,9 +48,11 @@ public:
     explicit Community(CommunityDB *comm_db)
         : comm_db_(comm_db) {
         refcount_ = 0;
+        UpdateHash();
     }
     explicit Community(const Community &rhs)
-        : comm_db_(rhs.comm_db_), communities_(rhs.communities_) {
+        : comm_db_(rhs.comm_db_), communities_(rhs.communities_),
+          hash_(rhs.hash_) {
         refcount_ = 0;
     }
     explicit Community(CommunityDB *comm_db, const CommunitySpec spec);
@@ -63,16 +65,18 @@ public:
 
     const std::vector<uint32_t> &communities() const { return communities_; }
 
+    //
+    // The hash is computed whenever the list of communities is modified,
+    // so that hashing a BgpAttr doesn't have to walk the whole list.
+    //
     friend std::size_t hash_value(Community const &comm) {
-        size_t hash = 0;
-        boost::hash_range(hash, comm.communities_.begin(),
-                          comm.communities_.end());
-        return hash;
+        return comm.hash_;
     }
 
 private:
     friend int intrusive_ptr_add_ref(const Community *ccomm);
     friend int intrusive_ptr_del_ref(const Community *ccomm);
+    friend bool intrusive_ptr_add_ref_if_live(const Community *ccomm);
     friend void intrusive_ptr_release(const Community *ccomm);
     friend class CommunityDB;
     friend class BgpAttrTest;
@@ -81,10 +85,12 @@ private:
     void Append(const std::vector<uint32_t> &communities);
     void Set(const std::vector<uint32_t> &communities);
     void Remove(const std::vector<uint32_t> &communities);
+    void UpdateHash();
 
     mutable tbb::atomic<int> refcount_;
     CommunityDB *comm_db_;
     std::vector<uint32_t> communities_;
+    size_t hash_;
 };
 
 inline int intrusive_ptr_add_ref(const Community *ccomm) {
@@ -95,6 +101,10 @@ inline int intrusive_ptr_del_ref(const Community *ccomm) {
     return ccomm->refcount_.fetch_and_decrement();
 }
 
+inline bool intrusive_ptr_add_ref_if_live(const Community *ccomm) {
+    return BgpAttrAddRefIfLive(ccomm->refcount_);
+}
+
 inline void intrusive_ptr_release(const Community *ccomm) {
     int prev = ccomm->refcount_.fetch_and_decrement();
     if (prev == 1) {
@@ -149,14 +159,17 @@ class ExtCommunity {
 public:
     typedef boost::array<uint8_t, 8> ExtCommunityValue;
     typedef std::vector<ExtCommunityValue> ExtCommunityList;
+    typedef bool (*ValuePredicate)(const ExtCommunityValue &val);
 
     explicit ExtCommunity(ExtCommunityDB *extcomm_db)
         : extcomm_db_(extcomm_db) {
         refcount_ = 0;
+        UpdateHash();
     }
     explicit ExtCommunity(const ExtCommunity &rhs)
         : extcomm_db_(rhs.extcomm_db_),
-          communities_(rhs.communities_) {
+          communities_(rhs.communities_),
+          hash_(rhs.hash_) {
         refcount_ = 0;
     }
 
@@ -167,6 +180,7 @@ public:
     int CompareTo(const ExtCommunity &rhs) const;
 
     bool ContainsOriginVn(const ExtCommunityValue &val) const;
+    bool ContainsAny(ValuePredicate pred) const;
 
     // Return vector of communities
     const ExtCommunityList &communities() const {
@@ -310,37 +324,31 @@ public:
                (val[1] == BgpExtendedCommunityExperimentalSubType::Tag);
     }
 
+    //
+    // The hash is computed whenever the list of communities is modified,
+    // so that hashing a BgpAttr doesn't have to walk the whole list.
+    //
     friend std::size_t hash_value(ExtCommunity const &comm) {
-        size_t hash = 0;
-        for (ExtCommunityList::const_iterator iter = comm.communities_.begin();
-                iter != comm.communities_.end(); iter++) {
-            boost::hash_range(hash, iter->begin(), iter->end());
-        }
-        return hash;
+        return comm.hash_;
     }
 
 private:
     friend int intrusive_ptr_add_ref(const ExtCommunity *cextcomm);
     friend int intrusive_ptr_del_ref(const ExtCommunity *cextcomm);
+    friend bool intrusive_ptr_add_ref_if_live(const ExtCommunity *cextcomm);
     friend void intrusive_ptr_release(const ExtCommunity *cextcomm);
     friend class ExtCommunityDB;
     friend class BgpAttrTest;
 
     void Append(const ExtCommunityValue &value);
     void Append(const ExtCommunityList &list);
-    void RemoveRTarget();
-    void RemoveSGID();
-    void RemoveTag();
-    void RemoveSiteOfOrigin();
-    void RemoveSourceAS();
-    void RemoveVrfRouteImport();
-    void RemoveOriginVn();
-    void RemoveTunnelEncapsulation();
-    void RemoveLoadBalance();
+    void RemoveIf(ValuePredicate pred);
+    void UpdateHash();
 
     mutable tbb::atomic<int> refcount_;
     ExtCommunityDB *extcomm_db_;
     ExtCommunityList communities_;
+    size_t hash_;
 };
 
 inline int intrusive_ptr_add_ref(const ExtCommunity *cextcomm) {
@@ -351,6 +359,10 @@ inline int intrusive_ptr_del_ref(const ExtCommunity *cextcomm) {
     return cextcomm->refcount_.fetch_and_decrement();
 }
 
+inline bool intrusive_ptr_add_ref_if_live(const ExtCommunity *cextcomm) {
+    return BgpAttrAddRefIfLive(cextcomm->refcount_);
+}
+
 inline void intrusive_ptr_release(const ExtCommunity *cextcomm) {
     int prev = cextcomm->refcount_.fetch_and_decrement();
     if (prev == 1) {
@@ -381,6 +393,20 @@ public:
     ExtCommunityPtr AppendAndLocate(const ExtCommunity *src,
             const ExtCommunity::ExtCommunityValue &value);
 
+    //
+    // Generic set operations on an interned ExtCommunity. The predicate
+    // selects the values to be removed or replaced e.g. one of the static
+    // ExtCommunity::is_xxx methods.
+    //
+    ExtCommunityPtr RemoveAndLocate(const ExtCommunity *src,
+            ExtCommunity::ValuePredicate pred);
+    ExtCommunityPtr ReplaceAndLocate(const ExtCommunity *src,
+            ExtCommunity::ValuePredicate pred,
+            const ExtCommunity::ExtCommunityList &list);
+    ExtCommunityPtr ReplaceAndLocate(const ExtCommunity *src,
+            ExtCommunity::ValuePredicate pred,
+            const ExtCommunity::ExtCommunityValue &value);
+
     ExtCommunityPtr ReplaceRTargetAndLocate(const ExtCommunity *src,
             const ExtCommunity::ExtCommunityList &export_list);
     ExtCommunityPtr ReplaceSGIDListAndLocate(const ExtCommunity *src,
@@ -5,6 +5,7 @@
 #include "bgp/extended-community/load_balance.h"
 
 #include <boost/foreach.hpp>
+#include <string.h>
 
 #include <algorithm>
 #include <string>
@@ -65,6 +66,27 @@ void LoadBalance::LoadBalanceAttribute::Encode(
     lb_type->load_balance_decision = source_bias ? "source-bias" : "field-hash";
 }
 
+//
+// Set the hash field with the given xmpp name. Return false if the name is
+// not recognized.
+//
+bool LoadBalance::LoadBalanceAttribute::SetField(const char *field) {
+    if (strcmp(field, "l3-source-address") == 0) {
+        l3_source_address = true;
+    } else if (strcmp(field, "l3-destination-address") == 0) {
+        l3_destination_address = true;
+    } else if (strcmp(field, "l4-protocol") == 0) {
+        l4_protocol = true;
+    } else if (strcmp(field, "l4-source-port") == 0) {
+        l4_source_port = true;
+    } else if (strcmp(field, "l4-destination-port") == 0) {
+        l4_destination_port = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 bool LoadBalance::LoadBalanceAttribute::operator==(
         const LoadBalance::LoadBalanceAttribute &other) const {
     return value1 == other.value1 && value2 == other.value2;
@@ -133,27 +155,7 @@ LoadBalance::LoadBalance(const autogen::LoadBalanceType &lb_type) {
     for (autogen::LoadBalanceFieldListType::const_iterator it =
             lb_type.load_balance_fields.begin();
             it != lb_type.load_balance_fields.end(); ++it) {
-        const string s = *it;
-        if (s == "l3-source-address") {
-            attr.l3_source_address = true;
-            continue;
-        }
-        if (s == "l3-destination-address") {
-            attr.l3_destination_address = true;
-            continue;
-        }
-        if (s == "l4-protocol") {
-            attr.l4_protocol = true;
-            continue;
-        }
-        if (s == "l4-source-port") {
-            attr.l4_source_port = true;
-            continue;
-        }
-        if (s == "l4-destination-port") {
-            attr.l4_destination_port = true;
-            continue;
-        }
+        attr.SetField(it->c_str());
     }
 
     put_value(&data_[0], 4, attr.value1);
@@ -101,6 +101,7 @@ public:
         LoadBalanceAttribute();
         LoadBalanceAttribute(uint32_t value1, uint32_t value2);
         void Encode(autogen::LoadBalanceType *lb_type) const;
+        bool SetField(const char *field);
         bool operator==(const LoadBalanceAttribute &other) const;
         bool operator!=(const LoadBalanceAttribute &other) const;
         const bool IsDefault() const;
@@ -10,6 +10,7 @@
 
 #include <string>
 
+class ConditionMatchQueueStats;
 class RoutingInstance;
 class ServiceChainConfig;
 class ShowServicechainInfo;
@@ -25,6 +26,9 @@ public:
     virtual size_t ResolvedQueueSize() const = 0;
     virtual uint32_t GetDownServiceChainCount() const = 0;
     virtual bool IsQueueEmpty() const = 0;
+    virtual size_t GetQueueLength() const = 0;
+    virtual size_t GetMaxQueueLength() const = 0;
+    virtual const ConditionMatchQueueStats &queue_stats() const = 0;
     virtual bool FillServiceChainInfo(RoutingInstance *rtinstance,
                                       ShowServicechainInfo *info) const = 0;
     virtual bool IsPending(RoutingInstance *rtinstance,
@@ -5,8 +5,10 @@
 #ifndef SRC_BGP_ROUTING_INSTANCE_ISTATIC_ROUTE_MGR_H_
 #define SRC_BGP_ROUTING_INSTANCE_ISTATIC_ROUTE_MGR_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
+class ConditionMatchQueueStats;
 class RoutingInstance;
 class StaticRouteEntriesInfo;
 
@@ -23,6 +25,9 @@ public:
     virtual uint32_t GetDownRouteCount() const = 0;
     virtual bool FillStaticRouteInfo(RoutingInstance *rtinstance,
                                      StaticRouteEntriesInfo *info) const = 0;
+    virtual size_t GetQueueLength() const = 0;
+    virtual size_t GetMaxQueueLength() const = 0;
+    virtual const ConditionMatchQueueStats &queue_stats() const = 0;
 
 private:
     template <typename U> friend class StaticRouteTest;
@@ -86,8 +86,10 @@ PathResolver::PathResolver(BgpTable *table)
           boost::bind(&PathResolver::ProcessResolverNexthopUpdateList, this),
           TaskScheduler::GetInstance()->GetTaskId("bgp::ResolverNexthop"),
           0)),
+      nexthop_update_lists_(DB::PartitionCount()),
       deleter_(new DeleteActor(this)),
       table_delete_ref_(this, table->deleter()) {
+    nexthop_update_count_ = 0;
     for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
         partitions_.push_back(new PathResolverPartition(part_id, this));
     }
@@ -189,12 +191,19 @@ void PathResolver::RegisterUnregisterResolverNexthop(
 }
 
 //
-// Add a ResolverNexthop to the update list and start the Task to process the
-// list.
+// Add a ResolverNexthop to the update list for the given partition and start
+// the Task to process the lists.
 //
-void PathResolver::UpdateResolverNexthop(ResolverNexthop *rnexthop) {
-    tbb::mutex::scoped_lock lock(mutex_);
-    nexthop_update_list_.insert(rnexthop);
+// The partition is that of the BgpRoute being tracked by the ResolverNexthop
+// and this is called from the db::DBTable Task for the partition. So there's
+// no concurrent access to the update list for a given partition.
+//
+void PathResolver::UpdateResolverNexthop(int part_id,
+    ResolverNexthop *rnexthop) {
+    CHECK_CONCURRENCY("db::DBTable");
+
+    if (nexthop_update_lists_[part_id].insert(rnexthop).second)
+        nexthop_update_count_++;
     nexthop_update_trigger_->Set();
 }
 
@@ -273,7 +282,11 @@ void PathResolver::RemoveResolverNexthop(ResolverNexthop *rnexthop) {
     ResolverNexthopMap::iterator loc = nexthop_map_.find(key);
     assert(loc != nexthop_map_.end());
     nexthop_map_.erase(loc);
-    nexthop_update_list_.erase(rnexthop);
+    for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
+        nexthop_update_count_ -=
+            nexthop_update_lists_[part_id].erase(rnexthop);
+        partitions_[part_id]->RemoveResolverNexthop(rnexthop);
+    }
 }
 
 //
@@ -377,18 +390,22 @@ bool PathResolver::ProcessResolverNexthopRegUnregList() {
 }
 
 //
-// Handle processing of all ResolverNexthops on the update list.
+// Handle processing of all ResolverNexthops on the update lists.
 //
 bool PathResolver::ProcessResolverNexthopUpdateList() {
     CHECK_CONCURRENCY("bgp::ResolverNexthop");
 
-    for (ResolverNexthopList::iterator it = nexthop_update_list_.begin();
-         it != nexthop_update_list_.end(); ++it) {
-        ResolverNexthop *rnexthop = *it;
-        assert(!rnexthop->deleted());
-        rnexthop->TriggerAllResolverPaths();
+    for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
+        ResolverNexthopList &update_list = nexthop_update_lists_[part_id];
+        for (ResolverNexthopList::iterator it = update_list.begin();
+             it != update_list.end(); ++it) {
+            ResolverNexthop *rnexthop = *it;
+            assert(!rnexthop->deleted());
+            rnexthop->TriggerAllResolverPaths();
+        }
+        nexthop_update_count_ -= update_list.size();
+        update_list.clear();
     }
-    nexthop_update_list_.clear();
     return true;
 }
 
@@ -416,7 +433,9 @@ bool PathResolver::MayDelete() const {
         return false;
     if (!nexthop_reg_unreg_list_.empty())
         return false;
-    assert(nexthop_update_list_.empty());
+    for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
+        assert(nexthop_update_lists_[part_id].empty());
+    }
     return true;
 }
 
@@ -497,12 +516,12 @@ void PathResolver::EnableResolverNexthopUpdateProcessing() {
 }
 
 //
-// Get size of the update list.
-// For testing only.
+// Get total size of the update lists.
+// Uses the atomic count since the lists are modified from the db::DBTable
+// Task without holding the mutex.
 //
 size_t PathResolver::GetResolverNexthopUpdateListSize() const {
-    tbb::mutex::scoped_lock lock(mutex_);
-    return nexthop_update_list_.size();
+    return nexthop_update_count_;
 }
 
 //
@@ -569,7 +588,7 @@ void PathResolver::FillShowInfo(ShowPathResolver *spr, bool summary) const {
     for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
         const PathResolverPartition *partition = partitions_[part_id];
         path_count += partition->rpath_map_.size();
-        modified_path_count += partition->rpath_update_list_.size();
+        modified_path_count += partition->GetResolverPathUpdateListSize();
         if (summary)
             continue;
         for (PathResolverPartition::PathToResolverPathMap::const_iterator it =
@@ -587,7 +606,7 @@ void PathResolver::FillShowInfo(ShowPathResolver *spr, bool summary) const {
     spr->set_modified_path_count(modified_path_count);
     spr->set_nexthop_count(nexthop_map_.size());
     spr->set_modified_nexthop_count(nexthop_reg_unreg_list_.size() +
-        nexthop_delete_list_.size() + nexthop_update_list_.size());
+        nexthop_delete_list_.size() + GetResolverNexthopUpdateListSize());
 
     if (summary)
         return;
@@ -636,6 +655,7 @@ PathResolverPartition::PathResolverPartition(int part_id,
 //
 PathResolverPartition::~PathResolverPartition() {
     assert(rpath_update_list_.empty());
+    assert(rnexthop_update_list_.empty());
     rpath_update_trigger_->Reset();
 }
 
@@ -711,6 +731,18 @@ void PathResolverPartition::TriggerPathResolution(ResolverPath *rpath) {
     rpath_update_trigger_->Set();
 }
 
+//
+// Add a ResolverNexthop to the nexthop update list and start Task to process
+// the list. All dependent ResolverPaths in this partition get added to the
+// update list when the Task runs.
+//
+void PathResolverPartition::TriggerPathResolution(ResolverNexthop *rnexthop) {
+    CHECK_CONCURRENCY("bgp::ResolverNexthop");
+
+    rnexthop_update_list_.insert(rnexthop);
+    rpath_update_trigger_->Set();
+}
+
 //
 // Add a ResolverPath to the update list and start Task to process the list.
 // This is used to defer re-evaluation of the ResolverPath when the update
@@ -767,12 +799,40 @@ ResolverPath *PathResolverPartition::RemoveResolverPath(const BgpPath *path) {
     }
 }
 
+//
+// Remove the ResolverNexthop from the nexthop update list.
+// Called when the ResolverNexthop is removed from the PathResolver.
+//
+void PathResolverPartition::RemoveResolverNexthop(ResolverNexthop *rnexthop) {
+    CHECK_CONCURRENCY("bgp::Config");
+
+    rnexthop_update_list_.erase(rnexthop);
+}
+
+//
+// Add all ResolverPaths in this partition that depend on the ResolverNexthops
+// on the nexthop update list to the update list.
+//
+void PathResolverPartition::ProcessResolverNexthopUpdateList() {
+    CHECK_CONCURRENCY("bgp::ResolverPath");
+
+    for (ResolverNexthopList::iterator it = rnexthop_update_list_.begin();
+         it != rnexthop_update_list_.end(); ++it) {
+        const ResolverNexthop *rnexthop = *it;
+        const ResolverPathList &rpath_list = rnexthop->rpath_list(part_id_);
+        rpath_update_list_.insert(rpath_list.begin(), rpath_list.end());
+    }
+    rnexthop_update_list_.clear();
+}
+
 //
 // Handle processing of all ResolverPaths on the update list.
 //
 bool PathResolverPartition::ProcessResolverPathUpdateList() {
     CHECK_CONCURRENCY("bgp::ResolverPath");
 
+    ProcessResolverNexthopUpdateList();
+
     ResolverPathList update_list;
     rpath_update_list_.swap(update_list);
     for (ResolverPathList::iterator it = update_list.begin();
@@ -818,11 +878,21 @@ void PathResolverPartition::ResumeResolverPathUpdateProcessing() {
 }
 
 //
-// Get size of the update list.
-// For testing only.
+// Get size of the update list, including ResolverPaths that depend on the
+// ResolverNexthops on the nexthop update list.
 //
 size_t PathResolverPartition::GetResolverPathUpdateListSize() const {
-    return rpath_update_list_.size();
+    if (rnexthop_update_list_.empty())
+        return rpath_update_list_.size();
+
+    ResolverPathList update_list(rpath_update_list_);
+    for (ResolverNexthopList::const_iterator it = rnexthop_update_list_.begin();
+         it != rnexthop_update_list_.end(); ++it) {
+        const ResolverNexthop *rnexthop = *it;
+        const ResolverPathList &rpath_list = rnexthop->rpath_list(part_id_);
+        update_list.insert(rpath_list.begin(), rpath_list.end());
+    }
+    return update_list.size();
 }
 
 //
@@ -1147,7 +1217,8 @@ bool ResolverNexthop::Match(BgpServer *server, BgpTable *table,
         return false;
 
     // Trigger re-evaluation of all dependent ResolverPaths.
-    resolver_->UpdateResolverNexthop(this);
+    resolver_->UpdateResolverNexthop(route->get_table_partition()->index(),
+        this);
     return true;
 }
 
@@ -1204,15 +1275,17 @@ ResolverRouteState *ResolverNexthop::GetResolverRouteState() {
 // the ResolverNexthop. Actual update of the resolved BgpPaths happens when
 // the PathResolverPartitions process their update lists.
 //
-void ResolverNexthop::TriggerAllResolverPaths() const {
+// The ResolverNexthop is handed off to the PathResolverPartitions instead of
+// enqueueing the ResolverPaths individually. The partitions then enqueue the
+// dependent ResolverPaths concurrently.
+//
+void ResolverNexthop::TriggerAllResolverPaths() {
     CHECK_CONCURRENCY("bgp::ResolverNexthop");
 
     for (int part_id = 0; part_id < DB::PartitionCount(); ++part_id) {
-        for (ResolverPathList::iterator it = rpath_lists_[part_id].begin();
-             it != rpath_lists_[part_id].end(); ++it) {
-            ResolverPath *rpath = *it;
-            resolver_->GetPartition(part_id)->TriggerPathResolution(rpath);
-        }
+        if (rpath_lists_[part_id].empty())
+            continue;
+        resolver_->GetPartition(part_id)->TriggerPathResolution(this);
     }
 }
 
@@ -6,6 +6,7 @@
 #define SRC_BGP_ROUTING_INSTANCE_PATH_RESOLVER_H_
 
 #include <boost/scoped_ptr.hpp>
+#include <tbb/atomic.h>
 #include <tbb/mutex.h>
 #include <tbb/spin_rw_mutex.h>
 
@@ -52,11 +53,18 @@ class TaskTrigger;
 //
 // The nexthop map keeps track of all ResolverNexthop for this instance. In
 // addition, a given ResolverNexthop may be on the register/unregister list
-// and the update list. Entries are added to the map and the lists from the
-// db::DBTable Task. A mutex is used to serialize updates to the map and the
-// lists. Note that there's no no concurrent access when entries are removed
-// from the map and the lists, since the remove operations happen from Tasks
-// that are mutually exclusive.
+// and the update lists. Entries are added to the map and the register list
+// from the db::DBTable Task. A mutex is used to serialize updates to the map
+// and the register/unregister list. Note that there's no concurrent access
+// when entries are removed from the map and the lists, since the remove
+// operations happen from Tasks that are mutually exclusive.
+//
+// There's one update list per DB partition. A ResolverNexthop is added to
+// the update list for the partition of the BgpRoute that it tracks, from the
+// db::DBTable Task for that partition. Hence the update lists don't need to
+// be protected by the mutex. An atomic count of entries on all the update
+// lists is maintained so that the total can be read from other Tasks e.g.
+// bgp::ShowCommand, without looking at the lists.
 //
 // The register/unregister list is processed in the context of bgp::Config
 // Task. ResolverNexthops are added to this list when we need to add/remove
@@ -71,9 +79,13 @@ class TaskTrigger;
 // erased from the delete list and unregistered from BgpConditionListener
 // after the list is processed again.
 //
-// The update list is processed in the context of bgp::ResolverNexthop Task.
-// When an entry on this list is processed all it's dependent ResolverPaths
-// are queued for re-evaluation in the PathResolverPartition.
+// The update lists are processed in the context of bgp::ResolverNexthop Task.
+// Changes to the same ResolverNexthop are coalesced since the lists are sets.
+// When an entry on a list is processed, the ResolverNexthop is handed off to
+// each PathResolverPartition that has dependent ResolverPaths. The partition
+// queues the dependent ResolverPaths for re-evaluation itself, so that work
+// proportional to the number of dependent ResolverPaths is done in parallel
+// in all the partitions rather than serially in bgp::ResolverNexthop Task.
 //
 // Concurrency Notes:
 //
@@ -129,7 +141,7 @@ private:
 
     ResolverNexthop *LocateResolverNexthop(IpAddress address, BgpTable *table);
     void RemoveResolverNexthop(ResolverNexthop *rnexthop);
-    void UpdateResolverNexthop(ResolverNexthop *rnexthop);
+    void UpdateResolverNexthop(int part_id, ResolverNexthop *rnexthop);
     void RegisterUnregisterResolverNexthop(ResolverNexthop *rnexthop);
 
     void UnregisterResolverNexthopDone(BgpTable *table, ConditionMatch *match);
@@ -162,7 +174,8 @@ private:
     ResolverNexthopMap nexthop_map_;
     ResolverNexthopList nexthop_reg_unreg_list_;
     boost::scoped_ptr<TaskTrigger> nexthop_reg_unreg_trigger_;
-    ResolverNexthopList nexthop_update_list_;
+    std::vector<ResolverNexthopList> nexthop_update_lists_;
+    tbb::atomic<size_t> nexthop_update_count_;
     boost::scoped_ptr<TaskTrigger> nexthop_update_trigger_;
     ResolverNexthopList nexthop_delete_list_;
     std::vector<PathResolverPartition *> partitions_;
@@ -183,6 +196,12 @@ private:
 // ResolverPath class. The list is processed in context of bgp::ResolverPath
 // Task with the partition index as the Task instance id. This allows all the
 // PathResolverPartitions to work concurrently.
+//
+// The nexthop update list contains ResolverNexthops that have changed. All
+// the ResolverPaths in this partition that depend on them are added to the
+// update list before it gets processed. This is done in bgp::ResolverPath
+// Task so that the potentially large number of dependent ResolverPaths for
+// a ResolverNexthop are queued by all partitions in parallel.
 
 // Mutual exclusion of db::DBTable and bgp::ResolverPath Tasks ensures that
 // it's safe to add/delete/update resolved BgpPaths from the bgp::ResolverPath
@@ -203,6 +222,7 @@ public:
     void StopPathResolution(const BgpPath *path);
 
     void TriggerPathResolution(ResolverPath *rpath);
+    void TriggerPathResolution(ResolverNexthop *rnexthop);
     void DeferPathResolution(ResolverPath *rpath);
 
     int part_id() const { return part_id_; }
@@ -218,11 +238,14 @@ private:
 
     typedef std::map<const BgpPath *, ResolverPath *> PathToResolverPathMap;
     typedef std::set<ResolverPath *> ResolverPathList;
+    typedef std::set<ResolverNexthop *> ResolverNexthopList;
 
     ResolverPath *CreateResolverPath(const BgpPath *path, BgpRoute *route,
         ResolverNexthop *rnexthop);
     ResolverPath *FindResolverPath(const BgpPath *path);
     ResolverPath *RemoveResolverPath(const BgpPath *path);
+    void RemoveResolverNexthop(ResolverNexthop *rnexthop);
+    void ProcessResolverNexthopUpdateList();
     bool ProcessResolverPathUpdateList();
 
     void DisableResolverPathUpdateProcessing();
@@ -235,6 +258,7 @@ private:
     PathResolver *resolver_;
     PathToResolverPathMap rpath_map_;
     ResolverPathList rpath_update_list_;
+    ResolverNexthopList rnexthop_update_list_;
     boost::scoped_ptr<TaskTrigger> rpath_update_trigger_;
 
     DISALLOW_COPY_AND_ASSIGN(PathResolverPartition);
@@ -359,7 +383,9 @@ private:
 // the IP address being tracked, the ResolverNexthop is added to the update
 // list in the PathResolver. The PathResolver processes the entries in this
 // list in the context of the bgp::ResolverNexthop Task. The action is to
-// trigger re-evaluation of all ResolverPaths that use the ResolverNexthop.
+// trigger re-evaluation of all ResolverPaths that use the ResolverNexthop,
+// which is done by handing off the ResolverNexthop to each partition with
+// dependent ResolverPaths.
 //
 // When the last ResolverPath in a partition using a ResolverNexthop gets
 // removed, the ResolverNexthop is added to the registration/unregistration
@@ -386,6 +412,8 @@ private:
 //
 class ResolverNexthop : public ConditionMatch {
 public:
+    typedef std::set<ResolverPath *> ResolverPathList;
+
     ResolverNexthop(PathResolver *resolver, IpAddress address, BgpTable *table);
     virtual ~ResolverNexthop();
 
@@ -396,7 +424,10 @@ public:
     void RemoveResolverPath(int part_id, ResolverPath *rpath);
     ResolverRouteState *GetResolverRouteState();
 
-    void TriggerAllResolverPaths() const;
+    void TriggerAllResolverPaths();
+    const ResolverPathList &rpath_list(int part_id) const {
+        return rpath_lists_[part_id];
+    }
 
     void ManagedDelete() { }
 
@@ -409,8 +440,6 @@ public:
     void set_registered() { registered_ = true; }
 
 private:
-    typedef std::set<ResolverPath *> ResolverPathList;
-
     PathResolver *resolver_;
     IpAddress address_;
     BgpTable *table_;
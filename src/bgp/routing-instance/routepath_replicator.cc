@@ -19,6 +19,7 @@
 #include "bgp/routing-instance/routing_instance.h"
 #include "bgp/routing-instance/rtarget_group_mgr.h"
 #include "bgp/routing-instance/routing_instance_analytics_types.h"
+#include "db/db.h"
 
 using std::ostringstream;
 using std::make_pair;
@@ -170,11 +171,23 @@ RoutePathReplicator::RoutePathReplicator(BgpServer *server,
     : server_(server),
       family_(family),
       vpn_table_(NULL),
+      rtarget_trigger_lists_(DB::PartitionCount()),
       trace_buf_(SandeshTraceBufferCreate("RoutePathReplicator", 500)) {
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    for (int idx = 0; idx < DB::PartitionCount(); ++idx) {
+        rtarget_triggers_.push_back(boost::shared_ptr<TaskTrigger>(
+            new TaskTrigger(
+                boost::bind(&RoutePathReplicator::ProcessRouteTargetList,
+                    this, idx),
+                scheduler->GetTaskId("db::DBTable"), idx)));
+    }
 }
 
 RoutePathReplicator::~RoutePathReplicator() {
     assert(table_state_list_.empty());
+    for (int idx = 0; idx < DB::PartitionCount(); ++idx) {
+        rtarget_triggers_[idx]->Reset();
+    }
 }
 
 void RoutePathReplicator::Initialize() {
@@ -288,6 +301,70 @@ void RoutePathReplicator::LeaveVpnTable(RtGroup *group) {
     RemoveTableState(vpn_table_, group);
 }
 
+//
+// Enqueue the RouteTarget for processing of dependent VPN routes in all
+// partitions.
+//
+void RoutePathReplicator::AddRouteTargetToLists(const RouteTarget &rtarget) {
+    CHECK_CONCURRENCY("bgp::Config", "bgp::ConfigHelper");
+    for (int idx = 0; idx < DB::PartitionCount(); ++idx) {
+        rtarget_trigger_lists_[idx].insert(rtarget);
+        rtarget_triggers_[idx]->Set();
+    }
+}
+
+//
+// Notify VPN routes that depend on the RouteTargets in the
+// RouteTargetTriggerList for the partition, so that their replication gets
+// re-evaluated.
+//
+// The dependent routes for a RouteTarget include routes from the VPN tables
+// of all families, so only the ones in our VPN table are notified. A route
+// with multiple RouteTargets on the list is put on the change list once.
+//
+bool RoutePathReplicator::ProcessRouteTargetList(int part_id) {
+    CHECK_CONCURRENCY("db::DBTable");
+
+    RouteTargetTriggerList *rtarget_list = &rtarget_trigger_lists_[part_id];
+    if (!FindTableState(vpn_table_)) {
+        rtarget_list->clear();
+        return true;
+    }
+
+    RTargetGroupMgr *rtgroup_mgr = server()->rtarget_group_mgr();
+    BOOST_FOREACH(const RouteTarget &rtarget, *rtarget_list) {
+        RtGroup *group = rtgroup_mgr->GetRtGroup(rtarget);
+        if (!group)
+            continue;
+        group->NotifyDepRoutes(part_id, vpn_table_);
+    }
+    rtarget_list->clear();
+    return true;
+}
+
+void RoutePathReplicator::DisableRouteTargetProcessing() {
+    for (int idx = 0; idx < DB::PartitionCount(); ++idx) {
+        rtarget_triggers_[idx]->set_disable();
+    }
+}
+
+void RoutePathReplicator::EnableRouteTargetProcessing() {
+    for (int idx = 0; idx < DB::PartitionCount(); ++idx) {
+        rtarget_triggers_[idx]->set_enable();
+    }
+}
+
+bool RoutePathReplicator::IsRouteTargetOnList(
+    const RouteTarget &rtarget) const {
+    for (int idx = 0; idx < DB::PartitionCount(); ++idx) {
+        if (rtarget_trigger_lists_[idx].find(rtarget) !=
+            rtarget_trigger_lists_[idx].end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 //
 // Add a given BgpTable to RtGroup of given RouteTarget.
 // It will create a new RtGroup if none exists.
@@ -305,7 +382,7 @@ void RoutePathReplicator::Join(BgpTable *table, const RouteTarget &rt,
     if (import) {
         first = group->AddImportTable(family(), table);
         if (group->HasDepRoutes())
-            server()->rtarget_group_mgr()->NotifyRtGroup(rt);
+            AddRouteTargetToLists(rt);
         if (family_ == Address::INETVPN)
             server_->NotifyAllStaticRoutes();
         BOOST_FOREACH(BgpTable *sec_table, group->GetExportTables(family())) {
@@ -343,7 +420,7 @@ void RoutePathReplicator::Leave(BgpTable *table, const RouteTarget &rt,
     if (import) {
         group->RemoveImportTable(family(), table);
         if (group->HasDepRoutes())
-            server()->rtarget_group_mgr()->NotifyRtGroup(rt);
+            AddRouteTargetToLists(rt);
         if (family_ == Address::INETVPN)
             server_->NotifyAllStaticRoutes();
         BOOST_FOREACH(BgpTable *sec_table, group->GetExportTables(family())) {
@@ -6,6 +6,7 @@
 #define SRC_BGP_ROUTING_INSTANCE_ROUTEPATH_REPLICATOR_H_
 
 #include <boost/ptr_container/ptr_map.hpp>
+#include <boost/shared_ptr.hpp>
 #include <sandesh/sandesh_trace.h>
 #include <tbb/mutex.h>
 
@@ -18,6 +19,7 @@
 #include "base/lifetime.h"
 #include "base/util.h"
 #include "bgp/bgp_path.h"
+#include "bgp/rtarget/rtarget_address.h"
 #include "db/db_entry.h"
 #include "db/db_table.h"
 
@@ -26,7 +28,7 @@ class BgpServer;
 class BgpTable;
 class RtGroup;
 class RoutePathReplicator;
-class RouteTarget;
+class TaskTrigger;
 
 //
 // This keeps track of a RoutePathReplicator's listener state for a BgpTable.
@@ -212,9 +214,14 @@ private:
 //    list of tables that export a target is maintained in the RTargetGroupMgr.
 //    This list is updated by the replicator (by calling RTargetGroupMgr APIs)
 //    based on configuration changes in the routing instance.
-// 3. When an import target is added to or removed from a VRF tables, walk all
-//    VPN routes with the target in question.  This dependency is maintained
-//    by RTargetGroupMgr.
+// 3. When an import target is added to or removed from a VRF tables, evaluate
+//    all VPN routes with the target in question.  This dependency is
+//    maintained by RTargetGroupMgr as a per partition list of VPN routes for
+//    each RouteTarget. The target is added to the RouteTargetTriggerList for
+//    each partition and the dependent routes in the VPN table are notified
+//    from the db::DBTable task for the partition. This avoids walking the
+//    entire VPN table and dependent routes in the VPN tables of the other
+//    families.
 // 4. When a route is updated, calculate new set of secondary paths by going
 //    through all VRF tables that import one of the targets for the route in
 //    question.  The list of VRF tables is obtained from the RTargetGroupMgr.
@@ -232,6 +239,13 @@ private:
 // TableState. Requests are enqueued from the db::DBTable task when a table
 // walk finishes and the TableState is empty.
 //
+// The RouteTargetTriggerLists keep track of import targets whose dependent
+// VPN routes need to be re-evaluated, one list per DB partition. The lists
+// are updated from the bgp::Config or bgp::ConfigHelper tasks and processed
+// concurrently from the db::DBTable tasks, which are mutually exclusive with
+// the former. Multiple changes to the same target or to different targets
+// with common dependent routes are absorbed before the routes are evaluated.
+//
 // A mutex is used to serialize access from multiple bgp::ConfigHelper tasks.
 //
 class RoutePathReplicator {
@@ -255,6 +269,7 @@ private:
 
     typedef std::map<BgpTable *, TableState *> TableStateList;
     typedef std::set<BgpTable *> UnregTableList;
+    typedef std::set<RouteTarget> RouteTargetTriggerList;
 
     void RequestWalk(BgpTable *table);
     void BulkReplicationDone(DBTableBase *dbtable);
@@ -270,6 +285,12 @@ private:
     void JoinVpnTable(RtGroup *group);
     void LeaveVpnTable(RtGroup *group);
 
+    void AddRouteTargetToLists(const RouteTarget &rtarget);
+    bool ProcessRouteTargetList(int part_id);
+    void DisableRouteTargetProcessing();
+    void EnableRouteTargetProcessing();
+    bool IsRouteTargetOnList(const RouteTarget &rtarget) const;
+
     bool RouteListener(TableState *ts, DBTablePartBase *root,
                        DBEntryBase *entry);
     void DeleteSecondaryPath(BgpTable  *table, BgpRoute *rt,
@@ -287,6 +308,8 @@ private:
     TableStateList table_state_list_;
     Address::Family family_;
     BgpTable *vpn_table_;
+    std::vector<RouteTargetTriggerList> rtarget_trigger_lists_;
+    std::vector<boost::shared_ptr<TaskTrigger> > rtarget_triggers_;
     SandeshTraceBufferPtr trace_buf_;
 
     DISALLOW_COPY_AND_ASSIGN(RoutePathReplicator);
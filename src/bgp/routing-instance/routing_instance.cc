@@ -11,6 +11,7 @@
 #include "base/set_util.h"
 #include "base/task_annotations.h"
 #include "base/task_trigger.h"
+#include "base/time_util.h"
 #include "bgp/bgp_config.h"
 #include "bgp/bgp_factory.h"
 #include "bgp/bgp_log.h"
@@ -61,6 +62,8 @@ RoutingInstanceMgr::RoutingInstanceMgr(BgpServer *server) :
         server_(server),
         instance_config_lists_(
             TaskScheduler::GetInstance()->HardwareThreadCount()),
+        instance_config_stats_(
+            TaskScheduler::GetInstance()->HardwareThreadCount()),
         default_rtinstance_(NULL),
         deleted_count_(0),
         asn_listener_id_(server->RegisterASNUpdateCallback(
@@ -323,19 +326,38 @@ bool RoutingInstanceMgr::ProcessInstanceConfigList(int idx) {
     if (deleted()) {
         deleter()->RetryDelete();
     } else {
+        uint64_t start = UTCTimestampUsec();
+        uint64_t skipped = 0;
         BOOST_FOREACH(const string &name, instance_config_lists_[idx]) {
             const BgpInstanceConfig *config =
                 server()->config_manager()->FindInstance(name);
-            if (!config)
+            if (!config) {
+                skipped++;
                 continue;
+            }
             LocateRoutingInstance(config);
         }
+        instance_config_stats_[idx].Update(start, UTCTimestampUsec(),
+            instance_config_lists_[idx].size() - skipped, skipped);
     }
 
     instance_config_lists_[idx].clear();
     return true;
 }
 
+//
+// Aggregate the stats for all the bgp::ConfigHelper tasks. Note that the
+// busy time is the sum across all tasks and could exceed the elapsed time.
+//
+BgpConfigPhaseStats RoutingInstanceMgr::GetInstanceConfigStats() const {
+    BgpConfigPhaseStats stats;
+    BOOST_FOREACH(const BgpConfigPhaseStats &idx_stats,
+                  instance_config_stats_) {
+        stats.Merge(idx_stats);
+    }
+    return stats;
+}
+
 RoutingInstance *RoutingInstanceMgr::GetDefaultRoutingInstance() {
     return default_rtinstance_;
 }
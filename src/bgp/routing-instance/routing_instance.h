@@ -370,6 +370,7 @@ public:
     bool DeleteVirtualNetworkMapping(const std::string &virtual_network,
                                      const std::string &instance_name);
     uint32_t SendTableStatsUve();
+    BgpConfigPhaseStats GetInstanceConfigStats() const;
 
 private:
     friend class BgpConfigTest;
@@ -402,6 +403,7 @@ private:
     mutable tbb::mutex mutex_;
     std::vector<RoutingInstanceConfigList> instance_config_lists_;
     std::vector<TaskTrigger *> instance_config_triggers_;
+    std::vector<BgpConfigPhaseStats> instance_config_stats_;
     RoutingInstanceConfigList neighbor_config_list_;
     boost::scoped_ptr<TaskTrigger> neighbor_config_trigger_;
     RoutingInstance *default_rtinstance_;
@@ -119,6 +119,15 @@ void RtGroup::NotifyDepRoutes(int part_id) {
     }
 }
 
+void RtGroup::NotifyDepRoutes(int part_id, const BgpTable *table) {
+    BOOST_FOREACH(BgpRoute *route, dep_[part_id]) {
+        if (route->get_table() != table)
+            continue;
+        DBTablePartBase *dbpart = route->get_table_partition();
+        dbpart->Notify(route);
+    }
+}
+
 bool RtGroup::HasDepRoutes() const {
     for (RTargetDepRouteList::const_iterator it = dep_.begin();
          it != dep_.end(); ++it) {
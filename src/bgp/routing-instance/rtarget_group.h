@@ -85,6 +85,7 @@ public:
     void AddDepRoute(int part_id, BgpRoute *rt);
     void RemoveDepRoute(int part_id, BgpRoute *rt);
     void NotifyDepRoutes(int part_id);
+    void NotifyDepRoutes(int part_id, const BgpTable *table);
     bool HasDepRoutes() const;
 
     const RtGroupInterestedPeerSet &GetInterestedPeers() const;
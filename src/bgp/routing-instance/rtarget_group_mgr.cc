@@ -8,6 +8,7 @@
 #include <utility>
 
 #include "base/map_util.h"
+#include "base/parse_object.h"
 #include "base/set_util.h"
 #include "base/task_annotations.h"
 #include "base/task_trigger.h"
@@ -54,6 +55,79 @@ void RTargetState::DeleteInterestedPeer(RTargetGroupMgr *mgr, RtGroup *rtgroup,
     list_.erase(it);
 }
 
+const size_t RTargetInterestIndex::kMinBits;
+const size_t RTargetInterestIndex::kBitsPerRouteTarget;
+
+RTargetInterestIndex::RTargetInterestIndex()
+    : valid_(false), enabled_(false), generation_(0), mask_(0) {
+}
+
+bool RTargetInterestIndex::IsCurrent(uint64_t generation,
+    const BitSet &peerset) const {
+    return valid_ && generation_ == generation && peerset_ == peerset;
+}
+
+void RTargetInterestIndex::Reset(uint64_t generation, const BitSet &peerset,
+    bool enabled, size_t rtarget_count) {
+    valid_ = true;
+    enabled_ = enabled;
+    generation_ = generation;
+    peerset_ = peerset;
+    size_t bit_count = kMinBits;
+    while (bit_count < rtarget_count * kBitsPerRouteTarget) {
+        bit_count <<= 1;
+    }
+    bits_.assign(bit_count / 64, 0);
+    mask_ = bit_count - 1;
+}
+
+//
+// Mix all bits of the RouteTarget so that the two halves of the result can
+// be used as independent hash values.
+//
+uint64_t RTargetInterestIndex::Hash(
+    const RouteTarget::bytes_type &rtarget) const {
+    uint64_t value = get_value(rtarget.data(), RouteTarget::kSize);
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+void RTargetInterestIndex::Add(const RouteTarget::bytes_type &rtarget) {
+    uint64_t value = Hash(rtarget);
+    size_t bit1 = value & mask_;
+    size_t bit2 = (value >> 32) & mask_;
+    bits_[bit1 / 64] |= 1ULL << (bit1 % 64);
+    bits_[bit2 / 64] |= 1ULL << (bit2 % 64);
+}
+
+bool RTargetInterestIndex::Test(const RouteTarget::bytes_type &rtarget) const {
+    uint64_t value = Hash(rtarget);
+    size_t bit1 = value & mask_;
+    size_t bit2 = (value >> 32) & mask_;
+    return (bits_[bit1 / 64] & (1ULL << (bit1 % 64))) &&
+        (bits_[bit2 / 64] & (1ULL << (bit2 % 64)));
+}
+
+//
+// Return false if none of the peers in the RibOut can be interested in any
+// of the RouteTargets in the ExtCommunity.
+//
+bool RTargetInterestIndex::MayBeInterested(
+    const ExtCommunity *ext_community) const {
+    if (!enabled_)
+        return true;
+    BOOST_FOREACH(const ExtCommunity::ExtCommunityValue &comm,
+                  ext_community->communities()) {
+        if (ExtCommunity::is_route_target(comm) && Test(comm))
+            return true;
+    }
+    return false;
+}
+
 RTargetGroupMgr::RTargetGroupMgr(BgpServer *server) : server_(server),
     rtarget_route_trigger_(new TaskTrigger(
            boost::bind(&RTargetGroupMgr::ProcessRTargetRouteList, this),
@@ -69,6 +143,7 @@ RTargetGroupMgr::RTargetGroupMgr(BgpServer *server) : server_(server),
                                        this, i),
                TaskScheduler::GetInstance()->GetTaskId("db::DBTable"), i)));
     }
+    interest_generation_ = 0;
 }
 
 void RTargetGroupMgr::RTargetPeerSync(BgpTable *table, RTargetRoute *rt,
@@ -91,6 +166,7 @@ void RTargetGroupMgr::RTargetPeerSync(BgpTable *table, RTargetRoute *rt,
         delete dbstate;
         RemoveRtGroup(rtarget);
     }
+    interest_generation_++;
 }
 
 void RTargetGroupMgr::BuildRTargetDistributionGraph(BgpTable *table,
@@ -393,12 +469,6 @@ void RTargetGroupMgr::NotifyRtGroupUnlocked(const RouteTarget &rt) {
     }
 }
 
-void RTargetGroupMgr::NotifyRtGroup(const RouteTarget &rt) {
-    CHECK_CONCURRENCY("bgp::Config", "bgp::ConfigHelper");
-    tbb::mutex::scoped_lock lock(mutex_);
-    NotifyRtGroupUnlocked(rt);
-}
-
 void RTargetGroupMgr::RemoveRtGroup(const RouteTarget &rt) {
     tbb::mutex::scoped_lock lock(mutex_);
     RtGroupMap::iterator loc = rtgroup_map_.find(rt);
@@ -437,6 +507,54 @@ void RTargetGroupMgr::GetRibOutInterestedPeers(RibOut *ribout,
     }
 }
 
+//
+// Build the RTargetInterestIndex for the RibOut.
+//
+// Called from the db::DBTable task. The InterestedPeerLists of the RtGroups
+// are only modified from the bgp::RTFilter task, which is mutually exclusive
+// with db::DBTable. The mutex protects the RtGroupMap itself since RtGroups
+// can get added from other db::DBTable tasks.
+//
+void RTargetGroupMgr::BuildInterestIndex(RibOut *ribout,
+    RTargetInterestIndex *index) {
+    CHECK_CONCURRENCY("db::DBTable");
+
+    uint64_t generation = interest_generation_;
+    const RibPeerSet &peerset = ribout->PeerSet();
+    RtGroupInterestedPeerSet ribout_peers;
+    bool enabled = true;
+    RibOut::PeerIterator iter(ribout, peerset);
+    while (iter.HasNext()) {
+        BgpPeer *peer = dynamic_cast<BgpPeer *>(iter.Next());
+        if (!peer || !peer->IsFamilyNegotiated(Address::RTARGET)) {
+            enabled = false;
+            break;
+        }
+        ribout_peers.set(peer->GetIndex());
+    }
+
+    std::vector<const RouteTarget *> rtargets;
+    tbb::mutex::scoped_lock lock(mutex_);
+    for (RtGroupMap::const_iterator it = rtgroup_map_.begin();
+         enabled && it != rtgroup_map_.end(); ++it) {
+        const RtGroup *rtgroup = it->second;
+        if (!rtgroup->GetInterestedPeers().intersects(ribout_peers))
+            continue;
+        if (it->first.IsNull()) {
+            enabled = false;
+            break;
+        }
+        rtargets.push_back(&it->first);
+    }
+
+    index->Reset(generation, peerset, enabled, rtargets.size());
+    if (!enabled)
+        return;
+    BOOST_FOREACH(const RouteTarget *rtarget, rtargets) {
+        index->Add(rtarget->GetExtCommunity());
+    }
+}
+
 void RTargetGroupMgr::UnregisterTables() {
     CHECK_CONCURRENCY("bgp::RTFilter");
 
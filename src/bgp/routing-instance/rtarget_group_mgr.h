@@ -103,6 +103,54 @@ private:
     RtGroup::InterestedPeerList list_;
 };
 
+//
+// Summary of the RouteTargets that the peers in a RibOut are interested in.
+// BgpExport uses it to skip export processing for a VPN route when none of
+// the peers in the RibOut want any of its RouteTargets. That is the case
+// where GetRibOutInterestedPeers would return an empty peer set.
+//
+// The summary is a bloom filter with two hash functions, sized based on the
+// number of RouteTargets. A route that hits in the filter goes through the
+// regular export processing, so false positives only cost performance. The
+// filter is disabled if any peer in the RibOut hasn't negotiated the RTARGET
+// family or is interested in the null RouteTarget, since such peers get all
+// routes.
+//
+// The index is rebuilt when the interest generation of the RTargetGroupMgr
+// or the set of peers in the RibOut changes. BgpExport keeps an index per DB
+// partition so that it can be used without locking from db::DBTable tasks.
+//
+class RTargetInterestIndex {
+public:
+    static const size_t kMinBits = 1024;
+    static const size_t kBitsPerRouteTarget = 8;
+
+    RTargetInterestIndex();
+
+    bool IsCurrent(uint64_t generation, const BitSet &peerset) const;
+    bool enabled() const { return enabled_; }
+    bool MayBeInterested(const ExtCommunity *ext_community) const;
+    size_t bit_count() const { return bits_.size() * 64; }
+
+private:
+    friend class RTargetGroupMgr;
+
+    void Reset(uint64_t generation, const BitSet &peerset, bool enabled,
+        size_t rtarget_count);
+    void Add(const RouteTarget::bytes_type &rtarget);
+    bool Test(const RouteTarget::bytes_type &rtarget) const;
+    uint64_t Hash(const RouteTarget::bytes_type &rtarget) const;
+
+    bool valid_;
+    bool enabled_;
+    uint64_t generation_;
+    BitSet peerset_;
+    std::vector<uint64_t> bits_;
+    size_t mask_;
+
+    DISALLOW_COPY_AND_ASSIGN(RTargetInterestIndex);
+};
+
 struct RtGroupMgrReq {
     enum RequestType {
         SHOW_RTGROUP,
@@ -203,6 +251,10 @@ private:
 // with the bgp::RTFilter task, it is guaranteed that a RouteTargetTriggerList
 // does not get modified while it's being processed.
 //
+// The interest generation is incremented whenever an RTargetRoute has been
+// processed in the bgp::RTFilter task. It tells users of RTargetInterestIndex
+// that the index may be out of date.
+//
 class RTargetGroupMgr {
 public:
     typedef boost::ptr_map<const RouteTarget, RtGroup> RtGroupMap;
@@ -223,12 +275,13 @@ public:
     RtGroup *GetRtGroup(const ExtCommunity::ExtCommunityValue &comm);
     RtGroup *LocateRtGroup(const RouteTarget &rt);
     void NotifyRtGroupUnlocked(const RouteTarget &rt);
-    void NotifyRtGroup(const RouteTarget &rt);
     void RemoveRtGroup(const RouteTarget &rt);
 
     virtual void GetRibOutInterestedPeers(RibOut *ribout,
              const ExtCommunity *ext_community,
              const RibPeerSet &peerset, RibPeerSet *new_peerset);
+    void BuildInterestIndex(RibOut *ribout, RTargetInterestIndex *index);
+    uint64_t interest_generation() const { return interest_generation_; }
     void Enqueue(RtGroupMgrReq *req);
     void Initialize();
     void ManagedDelete();
@@ -288,6 +341,7 @@ private:
     RTargetRouteTriggerList rtarget_route_list_;
     std::vector<RouteTargetTriggerList> rtarget_trigger_lists_;
     RtGroupRemoveList rtgroup_remove_list_;
+    tbb::atomic<uint64_t> interest_generation_;
     LifetimeRef<RTargetGroupMgr> master_instance_delete_ref_;
 
     DISALLOW_COPY_AND_ASSIGN(RTargetGroupMgr);
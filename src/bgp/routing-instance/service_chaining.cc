@@ -10,6 +10,7 @@
 
 #include "base/task_annotations.h"
 #include "base/task_trigger.h"
+#include "base/time_util.h"
 #include "bgp/bgp_config.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_membership.h"
@@ -236,6 +237,21 @@ bool ServiceChain<T>::Match(BgpServer *server, BgpTable *table, BgpRoute *route,
         }
     }
 
+    // An add/change request that's still in the queue picks up the latest
+    // state of the route when it's processed, so there's no need for one
+    // more. This keeps a burst of changes to a connected route e.g. when a
+    // service instance VM moves, from turning into a burst of updates for
+    // all the service chain routes.
+    if (!deleted && state->update_pending()) {
+        manager_->Coalesce();
+        return true;
+    }
+    if (deleted) {
+        state->reset_update_pending();
+    } else {
+        state->set_update_pending();
+    }
+
     // The MatchState reference is taken to ensure that the route is not
     // deleted when request is still present in the queue
     // This is to handle the case where MatchState already exists and
@@ -720,6 +736,10 @@ bool ServiceChainMgr<T>::RequestHandler(ServiceChainRequestT *req) {
             (listener_->GetMatchState(table, route, info));
     }
 
+    // Further add/changes for the route need a new request from here on.
+    if (state)
+        state->reset_update_pending();
+
     switch (req->type_) {
         case ServiceChainRequestT::MORE_SPECIFIC_ADD_CHG: {
             assert(state);
@@ -901,6 +921,7 @@ bool ServiceChainMgr<T>::RequestHandler(ServiceChainRequestT *req) {
             }
         }
     }
+    queue_stats_.RecordProcessed(ClockMonotonicUsec() - req->enqueue_time_);
     delete req;
     return true;
 }
@@ -950,6 +971,8 @@ Address::Family ServiceChainMgr<ServiceChainInet6>::GetFamily() const {
 
 template <typename T>
 void ServiceChainMgr<T>::Enqueue(ServiceChainRequestT *req) {
+    req->enqueue_time_ = ClockMonotonicUsec();
+    queue_stats_.RecordEnqueue();
     process_queue_->Enqueue(req);
 }
 
@@ -969,6 +992,16 @@ bool ServiceChainMgr<T>::IsPending(RoutingInstance *rtinstance,
 template <typename T>
 bool ServiceChainMgr<T>::FillServiceChainInfo(RoutingInstance *rtinstance,
         ShowServicechainInfo *info) const {
+    ServiceChainQueueInfo queue_info;
+    queue_info.set_queue_length(GetQueueLength());
+    queue_info.set_max_queue_length(GetMaxQueueLength());
+    queue_info.set_enqueued(queue_stats_.enqueued());
+    queue_info.set_coalesced(queue_stats_.coalesced());
+    queue_info.set_processed(queue_stats_.processed());
+    queue_info.set_average_latency_usec(queue_stats_.average_latency_usec());
+    queue_info.set_max_latency_usec(queue_stats_.max_latency_usec());
+    info->set_queue_info(queue_info);
+
     string pending_reason;
     if (IsPending(rtinstance, &pending_reason)) {
         info->set_state("pending");
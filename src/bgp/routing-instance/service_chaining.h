@@ -86,14 +86,16 @@ public:
           rt_(route),
           aggregate_match_(aggregate_match),
           info_(info),
-          snh_resp_(NULL) {
+          snh_resp_(NULL),
+          enqueue_time_(0) {
     }
 
     ServiceChainRequest(RequestType type, SandeshResponse *resp)
         : type_(type),
           table_(NULL),
           rt_(NULL),
-          snh_resp_(resp) {
+          snh_resp_(resp),
+          enqueue_time_(0) {
     }
 
     RequestType type_;
@@ -102,6 +104,7 @@ public:
     PrefixT aggregate_match_;
     ServiceChainPtr info_;
     SandeshResponse *snh_resp_;
+    uint64_t enqueue_time_;
 
 private:
     DISALLOW_COPY_AND_ASSIGN(ServiceChainRequest);
@@ -252,11 +255,19 @@ public:
     virtual size_t ResolvedQueueSize() const { return chain_set_.size(); }
     virtual uint32_t GetDownServiceChainCount() const;
     virtual bool IsQueueEmpty() const { return process_queue_->IsQueueEmpty(); }
+    virtual size_t GetQueueLength() const { return process_queue_->Length(); }
+    virtual size_t GetMaxQueueLength() const {
+        return process_queue_->max_queue_len();
+    }
+    virtual const ConditionMatchQueueStats &queue_stats() const {
+        return queue_stats_;
+    }
     virtual bool IsPending(RoutingInstance *rtinstance,
         std::string *reason = NULL) const;
 
     Address::Family GetFamily() const;
     void Enqueue(ServiceChainRequestT *req);
+    void Coalesce() { queue_stats_.RecordCoalesced(); }
     virtual bool FillServiceChainInfo(RoutingInstance *rtinstance,
                                       ShowServicechainInfo *info) const;
 
@@ -317,6 +328,7 @@ private:
     BgpConditionListener *listener_;
     boost::scoped_ptr<TaskTrigger> resolve_trigger_;
     boost::scoped_ptr<WorkQueue<ServiceChainRequestT *> > process_queue_;
+    ConditionMatchQueueStats queue_stats_;
     ServiceChainMap chain_set_;
     PendingServiceChainList pending_chains_;
     bool aggregate_host_route_;
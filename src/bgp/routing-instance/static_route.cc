@@ -14,6 +14,7 @@
 #include "base/map_util.h"
 #include "base/task_annotations.h"
 #include "base/task_trigger.h"
+#include "base/time_util.h"
 #include "bgp/bgp_config.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_server.h"
@@ -290,6 +291,20 @@ bool StaticRoute<T>::Match(BgpServer *server, BgpTable *table,
         }
     }
 
+    // A NEXTHOP_ADD_CHG that's still in the queue picks up the latest state
+    // of the nexthop route when it's processed, so there's no need for one
+    // more. This keeps a burst of changes to the nexthop route from getting
+    // turned into a burst of updates to the static route.
+    if (!deleted && state->update_pending()) {
+        manager_->CoalesceStaticRouteReq();
+        return true;
+    }
+    if (deleted) {
+        state->reset_update_pending();
+    } else {
+        state->set_update_pending();
+    }
+
     // The MatchState reference is taken to ensure that the route is not
     // deleted when request is still present in the queue
     // This is to handle the case where MatchState already exists and
@@ -624,6 +639,8 @@ Ip6Address StaticRouteMgr<StaticRouteInet6>::GetAddress(IpAddress addr) const {
 
 template <typename T>
 void StaticRouteMgr<T>::EnqueueStaticRouteReq(StaticRouteRequest *req) {
+    req->enqueue_time_ = ClockMonotonicUsec();
+    queue_stats_.RecordEnqueue();
     static_route_queue_->Enqueue(req);
 }
 
@@ -640,6 +657,10 @@ bool StaticRouteMgr<T>::StaticRouteEventCallback(StaticRouteRequest *req) {
             (listener_->GetMatchState(table, route, info));
     }
 
+    // Further add/changes for the route need a new request from here on.
+    if (state)
+        state->reset_update_pending();
+
     switch (req->type_) {
         case StaticRouteRequest::NEXTHOP_ADD_CHG: {
             assert(state);
@@ -685,6 +706,7 @@ bool StaticRouteMgr<T>::StaticRouteEventCallback(StaticRouteRequest *req) {
         }
     }
 
+    queue_stats_.RecordProcessed(ClockMonotonicUsec() - req->enqueue_time_);
     delete req;
     return true;
 }
@@ -935,6 +957,16 @@ template <typename T> bool StaticRouteMgr<T>::FillStaticRouteInfo(
         match->FillShowInfo(&static_info);
         info->static_route_list.push_back(static_info);
     }
+
+    StaticRouteQueueInfo queue_info;
+    queue_info.set_queue_length(GetQueueLength());
+    queue_info.set_max_queue_length(GetMaxQueueLength());
+    queue_info.set_enqueued(queue_stats_.enqueued());
+    queue_info.set_coalesced(queue_stats_.coalesced());
+    queue_info.set_processed(queue_stats_.processed());
+    queue_info.set_average_latency_usec(queue_stats_.average_latency_usec());
+    queue_info.set_max_latency_usec(queue_stats_.max_latency_usec());
+    info->set_queue_info(queue_info);
     return true;
 }
 
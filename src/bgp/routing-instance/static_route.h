@@ -48,13 +48,15 @@ struct StaticRouteRequest {
 
     StaticRouteRequest(RequestType type, BgpTable *table, BgpRoute *route,
                         StaticRoutePtr info)
-        : type_(type), table_(table), rt_(route), info_(info) {
+        : type_(type), table_(table), rt_(route), info_(info),
+          enqueue_time_(0) {
     }
 
     RequestType type_;
     BgpTable *table_;
     BgpRoute *rt_;
     StaticRoutePtr info_;
+    uint64_t enqueue_time_;
 
 private:
     DISALLOW_COPY_AND_ASSIGN(StaticRouteRequest);
@@ -81,6 +83,7 @@ public:
     virtual void FlushStaticRouteConfig();
 
     void EnqueueStaticRouteReq(StaticRouteRequest *req);
+    void CoalesceStaticRouteReq() { queue_stats_.RecordCoalesced(); }
     const StaticRouteMap &static_route_map() const { return static_route_map_; }
 
     virtual void NotifyAllRoutes();
@@ -89,6 +92,15 @@ public:
     virtual uint32_t GetDownRouteCount() const;
     virtual bool FillStaticRouteInfo(RoutingInstance *rtinstance,
                                      StaticRouteEntriesInfo *info) const;
+    virtual size_t GetQueueLength() const {
+        return static_route_queue_->Length();
+    }
+    virtual size_t GetMaxQueueLength() const {
+        return static_route_queue_->max_queue_len();
+    }
+    virtual const ConditionMatchQueueStats &queue_stats() const {
+        return queue_stats_;
+    }
 
     Address::Family GetFamily() const;
     AddressT GetAddress(IpAddress addr) const;
@@ -129,6 +141,7 @@ private:
     BgpConditionListener *listener_;
     StaticRouteMap  static_route_map_;
     WorkQueue<StaticRouteRequest *> *static_route_queue_;
+    ConditionMatchQueueStats queue_stats_;
     tbb::mutex mutex_;
     StaticRouteProcessList unregister_static_route_list_;
     boost::scoped_ptr<TaskTrigger> unregister_list_trigger_;
@@ -16,6 +16,7 @@
 #include "bgp/routing-instance/routing_instance.h"
 #include "bgp/routing-policy/routing_policy_action.h"
 #include "bgp/routing-policy/routing_policy_match.h"
+#include "bgp/routing-policy/routing_policy_program.h"
 
 
 class RoutingPolicyMgr::DeleteActor : public LifetimeActor {
@@ -420,6 +421,7 @@ void RoutingPolicy::ProcessConfig() {
         if (term)
             add_term(term);
     }
+    Compile();
 }
 
 //
@@ -466,7 +468,10 @@ void RoutingPolicy::UpdateConfig(const BgpRoutingPolicyConfig *cfg) {
         update_policy = true;
     }
 
-    if (update_policy) generation_++;
+    if (update_policy) {
+        generation_++;
+        Compile();
+    }
 }
 
 void RoutingPolicy::ClearConfig() {
@@ -508,8 +513,33 @@ void RoutingPolicy::RetryDelete() {
     deleter_->RetryDelete();
 }
 
+void RoutingPolicy::add_term(PolicyTermPtr term) {
+    terms_.push_back(term);
+    program_.reset();
+}
+
+//
+// Build the program used by operator() from the current list of terms.
+// Called from bgp::Config task, which is exclusive with the db::DBTable
+// tasks that evaluate the policy.
+//
+void RoutingPolicy::Compile() {
+    program_.reset(new RoutingPolicyProgram(terms_));
+}
+
+//
+// Apply the policy using the compiled program. Fall back to evaluating the
+// terms one at a time if a term was added after the program was built.
+//
 RoutingPolicy::PolicyResult RoutingPolicy::operator()(const BgpRoute *route,
                                   const BgpPath *path, BgpAttr *attr) const {
+    if (program_)
+        return program_->Evaluate(route, path, attr);
+    return ApplyTerms(route, path, attr);
+}
+
+RoutingPolicy::PolicyResult RoutingPolicy::ApplyTerms(const BgpRoute *route,
+                                  const BgpPath *path, BgpAttr *attr) const {
     BOOST_FOREACH(PolicyTermPtr term, terms()) {
         bool terminal = term->terminal();
         bool matched = term->ApplyTerm(route, path, attr);
@@ -535,35 +565,41 @@ bool PolicyTerm::terminal() const {
     return false;
 }
 
-bool PolicyTerm::ApplyTerm(const BgpRoute *route, const BgpPath *path,
-                           BgpAttr *attr) const {
-    bool matched = true;
+bool PolicyTerm::Match(const BgpRoute *route, const BgpPath *path,
+                       const BgpAttr *attr) const {
     BOOST_FOREACH(RoutingPolicyMatch *match, matches()) {
-        if (!(*match)(route, path, attr)) {
-            matched = false;
-            break;
-        }
+        if (!(*match)(route, path, attr))
+            return false;
     }
-    if (matched) {
-        bool first = true;
-        BOOST_FOREACH(RoutingPolicyAction *action, actions()) {
-            // First action defines what to do with the route
-            // accept/reject/next-term
-            if (first) {
-                if (action->terminal()) {
-                    if (!action->accept()) {
-                        // out_attr is unaltered
-                        break;
-                    }
+    return true;
+}
+
+void PolicyTerm::ApplyActions(BgpAttr *attr) const {
+    bool first = true;
+    BOOST_FOREACH(RoutingPolicyAction *action, actions()) {
+        // First action defines what to do with the route
+        // accept/reject/next-term
+        if (first) {
+            if (action->terminal()) {
+                if (!action->accept()) {
+                    // out_attr is unaltered
+                    break;
                 }
-                first = false;
-            } else {
-                RoutingPolicyUpdateAction *update =
-                    static_cast<RoutingPolicyUpdateAction *>(action);
-                (*update)(attr);
             }
+            first = false;
+        } else {
+            RoutingPolicyUpdateAction *update =
+                static_cast<RoutingPolicyUpdateAction *>(action);
+            (*update)(attr);
         }
     }
+}
+
+bool PolicyTerm::ApplyTerm(const BgpRoute *route, const BgpPath *path,
+                           BgpAttr *attr) const {
+    bool matched = Match(route, path, attr);
+    if (matched)
+        ApplyActions(attr);
     return matched;
 }
 
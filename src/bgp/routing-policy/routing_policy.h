@@ -33,6 +33,7 @@ class BgpRoutingPolicyConfig;
 class RoutingInstance;
 class RoutingPolicyMatch;
 class RoutingPolicyAction;
+class RoutingPolicyProgram;
 class RoutingPolicyTermConfig;
 class TaskTrigger;
 
@@ -87,6 +88,10 @@ class TaskTrigger;
 // RoutingPolicy object provided operator() to apply the policy on a
 // BgpRoute+BgpPath. In this operator overload function, route is processed
 // against each policy term till a terminal rule is encountered.
+// The terms are compiled into a RoutingPolicyProgram whenever they change
+// so that operator() need not evaluate every match condition of every term
+// for each path. ApplyTerms evaluates the terms one at a time and gives the
+// same result.
 // A terminal rule is a term where action on successful match is to Reject or
 // Accept the route. Return value gives the hint of result of policy apply.
 // Result is represented as a pair with first element representing whether the
@@ -202,6 +207,9 @@ public:
     bool terminal() const;
     bool ApplyTerm(const BgpRoute *route,
                    const BgpPath *path, BgpAttr *attr) const;
+    bool Match(const BgpRoute *route,
+               const BgpPath *path, const BgpAttr *attr) const;
+    void ApplyActions(BgpAttr *attr) const;
     void set_actions(const ActionList &actions) {
         actions_ = actions;
     }
@@ -251,12 +259,13 @@ public:
 
     RoutingPolicyTermList *terms() { return &terms_; }
     const RoutingPolicyTermList &terms() const { return terms_; }
-    void add_term(PolicyTermPtr term) {
-        terms_.push_back(term);
-    }
+    void add_term(PolicyTermPtr term);
 
     PolicyResult operator()(const BgpRoute *route,
                             const BgpPath *path, BgpAttr *attr) const;
+    PolicyResult ApplyTerms(const BgpRoute *route,
+                            const BgpPath *path, BgpAttr *attr) const;
+    const RoutingPolicyProgram *program() const { return program_.get(); }
     uint32_t generation() const { return generation_; }
     uint32_t refcount() const { return refcount_; }
 
@@ -267,6 +276,8 @@ private:
     friend void intrusive_ptr_release(RoutingPolicy *policy);
 
     PolicyTermPtr BuildTerm(const RoutingPolicyTermConfig &term);
+    void Compile();
+
     std::string name_;
     BgpServer *server_;
     RoutingPolicyMgr *mgr_;
@@ -278,6 +289,7 @@ private:
     tbb::atomic<uint32_t> refcount_;
     uint32_t generation_;
     RoutingPolicyTermList terms_;
+    boost::scoped_ptr<RoutingPolicyProgram> program_;
 };
 
 inline void intrusive_ptr_add_ref(RoutingPolicy *policy) {
@@ -58,11 +58,10 @@ MatchCommunity::~MatchCommunity() {
 
 //
 // Return true if all community strings (normal or regex) are matched by the
-// community values in the BgpAttr.
+// community values in the Community.
 //
-bool MatchCommunity::MatchAll(const BgpAttr *attr) const {
-    // Bail if there's no community values in the BgpAttr.
-    const Community *comm = attr->community();
+bool MatchCommunity::MatchAll(const Community *comm) const {
+    // Bail if there's no community values.
     if (!comm)
         return false;
 
@@ -95,11 +94,10 @@ bool MatchCommunity::MatchAll(const BgpAttr *attr) const {
 
 //
 // Return true if any community strings (normal or regex) is matched by the
-// community values in the BgpAttr.
+// community values in the Community.
 //
-bool MatchCommunity::MatchAny(const BgpAttr *attr) const {
-    // Bail if there's no community values in the BgpAttr.
-    const Community *comm = attr->community();
+bool MatchCommunity::MatchAny(const Community *comm) const {
+    // Bail if there's no community values.
     if (!comm)
         return false;
 
@@ -123,12 +121,19 @@ bool MatchCommunity::MatchAny(const BgpAttr *attr) const {
     return false;
 }
 
+//
+// Return true if the Community matches this MatchCommunity.
+//
+bool MatchCommunity::Match(const Community *comm) const {
+    return (match_all_ ? MatchAll(comm) : MatchAny(comm));
+}
+
 //
 // Return true if the BgpPath matches this MatchCommunity.
 //
 bool MatchCommunity::Match(const BgpRoute *route, const BgpPath *path,
                            const BgpAttr *attr) const {
-    return (match_all_ ? MatchAll(attr) : MatchAny(attr));
+    return Match(attr->community());
 }
 
 //
@@ -306,10 +311,10 @@ MatchProtocol::MatchProtocol(const vector<string> &protocols) {
 MatchProtocol::~MatchProtocol() {
 }
 
-bool MatchProtocol::Match(const BgpRoute *route, const BgpPath *path,
-                           const BgpAttr *attr) const {
-    BgpPath::PathSource path_src = path->GetSource();
-    bool is_xmpp = path->GetPeer() ? path->GetPeer()->IsXmppPeer() : false;
+//
+// Return true if a path with the given source matches this MatchProtocol.
+//
+bool MatchProtocol::Match(BgpPath::PathSource path_src, bool is_xmpp) const {
     BOOST_FOREACH(MatchProtocolType protocol, protocols()) {
         BgpPath::PathSource mapped_src = PathSourceFromMatchProtocol(protocol);
         if (mapped_src != BgpPath::None) {
@@ -323,6 +328,13 @@ bool MatchProtocol::Match(const BgpRoute *route, const BgpPath *path,
     return false;
 }
 
+bool MatchProtocol::Match(const BgpRoute *route, const BgpPath *path,
+                           const BgpAttr *attr) const {
+    BgpPath::PathSource path_src = path->GetSource();
+    bool is_xmpp = path->GetPeer() ? path->GetPeer()->IsXmppPeer() : false;
+    return Match(path_src, is_xmpp);
+}
+
 string MatchProtocol::ToString() const {
     ostringstream oss;
     oss << "protocol [ ";
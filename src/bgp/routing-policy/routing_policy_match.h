@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "bgp/bgp_config.h"
+#include "bgp/bgp_path.h"
 #include "bgp/inet/inet_route.h"
 #include "bgp/inet6/inet6_route.h"
 
@@ -63,10 +64,11 @@ public:
         return to_match_regex_strings_;
     }
     const CommunityRegexList &regexs() const { return to_match_regexs_; }
+    bool Match(const Community *comm) const;
 
 private:
-    bool MatchAll(const BgpAttr *attr) const;
-    bool MatchAny(const BgpAttr *attr) const;
+    bool MatchAll(const Community *comm) const;
+    bool MatchAny(const Community *comm) const;
 
     bool match_all_;
     CommunityList to_match_;
@@ -94,6 +96,7 @@ public:
     const PathSourceList &protocols() const {
         return to_match_;
     }
+    bool Match(BgpPath::PathSource path_src, bool is_xmpp) const;
 
 private:
     PathSourceList to_match_;
@@ -129,6 +132,7 @@ public:
                        const BgpPath *path, const BgpAttr *attr) const;
     virtual std::string ToString() const;
     virtual bool IsEqual(const RoutingPolicyMatch &prefix) const;
+    const PrefixMatchList &match_list() const { return match_list_; }
 
 private:
     PrefixMatchList match_list_;
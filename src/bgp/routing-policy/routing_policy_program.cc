@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/routing-policy/routing_policy_program.h"
+
+#include <boost/foreach.hpp>
+
+#include <typeinfo>
+
+#include "bgp/bgp_attr.h"
+#include "bgp/ipeer.h"
+#include "bgp/routing-policy/routing_policy_action.h"
+
+using std::make_pair;
+using std::vector;
+
+const size_t RoutingPolicyProgram::kMaxCommunityCacheSize = 16 * 1024;
+
+static bool PrefixBit(const Ip4Prefix &prefix, int bit) {
+    return (prefix.ip4_addr().to_ulong() >> (31 - bit)) & 0x1;
+}
+
+static bool PrefixBit(const Inet6Prefix &prefix, int bit) {
+    Ip6Address::bytes_type bytes = prefix.ip6_addr().to_bytes();
+    return (bytes[bit / 8] >> (7 - bit % 8)) & 0x1;
+}
+
+//
+// Binary trie of the prefixes in the MatchPrefix conditions for one address
+// family. Nodes are kept in a vector and refer to each other by index.
+//
+// A node for a configured prefix has an entry with the exact, longer and
+// orlonger terms for that prefix. A lookup walks down from the root along
+// the bits of the route prefix. Every entry on the way is for a prefix that
+// covers the route prefix, so all of its orlonger terms match. Its longer
+// terms match if the route prefix is more specific and its exact terms match
+// if the two prefixes are the same.
+//
+template <typename PrefixT>
+class RoutingPolicyProgram::PrefixTrie {
+public:
+    explicit PrefixTrie(size_t term_count) : term_count_(term_count) {
+        nodes_.push_back(Node());
+    }
+
+    void Insert(const PrefixT &prefix, int match_type, size_t idx) {
+        size_t node_idx = 0;
+        for (int bit = 0; bit < prefix.prefixlen(); ++bit) {
+            int child = PrefixBit(prefix, bit);
+            if (!nodes_[node_idx].child[child]) {
+                nodes_[node_idx].child[child] = nodes_.size();
+                nodes_.push_back(Node());
+            }
+            node_idx = nodes_[node_idx].child[child];
+        }
+        if (nodes_[node_idx].entry < 0) {
+            nodes_[node_idx].entry = entries_.size();
+            entries_.push_back(Entry(term_count_));
+        }
+        Entry &entry = entries_[nodes_[node_idx].entry];
+        if (match_type == PrefixMatchInet::EXACT) {
+            entry.exact.set(idx);
+        } else if (match_type == PrefixMatchInet::LONGER) {
+            entry.longer.set(idx);
+        } else {
+            entry.orlonger.set(idx);
+        }
+    }
+
+    void Lookup(const PrefixT &prefix, TermSet *terms) const {
+        size_t node_idx = 0;
+        for (int bit = 0; ; ++bit) {
+            const Node &node = nodes_[node_idx];
+            if (node.entry >= 0) {
+                const Entry &entry = entries_[node.entry];
+                *terms |= entry.orlonger;
+                if (bit == prefix.prefixlen()) {
+                    *terms |= entry.exact;
+                } else {
+                    *terms |= entry.longer;
+                }
+            }
+            if (bit == prefix.prefixlen())
+                break;
+            node_idx = node.child[PrefixBit(prefix, bit)];
+            if (!node_idx)
+                break;
+        }
+    }
+
+private:
+    struct Node {
+        Node() : entry(-1) {
+            child[0] = child[1] = 0;
+        }
+        size_t child[2];
+        int entry;
+    };
+
+    struct Entry {
+        explicit Entry(size_t term_count)
+            : exact(term_count), longer(term_count), orlonger(term_count) {
+        }
+        TermSet exact;
+        TermSet longer;
+        TermSet orlonger;
+    };
+
+    size_t term_count_;
+    vector<Node> nodes_;
+    vector<Entry> entries_;
+};
+
+RoutingPolicyProgram::RoutingPolicyProgram(
+    const RoutingPolicy::RoutingPolicyTermList &terms)
+    : terms_(terms.begin(), terms.end()),
+      generic_terms_(terms_.size()),
+      no_prefix_terms_(terms_.size()),
+      inet_trie_(new InetPrefixTrie(terms_.size())),
+      inet6_trie_(new Inet6PrefixTrie(terms_.size())),
+      no_community_terms_(terms_.size()),
+      null_community_terms_(terms_.size()) {
+    for (int src = 0; src < kPathSourceCount; ++src) {
+        protocol_terms_[src][0].resize(terms_.size());
+        protocol_terms_[src][1].resize(terms_.size());
+    }
+    for (size_t idx = 0; idx < terms_.size(); ++idx) {
+        CompileTerm(terms_[idx].get(), idx);
+    }
+    null_community_terms_ = BuildCommunityTerms(NULL);
+}
+
+RoutingPolicyProgram::~RoutingPolicyProgram() {
+}
+
+//
+// Add the match conditions of the term at the given index to the program.
+//
+// A term with a prefix condition for each of inet and inet6 can't match any
+// route, so it doesn't get added to either trie or to no_prefix_terms_.
+//
+void RoutingPolicyProgram::CompileTerm(const PolicyTerm *term, size_t idx) {
+    const PrefixMatchInet *inet_match = NULL;
+    const PrefixMatchInet6 *inet6_match = NULL;
+    const MatchProtocol *protocol_match = NULL;
+    const MatchCommunity *community_match = NULL;
+    bool generic = false;
+    BOOST_FOREACH(const RoutingPolicyMatch *match, term->matches()) {
+        if (typeid(*match) == typeid(PrefixMatchInet) && !inet_match) {
+            inet_match = static_cast<const PrefixMatchInet *>(match);
+        } else if (typeid(*match) == typeid(PrefixMatchInet6) &&
+                   !inet6_match) {
+            inet6_match = static_cast<const PrefixMatchInet6 *>(match);
+        } else if (typeid(*match) == typeid(MatchProtocol) &&
+                   !protocol_match) {
+            protocol_match = static_cast<const MatchProtocol *>(match);
+        } else if (typeid(*match) == typeid(MatchCommunity) &&
+                   !community_match) {
+            community_match = static_cast<const MatchCommunity *>(match);
+        } else {
+            generic = true;
+            break;
+        }
+    }
+
+    // Let PolicyTerm::Match evaluate all the conditions.
+    if (generic) {
+        generic_terms_.set(idx);
+        no_prefix_terms_.set(idx);
+        no_community_terms_.set(idx);
+        for (int src = 0; src < kPathSourceCount; ++src) {
+            protocol_terms_[src][0].set(idx);
+            protocol_terms_[src][1].set(idx);
+        }
+        return;
+    }
+
+    if (inet_match && !inet6_match) {
+        BOOST_FOREACH(const PrefixMatchInet::PrefixMatch &match,
+            inet_match->match_list()) {
+            inet_trie_->Insert(match.first, match.second, idx);
+        }
+    } else if (inet6_match && !inet_match) {
+        BOOST_FOREACH(const PrefixMatchInet6::PrefixMatch &match,
+            inet6_match->match_list()) {
+            inet6_trie_->Insert(match.first, match.second, idx);
+        }
+    } else if (!inet_match && !inet6_match) {
+        no_prefix_terms_.set(idx);
+    }
+
+    for (int src = 0; src < kPathSourceCount; ++src) {
+        BgpPath::PathSource path_src = static_cast<BgpPath::PathSource>(src);
+        for (int is_xmpp = 0; is_xmpp < 2; ++is_xmpp) {
+            if (!protocol_match || protocol_match->Match(path_src, is_xmpp))
+                protocol_terms_[src][is_xmpp].set(idx);
+        }
+    }
+
+    if (community_match) {
+        community_matches_.push_back(make_pair(community_match, idx));
+    } else {
+        no_community_terms_.set(idx);
+    }
+}
+
+//
+// Add the terms whose prefix conditions are satisfied by the route.
+//
+void RoutingPolicyProgram::PrefixTerms(const BgpRoute *route,
+    TermSet *terms) const {
+    *terms |= no_prefix_terms_;
+    const InetRoute *inet_route = dynamic_cast<const InetRoute *>(route);
+    if (inet_route) {
+        inet_trie_->Lookup(inet_route->GetPrefix(), terms);
+        return;
+    }
+    const Inet6Route *inet6_route = dynamic_cast<const Inet6Route *>(route);
+    if (inet6_route) {
+        inet6_trie_->Lookup(inet6_route->GetPrefix(), terms);
+        return;
+    }
+}
+
+RoutingPolicyProgram::TermSet RoutingPolicyProgram::BuildCommunityTerms(
+    const Community *comm) const {
+    TermSet terms(no_community_terms_);
+    BOOST_FOREACH(const CommunityMatch &match, community_matches_) {
+        if (match.first->Match(comm))
+            terms.set(match.second);
+    }
+    return terms;
+}
+
+//
+// Return the terms whose community conditions are satisfied by the given
+// community list, using the cache if possible.
+//
+RoutingPolicyProgram::TermSet RoutingPolicyProgram::CommunityTerms(
+    const Community *comm) const {
+    if (!comm)
+        return null_community_terms_;
+    if (community_matches_.empty())
+        return no_community_terms_;
+
+    {
+        tbb::mutex::scoped_lock lock(mutex_);
+        CommunityCache::const_iterator loc = community_cache_.find(comm);
+        if (loc != community_cache_.end())
+            return loc->second.second;
+    }
+
+    // Evaluate without holding the lock since regex matches are expensive.
+    TermSet terms = BuildCommunityTerms(comm);
+
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (community_cache_.size() >= kMaxCommunityCacheSize)
+        community_cache_.clear();
+    community_cache_.insert(
+        make_pair(comm, make_pair(CommunityPtr(comm), terms)));
+    return terms;
+}
+
+size_t RoutingPolicyProgram::community_cache_size() const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    return community_cache_.size();
+}
+
+//
+// Apply the policy to the path and return the same result as
+// RoutingPolicy::ApplyTerms.
+//
+RoutingPolicy::PolicyResult RoutingPolicyProgram::Evaluate(
+    const BgpRoute *route, const BgpPath *path, BgpAttr *attr) const {
+    if (terms_.empty())
+        return make_pair(false, true);
+
+    TermSet candidates(terms_.size());
+    PrefixTerms(route, &candidates);
+    int src = path->GetSource();
+    if (src < 0 || src >= kPathSourceCount)
+        src = BgpPath::None;
+    bool is_xmpp = path->GetPeer() ? path->GetPeer()->IsXmppPeer() : false;
+    candidates &= protocol_terms_[src][is_xmpp];
+    if (candidates.none())
+        return make_pair(false, true);
+
+    const Community *comm = attr->community();
+    TermSet matched = candidates & CommunityTerms(comm);
+    for (size_t idx = matched.find_first(); idx != TermSet::npos;
+         idx = matched.find_next(idx)) {
+        const PolicyTerm *term = terms_[idx].get();
+        if (generic_terms_.test(idx) && !term->Match(route, path, attr))
+            continue;
+        term->ApplyActions(attr);
+        if (term->terminal())
+            return make_pair(true, (*term->actions().begin())->accept());
+
+        // Actions may have changed the community list in the BgpAttr.
+        if (attr->community() != comm) {
+            comm = attr->community();
+            matched = candidates & CommunityTerms(comm);
+        }
+    }
+    return make_pair(false, true);
+}
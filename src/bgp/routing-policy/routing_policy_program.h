@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_ROUTING_POLICY_ROUTING_POLICY_PROGRAM_H_
+#define SRC_BGP_ROUTING_POLICY_ROUTING_POLICY_PROGRAM_H_
+
+#include <boost/dynamic_bitset.hpp>
+#include <tbb/mutex.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "base/util.h"
+#include "bgp/bgp_path.h"
+#include "bgp/community.h"
+#include "bgp/routing-policy/routing_policy.h"
+#include "bgp/routing-policy/routing_policy_match.h"
+
+//
+// RoutingPolicyProgram is the compiled form of the terms of a RoutingPolicy.
+//
+// Evaluating a policy one term at a time costs a walk of the match list of
+// every term for each path, which adds up for policies with hundreds of
+// terms. The program instead computes the set of terms whose conditions are
+// satisfied by a path with a handful of lookups and then visits only those
+// terms, in term order, to apply their actions.
+//
+// The set of terms is represented as a bitset indexed by term position and
+// is the intersection of the sets for each kind of match condition:
+//
+// - Prefix conditions are stored in a binary trie per address family. The
+//   lookup walks the trie along the bits of the route prefix and collects
+//   the exact/longer/orlonger terms for each configured prefix it passes.
+// - Protocol conditions only depend on the source of the path and whether
+//   the peer is an xmpp peer, so the set for each combination is computed
+//   when the program is built.
+// - Community conditions depend on the community list in the BgpAttr. Since
+//   the community list is interned, the set is memoized on the Community
+//   pointer. The cache keeps a reference to the Community so that the
+//   pointer can't get reused while the entry is present. It is shared by
+//   all db::DBTable partitions and hence protected by a mutex.
+//
+// Update actions of a term can change the community list that subsequent
+// terms match against, so the community set is looked up again when the
+// BgpAttr gets a different community list.
+//
+// Terms with match conditions that can't be compiled e.g. more than one
+// condition of the same kind, are evaluated with PolicyTerm::Match.
+//
+class RoutingPolicyProgram {
+public:
+    typedef boost::dynamic_bitset<> TermSet;
+
+    static const size_t kMaxCommunityCacheSize;
+
+    explicit RoutingPolicyProgram(
+        const RoutingPolicy::RoutingPolicyTermList &terms);
+    ~RoutingPolicyProgram();
+
+    RoutingPolicy::PolicyResult Evaluate(const BgpRoute *route,
+        const BgpPath *path, BgpAttr *attr) const;
+
+    size_t term_count() const { return terms_.size(); }
+    size_t community_cache_size() const;
+
+private:
+    template <typename PrefixT> class PrefixTrie;
+    typedef PrefixTrie<Ip4Prefix> InetPrefixTrie;
+    typedef PrefixTrie<Inet6Prefix> Inet6PrefixTrie;
+    typedef std::pair<const MatchCommunity *, size_t> CommunityMatch;
+    typedef std::pair<CommunityPtr, TermSet> CommunityCacheEntry;
+    typedef std::map<const Community *, CommunityCacheEntry> CommunityCache;
+
+    static const int kPathSourceCount = BgpPath::Local + 1;
+
+    void CompileTerm(const PolicyTerm *term, size_t idx);
+    void PrefixTerms(const BgpRoute *route, TermSet *terms) const;
+    TermSet CommunityTerms(const Community *comm) const;
+    TermSet BuildCommunityTerms(const Community *comm) const;
+
+    std::vector<RoutingPolicy::PolicyTermPtr> terms_;
+    TermSet generic_terms_;
+    TermSet no_prefix_terms_;
+    boost::scoped_ptr<InetPrefixTrie> inet_trie_;
+    boost::scoped_ptr<Inet6PrefixTrie> inet6_trie_;
+    TermSet protocol_terms_[kPathSourceCount][2];
+    std::vector<CommunityMatch> community_matches_;
+    TermSet no_community_terms_;
+    TermSet null_community_terms_;
+
+    mutable tbb::mutex mutex_;
+    mutable CommunityCache community_cache_;
+
+    DISALLOW_COPY_AND_ASSIGN(RoutingPolicyProgram);
+};
+
+#endif  // SRC_BGP_ROUTING_POLICY_ROUTING_POLICY_PROGRAM_H_
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <boost/foreach.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <iostream>
+
+#include "base/string_util.h"
+#include "base/time_util.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_log.h"
+#include "bgp/bgp_server.h"
+#include "control-node/control_node.h"
+
+using std::cout;
+using std::endl;
+using std::vector;
+
+//
+// Measure throughput of BgpPathAttributeDB Locate with varying number of
+// concurrent threads and attribute db shards.
+//
+// Lookup mode keeps a reference to all attributes, so that Locate finds an
+// existing entry every time. Churn mode doesn't, so that every Locate ends
+// up inserting an entry which then gets deleted when the reference is
+// released.
+//
+// Set LOCATE_COUNT to change the number of Locate calls made per thread.
+//
+typedef std::tr1::tuple<int, int, bool> TestParams;
+
+class BgpAttrDBPerfTest : public ::testing::TestWithParam<TestParams> {
+protected:
+    static const int kAttrCount = 1024;
+
+    struct ThreadArgs {
+        BgpAttrDBPerfTest *test;
+        int index;
+    };
+
+    BgpAttrDBPerfTest()
+        : hash_size_(0), thread_count_(1), churn_(false),
+          locate_count_(4 * 1024) {
+    }
+
+    virtual void SetUp() {
+        hash_size_ = std::tr1::get<0>(GetParam());
+        thread_count_ = std::tr1::get<1>(GetParam());
+        churn_ = std::tr1::get<2>(GetParam());
+        char *str = getenv("LOCATE_COUNT");
+        if (str)
+            locate_count_ = strtoul(str, NULL, 0);
+
+        // Shard count is picked up when the attribute dbs are created.
+        if (hash_size_) {
+            setenv("BGP_PATH_ATTRIBUTE_DB_HASH_SIZE",
+                   integerToString(hash_size_).c_str(), true);
+        } else {
+            unsetenv("BGP_PATH_ATTRIBUTE_DB_HASH_SIZE");
+        }
+        server_.reset(new BgpServer(&evm_));
+        unsetenv("BGP_PATH_ATTRIBUTE_DB_HASH_SIZE");
+
+        for (int idx = 0; idx < kAttrCount; ++idx) {
+            BgpAttrSpec *spec = new BgpAttrSpec;
+            spec->push_back(new BgpAttrNextHop(0x0a000000 + idx));
+            spec->push_back(new BgpAttrLocalPref(100 + idx % 8));
+            specs_.push_back(spec);
+            CommunitySpec comm_spec;
+            comm_spec.communities.push_back(0xFFFF0000 + idx);
+            comm_specs_.push_back(comm_spec);
+        }
+
+        if (!churn_) {
+            for (int idx = 0; idx < kAttrCount; ++idx) {
+                attrs_.push_back(server_->attr_db()->Locate(*specs_[idx]));
+                comms_.push_back(server_->comm_db()->Locate(comm_specs_[idx]));
+            }
+        }
+    }
+
+    virtual void TearDown() {
+        attrs_.clear();
+        comms_.clear();
+        EXPECT_EQ(0, server_->attr_db()->Size());
+        EXPECT_EQ(0, server_->comm_db()->Size());
+        BOOST_FOREACH(BgpAttrSpec *spec, specs_) {
+            STLDeleteValues(spec);
+            delete spec;
+        }
+        server_->Shutdown();
+        task_util::WaitForIdle();
+        server_.reset();
+    }
+
+    static void *LocateThreadRun(void *objp) {
+        ThreadArgs *args = reinterpret_cast<ThreadArgs *>(objp);
+        BgpAttrDBPerfTest *test = args->test;
+        BgpAttrDB *attr_db = test->server_->attr_db();
+        CommunityDB *comm_db = test->server_->comm_db();
+
+        // Start each thread at a different offset so that threads don't
+        // march through the attributes in lock step.
+        int offset = args->index * (kAttrCount / test->thread_count_);
+        for (int count = 0; count < test->locate_count_; ++count) {
+            int idx = (offset + count) % kAttrCount;
+            BgpAttrPtr attr = attr_db->Locate(*test->specs_[idx]);
+            CommunityPtr comm = comm_db->Locate(test->comm_specs_[idx]);
+        }
+        return NULL;
+    }
+
+    void RunTest() {
+        vector<pthread_t> thread_ids;
+        vector<ThreadArgs> args(thread_count_);
+
+        uint64_t start = ClockMonotonicUsec();
+        for (int idx = 0; idx < thread_count_; ++idx) {
+            pthread_t tid;
+            args[idx].test = this;
+            args[idx].index = idx;
+            if (!pthread_create(&tid, NULL, &LocateThreadRun, &args[idx]))
+                thread_ids.push_back(tid);
+        }
+        BOOST_FOREACH(pthread_t tid, thread_ids) {
+            pthread_join(tid, NULL);
+        }
+        uint64_t elapsed = ClockMonotonicUsec() - start;
+        EXPECT_EQ(thread_count_, static_cast<int>(thread_ids.size()));
+
+        // Two Locate calls per iteration - one each for attr and community.
+        uint64_t total = 2ULL * locate_count_ * thread_ids.size();
+        cout << "Shards " << server_->attr_db()->hash_size()
+             << " Threads " << thread_count_
+             << (churn_ ? " Churn" : " Lookup")
+             << " Locates " << total
+             << " Elapsed(usec) " << elapsed
+             << " Locates/sec " << (elapsed ? total * 1000000 / elapsed : 0)
+             << endl;
+    }
+
+    EventManager evm_;
+    boost::scoped_ptr<BgpServer> server_;
+    int hash_size_;
+    int thread_count_;
+    bool churn_;
+    int locate_count_;
+    vector<BgpAttrSpec *> specs_;
+    vector<CommunitySpec> comm_specs_;
+    vector<BgpAttrPtr> attrs_;
+    vector<CommunityPtr> comms_;
+};
+
+TEST_P(BgpAttrDBPerfTest, Locate) {
+    RunTest();
+}
+
+// Single shard vs. default (one shard per hardware thread).
+INSTANTIATE_TEST_CASE_P(Instance, BgpAttrDBPerfTest,
+    ::testing::Combine(
+        ::testing::Values(1, 0),
+        ::testing::Values(1, 2, 4, 8, 16, 32, 64),
+        ::testing::Bool()));
+
+static void SetUp() {
+    bgp_log_test::init();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
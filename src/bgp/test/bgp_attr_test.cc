@@ -7,6 +7,7 @@
 #include <boost/foreach.hpp>
 #include <boost/scoped_ptr.hpp>
 
+#include <algorithm>
 #include <sstream>
 
 #include "base/test/task_test_util.h"
@@ -1181,6 +1182,90 @@ TEST_F(BgpAttrTest, ExtCommunityAppend2) {
     EXPECT_EQ(0, extcomm1.CompareTo(extcomm2));
 }
 
+//
+// Appending values that interleave with the existing ones keeps the list
+// sorted and produces the same hash as building the list from scratch.
+//
+TEST_F(BgpAttrTest, ExtCommunityAppend3) {
+    ExtCommunitySpec spec1;
+    for (int idx = 1; idx < 9; idx += 2)
+        spec1.communities.push_back(100 * idx);
+    ExtCommunity extcomm1(extcomm_db_, spec1);
+
+    ExtCommunity::ExtCommunityList list;
+    for (int idx = 8; idx >= 2; idx -= 2) {
+        ExtCommunity::ExtCommunityValue comm;
+        put_value(comm.data(), comm.size(), 100 * idx);
+        list.push_back(comm);
+    }
+    AppendExtendedCommunity(extcomm1, list);
+
+    ExtCommunitySpec spec2;
+    for (int idx = 1; idx < 9; idx++)
+        spec2.communities.push_back(100 * idx);
+    ExtCommunity extcomm2(extcomm_db_, spec2);
+
+    EXPECT_EQ(0, extcomm1.CompareTo(extcomm2));
+    EXPECT_EQ(hash_value(extcomm2), hash_value(extcomm1));
+    ExtCommunity::ExtCommunityList sorted_list(extcomm1.communities());
+    std::sort(sorted_list.begin(), sorted_list.end());
+    EXPECT_TRUE(sorted_list == extcomm1.communities());
+}
+
+TEST_F(BgpAttrTest, ExtCommunityRemoveAndLocate) {
+    ExtCommunitySpec spec;
+    for (int idx = 1; idx < 5; idx++)
+        spec.communities.push_back(100 * idx);
+    ExtCommunityPtr extcomm1 = extcomm_db_->Locate(spec);
+
+    // Nothing to remove - should get back the same interned instance.
+    ExtCommunityPtr extcomm2 = extcomm_db_->RemoveAndLocate(
+        extcomm1.get(), &ExtCommunity::is_origin_vn);
+    EXPECT_EQ(extcomm1.get(), extcomm2.get());
+    EXPECT_EQ(1, extcomm_db_->Size());
+
+    OriginVn origin_vn(64512, 100);
+    ExtCommunityPtr extcomm3 = extcomm_db_->AppendAndLocate(
+        extcomm1.get(), origin_vn.GetExtCommunity());
+    EXPECT_EQ(5, extcomm3->communities().size());
+    EXPECT_EQ(2, extcomm_db_->Size());
+
+    ExtCommunityPtr extcomm4 = extcomm_db_->RemoveAndLocate(
+        extcomm3.get(), &ExtCommunity::is_origin_vn);
+    EXPECT_EQ(extcomm1.get(), extcomm4.get());
+    EXPECT_EQ(2, extcomm_db_->Size());
+}
+
+TEST_F(BgpAttrTest, ExtCommunityReplaceAndLocate) {
+    ExtCommunitySpec spec1;
+    for (int idx = 1; idx < 5; idx++)
+        spec1.communities.push_back(100 * idx);
+    for (int idx = 1; idx < 3; idx++) {
+        OriginVn origin_vn(64512, 100 * idx);
+        spec1.communities.push_back(origin_vn.GetExtCommunityValue());
+    }
+    ExtCommunityPtr extcomm1 = extcomm_db_->Locate(spec1);
+    EXPECT_EQ(6, extcomm1->communities().size());
+
+    OriginVn origin_vn(64512, 300);
+    ExtCommunityPtr extcomm2 = extcomm_db_->ReplaceAndLocate(
+        extcomm1.get(), &ExtCommunity::is_origin_vn,
+        origin_vn.GetExtCommunity());
+    EXPECT_EQ(5, extcomm2->communities().size());
+    EXPECT_TRUE(extcomm2->ContainsOriginVn(origin_vn.GetExtCommunity()));
+    ExtCommunity::ExtCommunityList sorted_list(extcomm2->communities());
+    std::sort(sorted_list.begin(), sorted_list.end());
+    EXPECT_TRUE(sorted_list == extcomm2->communities());
+
+    ExtCommunitySpec spec3;
+    for (int idx = 1; idx < 5; idx++)
+        spec3.communities.push_back(100 * idx);
+    spec3.communities.push_back(origin_vn.GetExtCommunityValue());
+    ExtCommunityPtr extcomm3 = extcomm_db_->Locate(spec3);
+    EXPECT_EQ(extcomm2.get(), extcomm3.get());
+    EXPECT_EQ(2, extcomm_db_->Size());
+}
+
 TEST_F(BgpAttrTest, SequenceNumber1) {
     BgpAttrSpec attr_spec;
     ExtCommunitySpec spec;
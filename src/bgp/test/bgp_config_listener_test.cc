@@ -2,6 +2,7 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <algorithm>
 #include <fstream>
 
 #include "base/task_annotations.h"
@@ -18,6 +19,7 @@
 #include "ifmap/ifmap_dependency_tracker.h"
 #include "ifmap/ifmap_link_table.h"
 #include "ifmap/ifmap_node.h"
+#include "ifmap/ifmap_server_table.h"
 #include "ifmap/test/ifmap_test_util.h"
 #include "schema/bgp_schema_types.h"
 #include "schema/vnc_cfg_types.h"
@@ -159,6 +161,28 @@ protected:
         return count;
     }
 
+    static BgpConfigDelta BuildDelta(const string &id_type,
+        const string &id_name, IFMapObject *obj = NULL) {
+        BgpConfigDelta delta;
+        delta.id_type = id_type;
+        delta.id_name = id_name;
+        delta.obj = IFMapObjectRef(obj);
+        return delta;
+    }
+
+    static void CoalesceChanges(ChangeList *change_list) {
+        BgpIfmapConfigManager::CoalesceChanges(change_list);
+    }
+
+    static bool IsRoutingPolicyLink(const BgpConfigDelta &delta) {
+        return delta.id_type == "routing-policy-routing-instance";
+    }
+
+    void MoveRoutingPolicyLinksToFront() {
+        stable_partition(change_list_->begin(), change_list_->end(),
+            IsRoutingPolicyLink);
+    }
+
     size_t GetNodeListCount() {
         return tracker_->node_list().size();
     }
@@ -2237,6 +2261,106 @@ TEST_F(BgpConfigListenerTest, RouteAggregate_6) {
     task_util::WaitForIdle();
 }
 
+//
+// Duplicate deltas for the same object are collapsed into one. The delta is
+// kept at the position of the first occurrence and has the contents of the
+// last occurrence. Deltas are ordered by identifier type so that objects are
+// processed before the links that refer to them.
+//
+TEST_F(BgpConfigListenerTest, CoalesceChanges) {
+    string content = ReadFile("controller/src/bgp/testdata/config_listener_test_9.xml");
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+    IFMapNode *node =
+        ifmap_test_util::IFMapNodeLookup(&db_, "routing-instance", "test");
+    ASSERT_TRUE(node != NULL);
+    IFMapObject *obj = node->GetObject();
+
+    ChangeList change_list;
+    change_list.push_back(
+        BuildDelta("routing-policy-routing-instance", "attr(blue,p1)", obj));
+    change_list.push_back(BuildDelta("routing-instance", "red"));
+    change_list.push_back(BuildDelta("routing-instance", "blue", obj));
+    change_list.push_back(BuildDelta("bgp-peering", "attr(local,remote)"));
+    change_list.push_back(BuildDelta("routing-instance", "red", obj));
+    change_list.push_back(BuildDelta("routing-policy", "p1", obj));
+    change_list.push_back(BuildDelta("routing-instance", "blue"));
+    change_list.push_back(BuildDelta("routing-instance", "green", obj));
+    change_list.push_back(
+        BuildDelta("routing-policy-routing-instance", "attr(blue,p1)", obj));
+    change_list.push_back(BuildDelta("routing-policy", "p1", obj));
+    CoalesceChanges(&change_list);
+
+    ASSERT_EQ(6, change_list.size());
+    EXPECT_EQ("routing-policy", change_list[0].id_type);
+    EXPECT_EQ("p1", change_list[0].id_name);
+    EXPECT_EQ("routing-instance", change_list[1].id_type);
+    EXPECT_EQ("red", change_list[1].id_name);
+    EXPECT_EQ("routing-instance", change_list[2].id_type);
+    EXPECT_EQ("blue", change_list[2].id_name);
+    EXPECT_EQ("routing-instance", change_list[3].id_type);
+    EXPECT_EQ("green", change_list[3].id_name);
+    EXPECT_EQ("routing-policy-routing-instance", change_list[4].id_type);
+    EXPECT_EQ("attr(blue,p1)", change_list[4].id_name);
+    EXPECT_EQ("bgp-peering", change_list[5].id_type);
+    EXPECT_EQ("attr(local,remote)", change_list[5].id_name);
+
+    // Delete followed by add for red and add followed by delete for blue.
+    EXPECT_TRUE(change_list[1].obj.get() == obj);
+    EXPECT_TRUE(change_list[2].obj.get() == NULL);
+    change_list.clear();
+
+    boost::replace_all(content, "<config>", "<delete>");
+    boost::replace_all(content, "</config>", "</delete>");
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+}
+
+//
+// Links between the routing-instance and the routing-policies show up on the
+// change list before the routing-instance and the routing-policies. The links
+// must still get created even though each of them is processed only once.
+//
+TEST_F(BgpConfigListenerTest, CoalesceChangesRoutingPolicyLinkFirst) {
+    PauseChangeListPropagation();
+    string content = ReadFile("controller/src/bgp/testdata/config_listener_test_9.xml");
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+
+    PerformChangeListPropagation();
+    TASK_UTIL_EXPECT_EQ(2, GetChangeListCount("routing-policy"));
+    TASK_UTIL_EXPECT_LE(1, GetChangeListCount("routing-instance"));
+    TASK_UTIL_EXPECT_LE(2,
+        GetChangeListCount("routing-policy-routing-instance"));
+    MoveRoutingPolicyLinksToFront();
+    EXPECT_TRUE(IsRoutingPolicyLink(change_list_->front()));
+
+    ResumeChangeListPropagation();
+    TASK_UTIL_EXPECT_EQ(0, GetChangeListCount());
+
+    const BgpIfmapConfigData *config = config_manager_->config();
+    TASK_UTIL_EXPECT_TRUE(config->FindInstance("test") != NULL);
+    IFMapNode *rti_node =
+        ifmap_test_util::IFMapNodeLookup(&db_, "routing-instance", "test");
+    ASSERT_TRUE(rti_node != NULL);
+    const char *policies[] = { "basic_0", "basic_1" };
+    for (size_t idx = 0; idx < 2; ++idx) {
+        const char *policy = policies[idx];
+        TASK_UTIL_EXPECT_TRUE(config->FindRoutingPolicy(policy) != NULL);
+        IFMapNode *rtp_node =
+            ifmap_test_util::IFMapNodeLookup(&db_, "routing-policy", policy);
+        ASSERT_TRUE(rtp_node != NULL);
+        string link_name = IFMapServerTable::LinkAttrKey(rti_node, rtp_node);
+        TASK_UTIL_EXPECT_TRUE(
+            config->FindRoutingPolicyLink(link_name) != NULL);
+    }
+
+    boost::replace_all(content, "<config>", "<delete>");
+    boost::replace_all(content, "</config>", "</delete>");
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+}
+
 int main(int argc, char **argv) {
     bgp_log_test::init();
     ControlNode::SetDefaultSchedulingPolicy();
@@ -10,6 +10,7 @@
 #include <boost/assign/list_of.hpp>
 
 #include "base/task_annotations.h"
+#include "base/time_util.h"
 #include "base/test/task_test_util.h"
 #include "bgp/bgp_common.h"
 #include "bgp/bgp_config_ifmap.h"
@@ -42,6 +43,56 @@ static string FileRead(const string &filename) {
     return content;
 }
 
+class PeerMock : public IPeer {
+public:
+    PeerMock(bool is_xmpp, const string &address_str)
+        : is_xmpp_(is_xmpp) {
+        boost::system::error_code ec;
+        address_ = Ip4Address::from_string(address_str, ec);
+        assert(ec.value() == 0);
+        address_str_ = address_.to_string();
+    }
+    virtual ~PeerMock() { }
+    virtual const string &ToString() const { return address_str_; }
+    virtual const string &ToUVEKey() const { return address_str_; }
+    virtual bool SendUpdate(const uint8_t *msg, size_t msgsize) { return true; }
+    virtual BgpServer *server() { return NULL; }
+    virtual BgpServer *server() const { return NULL; }
+    virtual IPeerClose *peer_close() { return NULL; }
+    virtual IPeerClose *peer_close() const { return NULL; }
+    virtual void UpdateCloseRouteStats(Address::Family family,
+        const BgpPath *old_path, uint32_t path_flags) const {
+    }
+    virtual IPeerDebugStats *peer_stats() { return NULL; }
+    virtual const IPeerDebugStats *peer_stats() const { return NULL; }
+    virtual bool IsReady() const { return true; }
+    virtual bool IsXmppPeer() const { return is_xmpp_; }
+    virtual bool IsRegistrationRequired() const { return false; }
+    virtual void Close(bool graceful) { }
+    BgpProto::BgpPeerType PeerType() const {
+        return is_xmpp_ ? BgpProto::XMPP : BgpProto::EBGP;
+    }
+    virtual uint32_t bgp_identifier() const {
+        return htonl(address_.to_ulong());
+    }
+    virtual const string GetStateName() const { return ""; }
+    virtual void UpdateTotalPathCount(int count) const { }
+    virtual int GetTotalPathCount() const { return 0; }
+    virtual void UpdatePrimaryPathCount(int count,
+        Address::Family family) const { }
+    virtual int GetPrimaryPathCount() const { return 0; }
+    virtual void MembershipRequestCallback(BgpTable *table) { }
+    virtual bool MembershipPathCallback(DBTablePartBase *tpart,
+        BgpRoute *route, BgpPath *path) { return false; }
+    virtual bool CanUseMembershipManager() const { return true; }
+    virtual bool IsInGRTimerWaitState() const { return false; }
+
+private:
+    bool is_xmpp_;
+    Ip4Address address_;
+    string address_str_;
+};
+
 class BgpConfigTest : public ::testing::Test {
 protected:
     BgpConfigTest()
@@ -3783,6 +3834,81 @@ TEST_F(BgpConfigTest, BgpAlwaysCompareMedChange) {
     TASK_UTIL_EXPECT_EQ(0, db_graph_.vertex_count());
 }
 
+//
+// Paths from xmpp peers are not affected when peers are cleared on a change
+// in the always-compare-med knob. Verify that the paths are sorted again and
+// the best path follows the knob.
+//
+TEST_F(BgpConfigTest, BgpAlwaysCompareMedChangeXmppPaths) {
+    string content_a =
+        FileRead("controller/src/bgp/testdata/config_test_46a.xml");
+    EXPECT_TRUE(parser_.Parse(content_a));
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_FALSE(server_.global_config()->always_compare_med());
+
+    BgpTable *table =
+        static_cast<BgpTable *>(server_.database()->FindTable("inet.0"));
+    TASK_UTIL_ASSERT_TRUE(table != NULL);
+
+    // Path from peer1 wins on router id, path from peer2 on med.
+    PeerMock peer1(true, "10.1.1.1");
+    PeerMock peer2(true, "10.1.1.2");
+    Ip4Prefix prefix(Ip4Prefix::FromString("192.168.1.0/24"));
+    PeerMock *peers[] = { &peer1, &peer2 };
+    uint32_t meds[] = { 200, 100 };
+    for (int idx = 0; idx < 2; ++idx) {
+        BgpAttrSpec attr_spec;
+        BgpAttrMultiExitDisc med_spec(meds[idx]);
+        attr_spec.push_back(&med_spec);
+        BgpAttrPtr attr = server_.attr_db()->Locate(attr_spec);
+        DBRequest req;
+        req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+        req.key.reset(new InetTable::RequestKey(prefix, peers[idx]));
+        req.data.reset(new InetTable::RequestData(attr, 0, 0));
+        table->Enqueue(&req);
+    }
+    task_util::WaitForIdle();
+
+    InetTable::RequestKey key(prefix, NULL);
+    BgpRoute *route = static_cast<BgpRoute *>(table->Find(&key));
+    TASK_UTIL_ASSERT_TRUE(route != NULL);
+    TASK_UTIL_EXPECT_EQ(2, route->count());
+    TASK_UTIL_EXPECT_EQ(&peer1, route->BestPath()->GetPeer());
+
+    string content_b =
+        FileRead("controller/src/bgp/testdata/config_test_46b.xml");
+    EXPECT_TRUE(parser_.Parse(content_b));
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_TRUE(server_.global_config()->always_compare_med());
+    TASK_UTIL_EXPECT_EQ(2, route->count());
+    TASK_UTIL_EXPECT_EQ(&peer2, route->BestPath()->GetPeer());
+
+    string content_c =
+        FileRead("controller/src/bgp/testdata/config_test_46c.xml");
+    EXPECT_TRUE(parser_.Parse(content_c));
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_FALSE(server_.global_config()->always_compare_med());
+    TASK_UTIL_EXPECT_EQ(2, route->count());
+    TASK_UTIL_EXPECT_EQ(&peer1, route->BestPath()->GetPeer());
+
+    for (int idx = 0; idx < 2; ++idx) {
+        DBRequest req;
+        req.oper = DBRequest::DB_ENTRY_DELETE;
+        req.key.reset(new InetTable::RequestKey(prefix, peers[idx]));
+        table->Enqueue(&req);
+    }
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(0, table->Size());
+
+    boost::replace_all(content_c, "<config>", "<delete>");
+    boost::replace_all(content_c, "</config>", "</delete>");
+    EXPECT_TRUE(parser_.Parse(content_c));
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_EQ(0, db_graph_.edge_count());
+    TASK_UTIL_EXPECT_EQ(0, db_graph_.vertex_count());
+}
+
 TEST_F(BgpConfigTest, BgpaaServiceParametersChange) {
     string content_a =
         FileRead("controller/src/bgp/testdata/config_test_46a.xml");
@@ -3814,6 +3940,77 @@ TEST_F(BgpConfigTest, BgpaaServiceParametersChange) {
     TASK_UTIL_EXPECT_EQ(0, db_graph_.vertex_count());
 }
 
+//
+// Create a large number of instances in one shot, similar to what happens
+// when the config snapshot is read after a restart, and report the config
+// processing stats.
+//
+// Each instance has multiple instance-target links, so there should be
+// multiple deltas for each routing-instance.
+//
+// Set INSTANCE_COUNT to change the number of instances.
+//
+TEST_F(BgpConfigTest, BulkInstanceCreate) {
+    int instance_count = 1024;
+    char *str = getenv("INSTANCE_COUNT");
+    if (str)
+        instance_count = strtoul(str, NULL, 0);
+
+    ostringstream oss;
+    oss << "<?xml version=\"1.0\" encoding\"utf-\"?>\n";
+    oss << "<config>\n";
+    for (int idx = 1; idx <= instance_count; ++idx) {
+        oss << "<routing-instance name=\"red" << idx << "\">\n";
+        oss << "  <vrf-target>target:1:" << idx << "</vrf-target>\n";
+        oss << "  <vrf-target>target:2:" << idx << "</vrf-target>\n";
+        oss << "  <vrf-target>\n";
+        oss << "    target:3:" << idx << "\n";
+        oss << "    <import-export>export</import-export>\n";
+        oss << "  </vrf-target>\n";
+        oss << "</routing-instance>\n";
+    }
+    oss << "</config>\n";
+
+    string content = oss.str();
+    uint64_t start = UTCTimestampUsec();
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+
+    RoutingInstanceMgr *mgr = server_.routing_instance_mgr();
+    TASK_UTIL_EXPECT_EQ(instance_count + 1, mgr->count());
+    for (int idx = 1; idx <= instance_count; ++idx) {
+        string name = "red" + integerToString(idx);
+        TASK_UTIL_EXPECT_TRUE(mgr->GetRoutingInstance(name) != NULL);
+        RoutingInstance *rtinstance = mgr->GetRoutingInstance(name);
+        TASK_UTIL_EXPECT_EQ(2, rtinstance->GetImportList().size());
+        TASK_UTIL_EXPECT_EQ(3, rtinstance->GetExportList().size());
+    }
+
+    const BgpConfigPhaseStats &config_stats =
+        server_.config_manager()->config_stats();
+    BgpConfigPhaseStats instance_stats = mgr->GetInstanceConfigStats();
+    EXPECT_LE(instance_count, config_stats.processed);
+    EXPECT_LT(0, config_stats.skipped);
+    EXPECT_LE(instance_count, instance_stats.processed);
+    EXPECT_LE(start, config_stats.first_at);
+    EXPECT_LE(config_stats.first_at, instance_stats.first_at);
+    cout << "Instances " << instance_count
+         << " Config(usec) " << config_stats.last_at - start
+         << " ConfigBusy(usec) " << config_stats.busy_usec
+         << " Deltas " << config_stats.processed
+         << " Coalesced " << config_stats.skipped
+         << " Instance(usec) " << instance_stats.last_at - start
+         << " InstanceBusy(usec) " << instance_stats.busy_usec
+         << endl;
+
+    boost::replace_all(content, "<config>", "<delete>");
+    boost::replace_all(content, "</config>", "</delete>");
+    EXPECT_TRUE(parser_.Parse(content));
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(1, mgr->count());
+    TASK_UTIL_EXPECT_EQ(0, db_graph_.vertex_count());
+}
+
 int main(int argc, char **argv) {
     bgp_log_test::init();
     ControlNode::SetDefaultSchedulingPolicy();
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <iostream>
+
+#include "bgp/test/bgp_evpn_manager_test.h"
+
+//
+// Measure the cost of joins and leaves of EvpnMcastNodes in a large L2 VN.
+//
+// The remote nodes are vRouters attached to other control nodes and support
+// edge replication, as do the local nodes. Hence the OList for each local
+// node has only the BGP peers, which don't support edge replication. A join
+// or leave of a vRouter should not cause the Broadcast MAC routes of all the
+// local nodes to be re-evaluated and building the OList for a local node
+// should not need to look at all the remote nodes.
+//
+// Set EVPN_SCALE_LOCAL_NODE_COUNT and EVPN_SCALE_REMOTE_NODE_COUNT to change
+// the number of local and remote nodes.
+//
+class BgpEvpnManagerScaleTest : public BgpEvpnManagerTest {
+protected:
+    BgpEvpnManagerScaleTest()
+        : local_node_count_(2048), remote_node_count_(2048) {
+    }
+
+    virtual void SetUp() {
+        char *str = getenv("EVPN_SCALE_LOCAL_NODE_COUNT");
+        if (str)
+            local_node_count_ = strtoul(str, NULL, 0);
+        str = getenv("EVPN_SCALE_REMOTE_NODE_COUNT");
+        if (str)
+            remote_node_count_ = strtoul(str, NULL, 0);
+
+        BgpEvpnManagerTest::SetUp();
+        for (int idx = 0; idx < local_node_count_; ++idx) {
+            Ip4Address address(0x0b000000 + idx + 1);
+            local_peers_.push_back(
+                new PeerMock(idx + 1, address, true, 1000 + idx));
+        }
+        for (int idx = 0; idx < remote_node_count_; ++idx) {
+            Ip4Address address(0x0c000000 + idx + 1);
+            PeerMock *peer = new PeerMock(idx + 1, address, false, 1000 + idx);
+            peer->set_edge_replication_supported(true);
+            remote_peers_.push_back(peer);
+        }
+    }
+
+    virtual void TearDown() {
+        STLDeleteValues(&remote_peers_);
+        STLDeleteValues(&local_peers_);
+        BgpEvpnManagerTest::TearDown();
+    }
+
+    void AddLocalNodes() {
+        BOOST_FOREACH(PeerMock *peer, local_peers_) {
+            EnqueueXmppPeerBroadcastMacRoute(peer, tag_);
+        }
+        task_util::WaitForIdle();
+    }
+
+    void DelLocalNodes() {
+        BOOST_FOREACH(PeerMock *peer, local_peers_) {
+            EnqueueDelXmppPeerBroadcastMacRoute(peer, tag_);
+        }
+        task_util::WaitForIdle();
+    }
+
+    void AddRemoteNodes() {
+        BOOST_FOREACH(PeerMock *peer, remote_peers_) {
+            EnqueueBgpPeerInclusiveMulticastRoute(peer, tag_);
+        }
+        task_util::WaitForIdle();
+    }
+
+    void DelRemoteNodes() {
+        BOOST_FOREACH(PeerMock *peer, remote_peers_) {
+            EnqueueDelBgpPeerInclusiveMulticastRoute(peer, tag_);
+        }
+        task_util::WaitForIdle();
+    }
+
+    //
+    // Build the UpdateInfo for the Broadcast MAC route of all local nodes
+    // and verify that the OList has all the BGP peers.
+    //
+    void BuildUpdateInfo() {
+        ConcurrencyScope scope("db::DBTable");
+        BOOST_FOREACH(PeerMock *peer, local_peers_) {
+            RouteDistinguisher rd(peer->address().to_ulong(), kVrfId);
+            EvpnPrefix prefix(rd, tag_, MacAddress::BroadcastMac(),
+                IpAddress());
+            EvpnTable::RequestKey key(prefix, peer);
+            EvpnRoute *rt = dynamic_cast<EvpnRoute *>(blue_->Find(&key));
+            ASSERT_TRUE(rt != NULL);
+            UpdateInfoPtr uinfo(blue_manager_->GetUpdateInfo(rt));
+            ASSERT_TRUE(uinfo != NULL);
+            const BgpAttr *attr = uinfo->roattr.attr();
+            EXPECT_EQ(bgp_peers_.size(), attr->olist()->elements().size());
+        }
+    }
+
+    void Run(const string &operation, void (BgpEvpnManagerScaleTest::*fn)()) {
+        uint64_t start = ClockMonotonicUsec();
+        (this->*fn)();
+        uint64_t elapsed = ClockMonotonicUsec() - start;
+        cout << "Local " << local_node_count_
+             << " Remote " << remote_node_count_
+             << " Operation " << operation
+             << " Elapsed(usec) " << elapsed
+             << endl;
+    }
+
+    int local_node_count_;
+    int remote_node_count_;
+    vector<PeerMock *> local_peers_;
+    vector<PeerMock *> remote_peers_;
+};
+
+TEST_P(BgpEvpnManagerScaleTest, JoinLeave) {
+    AddAllBgpPeersInclusiveMulticastRoute();
+    Run("AddLocal", &BgpEvpnManagerScaleTest::AddLocalNodes);
+    Run("AddRemote", &BgpEvpnManagerScaleTest::AddRemoteNodes);
+    Run("BuildUpdateInfo", &BgpEvpnManagerScaleTest::BuildUpdateInfo);
+    Run("DelRemote", &BgpEvpnManagerScaleTest::DelRemoteNodes);
+    Run("DelLocal", &BgpEvpnManagerScaleTest::DelLocalNodes);
+    DelAllBgpPeersInclusiveMulticastRoute();
+}
+
+INSTANTIATE_TEST_CASE_P(Default, BgpEvpnManagerScaleTest, ::testing::Values(0));
+
+static void SetUp() {
+    ControlNode::SetDefaultSchedulingPolicy();
+    BgpServerTest::GlobalSetUp();
+    BgpObjectFactory::Register<BgpXmppMessageBuilder>(
+        boost::factory<BgpXmppMessageBuilder *>());
+}
+
+static void TearDown() {
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    bgp_log_test::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+
+    return result;
+}
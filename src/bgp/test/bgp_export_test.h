@@ -355,7 +355,7 @@ protected:
             AdvertiseInfo *ainfo = new AdvertiseInfo;
             assert(attr_vec->at(idx));
             ainfo->roattr.set_attr(&table_, attr_vec->at(idx).get());
-            ainfo->bitset = *peerset_vec->at(idx);
+            ainfo->set_bitset(server_.peerset_db(), *peerset_vec->at(idx));
             adv_slist->push_front(*ainfo);
         }
     }
@@ -541,7 +541,7 @@ protected:
         EXPECT_EQ(1, rstate->Advertised()->size());
         const AdvertiseInfo *ainfo = rstate->FindHistory(roattrX);
         EXPECT_TRUE(ainfo != NULL);
-        EXPECT_TRUE(ainfo->bitset == adv_peerset);
+        EXPECT_TRUE(ainfo->bitset() == adv_peerset);
     }
 
     void VerifyHistory(RouteState *rstate,
@@ -551,7 +551,7 @@ protected:
         EXPECT_EQ(1, rstate->Advertised()->size());
         const AdvertiseInfo *ainfo = rstate->FindHistory(roattrX);
         EXPECT_TRUE(ainfo != NULL);
-        EXPECT_TRUE(ainfo->bitset == adv_peerset);
+        EXPECT_TRUE(ainfo->bitset() == adv_peerset);
     }
 
     void VerifyHistory(RouteState *rstate, BgpAttrPtr attr_blk[],
@@ -562,7 +562,7 @@ protected:
             RibOutAttr roattrX(&table_, attr_blk[idx].get(), 0);
             const AdvertiseInfo *ainfo = rstate->FindHistory(roattrX);
             EXPECT_TRUE(ainfo != NULL);
-            EXPECT_TRUE(ainfo->bitset == peerset_[idx]);
+            EXPECT_TRUE(ainfo->bitset() == peerset_[idx]);
         }
     }
 
@@ -575,7 +575,7 @@ protected:
         EXPECT_EQ(1, rt_update->History()->size());
         const AdvertiseInfo *ainfo = rt_update->FindHistory(roattrX);
         EXPECT_TRUE(ainfo != NULL);
-        EXPECT_TRUE(ainfo->bitset == adv_peerset);
+        EXPECT_TRUE(ainfo->bitset() == adv_peerset);
     }
 
     void VerifyHistory(RouteUpdate *rt_update,
@@ -585,7 +585,7 @@ protected:
         EXPECT_EQ(1, rt_update->History()->size());
         const AdvertiseInfo *ainfo = rt_update->FindHistory(roattrX);
         EXPECT_TRUE(ainfo != NULL);
-        EXPECT_TRUE(ainfo->bitset == adv_peerset);
+        EXPECT_TRUE(ainfo->bitset() == adv_peerset);
     }
 
     void VerifyHistory(RouteUpdate *rt_update, BgpAttrPtr attr_blk[],
@@ -596,7 +596,7 @@ protected:
             RibOutAttr roattrX(&table_, attr_blk[idx].get(), 0);
             const AdvertiseInfo *ainfo = rt_update->FindHistory(roattrX);
             EXPECT_TRUE(ainfo != NULL);
-            EXPECT_TRUE(ainfo->bitset == peerset_[idx]);
+            EXPECT_TRUE(ainfo->bitset() == peerset_[idx]);
         }
     }
 
@@ -609,7 +609,7 @@ protected:
         EXPECT_EQ(1, uplist->History()->size());
         const AdvertiseInfo *ainfo = uplist->FindHistory(roattrX);
         EXPECT_TRUE(ainfo != NULL);
-        EXPECT_TRUE(ainfo->bitset == adv_peerset);
+        EXPECT_TRUE(ainfo->bitset() == adv_peerset);
     }
 
     void VerifyHistory(UpdateList *uplist,
@@ -619,7 +619,7 @@ protected:
         EXPECT_EQ(1, uplist->History()->size());
         const AdvertiseInfo *ainfo = uplist->FindHistory(roattrX);
         EXPECT_TRUE(ainfo != NULL);
-        EXPECT_TRUE(ainfo->bitset == adv_peerset);
+        EXPECT_TRUE(ainfo->bitset() == adv_peerset);
     }
 
     void VerifyAdvertiseCount(int count) {
@@ -13,6 +13,7 @@
 #include "bgp/bgp_membership.h"
 #include "bgp/bgp_session_manager.h"
 #include "bgp/test/bgp_server_test_util.h"
+#include "db/db.h"
 #include "db/db_partition.h"
 
 using boost::scoped_ptr;
@@ -229,6 +230,12 @@ protected:
     size_t GetWalkerRibOutStateListSize() {
         return walker_->GetRibOutStateListSize();
     }
+    size_t GetWalkerLatePeerRibListSize() {
+        return walker_->GetLatePeerRibListSize();
+    }
+    void WalkerSetPartitionsStarted() {
+        walker_->entry_counts_.assign(DB::PartitionCount(), 1);
+    }
     void WalkerPostponeWalk() { walker_->PostponeWalk(); }
     void WalkerResumeWalk() { walker_->ResumeWalk(); }
 
@@ -673,8 +680,8 @@ TEST_F(BgpMembershipTest, MultiplePeers2) {
 
 //
 // Verify register/unregister of multiple peers to single table.
-// Register for remaining peers needs another table walk if walk has already
-// been started for some peers.
+// Register for remaining peers joins the table walk that has already been
+// started for some peers.
 //
 TEST_F(BgpMembershipTest, MultiplePeers3) {
     uint64_t blue_walk_count = blue_tbl_->walk_complete_count();
@@ -690,10 +697,12 @@ TEST_F(BgpMembershipTest, MultiplePeers3) {
     TASK_UTIL_EXPECT_EQ(blue_walk_count, blue_tbl_->walk_complete_count());
 
     // Register remaining peers.
+    // They should join the walk that has already been started.
     Register(peers_[1], blue_tbl_);
     Register(peers_[2], blue_tbl_);
     task_util::WaitForIdle();
-    TASK_UTIL_EXPECT_EQ(1, GetWalkerQueueSize());
+    TASK_UTIL_EXPECT_EQ(0, GetWalkerQueueSize());
+    TASK_UTIL_EXPECT_EQ(2, GetWalkerLatePeerRibListSize());
     TASK_UTIL_EXPECT_EQ(blue_walk_count, blue_tbl_->walk_request_count());
     TASK_UTIL_EXPECT_EQ(blue_walk_count, blue_tbl_->walk_complete_count());
 
@@ -703,8 +712,8 @@ TEST_F(BgpMembershipTest, MultiplePeers3) {
 
     TASK_UTIL_EXPECT_EQ(0, GetWalkerQueueSize());
     TASK_UTIL_EXPECT_EQ(3, mgr_->GetMembershipCount());
-    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_request_count());
-    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 1, blue_tbl_->walk_request_count());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 1, blue_tbl_->walk_complete_count());
 
     // Disable walker.
     SetWalkerDisable(true);
@@ -716,8 +725,8 @@ TEST_F(BgpMembershipTest, MultiplePeers3) {
     task_util::WaitForIdle();
 
     TASK_UTIL_EXPECT_EQ(1, GetWalkerQueueSize());
-    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_request_count());
-    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 1, blue_tbl_->walk_request_count());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 1, blue_tbl_->walk_complete_count());
 
     // Enable walker.
     SetWalkerDisable(false);
@@ -725,14 +734,14 @@ TEST_F(BgpMembershipTest, MultiplePeers3) {
 
     TASK_UTIL_EXPECT_EQ(0, GetWalkerQueueSize());
     TASK_UTIL_EXPECT_EQ(0, mgr_->GetMembershipCount());
-    TASK_UTIL_EXPECT_EQ(blue_walk_count + 3, blue_tbl_->walk_request_count());
-    TASK_UTIL_EXPECT_EQ(blue_walk_count + 3, blue_tbl_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_request_count());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_complete_count());
 }
 
 //
 // Verify register/unregister of multiple peers to single table.
-// Unregister for remaining peers needs another table walk if walk has already
-// been started for some peers.
+// Unregister for remaining peers joins the table walk that has already been
+// started for some peers.
 //
 TEST_F(BgpMembershipTest, MultiplePeers4) {
     uint64_t blue_walk_count = blue_tbl_->walk_complete_count();
@@ -770,11 +779,13 @@ TEST_F(BgpMembershipTest, MultiplePeers4) {
     TASK_UTIL_EXPECT_EQ(blue_walk_count + 1, blue_tbl_->walk_complete_count());
 
     // Unregister remaining peers.
+    // They should join the walk that has already been started.
     Unregister(peers_[1], blue_tbl_);
     Unregister(peers_[2], blue_tbl_);
     task_util::WaitForIdle();
 
-    TASK_UTIL_EXPECT_EQ(1, GetWalkerQueueSize());
+    TASK_UTIL_EXPECT_EQ(0, GetWalkerQueueSize());
+    TASK_UTIL_EXPECT_EQ(2, GetWalkerLatePeerRibListSize());
     TASK_UTIL_EXPECT_EQ(blue_walk_count + 1, blue_tbl_->walk_request_count());
     TASK_UTIL_EXPECT_EQ(blue_walk_count + 1, blue_tbl_->walk_complete_count());
 
@@ -784,8 +795,8 @@ TEST_F(BgpMembershipTest, MultiplePeers4) {
 
     TASK_UTIL_EXPECT_EQ(0, GetWalkerQueueSize());
     TASK_UTIL_EXPECT_EQ(0, mgr_->GetMembershipCount());
-    TASK_UTIL_EXPECT_EQ(blue_walk_count + 3, blue_tbl_->walk_request_count());
-    TASK_UTIL_EXPECT_EQ(blue_walk_count + 3, blue_tbl_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_request_count());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_complete_count());
 }
 
 //
@@ -942,6 +953,217 @@ TEST_F(BgpMembershipTest, MultiplePeersWalkRibIn) {
     TASK_UTIL_EXPECT_EQ(0, mgr_->GetMembershipCount());
 }
 
+//
+// Verify walk statistics when walk requests from multiple peers are combined
+// into a single table walk.
+//
+TEST_F(BgpMembershipTest, MultiplePeersWalkRibInStats) {
+    static const int kRouteCount = 8;
+
+    // Register all peers.
+    Register(peers_[0], blue_tbl_);
+    Register(peers_[1], blue_tbl_);
+    Register(peers_[2], blue_tbl_);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(IsWalkerQueueEmpty());
+    TASK_UTIL_EXPECT_EQ(3, mgr_->GetMembershipCount());
+    uint64_t walk_count = mgr_->walk_count();
+    uint64_t walk_path_count = mgr_->walk_path_count();
+    uint64_t walk_path_change_count = mgr_->walk_path_change_count();
+
+    // Add paths from all peers.
+    for (int idx = 0; idx < kRouteCount; idx++) {
+        AddRoute(peers_[0], blue_tbl_, BuildPrefix(idx), "192.168.1.0");
+        AddRoute(peers_[1], blue_tbl_, BuildPrefix(idx), "192.168.1.1");
+        AddRoute(peers_[2], blue_tbl_, BuildPrefix(idx), "192.168.1.2");
+    }
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(kRouteCount, blue_tbl_->Size());
+
+    // Request walk for some peers with the walker disabled, so that they
+    // get combined into a single walk.
+    SetWalkerDisable(true);
+    WalkRibIn(peers_[0], blue_tbl_);
+    WalkRibIn(peers_[2], blue_tbl_);
+    SetWalkerDisable(false);
+    task_util::WaitForIdle();
+
+    // Paths from peers that requested the walk should have been counted.
+    TASK_UTIL_EXPECT_TRUE(IsWalkerQueueEmpty());
+    TASK_UTIL_EXPECT_EQ(walk_count + 1, mgr_->walk_count());
+    TASK_UTIL_EXPECT_EQ(walk_path_count + 2 * kRouteCount,
+        mgr_->walk_path_count());
+    TASK_UTIL_EXPECT_EQ(walk_path_change_count,
+        mgr_->walk_path_change_count());
+    TASK_UTIL_EXPECT_EQ(kRouteCount, peers_[0]->path_cb_count());
+    TASK_UTIL_EXPECT_EQ(0, peers_[1]->path_cb_count());
+    TASK_UTIL_EXPECT_EQ(kRouteCount, peers_[2]->path_cb_count());
+
+    // Delete paths from all peers.
+    for (int idx = 0; idx < kRouteCount; idx++) {
+        DeleteRoute(peers_[0], blue_tbl_, BuildPrefix(idx));
+        DeleteRoute(peers_[1], blue_tbl_, BuildPrefix(idx));
+        DeleteRoute(peers_[2], blue_tbl_, BuildPrefix(idx));
+    }
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(0, blue_tbl_->Size());
+
+    // Unregister all peers.
+    Unregister(peers_[0], blue_tbl_);
+    Unregister(peers_[1], blue_tbl_);
+    Unregister(peers_[2], blue_tbl_);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(IsWalkerQueueEmpty());
+    TASK_UTIL_EXPECT_EQ(0, mgr_->GetMembershipCount());
+}
+
+//
+// Verify WalkRibIn request that joins a table walk after all partitions have
+// started the walk. A tail walk is needed for the joining peer, but each path
+// should be processed for the peer exactly once.
+//
+TEST_F(BgpMembershipTest, MultiplePeersWalkRibInJoinTail) {
+    static const int kRouteCount = 8;
+
+    // Register all peers.
+    Register(peers_[0], blue_tbl_);
+    Register(peers_[1], blue_tbl_);
+    Register(peers_[2], blue_tbl_);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(IsWalkerQueueEmpty());
+    TASK_UTIL_EXPECT_EQ(3, mgr_->GetMembershipCount());
+    uint64_t blue_walk_count = blue_tbl_->walk_complete_count();
+    uint64_t walk_join_count = mgr_->walk_join_count();
+
+    // Add paths from all peers.
+    for (int idx = 0; idx < kRouteCount; idx++) {
+        AddRoute(peers_[0], blue_tbl_, BuildPrefix(idx), "192.168.1.0");
+        AddRoute(peers_[1], blue_tbl_, BuildPrefix(idx), "192.168.1.1");
+        AddRoute(peers_[2], blue_tbl_, BuildPrefix(idx), "192.168.1.2");
+    }
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(kRouteCount, blue_tbl_->Size());
+
+    // Request walk for first peer and postpone it.
+    WalkerPostponeWalk();
+    WalkRibIn(peers_[0], blue_tbl_);
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(1, GetWalkerPeerListSize());
+
+    // Pretend that all partitions have started the walk and request walk
+    // for another peer. It should join the ongoing walk.
+    WalkerSetPartitionsStarted();
+    WalkRibIn(peers_[2], blue_tbl_);
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(0, GetWalkerQueueSize());
+    TASK_UTIL_EXPECT_EQ(1, GetWalkerLatePeerRibListSize());
+    TASK_UTIL_EXPECT_EQ(walk_join_count + 1, mgr_->walk_join_count());
+
+    // Resume walk. There should be a tail walk for the joining peer.
+    WalkerResumeWalk();
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(IsWalkerQueueEmpty());
+    TASK_UTIL_EXPECT_EQ(0, GetWalkerLatePeerRibListSize());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_request_count());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(kRouteCount, peers_[0]->path_cb_count());
+    TASK_UTIL_EXPECT_EQ(0, peers_[1]->path_cb_count());
+    TASK_UTIL_EXPECT_EQ(kRouteCount, peers_[2]->path_cb_count());
+
+    // Delete paths from all peers.
+    for (int idx = 0; idx < kRouteCount; idx++) {
+        DeleteRoute(peers_[0], blue_tbl_, BuildPrefix(idx));
+        DeleteRoute(peers_[1], blue_tbl_, BuildPrefix(idx));
+        DeleteRoute(peers_[2], blue_tbl_, BuildPrefix(idx));
+    }
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(0, blue_tbl_->Size());
+
+    // Unregister all peers.
+    Unregister(peers_[0], blue_tbl_);
+    Unregister(peers_[1], blue_tbl_);
+    Unregister(peers_[2], blue_tbl_);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(IsWalkerQueueEmpty());
+    TASK_UTIL_EXPECT_EQ(0, mgr_->GetMembershipCount());
+}
+
+//
+// Verify WalkRibIn request that joins a table walk in which the partitions
+// finish without visiting any DBEntry, and a route gets added after that.
+// The route was not visited by the walk, so a tail walk is needed for the
+// joining peer.
+//
+TEST_F(BgpMembershipTest, MultiplePeersWalkRibInJoinEmptyPartition) {
+    // Register all peers.
+    Register(peers_[0], blue_tbl_);
+    Register(peers_[1], blue_tbl_);
+    Register(peers_[2], blue_tbl_);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(IsWalkerQueueEmpty());
+    TASK_UTIL_EXPECT_EQ(3, mgr_->GetMembershipCount());
+    TASK_UTIL_EXPECT_EQ(0, blue_tbl_->Size());
+    uint64_t blue_walk_count = blue_tbl_->walk_complete_count();
+    uint64_t walk_join_count = mgr_->walk_join_count();
+
+    // Request walk for first peer and postpone it.
+    WalkerPostponeWalk();
+    WalkRibIn(peers_[0], blue_tbl_);
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(1, GetWalkerPeerListSize());
+
+    // Request walk for another peer. It should join the ongoing walk.
+    WalkRibIn(peers_[2], blue_tbl_);
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(0, GetWalkerQueueSize());
+    TASK_UTIL_EXPECT_EQ(1, GetWalkerLatePeerRibListSize());
+    TASK_UTIL_EXPECT_EQ(walk_join_count + 1, mgr_->walk_join_count());
+
+    // Disable the walker so that the walk is not finished, and resume the
+    // walk. All partitions are empty, so they finish right away.
+    SetWalkerDisable(true);
+    WalkerResumeWalk();
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 1, blue_tbl_->walk_complete_count());
+
+    // Add a path from the joining peer to a partition that's done.
+    AddRoute(peers_[2], blue_tbl_, BuildPrefix(0), "192.168.1.2");
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(1, blue_tbl_->Size());
+
+    // Enable the walker. There should be a tail walk for the joining peer.
+    SetWalkerDisable(false);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(IsWalkerQueueEmpty());
+    TASK_UTIL_EXPECT_EQ(0, GetWalkerLatePeerRibListSize());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_request_count());
+    TASK_UTIL_EXPECT_EQ(blue_walk_count + 2, blue_tbl_->walk_complete_count());
+    TASK_UTIL_EXPECT_EQ(0, peers_[0]->path_cb_count());
+    TASK_UTIL_EXPECT_EQ(0, peers_[1]->path_cb_count());
+    TASK_UTIL_EXPECT_EQ(1, peers_[2]->path_cb_count());
+
+    // Delete path from the joining peer.
+    DeleteRoute(peers_[2], blue_tbl_, BuildPrefix(0));
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(0, blue_tbl_->Size());
+
+    // Unregister all peers.
+    Unregister(peers_[0], blue_tbl_);
+    Unregister(peers_[1], blue_tbl_);
+    Unregister(peers_[2], blue_tbl_);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(IsWalkerQueueEmpty());
+    TASK_UTIL_EXPECT_EQ(0, mgr_->GetMembershipCount());
+}
+
 //
 // Verify WalkRibIn functionality for multiple peers.
 // Walk requests from multiple peers and register from other peer is combined
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <algorithm>
+#include <iostream>
+
+#include "base/time_util.h"
+#include "bgp/test/bgp_multicast_test.h"
+
+//
+// Measure the cost of building and incrementally updating the distribution
+// tree for a (G,S) with a large number of McastForwarders.
+//
+// After the initial build, McastForwarders leave and join again one at a
+// time. Each such event should only change a handful of links and should
+// not result in labels getting re-allocated for the other McastForwarders.
+//
+// Set MCAST_FORWARDER_COUNT to change the number of McastForwarders and
+// MCAST_CHURN_COUNT to change the number of leave and join events.
+//
+TEST_F(BgpMulticastTest, LargeGroupIncrementalUpdate) {
+    int forwarder_count = 2048;
+    int churn_count = 64;
+    char *str = getenv("MCAST_FORWARDER_COUNT");
+    if (str)
+        forwarder_count = strtoul(str, NULL, 0);
+    str = getenv("MCAST_CHURN_COUNT");
+    if (str)
+        churn_count = strtoul(str, NULL, 0);
+    churn_count = std::max(1, std::min(churn_count, forwarder_count));
+
+    vector<XmppPeerMock *> peers;
+    for (int idx = 0; idx < forwarder_count; ++idx) {
+        std::ostringstream repr;
+        repr << "10.2." << ((idx + 1) >> 8) << "." << ((idx + 1) & 0xff);
+        peers.push_back(new XmppPeerMock(&server_, repr.str()));
+    }
+
+    string group_str("192.168.1.255");
+    uint64_t start = ClockMonotonicUsec();
+    for (int idx = 0; idx < forwarder_count; ++idx) {
+        peers[idx]->AddRoute(red_table_, group_str);
+    }
+    task_util::WaitForIdle();
+    uint64_t build_usec = ClockMonotonicUsec() - start;
+
+    McastSGEntry *sg_entry = FindSGEntry(red_tm_, group_str);
+    ASSERT_TRUE(sg_entry != NULL);
+    VerifyTree(sg_entry, forwarder_count);
+    uint64_t build_links = sg_entry->link_change_count();
+    uint64_t build_labels = sg_entry->label_allocation_count();
+    cout << "Forwarders " << forwarder_count
+         << " Build Elapsed(usec) " << build_usec
+         << " Links changed " << build_links
+         << " Labels allocated " << build_labels
+         << endl;
+
+    // Pick McastForwarders spread over the whole tree.
+    int step = forwarder_count / churn_count;
+    uint64_t churn_usec = 0;
+    for (int idx = 0; idx < churn_count; ++idx) {
+        XmppPeerMock *peer = peers[idx * step];
+        start = ClockMonotonicUsec();
+        peer->DelRoute(red_table_, group_str);
+        task_util::WaitForIdle();
+        peer->AddRoute(red_table_, group_str);
+        task_util::WaitForIdle();
+        churn_usec += ClockMonotonicUsec() - start;
+    }
+
+    VerifyTree(sg_entry, forwarder_count);
+    uint64_t churn_links = sg_entry->link_change_count() - build_links;
+    uint64_t churn_labels = sg_entry->label_allocation_count() - build_labels;
+    cout << "Forwarders " << forwarder_count
+         << " Churn " << churn_count
+         << " Elapsed(usec) " << churn_usec
+         << " Links changed " << churn_links
+         << " Labels allocated " << churn_labels
+         << endl;
+
+    // A leave changes at most 2 * kDegree + 3 links and a join changes one.
+    EXPECT_LE(churn_links,
+        static_cast<uint64_t>(churn_count) *
+        (2 * McastTreeManager::kDegree + 4));
+    EXPECT_EQ(static_cast<uint64_t>(churn_count), churn_labels);
+
+    for (int idx = 0; idx < forwarder_count; ++idx) {
+        peers[idx]->DelRoute(red_table_, group_str);
+    }
+    task_util::WaitForIdle();
+    VerifySGCount(red_tm_, 0);
+    STLDeleteValues(&peers);
+}
+
+int main(int argc, char **argv) {
+    bgp_log_test::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    ControlNode::SetDefaultSchedulingPolicy();
+    int result = RUN_ALL_TESTS();
+    TaskScheduler::GetInstance()->Terminate();
+    return result;
+}
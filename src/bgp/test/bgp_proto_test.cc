@@ -6,6 +6,7 @@
 #include "base/test/task_test_util.h"
 #include "control-node/control_node.h"
 #include <boost/assign/list_of.hpp>
+#include <boost/scoped_ptr.hpp>
 #include "net/bgp_af.h"
 #include "bgp/bgp_log.h"
 #include "bgp_message_test.h"
@@ -30,6 +31,17 @@ protected:
         EXPECT_EQ(offset, ec.data-data);
         EXPECT_EQ(err_size, ec.data_size);
         if (result) delete result;
+
+        // DecodeLazy must report the same error.
+        ParseErrorContext lazy_ec;
+        const BgpProto::BgpMessage *lazy_result =
+                BgpProto::DecodeLazy(&data[0], size, &lazy_ec);
+        EXPECT_TRUE(lazy_result == NULL);
+        EXPECT_EQ(error, lazy_ec.error_code);
+        EXPECT_EQ(subcode, lazy_ec.error_subcode);
+        EXPECT_EQ(offset, lazy_ec.data-data);
+        EXPECT_EQ(err_size, lazy_ec.data_size);
+        if (lazy_result) delete lazy_result;
         return true;
     }
 
@@ -59,7 +71,127 @@ protected:
         }
 
         BgpProto::BgpMessage *msg = BgpProto::Decode(new_data, data_size);
+        BgpProto::BgpMessage *lazy_msg =
+            BgpProto::DecodeLazy(new_data, data_size);
+        EXPECT_EQ(msg == NULL, lazy_msg == NULL);
         if (msg) delete msg;
+        if (lazy_msg) delete lazy_msg;
+
+        // The view must not read beyond the corrupted message.
+        BgpProto::UpdateView view;
+        if (view.Parse(new_data, data_size)) {
+            BgpProto::UpdateView::Attribute attr;
+            BgpProto::UpdateView::AttributeIterator it =
+                view.path_attributes();
+            while (it.Next(&attr)) {
+                BgpProto::UpdateView::MpNlri mp_nlri;
+                if (!BgpProto::UpdateView::ParseMpNlri(attr, &mp_nlri))
+                    continue;
+                BgpProto::UpdateView::Prefix prefix;
+                while (mp_nlri.nlri.Next(&prefix)) {
+                }
+            }
+        }
+    }
+
+    void VerifyPrefixView(BgpProto::UpdateView::PrefixIterator it,
+                          const vector<BgpProtoPrefix *> &prefixes) {
+        BgpProto::UpdateView::Prefix prefix;
+        size_t idx = 0;
+        while (it.Next(&prefix)) {
+            ASSERT_LT(idx, prefixes.size());
+            EXPECT_EQ(prefixes[idx]->type, prefix.type);
+            EXPECT_EQ(prefixes[idx]->prefixlen, prefix.prefixlen);
+            EXPECT_TRUE(prefixes[idx]->prefix ==
+                vector<uint8_t>(prefix.data, prefix.data + prefix.size));
+            idx++;
+        }
+        EXPECT_FALSE(it.error());
+        EXPECT_EQ(prefixes.size(), idx);
+    }
+
+    //
+    // Verify that walking the UpdateView for the encoded message yields the
+    // same prefixes and MpNlri attributes as the decoded message.
+    //
+    void VerifyUpdateView(const uint8_t *data, size_t size,
+                          const BgpProto::Update *update) {
+        BgpProto::UpdateView view;
+        EXPECT_TRUE(view.Parse(data, size));
+        VerifyPrefixView(view.withdrawn_routes(), update->withdrawn_routes);
+        VerifyPrefixView(view.nlri(), update->nlri);
+
+        vector<const BgpMpNlri *> mp_nlri_list;
+        for (vector<BgpAttribute *>::const_iterator it =
+             update->path_attributes.begin();
+             it != update->path_attributes.end(); ++it) {
+            if ((*it)->code == BgpAttribute::MPReachNlri ||
+                (*it)->code == BgpAttribute::MPUnreachNlri) {
+                mp_nlri_list.push_back(static_cast<const BgpMpNlri *>(*it));
+            }
+        }
+
+        BgpProto::UpdateView::AttributeIterator it = view.path_attributes();
+        BgpProto::UpdateView::Attribute attr;
+        size_t idx = 0;
+        while (it.Next(&attr)) {
+            if (attr.code != BgpAttribute::MPReachNlri &&
+                attr.code != BgpAttribute::MPUnreachNlri) {
+                continue;
+            }
+            ASSERT_LT(idx, mp_nlri_list.size());
+            const BgpMpNlri *mp_nlri = mp_nlri_list[idx];
+            BgpProto::UpdateView::MpNlri mp_nlri_view;
+            EXPECT_TRUE(
+                BgpProto::UpdateView::ParseMpNlri(attr, &mp_nlri_view));
+            EXPECT_EQ(mp_nlri->code, attr.code);
+            EXPECT_EQ(mp_nlri->afi, mp_nlri_view.afi);
+            EXPECT_EQ(mp_nlri->safi, mp_nlri_view.safi);
+            EXPECT_TRUE(mp_nlri->nexthop == vector<uint8_t>(
+                mp_nlri_view.nexthop,
+                mp_nlri_view.nexthop + mp_nlri_view.nexthop_size));
+            VerifyPrefixView(mp_nlri_view.nlri, mp_nlri->nlri);
+            idx++;
+        }
+        EXPECT_FALSE(it.error());
+        EXPECT_EQ(mp_nlri_list.size(), idx);
+    }
+
+    //
+    // Verify that DecodeLazy yields the same path attributes as the decoded
+    // message, except that there are no prefixes in the MpNlri attributes,
+    // and that it keeps the raw message.
+    //
+    void VerifyDecodeLazy(const uint8_t *data, size_t size,
+                          const BgpProto::Update *update) {
+        boost::scoped_ptr<const BgpProto::Update> result(
+            static_cast<const BgpProto::Update *>(
+                BgpProto::DecodeLazy(data, size)));
+        ASSERT_TRUE(result.get() != NULL);
+        EXPECT_TRUE(result->withdrawn_routes.empty());
+        EXPECT_TRUE(result->nlri.empty());
+        EXPECT_TRUE(result->raw_msg == vector<uint8_t>(data, data + size));
+        EXPECT_EQ(!update->nlri.empty(), result->HasNlri());
+
+        ASSERT_EQ(update->path_attributes.size(),
+            result->path_attributes.size());
+        for (size_t idx = 0; idx < update->path_attributes.size(); ++idx) {
+            const BgpAttribute *attr = update->path_attributes[idx];
+            const BgpAttribute *lazy_attr = result->path_attributes[idx];
+            EXPECT_EQ(attr->code, lazy_attr->code);
+            if (attr->code != BgpAttribute::MPReachNlri &&
+                attr->code != BgpAttribute::MPUnreachNlri) {
+                EXPECT_EQ(0, attr->CompareTo(*lazy_attr));
+                continue;
+            }
+            const BgpMpNlri *mp_nlri = static_cast<const BgpMpNlri *>(attr);
+            const BgpMpNlri *lazy_mp_nlri =
+                static_cast<const BgpMpNlri *>(lazy_attr);
+            EXPECT_EQ(mp_nlri->afi, lazy_mp_nlri->afi);
+            EXPECT_EQ(mp_nlri->safi, lazy_mp_nlri->safi);
+            EXPECT_TRUE(mp_nlri->nexthop == lazy_mp_nlri->nexthop);
+            EXPECT_TRUE(lazy_mp_nlri->nlri.empty());
+        }
     }
 
     const BgpAttribute *BgpFindAttribute(const BgpProto::Update *update,
@@ -1005,6 +1137,125 @@ TEST_F(BgpProtoTest, UpdateScale) {
     }
 }
 
+TEST_F(BgpProtoTest, UpdateView1) {
+    BgpProto::Update update;
+    BgpMessageTest::GenerateUpdateMessage(&update, BgpAf::IPv4, BgpAf::Unicast);
+    uint8_t data[256];
+    int res = BgpProto::Encode(&update, data, 256);
+    EXPECT_NE(-1, res);
+
+    boost::scoped_ptr<const BgpProto::Update> result(
+        static_cast<const BgpProto::Update *>(BgpProto::Decode(data, res)));
+    ASSERT_TRUE(result.get() != NULL);
+    VerifyUpdateView(data, res, result.get());
+    VerifyDecodeLazy(data, res, result.get());
+}
+
+TEST_F(BgpProtoTest, UpdateView2) {
+    BgpProto::Update update;
+    BgpMessageTest::GenerateUpdateMessage(&update, BgpAf::IPv4, BgpAf::Vpn);
+    uint8_t data[256];
+    int res = BgpProto::Encode(&update, data, 256);
+    EXPECT_NE(-1, res);
+
+    boost::scoped_ptr<const BgpProto::Update> result(
+        static_cast<const BgpProto::Update *>(BgpProto::Decode(data, res)));
+    ASSERT_TRUE(result.get() != NULL);
+    VerifyUpdateView(data, res, result.get());
+    VerifyDecodeLazy(data, res, result.get());
+}
+
+TEST_F(BgpProtoTest, UpdateView3) {
+    BgpProto::Update update;
+    BgpMessageTest::GenerateUpdateMessage(&update, BgpAf::L2Vpn, BgpAf::EVpn);
+    uint8_t data[256];
+    int res = BgpProto::Encode(&update, data, 256);
+    EXPECT_NE(-1, res);
+
+    boost::scoped_ptr<const BgpProto::Update> result(
+        static_cast<const BgpProto::Update *>(BgpProto::Decode(data, res)));
+    ASSERT_TRUE(result.get() != NULL);
+    VerifyUpdateView(data, res, result.get());
+    VerifyDecodeLazy(data, res, result.get());
+}
+
+//
+// EndOfRib markers and withdraws have no prefixes, or only an MpUnreachNlri.
+//
+TEST_F(BgpProtoTest, DecodeLazyWithdraw) {
+    uint8_t data[256];
+
+    BgpProto::Update update1;
+    BgpMessageTest::GenerateEmptyUpdateMessage(&update1);
+    int res = BgpProto::Encode(&update1, data, 256);
+    EXPECT_NE(-1, res);
+    boost::scoped_ptr<const BgpProto::Update> result1(
+        static_cast<const BgpProto::Update *>(BgpProto::Decode(data, res)));
+    ASSERT_TRUE(result1.get() != NULL);
+    VerifyDecodeLazy(data, res, result1.get());
+
+    BgpProto::Update update2;
+    BgpMessageTest::GenerateWithdrawMessage(&update2);
+    res = BgpProto::Encode(&update2, data, 256);
+    EXPECT_NE(-1, res);
+    boost::scoped_ptr<const BgpProto::Update> result2(
+        static_cast<const BgpProto::Update *>(BgpProto::Decode(data, res)));
+    ASSERT_TRUE(result2.get() != NULL);
+    VerifyUpdateView(data, res, result2.get());
+    VerifyDecodeLazy(data, res, result2.get());
+}
+
+//
+// A message that the view rejects is decoded in full by DecodeLazy.
+//
+TEST_F(BgpProtoTest, DecodeLazyFallback) {
+    uint8_t data[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                       0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+                       0x00, 0x15, 0x02, 0x00, 0x00 };
+    BgpProto::UpdateView view;
+    EXPECT_FALSE(view.Parse(data, sizeof(data)));
+    boost::scoped_ptr<const BgpProto::Update> result(
+        static_cast<const BgpProto::Update *>(
+            BgpProto::DecodeLazy(data, sizeof(data))));
+    ASSERT_TRUE(result.get() != NULL);
+    EXPECT_EQ(BgpProto::UPDATE, result->type);
+    EXPECT_TRUE(result->raw_msg.empty());
+}
+
+//
+// Framing errors are detected by Parse.
+//
+TEST_F(BgpProtoTest, UpdateViewError) {
+    BgpProto::Update update;
+    BgpMessageTest::GenerateUpdateMessage(&update, BgpAf::IPv4, BgpAf::Unicast);
+    uint8_t data[256];
+    int res = BgpProto::Encode(&update, data, 256);
+    EXPECT_NE(-1, res);
+    BgpProto::UpdateView view;
+
+    // Truncated message.
+    EXPECT_FALSE(view.Parse(data, res - 1));
+
+    // Marker error.
+    data[0] = 0xfe;
+    EXPECT_FALSE(view.Parse(data, res));
+    data[0] = 0xff;
+
+    // Message type is not UPDATE.
+    data[18] = BgpProto::KEEPALIVE;
+    EXPECT_FALSE(view.Parse(data, res));
+    data[18] = BgpProto::UPDATE;
+
+    // Withdrawn routes length exceeds message.
+    data[19] = 0xff;
+    EXPECT_FALSE(view.Parse(data, res));
+    data[19] = 0;
+
+    // Last NLRI prefix runs past the end of the message.
+    data[res - 3] = 32;
+    EXPECT_FALSE(view.Parse(data, res));
+}
+
 TEST_F(BgpProtoTest, KeepaliveError) {
     uint8_t data[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
                        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
@@ -1051,6 +1302,8 @@ TEST_F(BgpProtoTest, RandomUpdate) {
         EXPECT_TRUE(result.get() != NULL);
         if (result.get() != NULL) {
             EXPECT_EQ(0, result->CompareTo(update));
+            VerifyUpdateView(data, msglen, result.get());
+            VerifyDecodeLazy(data, msglen, result.get());
         } else {
             string repr(BgpProto::Notification::toString(
                 (BgpProto::Notification::Code) err.error_code,
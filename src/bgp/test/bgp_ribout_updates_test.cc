@@ -1615,6 +1615,51 @@ TEST_F(RibOutUpdatesTest, DequeueCommonMultipleAttrs1b) {
     }
 }
 
+// Routes:   Routes x=[0,kRouteCount-1] enqueued to all peers, attr A.
+//           For route 0, the first half of the peers have label 16 and the
+//           rest have label 17. All other routes have label 0.
+// Blocking: None.
+// Result:   Routes get sent to all peers with one update per label for the
+//           route 0. The 2 UpdateInfos for route 0 have the same BgpAttr so
+//           all other routes should get packed into the same updates.
+TEST_F(RibOutUpdatesTest, DequeueCommonSameAttrTwoLabels) {
+    ASSERT_TRUE(kPeerCount >= 2);
+    int vPeerCount = kPeerCount / 2;
+
+    // Build UpdateInfos for route 0 with 2 labels and attr A.
+    UpdateInfoSList uinfo_slist;
+    PrependUpdateInfo(uinfo_slist, attrA_, 16, 0, vPeerCount-1);
+    PrependUpdateInfo(uinfo_slist, attrA_, 17, vPeerCount, kPeerCount-1);
+    BuildRouteUpdate(routes_[0], uinfo_slist);
+
+    // Build updates for the other routes with attr A.
+    for (int idx = 1; idx < kRouteCount; idx++) {
+        UpdateInfoSList temp_uinfo_slist;
+        PrependUpdateInfo(temp_uinfo_slist, attrA_, 0, kPeerCount-1);
+        BuildRouteUpdate(routes_[idx], temp_uinfo_slist);
+    }
+
+    // Dequeue the updates.
+    UpdateRibOut();
+
+    // Verify update counts and blocked state.
+    VerifyUpdateCount(0, kPeerCount-1, COUNT_1);
+    VerifyPeerBlock(0, kPeerCount-1, false);
+    VerifyPeerInSync(0, kPeerCount-1, true);
+    VerifyMessageCount(2);
+
+    // Verify DB State for the routes.
+    RouteState *rstate = ExpectRouteState(routes_[0]);
+    RibOutAttr roattrA16(&table_, attrA_.get(), 16);
+    RibOutAttr roattrA17(&table_, attrA_.get(), 17);
+    VerifyHistory(rstate, roattrA16, 0, vPeerCount-1, 2);
+    VerifyHistory(rstate, roattrA17, vPeerCount, kPeerCount-1, 2);
+    for (int idx = 1; idx < kRouteCount; idx++) {
+        rstate = ExpectRouteState(routes_[idx]);
+        VerifyHistory(rstate, attrA_, 0, kPeerCount-1);
+    }
+}
+
 // Routes:   Routes x=[0,kRouteCount-1] enqueued to all peers.
 //           For even x, peer y=[0,kPeerCount-1] has attribute attr[y].
 //           For odd x, peer y=[0,kPeerCount-1] has attribute alt_attr[y].
@@ -515,7 +515,7 @@ protected:
         EXPECT_EQ(count, rstate->Advertised()->size());
         const AdvertiseInfo *ainfo = rstate->FindHistory(roattrX);
         EXPECT_TRUE(ainfo != NULL);
-        EXPECT_TRUE(ainfo->bitset == adv_peerset);
+        EXPECT_TRUE(ainfo->bitset() == adv_peerset);
     }
 
     void VerifyHistory(RouteState *rstate, BgpAttrPtr attrX,
@@ -534,7 +534,7 @@ protected:
             EXPECT_TRUE(ainfo != NULL);
             RibPeerSet bitset;
             bitset.set(ribout_->GetPeerIndex(peers_[idx]));
-            EXPECT_TRUE(ainfo->bitset == bitset);
+            EXPECT_TRUE(ainfo->bitset() == bitset);
         }
     }
 
@@ -555,7 +555,7 @@ protected:
         RibOutAttr roattrX(&table_, attrX.get(), 0);
         const AdvertiseInfo *ainfo = rt_update->FindHistory(roattrX);
         EXPECT_TRUE(ainfo != NULL);
-        EXPECT_TRUE(ainfo->bitset == adv_peerset);
+        EXPECT_TRUE(ainfo->bitset() == adv_peerset);
     }
 
     void VerifyHistory(RouteUpdate *rt_update, std::vector<BgpAttrPtr> &attrvec,
@@ -568,7 +568,7 @@ protected:
             EXPECT_TRUE(ainfo != NULL);
             RibPeerSet bitset;
             bitset.set(ribout_->GetPeerIndex(peers_[idx]));
-            EXPECT_TRUE(ainfo->bitset == bitset);
+            EXPECT_TRUE(ainfo->bitset() == bitset);
         }
     }
 
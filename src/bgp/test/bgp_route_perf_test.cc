@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <iostream>
+#include <vector>
+
+#include "base/time_util.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_log.h"
+#include "bgp/bgp_server.h"
+#include "bgp/bgp_table.h"
+#include "bgp/inet/inet_route.h"
+#include "bgp/test/bgp_route_test.h"
+#include "control-node/control_node.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+//
+// Measure the cost of path selection for a route with many paths e.g. an
+// anycast prefix advertised by hundreds of agents, when one path at a time
+// gets deleted and added back as the agents flap.
+//
+// Incremental uses BgpRoute::InsertPath and BgpRoute::DeletePath, which
+// place the path at its position in the already sorted list. FullSort does
+// the same operations but sorts the whole list after each of them.
+//
+// Set PATH_FLAP_COUNT to change the number of flaps for each route.
+//
+class BgpRoutePerfTest : public ::testing::Test {
+protected:
+    BgpRoutePerfTest() : server_(&evm_), flap_count_(256) {
+    }
+
+    virtual void SetUp() {
+        char *str = getenv("PATH_FLAP_COUNT");
+        if (str)
+            flap_count_ = strtoul(str, NULL, 0);
+    }
+
+    virtual void TearDown() {
+        STLDeleteValues(&peers_);
+        server_.Shutdown();
+        task_util::WaitForIdle();
+    }
+
+    void CreatePeers(int count) {
+        for (int idx = 0; idx < count; ++idx) {
+            peers_.push_back(new PeerMock(BgpProto::XMPP,
+                Ip4Address(0x0a000000 + idx + 1)));
+        }
+    }
+
+    //
+    // Use a few local preference values so that the best path moves around
+    // and the rest of the paths are ordered based on router id.
+    //
+    BgpPath *BuildPath(int idx, int flap) {
+        BgpAttrSpec spec;
+        BgpAttrLocalPref local_pref(100 + (idx + flap) % 4);
+        spec.push_back(&local_pref);
+        BgpAttrPtr attr = server_.attr_db()->Locate(spec);
+        return new BgpPath(peers_[idx], BgpPath::BGP_XMPP, attr, 0, 0);
+    }
+
+    void FlapIncremental(BgpRoute *route, vector<BgpPath *> *paths,
+                         int idx, int flap) {
+        route->DeletePath((*paths)[idx]);
+        (*paths)[idx] = BuildPath(idx, flap);
+        route->InsertPath((*paths)[idx]);
+    }
+
+    void FlapFullSort(BgpRoute *route, vector<BgpPath *> *paths,
+                      int idx, int flap) {
+        const Path *prev_front = route->front();
+        route->remove((*paths)[idx]);
+        route->Sort(&BgpTable::PathSelection, prev_front);
+        delete (*paths)[idx];
+        (*paths)[idx] = BuildPath(idx, flap);
+        prev_front = route->front();
+        route->insert((*paths)[idx]);
+        route->Sort(&BgpTable::PathSelection, prev_front);
+    }
+
+    void RunTest(int path_count) {
+        CreatePeers(path_count);
+
+        Ip4Prefix prefix(Ip4Prefix::FromString("10.1.1.0/24"));
+        InetRoute incremental_route(prefix);
+        InetRoute full_sort_route(prefix);
+        vector<BgpPath *> incremental_paths;
+        vector<BgpPath *> full_sort_paths;
+        for (int idx = 0; idx < path_count; ++idx) {
+            incremental_paths.push_back(BuildPath(idx, 0));
+            incremental_route.InsertPath(incremental_paths.back());
+            full_sort_paths.push_back(BuildPath(idx, 0));
+            const Path *prev_front = full_sort_route.front();
+            full_sort_route.insert(full_sort_paths.back());
+            full_sort_route.Sort(&BgpTable::PathSelection, prev_front);
+        }
+
+        uint64_t start = ClockMonotonicUsec();
+        for (int flap = 1; flap <= flap_count_; ++flap) {
+            FlapIncremental(&incremental_route, &incremental_paths,
+                flap % path_count, flap);
+        }
+        Report(path_count, "Incremental", ClockMonotonicUsec() - start);
+
+        start = ClockMonotonicUsec();
+        for (int flap = 1; flap <= flap_count_; ++flap) {
+            FlapFullSort(&full_sort_route, &full_sort_paths,
+                flap % path_count, flap);
+        }
+        Report(path_count, "FullSort", ClockMonotonicUsec() - start);
+
+        // Both routes must end up with the same order of paths.
+        Route::PathList::const_iterator it1 =
+            incremental_route.GetPathList().begin();
+        Route::PathList::const_iterator it2 =
+            full_sort_route.GetPathList().begin();
+        for (; it1 != incremental_route.GetPathList().end() &&
+             it2 != full_sort_route.GetPathList().end(); ++it1, ++it2) {
+            const BgpPath *path1 =
+                static_cast<const BgpPath *>(it1.operator->());
+            const BgpPath *path2 =
+                static_cast<const BgpPath *>(it2.operator->());
+            EXPECT_EQ(path1->GetPeer(), path2->GetPeer());
+            EXPECT_EQ(path1->GetAttr(), path2->GetAttr());
+        }
+
+        for (int idx = 0; idx < path_count; ++idx) {
+            incremental_route.DeletePath(incremental_paths[idx]);
+            full_sort_route.remove(full_sort_paths[idx]);
+            delete full_sort_paths[idx];
+        }
+    }
+
+    void Report(int path_count, const string &mode, uint64_t elapsed) {
+        cout << "Paths " << path_count
+             << " Mode " << mode
+             << " Flaps " << flap_count_
+             << " Elapsed(usec) " << elapsed
+             << " Flaps/sec "
+             << (elapsed ? flap_count_ * 1000000ULL / elapsed : 0)
+             << endl;
+    }
+
+    EventManager evm_;
+    BgpServer server_;
+    vector<PeerMock *> peers_;
+    int flap_count_;
+};
+
+TEST_F(BgpRoutePerfTest, Paths1) {
+    RunTest(1);
+}
+
+TEST_F(BgpRoutePerfTest, Paths16) {
+    RunTest(16);
+}
+
+TEST_F(BgpRoutePerfTest, Paths256) {
+    RunTest(256);
+}
+
+TEST_F(BgpRoutePerfTest, Paths1024) {
+    RunTest(1024);
+}
+
+static void SetUp() {
+    bgp_log_test::init();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_TEST_BGP_ROUTE_TEST_H_
+#define SRC_BGP_TEST_BGP_ROUTE_TEST_H_
+
+#include <string>
+
+#include "bgp/bgp_proto.h"
+#include "bgp/ipeer.h"
+
+class PeerMock : public IPeer {
+public:
+    PeerMock()
+        : peer_type_(BgpProto::IBGP),
+          address_(Ip4Address(0)) {
+    }
+    PeerMock(BgpProto::BgpPeerType peer_type, Ip4Address address)
+        : peer_type_(peer_type),
+          address_(address),
+          address_str_("Peer_" + address.to_string()) {
+    }
+
+    virtual const std::string &ToString() const { return address_str_; }
+    virtual const std::string &ToUVEKey() const { return address_str_; }
+    virtual bool SendUpdate(const uint8_t *msg, size_t msgsize) { return true; }
+    virtual BgpServer *server() { return NULL; }
+    virtual BgpServer *server() const { return NULL; }
+    virtual IPeerClose *peer_close() { return NULL; }
+    virtual IPeerClose *peer_close() const { return NULL; }
+    virtual void UpdateCloseRouteStats(Address::Family family,
+        const BgpPath *old_path, uint32_t path_flags) const {
+    }
+    virtual IPeerDebugStats *peer_stats() { return NULL; }
+    virtual const IPeerDebugStats *peer_stats() const { return NULL; }
+    virtual bool IsReady() const { return true; }
+    virtual bool IsXmppPeer() const { return peer_type_ == BgpProto::XMPP; }
+    virtual void Close(bool graceful) { }
+    virtual const std::string GetStateName() const { return "Established"; }
+    BgpProto::BgpPeerType PeerType() const { return peer_type_; }
+    virtual uint32_t bgp_identifier() const { return address_.to_ulong(); }
+    virtual void UpdateTotalPathCount(int count) const { }
+    virtual int GetTotalPathCount() const { return 0; }
+    virtual void UpdatePrimaryPathCount(int count,
+        Address::Family family) const { }
+    virtual int GetPrimaryPathCount() const { return 0; }
+    virtual bool IsRegistrationRequired() const { return true; }
+    virtual void MembershipRequestCallback(BgpTable *table) { }
+    virtual bool MembershipPathCallback(DBTablePartBase *tpart,
+        BgpRoute *route, BgpPath *path) { return false; }
+    virtual bool CanUseMembershipManager() const { return true; }
+    virtual bool IsInGRTimerWaitState() const { return false; }
+
+private:
+    BgpProto::BgpPeerType peer_type_;
+    Ip4Address address_;
+    std::string address_str_;
+};
+
+#endif  // SRC_BGP_TEST_BGP_ROUTE_TEST_H_
@@ -18,6 +18,10 @@ protected:
           rt_table_(static_cast<InetTable *>(db_.CreateTable("inet.0"))) {
     }
 
+    bool HasReprCache(int part_id) const {
+        return rt_table_->repr_cache_[part_id] != NULL;
+    }
+
     DB db_;
     BgpUpdateSender sender_;
     InetTable *rt_table_;
@@ -433,6 +437,37 @@ TEST_F(BgpTableTest, RiboutLlgrEnabled) {
     ASSERT_TRUE(ribout2 == NULL);
 }
 
+// Table memory accounts for the RibOuts of the table.
+TEST_F(BgpTableTest, TableMemory) {
+    size_t memory = rt_table_->GetTableMemory();
+    EXPECT_LT(sizeof(InetTable), memory);
+
+    RibExportPolicy policy(BgpProto::IBGP, RibExportPolicy::BGP, 1, 0);
+    RibOut *ribout = rt_table_->RibOutLocate(&sender_, policy);
+    ASSERT_TRUE(ribout != NULL);
+    EXPECT_LT(memory, rt_table_->GetTableMemory());
+
+    rt_table_->RibOutDelete(policy);
+    EXPECT_EQ(memory, rt_table_->GetTableMemory());
+}
+
+// RibOutAttrReprCache for a partition is created on first use.
+TEST_F(BgpTableTest, ReprCacheLazyCreate) {
+    size_t memory = rt_table_->GetTableMemory();
+    for (int idx = 0; idx < DB::PartitionCount(); ++idx) {
+        EXPECT_FALSE(HasReprCache(idx));
+    }
+
+    RibOutAttrReprCache *cache = rt_table_->repr_cache(0);
+    ASSERT_TRUE(cache != NULL);
+    EXPECT_EQ(cache, rt_table_->repr_cache(0));
+    EXPECT_TRUE(HasReprCache(0));
+    for (int idx = 1; idx < DB::PartitionCount(); ++idx) {
+        EXPECT_FALSE(HasReprCache(idx));
+    }
+    EXPECT_LT(memory, rt_table_->GetTableMemory());
+}
+
 static void SetUp() {
     bgp_log_test::init();
     ControlNode::SetDefaultSchedulingPolicy();
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <boost/scoped_ptr.hpp>
+
+#include <iostream>
+
+#include "base/time_util.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_log.h"
+#include "bgp/bgp_proto.h"
+#include "control-node/control_node.h"
+#include "net/bgp_af.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+//
+// Compare decode throughput of BgpProto::Decode with BgpProto::DecodeLazy
+// for UPDATE messages of various families.
+//
+// BgpProto::Decode materializes all prefixes and path attributes. DecodeLazy
+// decodes only the path attributes and the prefixes are then walked in place
+// with an UpdateView, which is what BgpPeer does on the receive path.
+//
+// Set DECODE_COUNT to change the number of times each message is decoded.
+//
+class BgpUpdateDecodePerfTest : public ::testing::Test {
+protected:
+    BgpUpdateDecodePerfTest() : decode_count_(1024), size_(0) {
+    }
+
+    virtual void SetUp() {
+        char *str = getenv("DECODE_COUNT");
+        if (str)
+            decode_count_ = strtoul(str, NULL, 0);
+    }
+
+    static void AddPathAttributes(BgpProto::Update *update) {
+        update->path_attributes.push_back(
+            new BgpAttrOrigin(BgpAttrOrigin::IGP));
+        AsPathSpec *path_spec = new AsPathSpec;
+        AsPathSpec::PathSegment *ps = new AsPathSpec::PathSegment;
+        ps->path_segment_type = AsPathSpec::PathSegment::AS_SEQUENCE;
+        ps->path_segment.push_back(64512);
+        ps->path_segment.push_back(64513);
+        path_spec->path_segments.push_back(ps);
+        update->path_attributes.push_back(path_spec);
+        update->path_attributes.push_back(new BgpAttrLocalPref(100));
+        CommunitySpec *community = new CommunitySpec;
+        community->communities.push_back(0xFFFF0001);
+        update->path_attributes.push_back(community);
+        ExtCommunitySpec *ext_community = new ExtCommunitySpec;
+        ext_community->communities.push_back(0x0002fc00007a1200ULL);
+        update->path_attributes.push_back(ext_community);
+    }
+
+    static BgpProtoPrefix *BuildPrefix(int idx, int size, uint8_t type) {
+        BgpProtoPrefix *prefix = new BgpProtoPrefix;
+        prefix->type = type;
+        prefix->prefixlen = size * 8;
+        for (int byte = 0; byte < size; ++byte) {
+            prefix->prefix.push_back((idx >> (8 * (byte % 2))) & 0xff);
+        }
+        return prefix;
+    }
+
+    void BuildInetUpdate(int count, bool withdraw) {
+        BgpProto::Update update;
+        for (int idx = 0; idx < count; ++idx) {
+            if (withdraw) {
+                update.withdrawn_routes.push_back(BuildPrefix(idx, 3, 0));
+            } else {
+                update.nlri.push_back(BuildPrefix(idx, 3, 0));
+            }
+        }
+        if (!withdraw) {
+            AddPathAttributes(&update);
+            update.path_attributes.push_back(new BgpAttrNextHop(0x0a0a0a0a));
+        }
+        Encode(&update);
+    }
+
+    void BuildMpUpdate(uint16_t afi, uint8_t safi, int count, int size,
+                       uint8_t type, bool withdraw) {
+        BgpProto::Update update;
+        BgpMpNlri *mp_nlri = new BgpMpNlri(withdraw ?
+            BgpAttribute::MPUnreachNlri : BgpAttribute::MPReachNlri);
+        mp_nlri->afi = afi;
+        mp_nlri->safi = safi;
+        if (!withdraw) {
+            AddPathAttributes(&update);
+            if (safi == BgpAf::Vpn)
+                mp_nlri->nexthop.resize(RouteDistinguisher::kSize);
+            uint8_t nh[4] = { 10, 10, 10, 10 };
+            mp_nlri->nexthop.insert(mp_nlri->nexthop.end(), nh, nh + 4);
+        }
+        for (int idx = 0; idx < count; ++idx) {
+            mp_nlri->nlri.push_back(BuildPrefix(idx, size, type));
+        }
+        update.path_attributes.push_back(mp_nlri);
+        Encode(&update);
+    }
+
+    void Encode(BgpProto::Update *update) {
+        int result = BgpProto::Encode(update, data_, sizeof(data_));
+        ASSERT_GT(result, 0);
+        size_ = result;
+    }
+
+    static size_t WalkView(const BgpProto::UpdateView &view) {
+        size_t count = 0;
+        BgpProto::UpdateView::Prefix prefix;
+        BgpProto::UpdateView::PrefixIterator withdrawn_it =
+            view.withdrawn_routes();
+        while (withdrawn_it.Next(&prefix)) {
+            count++;
+        }
+        BgpProto::UpdateView::PrefixIterator nlri_it = view.nlri();
+        while (nlri_it.Next(&prefix)) {
+            count++;
+        }
+
+        BgpProto::UpdateView::Attribute attr;
+        BgpProto::UpdateView::AttributeIterator attr_it =
+            view.path_attributes();
+        while (attr_it.Next(&attr)) {
+            BgpProto::UpdateView::MpNlri mp_nlri;
+            if (!BgpProto::UpdateView::ParseMpNlri(attr, &mp_nlri))
+                continue;
+            while (mp_nlri.nlri.Next(&prefix)) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    static size_t CountPrefixes(const BgpProto::Update *update) {
+        size_t count = update->withdrawn_routes.size() + update->nlri.size();
+        for (vector<BgpAttribute *>::const_iterator it =
+             update->path_attributes.begin();
+             it != update->path_attributes.end(); ++it) {
+            if ((*it)->code == BgpAttribute::MPReachNlri ||
+                (*it)->code == BgpAttribute::MPUnreachNlri) {
+                count += static_cast<BgpMpNlri *>(*it)->nlri.size();
+            }
+        }
+        return count;
+    }
+
+    void Report(const string &name, const string &decoder, size_t prefixes,
+                uint64_t elapsed) {
+        cout << name
+             << " Decoder " << decoder
+             << " Size " << size_
+             << " Prefixes " << prefixes
+             << " Messages " << decode_count_
+             << " Elapsed(usec) " << elapsed
+             << " Messages/sec "
+             << (elapsed ? decode_count_ * 1000000ULL / elapsed : 0)
+             << endl;
+    }
+
+    void RunTest(const string &name) {
+        size_t decode_prefixes = 0;
+        uint64_t start = ClockMonotonicUsec();
+        for (int idx = 0; idx < decode_count_; ++idx) {
+            boost::scoped_ptr<const BgpProto::Update> update(
+                static_cast<const BgpProto::Update *>(
+                    BgpProto::Decode(data_, size_)));
+            ASSERT_TRUE(update.get() != NULL);
+            decode_prefixes = CountPrefixes(update.get());
+        }
+        Report(name, "Decode", decode_prefixes, ClockMonotonicUsec() - start);
+
+        size_t view_prefixes = 0;
+        start = ClockMonotonicUsec();
+        for (int idx = 0; idx < decode_count_; ++idx) {
+            boost::scoped_ptr<const BgpProto::Update> update(
+                static_cast<const BgpProto::Update *>(
+                    BgpProto::DecodeLazy(data_, size_)));
+            ASSERT_TRUE(update.get() != NULL);
+            ASSERT_FALSE(update->raw_msg.empty());
+            BgpProto::UpdateView view;
+            ASSERT_TRUE(view.Parse(&update->raw_msg[0],
+                update->raw_msg.size()));
+            view_prefixes = WalkView(view);
+        }
+        Report(name, "DecodeLazy", view_prefixes,
+            ClockMonotonicUsec() - start);
+
+        EXPECT_EQ(decode_prefixes, view_prefixes);
+    }
+
+    int decode_count_;
+    uint8_t data_[BgpProto::kMaxMessageSize];
+    size_t size_;
+};
+
+TEST_F(BgpUpdateDecodePerfTest, InetReach) {
+    BuildInetUpdate(512, false);
+    RunTest("InetReach");
+}
+
+TEST_F(BgpUpdateDecodePerfTest, InetUnreach) {
+    BuildInetUpdate(512, true);
+    RunTest("InetUnreach");
+}
+
+TEST_F(BgpUpdateDecodePerfTest, InetVpnReach) {
+    BuildMpUpdate(BgpAf::IPv4, BgpAf::Vpn, 192, 15, 0, false);
+    RunTest("InetVpnReach");
+}
+
+TEST_F(BgpUpdateDecodePerfTest, InetVpnUnreach) {
+    BuildMpUpdate(BgpAf::IPv4, BgpAf::Vpn, 192, 15, 0, true);
+    RunTest("InetVpnUnreach");
+}
+
+TEST_F(BgpUpdateDecodePerfTest, EvpnReach) {
+    BuildMpUpdate(BgpAf::L2Vpn, BgpAf::EVpn, 96, 33, 2, false);
+    RunTest("EvpnReach");
+}
+
+TEST_F(BgpUpdateDecodePerfTest, EvpnUnreach) {
+    BuildMpUpdate(BgpAf::L2Vpn, BgpAf::EVpn, 96, 33, 2, true);
+    RunTest("EvpnUnreach");
+}
+
+int main(int argc, char **argv) {
+    bgp_log_test::init();
+    ControlNode::SetDefaultSchedulingPolicy();
+    ::testing::InitGoogleTest(&argc, argv);
+    int result = RUN_ALL_TESTS();
+    TaskScheduler::GetInstance()->Terminate();
+    return result;
+}
@@ -0,0 +1,603 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/tuple/tuple.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "base/time_util.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_factory.h"
+#include "bgp/bgp_peer.h"
+#include "bgp/bgp_update_recorder.h"
+#include "bgp/bgp_xmpp_channel.h"
+#include "bgp/l3vpn/inetvpn_table.h"
+#include "bgp/routing-instance/peer_manager.h"
+#include "bgp/routing-instance/routing_instance.h"
+#include "bgp/rtarget/rtarget_address.h"
+#include "bgp/test/bgp_server_test_util.h"
+#include "bgp/xmpp_message_builder.h"
+#include "control-node/control_node.h"
+#include "control-node/test/network_agent_mock.h"
+#include "io/test/event_manager_test.h"
+#include "net/bgp_af.h"
+#include "xmpp/xmpp_server.h"
+
+using std::cout;
+using std::endl;
+using std::ifstream;
+using std::map;
+using std::ostringstream;
+using std::string;
+using std::vector;
+
+class BgpPeerReplayMock : public BgpPeer {
+public:
+    BgpPeerReplayMock(BgpServer *server, RoutingInstance *instance,
+                      const BgpNeighborConfig *config)
+        : BgpPeer(server, instance, config) {
+    }
+
+    bool IsReady() const { return true; }
+    void TriggerPrefixLimitCheck() const { }
+};
+
+class BgpXmppChannelReplayMock : public BgpXmppChannel {
+public:
+    BgpXmppChannelReplayMock(XmppChannel *channel, BgpServer *server,
+        BgpXmppChannelManager *manager, tbb::atomic<uint64_t> *rx_count)
+        : BgpXmppChannel(channel, server, manager), rx_count_(rx_count) {
+    }
+
+    virtual void ReceiveUpdate(const XmppStanza::XmppMessage *msg) {
+        BgpXmppChannel::ReceiveUpdate(msg);
+        if (msg->type == XmppStanza::IQ_STANZA)
+            (*rx_count_)++;
+    }
+
+private:
+    tbb::atomic<uint64_t> *rx_count_;
+};
+
+class BgpXmppChannelManagerReplayMock : public BgpXmppChannelManager {
+public:
+    BgpXmppChannelManagerReplayMock(XmppServer *x, BgpServer *b)
+        : BgpXmppChannelManager(x, b) {
+        rx_count_ = 0;
+    }
+
+    virtual BgpXmppChannel *CreateChannel(XmppChannel *channel) {
+        return new BgpXmppChannelReplayMock(
+            channel, bgp_server_, this, &rx_count_);
+    }
+
+    uint64_t rx_count() const { return rx_count_; }
+
+private:
+    tbb::atomic<uint64_t> rx_count_;
+};
+
+static const char *default_config = "\
+<config>\
+    <bgp-router name=\'local\'>\
+        <identifier>192.168.0.1</identifier>\
+        <address>127.0.0.1</address>\
+        <autonomous-system>64512</autonomous-system>\
+    </bgp-router>\
+    <virtual-network name='blue'>\
+        <network-id>1</network-id>\
+    </virtual-network>\
+    <routing-instance name='blue'>\
+        <virtual-network>blue</virtual-network>\
+        <vrf-target>target:64512:1</vrf-target>\
+    </routing-instance>\
+</config>\
+";
+
+//
+// Replay a file written by BgpUpdateRecorder against a BgpServer and an
+// XmppServer, and report convergence latency percentiles, updates/sec and
+// peak RSS.
+//
+// BGP peers from the file are created as mock peers in the master instance
+// and their UPDATEs are fed to BgpPeer::ProcessUpdate. XMPP peers are mock
+// agents and their stanzas are sent over a real xmpp session.
+//
+// Records are paced using the recorded timestamps divided by the speed. A
+// speed of 0 replays the records back to back. The latency for a record is
+// the time from when it's injected till the server converges i.e. all xmpp
+// stanzas sent so far have been received and the scheduler is idle.
+//
+// Environment variables:
+//
+//     BGP_REPLAY_FILE         file to replay
+//     BGP_REPLAY_CONFIG       config for the server, router name is "local"
+//     BGP_REPLAY_SPEED        speed multiplier, 0 means as fast as possible
+//     BGP_REPLAY_ROUTE_COUNT  routes in the generated file
+//
+// If BGP_REPLAY_FILE is not set, the test first records a file by sending
+// inet-vpn routes from a BGP peer and inet routes from two agents, and then
+// replays it.
+//
+class BgpUpdateReplayTest : public ::testing::Test {
+protected:
+    struct ReplayPeer {
+        ReplayPeer() : type(0), bgp_peer(NULL) { }
+        uint8_t type;
+        BgpPeer *bgp_peer;
+        test::NetworkAgentMockPtr agent;
+    };
+    typedef map<uint16_t, ReplayPeer> ReplayPeerMap;
+
+    BgpUpdateReplayTest()
+        : thread_(&evm_),
+          xmpp_server_(NULL),
+          speed_(1.0),
+          route_count_(4 * 1024),
+          xmpp_sent_(0),
+          idle_time_(0) {
+    }
+
+    virtual void SetUp() {
+        char *str = getenv("BGP_REPLAY_FILE");
+        if (str)
+            filename_ = str;
+        str = getenv("BGP_REPLAY_CONFIG");
+        if (str) {
+            ifstream ifs(str);
+            ostringstream oss;
+            oss << ifs.rdbuf();
+            config_ = oss.str();
+        } else {
+            config_ = default_config;
+        }
+        str = getenv("BGP_REPLAY_SPEED");
+        if (str)
+            speed_ = strtod(str, NULL);
+        str = getenv("BGP_REPLAY_ROUTE_COUNT");
+        if (str)
+            route_count_ = strtoul(str, NULL, 0);
+        thread_.Start();
+    }
+
+    virtual void TearDown() {
+        DestroyServers();
+        evm_.Shutdown();
+        thread_.Join();
+        task_util::WaitForIdle();
+    }
+
+    void CreateServers() {
+        bgp_server_.reset(new BgpServerTest(&evm_, "local"));
+        xmpp_server_ =
+            new XmppServer(&evm_, test::XmppDocumentMock::kControlNodeJID);
+        xmpp_server_->Initialize(0, false);
+        channel_manager_.reset(
+            new BgpXmppChannelManagerReplayMock(xmpp_server_,
+                                                bgp_server_.get()));
+        bgp_server_->Configure(config_);
+        task_util::WaitForIdle();
+    }
+
+    void DestroyServers() {
+        if (!bgp_server_)
+            return;
+        for (ReplayPeerMap::iterator it = peers_.begin();
+             it != peers_.end(); ++it) {
+            if (it->second.agent)
+                it->second.agent->Delete();
+        }
+        peers_.clear();
+        xmpp_server_->Shutdown();
+        task_util::WaitForIdle();
+        bgp_server_->Shutdown();
+        task_util::WaitForIdle();
+        channel_manager_.reset();
+        TcpServerManager::DeleteServer(xmpp_server_);
+        xmpp_server_ = NULL;
+        bgp_server_.reset();
+        task_util::WaitForIdle();
+    }
+
+    BgpPeer *CreateBgpPeer(const string &name, uint32_t peer_as) {
+        RoutingInstance *master =
+            bgp_server_->routing_instance_mgr()->GetDefaultRoutingInstance();
+        BgpProto::OpenMessage open;
+        BgpProto::OpenMessage::OptParam *opt =
+            new BgpProto::OpenMessage::OptParam;
+        BgpNeighborConfig::FamilyAttributesList family_attributes_list;
+        static const Address::Family families[] = {
+            Address::INET, Address::INETVPN, Address::INET6VPN,
+            Address::EVPN, Address::ERMVPN, Address::RTARGET
+        };
+        for (size_t idx = 0; idx < sizeof(families) / sizeof(families[0]);
+             ++idx) {
+            family_attributes_list.push_back(BgpFamilyAttributesConfig(
+                Address::FamilyToString(families[idx])));
+            uint16_t afi;
+            uint8_t safi;
+            boost::tie(afi, safi) = BgpAf::FamilyToAfiSafi(families[idx]);
+            uint8_t capc[] = {
+                static_cast<uint8_t>(afi >> 8),
+                static_cast<uint8_t>(afi & 0xff), 0, safi
+            };
+            opt->capabilities.push_back(
+                new BgpProto::OpenMessage::Capability(
+                    BgpProto::OpenMessage::Capability::MpExtension, capc, 4));
+        }
+        open.opt_params.push_back(opt);
+
+        BgpPeer *peer;
+        {
+            ConcurrencyScope scope("bgp::Config");
+            BgpNeighborConfig nbr_config;
+            nbr_config.set_name(name);
+            nbr_config.set_instance_name(BgpConfigManager::kMasterInstance);
+            nbr_config.set_local_identifier(
+                htonl(bgp_server_->bgp_identifier()));
+            nbr_config.set_local_as(bgp_server_->autonomous_system());
+            nbr_config.set_peer_as(peer_as);
+            nbr_config.set_family_attributes_list(family_attributes_list);
+            peer = master->peer_manager()->PeerLocate(bgp_server_.get(),
+                                                      &nbr_config);
+        }
+        peer->SetCapabilities(&open);
+        return peer;
+    }
+
+    test::NetworkAgentMockPtr CreateAgent(const string &name) {
+        test::NetworkAgentMockPtr agent(new test::NetworkAgentMock(
+            &evm_, name, xmpp_server_->GetPort(), "127.0.0.1"));
+        TASK_UTIL_EXPECT_TRUE(agent->IsEstablished());
+        return agent;
+    }
+
+    static BgpProto::Update *BuildInetVpnUpdate(int start, int count) {
+        BgpProto::Update *update = new BgpProto::Update;
+        update->path_attributes.push_back(
+            new BgpAttrOrigin(BgpAttrOrigin::IGP));
+        update->path_attributes.push_back(new AsPathSpec);
+        update->path_attributes.push_back(new BgpAttrLocalPref(100));
+        ExtCommunitySpec *ext_community = new ExtCommunitySpec;
+        ext_community->communities.push_back(
+            RouteTarget::FromString("target:64512:1").GetExtCommunityValue());
+        update->path_attributes.push_back(ext_community);
+
+        BgpMpNlri *mp_nlri = new BgpMpNlri(BgpAttribute::MPReachNlri);
+        mp_nlri->afi = BgpAf::IPv4;
+        mp_nlri->safi = BgpAf::Vpn;
+        uint8_t nh[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 192, 168, 1, 1 };
+        mp_nlri->nexthop.assign(&nh[0], &nh[12]);
+        for (int idx = start; idx < start + count; ++idx) {
+            ostringstream oss;
+            oss << "192.168.1.1:1:10." << ((idx >> 8) & 0xff) << "."
+                << (idx & 0xff) << ".0/24";
+            InetVpnPrefix prefix(InetVpnPrefix::FromString(oss.str()));
+            BgpProtoPrefix *bpp = new BgpProtoPrefix;
+            prefix.BuildProtoPrefix(10000 + idx, bpp);
+            mp_nlri->nlri.push_back(bpp);
+        }
+        update->path_attributes.push_back(mp_nlri);
+        return update;
+    }
+
+    //
+    // Record a file with routes from a BGP peer and two agents.
+    //
+    void Generate(const string &filename) {
+        CreateServers();
+        ASSERT_TRUE(bgp_server_->update_recorder()->Open(filename));
+
+        // The mock BGP peer doesn't have a session, so its UPDATEs don't go
+        // through BgpPeer::ReceiveMsg. Record the encoded messages directly.
+        BgpPeer *peer = CreateBgpPeer("bgp-peer", 64512);
+        static const int kPrefixesPerUpdate = 64;
+        for (int idx = 0; idx < route_count_; idx += kPrefixesPerUpdate) {
+            boost::scoped_ptr<BgpProto::Update> update(BuildInetVpnUpdate(
+                idx, std::min(kPrefixesPerUpdate, route_count_ - idx)));
+            uint8_t data[BgpProto::kMaxMessageSize];
+            int result = BgpProto::Encode(update.get(), data, sizeof(data));
+            ASSERT_GT(result, 0);
+            bgp_server_->update_recorder()->RecordBgpUpdate(peer, data,
+                                                            result);
+            peer->ProcessUpdate(update.get(), result);
+        }
+
+        test::NetworkAgentMockPtr agent_a = CreateAgent("agent-a");
+        test::NetworkAgentMockPtr agent_b = CreateAgent("agent-b");
+        agent_a->Subscribe("blue", 1);
+        agent_b->Subscribe("blue", 1);
+        for (int idx = 0; idx < route_count_; ++idx) {
+            ostringstream oss;
+            oss << "20." << ((idx >> 8) & 0xff) << "." << (idx & 0xff)
+                << ".0/24";
+            if (idx % 2) {
+                agent_a->AddRoute("blue", oss.str(), "192.168.0.11");
+            } else {
+                agent_b->AddRoute("blue", oss.str(), "192.168.0.12");
+            }
+        }
+        TASK_UTIL_EXPECT_EQ(route_count_ + 2,
+            static_cast<int>(channel_manager_->rx_count()));
+        task_util::WaitForIdle();
+
+        bgp_server_->update_recorder()->Close();
+        agent_a->Delete();
+        agent_b->Delete();
+        DestroyServers();
+    }
+
+    //
+    // Create a unique file for a recording in TMPDIR.
+    //
+    static string CreateTempFile() {
+        const char *tmpdir = getenv("TMPDIR");
+        string filename = string(tmpdir ? tmpdir : "/tmp") +
+            "/bgp_update_replay_test.XXXXXX";
+        int fd = mkstemp(&filename[0]);
+        if (fd < 0)
+            return string();
+        close(fd);
+        return filename;
+    }
+
+    void LoadRecords(const string &filename) {
+        BgpUpdateRecorder::Reader reader;
+        ASSERT_TRUE(reader.Open(filename));
+        BgpUpdateRecorder::Record record;
+        while (reader.Next(&record)) {
+            records_.push_back(record);
+        }
+    }
+
+    void CreatePeers() {
+        for (vector<BgpUpdateRecorder::Record>::const_iterator it =
+             records_.begin(); it != records_.end(); ++it) {
+            uint8_t peer_type;
+            uint32_t peer_as;
+            string name;
+            if (!BgpUpdateRecorder::Reader::ParsePeer(*it, &peer_type,
+                &peer_as, &name)) {
+                continue;
+            }
+            ReplayPeer &replay_peer = peers_[it->peer_index];
+            replay_peer.type = peer_type;
+            if (peer_type == BgpUpdateRecorder::BGP_PEER) {
+                replay_peer.bgp_peer = CreateBgpPeer(name, peer_as);
+            } else if (peer_type == BgpUpdateRecorder::XMPP_PEER) {
+                replay_peer.agent = CreateAgent(name);
+                replay_peer.agent->set_skip_updates_processing(true);
+            }
+        }
+        task_util::WaitForIdle();
+    }
+
+    bool Inject(const BgpUpdateRecorder::Record &record) {
+        ReplayPeerMap::iterator loc = peers_.find(record.peer_index);
+        if (loc == peers_.end())
+            return false;
+        const ReplayPeer &replay_peer = loc->second;
+        if (record.type == BgpUpdateRecorder::BGP_UPDATE &&
+            replay_peer.bgp_peer) {
+            const uint8_t *data =
+                reinterpret_cast<const uint8_t *>(record.data.data());
+            boost::scoped_ptr<BgpProto::BgpMessage> msg(
+                BgpProto::DecodeLazy(data, record.data.size()));
+            if (!msg || msg->type != BgpProto::UPDATE)
+                return false;
+            replay_peer.bgp_peer->ProcessUpdate(
+                static_cast<BgpProto::Update *>(msg.get()),
+                record.data.size());
+            return true;
+        }
+        if (record.type == BgpUpdateRecorder::XMPP_MESSAGE &&
+            replay_peer.agent) {
+            replay_peer.agent->SendRawMessage(record.data);
+            xmpp_sent_++;
+            return true;
+        }
+        return false;
+    }
+
+    //
+    // Check if the server has converged. The scheduler needs to be idle on
+    // two consecutive polls since xmpp messages are received asynchronously.
+    // All pending records get the time when the server was first seen idle.
+    //
+    void PollConvergence() {
+        if (pending_.empty())
+            return;
+        if (channel_manager_->rx_count() < xmpp_sent_ ||
+            !TaskScheduler::GetInstance()->IsEmpty()) {
+            idle_time_ = 0;
+            return;
+        }
+        if (!idle_time_) {
+            idle_time_ = ClockMonotonicUsec();
+            return;
+        }
+        for (vector<uint64_t>::const_iterator it = pending_.begin();
+             it != pending_.end(); ++it) {
+            latencies_.push_back(idle_time_ > *it ? idle_time_ - *it : 0);
+        }
+        pending_.clear();
+        idle_time_ = 0;
+    }
+
+    uint64_t Percentile(int percent) const {
+        if (latencies_.empty())
+            return 0;
+        size_t idx = latencies_.size() * percent / 100;
+        return latencies_[std::min(idx, latencies_.size() - 1)];
+    }
+
+    void Replay() {
+        CreateServers();
+        CreatePeers();
+
+        uint64_t first_timestamp = 0;
+        bool first = true;
+        uint64_t start = ClockMonotonicUsec();
+        for (vector<BgpUpdateRecorder::Record>::const_iterator it =
+             records_.begin(); it != records_.end(); ++it) {
+            if (it->type == BgpUpdateRecorder::PEER)
+                continue;
+            if (first) {
+                first_timestamp = it->timestamp;
+                first = false;
+            }
+            if (speed_ > 0) {
+                uint64_t due = start +
+                    static_cast<uint64_t>((it->timestamp - first_timestamp) /
+                                          speed_);
+                for (uint64_t now = ClockMonotonicUsec(); now < due;
+                     now = ClockMonotonicUsec()) {
+                    PollConvergence();
+                    usleep(std::min(due - now, static_cast<uint64_t>(100)));
+                }
+            }
+            uint64_t now = ClockMonotonicUsec();
+            if (Inject(*it))
+                pending_.push_back(now);
+        }
+        while (!pending_.empty()) {
+            PollConvergence();
+            usleep(100);
+        }
+        uint64_t elapsed = ClockMonotonicUsec() - start;
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        std::sort(latencies_.begin(), latencies_.end());
+        cout << "Records " << latencies_.size()
+             << " Speed " << speed_
+             << " Elapsed(usec) " << elapsed
+             << " Updates/sec "
+             << (elapsed ? latencies_.size() * 1000000ULL / elapsed : 0)
+             << " Latency(usec) p50 " << Percentile(50)
+             << " p90 " << Percentile(90)
+             << " p99 " << Percentile(99)
+             << " max " << (latencies_.empty() ? 0 : latencies_.back())
+             << " PeakRSS(KB) " << usage.ru_maxrss
+             << endl;
+
+        DestroyServers();
+    }
+
+    EventManager evm_;
+    ServerThread thread_;
+    boost::scoped_ptr<BgpServerTest> bgp_server_;
+    XmppServer *xmpp_server_;
+    boost::scoped_ptr<BgpXmppChannelManagerReplayMock> channel_manager_;
+    string filename_;
+    string config_;
+    double speed_;
+    int route_count_;
+    vector<BgpUpdateRecorder::Record> records_;
+    ReplayPeerMap peers_;
+    uint64_t xmpp_sent_;
+    vector<uint64_t> pending_;
+    vector<uint64_t> latencies_;
+    uint64_t idle_time_;
+};
+
+TEST_F(BgpUpdateReplayTest, Replay) {
+    string filename = filename_;
+    if (filename.empty()) {
+        filename = CreateTempFile();
+        ASSERT_FALSE(filename.empty());
+        Generate(filename);
+    }
+    LoadRecords(filename);
+    if (filename_.empty()) {
+        EXPECT_EQ(static_cast<size_t>(3 + route_count_ / 64 +
+            (route_count_ % 64 ? 1 : 0) + route_count_ + 2), records_.size());
+        unlink(filename.c_str());
+    }
+    Replay();
+}
+
+//
+// Write a few records and verify that they are read back.
+//
+TEST_F(BgpUpdateReplayTest, ReadWrite) {
+    string filename = CreateTempFile();
+    ASSERT_FALSE(filename.empty());
+    BgpUpdateRecorder recorder;
+    EXPECT_FALSE(recorder.enabled());
+    ASSERT_TRUE(recorder.Open(filename));
+    EXPECT_TRUE(recorder.enabled());
+    recorder.RecordXmppMessage("agent-a", "<iq type=\"set\"/>");
+    recorder.RecordXmppMessage("agent-b", "<iq type=\"get\"/>");
+    recorder.RecordXmppMessage("agent-a", "");
+    EXPECT_EQ(5U, recorder.record_count());
+    recorder.Close();
+    EXPECT_FALSE(recorder.enabled());
+
+    LoadRecords(filename);
+    unlink(filename.c_str());
+    ASSERT_EQ(5U, records_.size());
+
+    uint8_t peer_type;
+    uint32_t peer_as;
+    string name;
+    EXPECT_TRUE(BgpUpdateRecorder::Reader::ParsePeer(records_[0],
+        &peer_type, &peer_as, &name));
+    EXPECT_EQ(BgpUpdateRecorder::XMPP_PEER, peer_type);
+    EXPECT_EQ(0U, peer_as);
+    EXPECT_EQ("agent-a", name);
+    EXPECT_EQ(BgpUpdateRecorder::XMPP_MESSAGE, records_[1].type);
+    EXPECT_EQ(0, records_[1].peer_index);
+    EXPECT_EQ("<iq type=\"set\"/>", records_[1].data);
+    EXPECT_TRUE(BgpUpdateRecorder::Reader::ParsePeer(records_[2],
+        &peer_type, &peer_as, &name));
+    EXPECT_EQ("agent-b", name);
+    EXPECT_EQ(1, records_[2].peer_index);
+    EXPECT_EQ(1, records_[3].peer_index);
+    EXPECT_EQ("<iq type=\"get\"/>", records_[3].data);
+    EXPECT_EQ(0, records_[4].peer_index);
+    EXPECT_TRUE(records_[4].data.empty());
+    EXPECT_FALSE(BgpUpdateRecorder::Reader::ParsePeer(records_[4],
+        &peer_type, &peer_as, &name));
+    for (size_t idx = 1; idx < records_.size(); ++idx) {
+        EXPECT_GE(records_[idx].timestamp, records_[idx - 1].timestamp);
+    }
+
+    BgpUpdateRecorder::Reader reader;
+    EXPECT_FALSE(reader.Open(filename));
+}
+
+static void SetUp() {
+    bgp_log_test::init();
+    BgpServer::Initialize();
+    ControlNode::SetDefaultSchedulingPolicy();
+    BgpServerTest::GlobalSetUp();
+    BgpObjectFactory::Register<BgpPeer>(
+        boost::factory<BgpPeerReplayMock *>());
+    BgpObjectFactory::Register<BgpXmppMessageBuilder>(
+        boost::factory<BgpXmppMessageBuilder *>());
+}
+
+static void TearDown() {
+    BgpServer::Terminate();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
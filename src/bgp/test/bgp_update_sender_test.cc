@@ -1992,6 +1992,159 @@ TEST_F(BgpUpdateSenderMultiRibOutTest, PeerDequeueBlocks1b) {
     }
 }
 
+//
+// All RibOuts are active for all peers for the qid in question. Each peer has
+// a send window of 1 queue, so PeerDequeue for each peer should process the
+// RibOuts over multiple WorkPeers. The send window stays the same till the
+// peer gets in sync and then it grows once.
+// Since all peers get in sync after the calls to PeerDequeue, there will
+// be one automatic call to TailDequeue per RibOut for the qid in question.
+//
+TEST_F(BgpUpdateSenderMultiRibOutTest, PeerDequeueSendWindow) {
+    for (int qid = RibOutUpdates::QFIRST; qid < RibOutUpdates::QCOUNT; qid++) {
+        Initialize();
+
+        RibPeerSet peerset;
+        BuildPeerSet(peerset, 0, 0, kPeerCount-1);
+
+        // Expect call to TailDequeue for the first RibOut and get all peers
+        // into blocked state.
+        EXPECT_CALL(*updates_[0],
+            TailDequeue(qid, peerset,
+                        Property(&RibPeerSet::empty, true),
+                        Property(&RibPeerSet::empty, true)))
+            .Times(1)
+            .WillOnce(DoAll(SetArgPointee<2>(peerset), Return(false)));
+
+        // Expect calls to TailDequeue for the other RibOuts with an empty
+        // mysnc mask.
+        for (int ro_idx  = 1; ro_idx < kRiboutCount; ro_idx++) {
+            EXPECT_CALL(*updates_[ro_idx],
+                TailDequeue(qid,
+                            Property(&RibPeerSet::empty, true),
+                            Property(&RibPeerSet::empty, true),
+                            Property(&RibPeerSet::empty, true)))
+                .Times(1)
+                .WillOnce(DoAll(SetArgPointee<3>(peerset), Return(false)));
+        }
+
+        for (int ro_idx  = 0; ro_idx < kRiboutCount; ro_idx++) {
+            RibOutActive(ribouts_[ro_idx], qid);
+        }
+
+        // Verify that all peers are blocked.
+        task_util::WaitForIdle();
+        VerifyPeerBlock(0, kPeerCount-1, true);
+
+        // Expect PeerDequeue to be called for each peer for each RibOut.
+        // Return true to get the peers in sync.
+        for (int idx = 0; idx < kPeerCount; idx++) {
+            for (int ro_idx  = 0; ro_idx < kRiboutCount; ro_idx++) {
+                EXPECT_CALL(*updates_[ro_idx],
+                    PeerDequeue(qid, peers_[idx],
+                                Property(&RibPeerSet::empty, true)))
+                    .Times(1)
+                    .WillOnce(Return(true));
+            }
+        }
+
+        // Expect 1 call to TailDequeue for each RibOut as a consequence of
+        // the peers getting in sync.
+        for (int ro_idx  = 0; ro_idx < kRiboutCount; ro_idx++) {
+            RibPeerSet peerset;
+            BuildPeerSet(peerset, ro_idx, 0, kPeerCount-1);
+            EXPECT_CALL(*updates_[ro_idx],
+                TailDequeue(qid, peerset,
+                            Property(&RibPeerSet::empty, true),
+                            Property(&RibPeerSet::empty, true)))
+                .Times(1)
+                .WillOnce(Return(true));
+        }
+
+        // Shrink the send window and unblock all peers.
+        SchedulerStop();
+        for (int idx = 0; idx < kPeerCount; idx++) {
+            spartition_->SetPeerSendWindow(peers_[idx], 1);
+        }
+        SetPeerUnblockNow(0, kPeerCount-1);
+        SchedulerStart();
+
+        // Verify that all peers are in sync and that the send window grew.
+        task_util::WaitForIdle();
+        VerifyPeerInSync(0, kPeerCount-1, true);
+        for (int idx = 0; idx < kPeerCount; idx++) {
+            EXPECT_EQ(2, spartition_->PeerSendWindow(peers_[idx]));
+        }
+    }
+}
+
+//
+// Peers that get blocked and unblocked have the blocked duration accounted
+// for in their blocked statistics.
+//
+TEST_F(BgpUpdateSenderMultiRibOutTest, PeerBlockedStats) {
+    RibPeerSet peerset;
+    BuildPeerSet(peerset, 0, 0, kPeerCount-1);
+
+    // Expect call to TailDequeue for the first RibOut and get all peers
+    // into blocked state.
+    EXPECT_CALL(*updates_[0],
+        TailDequeue(RibOutUpdates::QUPDATE, peerset,
+                    Property(&RibPeerSet::empty, true),
+                    Property(&RibPeerSet::empty, true)))
+        .Times(1)
+        .WillOnce(DoAll(SetArgPointee<2>(peerset), Return(false)));
+    RibOutActive(ribouts_[0], RibOutUpdates::QUPDATE);
+    task_util::WaitForIdle();
+    VerifyPeerBlock(0, kPeerCount-1, true);
+
+    // Verify that nothing has been accounted for yet.
+    for (int idx = 0; idx < kPeerCount; idx++) {
+        ConcurrencyScope scope("bgp::ShowCommand");
+        BgpSenderPartition::BlockedStats stats;
+        sender_->GetPeerBlockedStats(peers_[idx], &stats);
+        EXPECT_EQ(0, stats.count);
+    }
+
+    // Expect PeerDequeue to be called for each peer and TailDequeue to be
+    // called when the peers get in sync.
+    for (int idx = 0; idx < kPeerCount; idx++) {
+        EXPECT_CALL(*updates_[0],
+            PeerDequeue(RibOutUpdates::QUPDATE, peers_[idx],
+                        Property(&RibPeerSet::empty, true)))
+            .Times(1)
+            .WillOnce(Return(true));
+    }
+    EXPECT_CALL(*updates_[0],
+        TailDequeue(RibOutUpdates::QUPDATE, peerset,
+                    Property(&RibPeerSet::empty, true),
+                    Property(&RibPeerSet::empty, true)))
+        .Times(1)
+        .WillOnce(Return(true));
+
+    // Unblock all peers.
+    SchedulerStop();
+    SetPeerUnblockNow(0, kPeerCount-1);
+    SchedulerStart();
+    task_util::WaitForIdle();
+
+    // Verify that the blocked duration got accounted for once per peer.
+    for (int idx = 0; idx < kPeerCount; idx++) {
+        ConcurrencyScope scope("bgp::ShowCommand");
+        BgpSenderPartition::BlockedStats stats;
+        sender_->GetPeerBlockedStats(peers_[idx], &stats);
+        EXPECT_EQ(1, stats.count);
+        EXPECT_GE(stats.max_duration_usecs, stats.duration_usecs);
+        uint64_t bucket_count = 0;
+        for (int bucket = 0;
+             bucket < BgpSenderPartition::BlockedStats::kBucketCount;
+             ++bucket) {
+            bucket_count += stats.buckets[bucket];
+        }
+        EXPECT_EQ(1, bucket_count);
+    }
+}
+
 int main(int argc, char **argv) {
     bgp_log_test::init();
     ControlNode::SetDefaultSchedulingPolicy();
@@ -283,7 +283,7 @@ TEST_F(BgpUpdateTest, Basic) {
     const AdvertiseSList &adv_slist = rs->Advertised();
     TASK_UTIL_EXPECT_EQ(1, adv_slist->size());
     const AdvertiseInfo &ainfo = *adv_slist->begin();
-    TASK_UTIL_EXPECT_TRUE(ribout1_->PeerSet() == ainfo.bitset);
+    TASK_UTIL_EXPECT_TRUE(ribout1_->PeerSet() == ainfo.bitset());
 
     // delete
     u1 = BuildWithdraw(&rt1, ribout1_);
@@ -300,6 +300,44 @@ TEST_F(BgpUpdateTest, Basic) {
 }
 
 // 2. Verify that update with same attribute end up in the same packet.
+// Advertise two routes with different attributes to the same peers and
+// observe that they share the same interned peer set.
+TEST_F(BgpUpdateTest, SharedPeerSet) {
+    RibOutUpdates *updates = ribout1_->updates(0);
+    InetVpnPrefix prefix1(InetVpnPrefix::FromString("0:0:192.168.24.0/24"));
+    InetVpnPrefix prefix2(InetVpnPrefix::FromString("0:0:192.168.25.0/24"));
+    InetVpnRoute rt1(prefix1);
+    InetVpnRoute rt2(prefix2);
+    EnqueueOneUpdate(updates, &rt1, BuildUpdate(&rt1, ribout1_, a1_));
+    EnqueueOneUpdate(updates, &rt2, BuildUpdate(&rt2, ribout1_, a2_));
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(ribout1_->updates(0)->Empty());
+    const RouteState *rs1 = static_cast<const RouteState *>(
+        rt1.GetState(ribout1_->table(), ribout1_->listener_id()));
+    const RouteState *rs2 = static_cast<const RouteState *>(
+        rt2.GetState(ribout1_->table(), ribout1_->listener_id()));
+    ASSERT_TRUE(rs1 != NULL);
+    ASSERT_TRUE(rs2 != NULL);
+    const AdvertiseInfo &ainfo1 = *rs1->Advertised()->begin();
+    const AdvertiseInfo &ainfo2 = *rs2->Advertised()->begin();
+    EXPECT_TRUE(ribout1_->PeerSet() == ainfo1.bitset());
+    EXPECT_TRUE(ribout1_->PeerSet() == ainfo2.bitset());
+    EXPECT_EQ(ainfo1.peerset.get(), ainfo2.peerset.get());
+    EXPECT_EQ(1, server_.peerset_db()->Size());
+
+    EnqueueOneUpdate(updates, &rt1, BuildWithdraw(&rt1, ribout1_));
+    EnqueueOneUpdate(updates, &rt2, BuildWithdraw(&rt2, ribout1_));
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_TRUE(ribout1_->updates(0)->Empty());
+    EXPECT_EQ(0, server_.peerset_db()->Size());
+
+    // Cleanup RouteState on all routes.
+    DeleteRouteState(ribout1_, &rt1);
+    DeleteRouteState(ribout1_, &rt2);
+}
+
 TEST_F(BgpUpdateTest, UpdatePack) {
     InetVpnPrefix prefix(InetVpnPrefix::FromString("0:0:192.168.24.0/24"));
     InetVpnRoute rt1(prefix), rt2(prefix), rt3(prefix), rt4(prefix);
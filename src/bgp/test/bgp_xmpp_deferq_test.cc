@@ -10,7 +10,9 @@
 using namespace boost::assign;
 
 
+#include "base/string_util.h"
 #include "base/task_annotations.h"
+#include "base/time_util.h"
 #include "bgp/bgp_factory.h"
 #include "bgp/bgp_path.h"
 #include "bgp/bgp_membership.h"
@@ -22,6 +24,7 @@ using namespace boost::assign;
 #include "io/test/event_manager_test.h"
 #include "control-node/control_node.h"
 #include "control-node/test/network_agent_mock.h"
+#include "xmpp/xmpp_state_machine.h"
 
 using namespace boost::asio;
 using namespace std;
@@ -249,6 +252,9 @@ protected:
     }
 
     virtual void TearDown() {
+        XmppStateMachine::SetReaderWaterMarks(
+            XmppStateMachine::kReaderHighWaterMark,
+            XmppStateMachine::kReaderLowWaterMark);
         task_util::WaitForIdle();
         ConcurrencyScope scope("bgp::Config");
         TASK_UTIL_EXPECT_TRUE(a_->IsReadyForDeletion());
@@ -3661,6 +3667,58 @@ TEST_F(BgpXmppUnitTest, BgpXmppBadAddress) {
     agent_a_->SessionDown();
     task_util::WaitForIdle();
 }
+
+//
+// Publish a burst of routes with very low reader water marks so that the
+// reader for the agent's session gets deferred and resumed repeatedly while
+// the xmpp state machine work queue is drained. All routes must still make
+// it into the table and get reflected back to the agent.
+//
+// Set ROUTE_COUNT to change the number of routes.
+//
+TEST_F(BgpXmppUnitTest, ReaderBackpressureStress) {
+    int route_count = 2048;
+    char *str = getenv("ROUTE_COUNT");
+    if (str)
+        route_count = strtoul(str, NULL, 0);
+
+    Configure();
+    task_util::WaitForIdle();
+    XmppStateMachine::SetReaderWaterMarks(2, 1);
+
+    // create an XMPP client in server A
+    agent_a_.reset(
+        new test::NetworkAgentMock(&evm_, SUB_ADDR, xs_a_->GetPort()));
+
+    TASK_UTIL_EXPECT_TRUE(channel() != NULL);
+    TASK_UTIL_EXPECT_TRUE(agent_a_->IsEstablished());
+
+    agent_a_->Subscribe("blue", 1);
+    task_util::WaitForIdle();
+
+    uint64_t start = ClockMonotonicUsec();
+    for (int idx = 0; idx < route_count; ++idx) {
+        string prefix = "10.1." + integerToString(idx / 256 % 256) + "." +
+            integerToString(idx % 256) + "/32";
+        agent_a_->AddRoute("blue", prefix);
+    }
+    BgpTable *table = VerifyBgpTable("blue", Address::INET);
+    BGP_VERIFY_ROUTE_COUNT(table, route_count);
+    TASK_UTIL_EXPECT_EQ(route_count, agent_a_->RouteCount());
+    uint64_t elapsed = ClockMonotonicUsec() - start;
+
+    const XmppStateMachine *state_machine =
+        channel()->channel()->connection()->state_machine();
+    cout << "Routes " << route_count
+         << " Elapsed(usec) " << elapsed
+         << " Routes/sec "
+         << (elapsed ? route_count * 1000000ULL / elapsed : 0)
+         << " ReaderDefers " << state_machine->reader_defer_count()
+         << endl;
+
+    agent_a_->SessionDown();
+    task_util::WaitForIdle();
+}
 }
 
 class TestEnvironment : public ::testing::Environment {
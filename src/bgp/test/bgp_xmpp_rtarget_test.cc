@@ -5,7 +5,9 @@
 #include <boost/assign/list_of.hpp>
 #include <boost/foreach.hpp>
 
+#include "bgp/bgp_export.h"
 #include "bgp/bgp_factory.h"
+#include "bgp/bgp_ribout.h"
 #include "bgp/bgp_sandesh.h"
 #include "bgp/bgp_xmpp_sandesh.h"
 #include "bgp/bgp_session_manager.h"
@@ -819,6 +821,19 @@ protected:
     }
 
 
+    uint64_t GetRTargetFilteredCount(BgpServerTest *server) {
+        task_util::WaitForIdle();
+        BgpTable *table = static_cast<BgpTable *>(
+            server->database()->FindTable("bgp.l3vpn.0"));
+        uint64_t count = 0;
+        for (BgpTable::RibOutMap::const_iterator it =
+             table->ribout_map().begin(); it != table->ribout_map().end();
+             ++it) {
+            count += it->second->bgp_export()->rtarget_filtered_count();
+        }
+        return count;
+    }
+
     vector<string> GetExportRouteTargetList(BgpServerTest *server,
         const string &instance) {
         TASK_UTIL_EXPECT_NE(static_cast<RoutingInstance *>(NULL),
@@ -1469,6 +1484,29 @@ TEST_F(BgpXmppRTargetTest, SubscribeUnsubscribe1) {
     DeleteInetRoute(mx_.get(), NULL, "blue", BuildPrefix());
 }
 
+//
+// VPN route on MX that no CN is interested in should get dropped by route
+// target filtering in BgpExport, before running the export policy.
+//
+TEST_F(BgpXmppRTargetTest, RTargetFilteredCount) {
+    AddRouteTarget(mx_.get(), "blue", "target:64496:1");
+    TASK_UTIL_EXPECT_EQ(2, GetExportRouteTargetListSize(mx_.get(), "blue"));
+
+    AddInetRoute(mx_.get(), NULL, "blue", BuildPrefix());
+
+    VerifyInetRouteExists(mx_.get(), "blue", BuildPrefix());
+    VerifyInetRouteNoExists(cn1_.get(), "blue", BuildPrefix());
+    VerifyInetRouteNoExists(cn2_.get(), "blue", BuildPrefix());
+    TASK_UTIL_EXPECT_NE(0U, GetRTargetFilteredCount(mx_.get()));
+
+    agent_a_1_->Subscribe("blue", 1);
+
+    VerifyInetRouteExists(cn1_.get(), "blue", BuildPrefix());
+    VerifyInetRouteNoExists(cn2_.get(), "blue", BuildPrefix());
+
+    DeleteInetRoute(mx_.get(), NULL, "blue", BuildPrefix());
+}
+
 //
 // Subscribe and Unsubscribe from agents should trigger advertisement and
 // withdrawal of RTargetRoutes from CNs and hence advertisement/withdrawal
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <boost/foreach.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <iostream>
+
+#include "base/string_util.h"
+#include "base/time_util.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_log.h"
+#include "bgp/bgp_server.h"
+#include "bgp/origin-vn/origin_vn.h"
+#include "bgp/rtarget/rtarget_address.h"
+#include "control-node/control_node.h"
+
+using std::cout;
+using std::endl;
+using std::vector;
+
+//
+// Measure locate rates for attributes with a large number of extended
+// communities per route.
+//
+// Set EXTCOMM_COUNT to change the number of route targets per attribute.
+// Set LOCATE_COUNT to change the number of Locate calls made per test.
+//
+class ExtCommunityPerfTest : public ::testing::Test {
+protected:
+    static const int kAttrCount = 1024;
+
+    ExtCommunityPerfTest()
+        : server_(new BgpServer(&evm_)),
+          extcomm_count_(24),
+          locate_count_(16 * 1024) {
+    }
+
+    virtual void SetUp() {
+        char *str = getenv("EXTCOMM_COUNT");
+        if (str)
+            extcomm_count_ = strtoul(str, NULL, 0);
+        str = getenv("LOCATE_COUNT");
+        if (str)
+            locate_count_ = strtoul(str, NULL, 0);
+
+        // Each attribute shares all but one of its route targets with the
+        // other attributes, which makes for expensive comparisons.
+        for (int idx = 0; idx < kAttrCount; ++idx) {
+            BgpAttrSpec *spec = new BgpAttrSpec;
+            spec->push_back(new BgpAttrNextHop(0x0a000000 + idx));
+            ExtCommunitySpec *extcomm_spec = new ExtCommunitySpec;
+            for (int rt_idx = 0; rt_idx < extcomm_count_ - 1; ++rt_idx) {
+                RouteTarget rtarget = RouteTarget::FromString(
+                    "target:64512:" + integerToString(rt_idx));
+                extcomm_spec->communities.push_back(
+                    rtarget.GetExtCommunityValue());
+            }
+            RouteTarget rtarget = RouteTarget::FromString(
+                "target:64513:" + integerToString(idx));
+            extcomm_spec->communities.push_back(rtarget.GetExtCommunityValue());
+            OriginVn origin_vn(64512, 1);
+            extcomm_spec->communities.push_back(
+                origin_vn.GetExtCommunityValue());
+            spec->push_back(extcomm_spec);
+            specs_.push_back(spec);
+        }
+
+        for (int idx = 0; idx < kAttrCount; ++idx) {
+            attrs_.push_back(server_->attr_db()->Locate(*specs_[idx]));
+        }
+    }
+
+    virtual void TearDown() {
+        attrs_.clear();
+        EXPECT_EQ(0, server_->attr_db()->Size());
+        EXPECT_EQ(0, server_->extcomm_db()->Size());
+        BOOST_FOREACH(BgpAttrSpec *spec, specs_) {
+            STLDeleteValues(spec);
+            delete spec;
+        }
+        server_->Shutdown();
+        task_util::WaitForIdle();
+        server_.reset();
+    }
+
+    void PrintResult(const char *name, uint64_t elapsed) {
+        cout << name
+             << " ExtCommunities " << extcomm_count_
+             << " Locates " << locate_count_
+             << " Elapsed(usec) " << elapsed
+             << " Locates/sec "
+             << (elapsed ? locate_count_ * 1000000ULL / elapsed : 0)
+             << endl;
+    }
+
+    EventManager evm_;
+    boost::scoped_ptr<BgpServer> server_;
+    int extcomm_count_;
+    int locate_count_;
+    vector<BgpAttrSpec *> specs_;
+    vector<BgpAttrPtr> attrs_;
+};
+
+//
+// Locate existing BgpAttrs. Exercises hashing and comparison of the
+// ExtCommunity in both the ExtCommunityDB and the BgpAttrDB.
+//
+TEST_F(ExtCommunityPerfTest, AttrLocate) {
+    BgpAttrDB *attr_db = server_->attr_db();
+    uint64_t start = ClockMonotonicUsec();
+    for (int count = 0; count < locate_count_; ++count) {
+        BgpAttrPtr attr = attr_db->Locate(*specs_[count % kAttrCount]);
+    }
+    PrintResult("AttrLocate", ClockMonotonicUsec() - start);
+}
+
+//
+// Replace the OriginVn of existing ExtCommunities. Alternate between two
+// values so that the result is always an existing ExtCommunity.
+//
+TEST_F(ExtCommunityPerfTest, ReplaceOriginVnAndLocate) {
+    ExtCommunityDB *extcomm_db = server_->extcomm_db();
+    OriginVn origin_vn1(64512, 1);
+    OriginVn origin_vn2(64512, 2);
+    vector<ExtCommunityPtr> extcomms;
+    BOOST_FOREACH(const BgpAttrPtr &attr, attrs_) {
+        extcomms.push_back(extcomm_db->ReplaceOriginVnAndLocate(
+            attr->ext_community(), origin_vn2.GetExtCommunity()));
+    }
+
+    uint64_t start = ClockMonotonicUsec();
+    for (int count = 0; count < locate_count_; ++count) {
+        const BgpAttr *attr = attrs_[count % kAttrCount].get();
+        const OriginVn &origin_vn = (count & 0x1) ? origin_vn1 : origin_vn2;
+        ExtCommunityPtr extcomm = extcomm_db->ReplaceOriginVnAndLocate(
+            attr->ext_community(), origin_vn.GetExtCommunity());
+    }
+    PrintResult("ReplaceOriginVnAndLocate", ClockMonotonicUsec() - start);
+}
+
+//
+// Replace the route targets of existing ExtCommunities and locate the
+// BgpAttr with the new ExtCommunity, as done when exporting a route.
+//
+TEST_F(ExtCommunityPerfTest, ReplaceRTargetAndLocate) {
+    BgpAttrDB *attr_db = server_->attr_db();
+    ExtCommunityDB *extcomm_db = server_->extcomm_db();
+    ExtCommunity::ExtCommunityList export_list;
+    for (int rt_idx = 0; rt_idx < extcomm_count_; ++rt_idx) {
+        RouteTarget rtarget = RouteTarget::FromString(
+            "target:64514:" + integerToString(rt_idx));
+        export_list.push_back(rtarget.GetExtCommunity());
+    }
+
+    vector<BgpAttrPtr> exported_attrs;
+    uint64_t start = ClockMonotonicUsec();
+    for (int count = 0; count < locate_count_; ++count) {
+        const BgpAttr *attr = attrs_[count % kAttrCount].get();
+        ExtCommunityPtr extcomm = extcomm_db->ReplaceRTargetAndLocate(
+            attr->ext_community(), export_list);
+        BgpAttrPtr exported_attr =
+            attr_db->ReplaceExtCommunityAndLocate(attr, extcomm);
+        if (count < kAttrCount)
+            exported_attrs.push_back(exported_attr);
+    }
+    PrintResult("ReplaceRTargetAndLocate", ClockMonotonicUsec() - start);
+}
+
+static void SetUp() {
+    bgp_log_test::init();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
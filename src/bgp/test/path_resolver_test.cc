@@ -12,6 +12,7 @@
 #include "sandesh/sandesh_types.h"
 #include "sandesh/sandesh.h"
 #include "sandesh/sandesh_trace.h"
+#include "base/time_util.h"
 #include "bgp/bgp_factory.h"
 #include "bgp/bgp_peer_types.h"
 #include "bgp/bgp_sandesh.h"
@@ -212,6 +213,24 @@ protected:
         return "";
     }
 
+    // Prefix for scale tests, allows for more than 64K prefixes.
+    string BuildScalePrefix(int index) const {
+        assert(index <= 0xFFFFFF);
+        string ipv4_prefix = "20." + integerToString(index / 65536) + "." +
+            integerToString(index / 256 % 256) + "." +
+            integerToString(index % 256);
+        uint8_t ipv4_plen = Address::kMaxV4PrefixLen;
+        if (family_ == Address::INET) {
+            return ipv4_prefix + "/" + integerToString(ipv4_plen);
+        }
+        if (family_ == Address::INET6) {
+            return ipv6_prefix_ + ipv4_prefix + "/" +
+                integerToString(96 + ipv4_plen);
+        }
+        assert(false);
+        return "";
+    }
+
     string BuildNextHopAddress(const string &ipv4_addr) const {
         return ipv4_addr;
     }
@@ -2630,6 +2649,61 @@ TYPED_TEST(PathResolverTest, Shutdown5) {
     TASK_UTIL_EXPECT_EQ(0, bgp_server->routing_instance_mgr()->count());
 }
 
+//
+// BGP has a large number of prefixes, each with the same nexthop.
+// Change XMPP path for the nexthop and measure the time taken for all the
+// resolved paths to converge.
+//
+// Set PATH_RESOLVER_SCALE_COUNT to change the number of BGP paths e.g. to
+// 100000 to get convergence time for 100K dependent paths.
+//
+TYPED_TEST(PathResolverTest, ScaleChangeXmppPath) {
+    PeerMock *bgp_peer1 = this->bgp_peer1_;
+    PeerMock *xmpp_peer1 = this->xmpp_peer1_;
+
+    int count = 16 * 1024;
+    char *str = getenv("PATH_RESOLVER_SCALE_COUNT");
+    if (str)
+        count = strtoul(str, NULL, 0);
+
+    this->AddXmppPath(xmpp_peer1, "blue",
+        this->BuildPrefix(bgp_peer1->ToString(), 32),
+        this->BuildNextHopAddress("172.16.1.1"), 10000);
+    for (int idx = 0; idx < count; ++idx) {
+        this->AddBgpPath(bgp_peer1, "blue", this->BuildScalePrefix(idx),
+            this->BuildHostAddress(bgp_peer1->ToString()));
+    }
+    task_util::WaitForIdle(600);
+    this->VerifyPathAttributes("blue", this->BuildScalePrefix(0), bgp_peer1,
+        this->BuildNextHopAddress("172.16.1.1"), 10000);
+    this->VerifyPathAttributes("blue", this->BuildScalePrefix(count - 1),
+        bgp_peer1, this->BuildNextHopAddress("172.16.1.1"), 10000);
+
+    for (uint32_t label = 10001; label <= 10004; ++label) {
+        uint64_t start = ClockMonotonicUsec();
+        this->AddXmppPath(xmpp_peer1, "blue",
+            this->BuildPrefix(bgp_peer1->ToString(), 32),
+            this->BuildNextHopAddress("172.16.1.1"), label);
+        task_util::WaitForIdle(600);
+        uint64_t elapsed = ClockMonotonicUsec() - start;
+        this->VerifyPathAttributes("blue", this->BuildScalePrefix(0),
+            bgp_peer1, this->BuildNextHopAddress("172.16.1.1"), label);
+        this->VerifyPathAttributes("blue", this->BuildScalePrefix(count - 1),
+            bgp_peer1, this->BuildNextHopAddress("172.16.1.1"), label);
+        cout << "Paths " << count
+             << " Nexthop change convergence(usec) " << elapsed
+             << " Paths/sec " << (elapsed ? count * 1000000ULL / elapsed : 0)
+             << endl;
+    }
+
+    for (int idx = 0; idx < count; ++idx) {
+        this->DeleteBgpPath(bgp_peer1, "blue", this->BuildScalePrefix(idx));
+    }
+    this->DeleteXmppPath(xmpp_peer1, "blue",
+        this->BuildPrefix(bgp_peer1->ToString(), 32));
+    task_util::WaitForIdle(600);
+}
+
 class TestEnvironment : public ::testing::Environment {
     virtual ~TestEnvironment() { }
 };
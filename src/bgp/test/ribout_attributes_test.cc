@@ -316,6 +316,87 @@ TEST_F(RibOutAttributesTest, SequenceNumber2) {
     route.RemovePath(&peer2);
 }
 
+// Identical RibOutAttrs for the same route share the string representation.
+TEST_F(RibOutAttributesTest, ReprCache1) {
+    Ip4Prefix prefix1(Ip4Prefix::FromString("10.1.1.1/32"));
+    Ip4Prefix prefix2(Ip4Prefix::FromString("10.1.1.2/32"));
+    InetRoute route1(prefix1);
+    InetRoute route2(prefix2);
+
+    BgpAttrNextHop nexthop(0x01010101);
+    BgpAttrSpec spec;
+    spec.push_back(&nexthop);
+    BgpAttrPtr attr = server_.attr_db()->Locate(spec);
+
+    RibOutAttrReprCache cache;
+    {
+        RibOutAttr roattr1(NULL, attr.get(), 100, 0, true);
+        RibOutAttr roattr2(NULL, attr.get(), 100, 0, true);
+        RibOutAttr roattr3(NULL, attr.get(), 100, 0, true);
+        roattr1.set_shared_repr(cache.Locate(&route1, roattr1));
+        roattr2.set_shared_repr(cache.Locate(&route1, roattr2));
+        roattr3.set_shared_repr(cache.Locate(&route2, roattr3));
+        EXPECT_EQ(2, cache.size());
+        EXPECT_TRUE(roattr1.is_repr_shared());
+        EXPECT_TRUE(roattr2.is_repr_shared());
+        EXPECT_TRUE(roattr3.is_repr_shared());
+
+        roattr1.set_repr("<item id=\"10.1.1.1/32\" />");
+        EXPECT_EQ(roattr1.repr(), roattr2.repr());
+        EXPECT_TRUE(roattr3.repr().empty());
+
+        // Copies don't carry the string representation.
+        RibOutAttr roattr4(roattr1);
+        EXPECT_FALSE(roattr4.is_repr_shared());
+        EXPECT_TRUE(roattr4.repr().empty());
+    }
+    EXPECT_EQ(0, cache.size());
+}
+
+// Different RibOutAttrs for the same route don't share representation.
+TEST_F(RibOutAttributesTest, ReprCache2) {
+    Ip4Prefix prefix(Ip4Prefix::FromString("10.1.1.1/32"));
+    InetRoute route(prefix);
+
+    BgpAttrNextHop nexthop(0x01010101);
+    BgpAttrSpec spec;
+    spec.push_back(&nexthop);
+    BgpAttrPtr attr = server_.attr_db()->Locate(spec);
+
+    RibOutAttrReprCache cache;
+    {
+        RibOutAttr roattr1(NULL, attr.get(), 100, 0, true);
+        RibOutAttr roattr2(NULL, attr.get(), 200, 0, true);
+        roattr1.set_shared_repr(cache.Locate(&route, roattr1));
+        roattr2.set_shared_repr(cache.Locate(&route, roattr2));
+        EXPECT_EQ(2, cache.size());
+
+        roattr1.set_repr("<item id=\"10.1.1.1/32\" />");
+        EXPECT_FALSE(roattr1.repr().empty());
+        EXPECT_TRUE(roattr2.repr().empty());
+
+        roattr1.set_shared_repr(RibOutAttrReprPtr());
+        EXPECT_EQ(1, cache.size());
+        EXPECT_TRUE(roattr1.repr().empty());
+    }
+    EXPECT_EQ(0, cache.size());
+}
+
+// Private string representation is allocated if there's no shared one.
+TEST_F(RibOutAttributesTest, ReprPrivate) {
+    BgpAttrNextHop nexthop(0x01010101);
+    BgpAttrSpec spec;
+    spec.push_back(&nexthop);
+    BgpAttrPtr attr = server_.attr_db()->Locate(spec);
+
+    RibOutAttr roattr(NULL, attr.get(), 100, 0, true);
+    EXPECT_TRUE(roattr.repr().empty());
+    std::string repr("xxxx<item id=\"10.1.1.1/32\" />");
+    roattr.set_repr(repr, 4);
+    EXPECT_FALSE(roattr.is_repr_shared());
+    EXPECT_EQ("<item id=\"10.1.1.1/32\" />", roattr.repr());
+}
+
 }  // namespace
 
 static void SetUp() {
@@ -7,6 +7,8 @@
 #include <boost/foreach.hpp>
 #include <boost/assign/list_of.hpp>
 
+#include "base/string_util.h"
+#include "base/time_util.h"
 #include "bgp/bgp_config_ifmap.h"
 #include "bgp/bgp_config_parser.h"
 #include "bgp/bgp_factory.h"
@@ -479,11 +481,22 @@ protected:
     }
 
     void DisableRouteTargetProcessing() {
-        bgp_server_->rtarget_group_mgr()->DisableRouteTargetProcessing();
+        RoutePathReplicator *replicator =
+            bgp_server_->replicator(Address::INETVPN);
+        replicator->DisableRouteTargetProcessing();
     }
 
     void EnableRouteTargetProcessing() {
-        bgp_server_->rtarget_group_mgr()->EnableRouteTargetProcessing();
+        RoutePathReplicator *replicator =
+            bgp_server_->replicator(Address::INETVPN);
+        replicator->EnableRouteTargetProcessing();
+    }
+
+    bool IsRouteTargetOnList(const string &target) {
+        RoutePathReplicator *replicator =
+            bgp_server_->replicator(Address::INETVPN);
+        return replicator->IsRouteTargetOnList(
+            RouteTarget::FromString(target));
     }
 
     const TableState *LookupVpnTableState() {
@@ -2409,7 +2422,7 @@ TEST_F(ReplicationTest, VpnTableStateDelete2) {
 
 //
 // Verify cleanup of VPN table state.
-// VPN routes are notified only after Leave has been processed for all
+// VPN routes are evaluated only after Leave has been processed for all
 // VRF tables.
 // Notification of last VPN route triggers deletion of VPN table state.
 //
@@ -2672,6 +2685,138 @@ TEST_F(ReplicationTest, TableStateOnVRFInBulkSyncList) {
     VerifyVRFTableStateExists("red", false);
 }
 
+//
+// Verify that adding or removing an import target re-evaluates only the VPN
+// routes with the target in question and that the evaluation happens from
+// the RouteTargetTriggerLists in the replicator.
+//
+TEST_F(ReplicationTest, ImportTargetDependentRoutes) {
+    vector<string> instance_names = list_of("blue");
+    multimap<string, string> connections;
+    NetworkConfig(instance_names, connections);
+    task_util::WaitForIdle();
+
+    boost::system::error_code ec;
+    peers_.push_back(
+        new BgpPeerMock(Ip4Address::from_string("192.168.0.1", ec)));
+
+    AddVPNRouteWithTarget(peers_[0], "192.168.0.1:1:10.0.1.1/32", 100,
+        "target:1:100");
+    AddVPNRouteWithTarget(peers_[0], "192.168.0.1:1:10.0.1.2/32", 100,
+        "target:1:200");
+    VERIFY_EQ(0, RouteCount("blue"));
+
+    // Add the import target with processing disabled.
+    DisableRouteTargetProcessing();
+    AddInstanceImportRouteTarget("blue", "target:1:100");
+    TASK_UTIL_EXPECT_TRUE(IsRouteTargetOnList("target:1:100"));
+    VERIFY_EQ(0, RouteCount("blue"));
+
+    // Enable processing and verify that only the dependent route is imported.
+    EnableRouteTargetProcessing();
+    TASK_UTIL_EXPECT_FALSE(IsRouteTargetOnList("target:1:100"));
+    VERIFY_EQ(1, RouteCount("blue"));
+    TASK_UTIL_EXPECT_TRUE(InetRouteLookup("blue", "10.0.1.1/32") != NULL);
+
+    // Remove the import target and verify that the route is removed.
+    RemoveInstanceRouteTarget("blue", "target:1:100");
+    VERIFY_EQ(0, RouteCount("blue"));
+
+    DeleteVPNRoute(peers_[0], "192.168.0.1:1:10.0.1.1/32");
+    DeleteVPNRoute(peers_[0], "192.168.0.1:1:10.0.1.2/32");
+    task_util::WaitForIdle();
+}
+
+//
+// Import a new target into a VRF when there are many VPN routes, only a
+// fraction of which have the target, and report the time taken.
+//
+// The default number of VPN routes is kept small so that this runs quickly
+// as part of the unit tests. Set REPLICATOR_SCALE_VPN_ROUTES to measure at
+// scale e.g. to 1000000 for 1M VPN routes. Every 16th route has the imported
+// target.
+//
+TEST_F(ReplicationTest, ScaleImportTarget) {
+    vector<string> instance_names = list_of("blue");
+    multimap<string, string> connections;
+    NetworkConfig(instance_names, connections);
+    task_util::WaitForIdle();
+
+    boost::system::error_code ec;
+    peers_.push_back(
+        new BgpPeerMock(Ip4Address::from_string("192.168.0.1", ec)));
+
+    int count = 64;
+    char *str = getenv("REPLICATOR_SCALE_VPN_ROUTES");
+    if (str)
+        count = strtoul(str, NULL, 0);
+
+    BgpTable *table = static_cast<BgpTable *>(
+        bgp_server_->database()->FindTable("bgp.l3vpn.0"));
+    ASSERT_TRUE(table != NULL);
+    vector<BgpAttrPtr> attrs;
+    vector<string> targets = list_of("target:1:100")("target:1:200");
+    BOOST_FOREACH(const string &target, targets) {
+        BgpAttrSpec attr_spec;
+        BgpAttrLocalPref local_pref(100);
+        attr_spec.push_back(&local_pref);
+        ExtCommunitySpec commspec;
+        const ExtCommunity::ExtCommunityValue &extcomm =
+            RouteTarget::FromString(target).GetExtCommunity();
+        commspec.communities.push_back(
+            get_value(extcomm.data(), extcomm.size()));
+        attr_spec.push_back(&commspec);
+        attrs.push_back(bgp_server_->attr_db()->Locate(attr_spec));
+    }
+
+    vector<string> prefixes;
+    for (int idx = 0; idx < count; ++idx) {
+        prefixes.push_back("192.168.0.1:1:10." +
+            integerToString(idx / 65536) + "." +
+            integerToString(idx / 256 % 256) + "." +
+            integerToString(idx % 256) + "/32");
+    }
+
+    for (int idx = 0; idx < count; ++idx) {
+        InetVpnPrefix nlri = InetVpnPrefix::FromString(prefixes[idx], &ec);
+        DBRequest request;
+        request.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+        request.key.reset(new InetVpnTable::RequestKey(nlri, peers_[0]));
+        request.data.reset(
+            new BgpTable::RequestData(attrs[idx % 16 ? 1 : 0], 0, 0));
+        table->Enqueue(&request);
+    }
+    task_util::WaitForIdle(600);
+    VERIFY_EQ(count, static_cast<int>(table->Size()));
+    VERIFY_EQ(0, RouteCount("blue"));
+
+    int imported = (count + 15) / 16;
+    uint64_t start = ClockMonotonicUsec();
+    AddInstanceImportRouteTarget("blue", "target:1:100");
+    VERIFY_EQ(imported, RouteCount("blue"));
+    uint64_t elapsed = ClockMonotonicUsec() - start;
+    cout << "VPN routes " << count << " Imported " << imported
+         << " Import target add(usec) " << elapsed << endl;
+
+    start = ClockMonotonicUsec();
+    RemoveInstanceRouteTarget("blue", "target:1:100");
+    VERIFY_EQ(0, RouteCount("blue"));
+    elapsed = ClockMonotonicUsec() - start;
+    cout << "VPN routes " << count << " Imported " << imported
+         << " Import target remove(usec) " << elapsed << endl;
+
+    for (int idx = 0; idx < count; ++idx) {
+        InetVpnPrefix nlri = InetVpnPrefix::FromString(prefixes[idx], &ec);
+        DBRequest request;
+        request.oper = DBRequest::DB_ENTRY_DELETE;
+        request.key.reset(new InetVpnTable::RequestKey(nlri, peers_[0]));
+        table->Enqueue(&request);
+    }
+    attrs.clear();
+    task_util::WaitForIdle(600);
+    VERIFY_EQ(0, static_cast<int>(table->Size()));
+}
+
 class TestEnvironment : public ::testing::Environment {
     virtual ~TestEnvironment() { }
 };
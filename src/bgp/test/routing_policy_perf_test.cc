@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/time_util.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_config.h"
+#include "bgp/bgp_log.h"
+#include "bgp/bgp_server.h"
+#include "bgp/community.h"
+#include "bgp/inet/inet_route.h"
+#include "bgp/routing-policy/routing_policy.h"
+#include "bgp/routing-policy/routing_policy_program.h"
+#include "control-node/control_node.h"
+
+using boost::lexical_cast;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+//
+// Measure the cost of applying a routing policy with many terms to a large
+// number of routes.
+//
+// Compiled uses RoutingPolicy::operator(), which evaluates the compiled
+// RoutingPolicyProgram. Interpreted uses RoutingPolicy::ApplyTerms, which
+// evaluates each term in turn. The results of both are compared for a
+// subset of the routes.
+//
+// The policy has prefix, community and protocol match conditions and the
+// routes use a small number of distinct community lists, as is typical.
+//
+// Set POLICY_ROUTE_COUNT to change the number of routes and POLICY_TERM_COUNT
+// to change the number of terms.
+//
+class RoutingPolicyPerfTest : public ::testing::Test {
+protected:
+    static const int kAttrCount = 64;
+    static const int kVerifyCount = 16 * 1024;
+
+    RoutingPolicyPerfTest()
+        : server_(&evm_), config_("perf-policy"), policy_(NULL),
+          route_count_(1024), term_count_(64) {
+    }
+
+    virtual void SetUp() {
+        char *str = getenv("POLICY_ROUTE_COUNT");
+        if (str)
+            route_count_ = strtoul(str, NULL, 0);
+        str = getenv("POLICY_TERM_COUNT");
+        if (str)
+            term_count_ = strtoul(str, NULL, 0);
+
+        BuildConfig();
+        policy_ = server_.routing_policy_mgr()->CreateRoutingPolicy(&config_);
+        BuildRoutes();
+        BuildAttrs();
+    }
+
+    virtual void TearDown() {
+        STLDeleteValues(&routes_);
+        attrs_.clear();
+        RoutingPolicyMgr *policy_mgr = server_.routing_policy_mgr();
+        task_util::TaskFire(boost::bind(&RoutingPolicyMgr::DeleteRoutingPolicy,
+            policy_mgr, config_.name()), "bgp::Config");
+        server_.Shutdown();
+        task_util::WaitForIdle();
+    }
+
+    static string CommunityString(int value) {
+        return "64512:" + lexical_cast<string>(value);
+    }
+
+    //
+    // Build a policy where most terms update the path and continue to the
+    // next term, so that each route gets evaluated against all the terms.
+    //
+    void BuildConfig() {
+        for (int idx = 0; idx < term_count_; ++idx) {
+            RoutingPolicyTermConfig term;
+            term.match.community_match_all = false;
+            term.action.action = RoutingPolicyActionConfig::NEXT_TERM;
+            term.action.update.local_pref = 0;
+            term.action.update.med = 0;
+
+            PrefixMatchConfig prefix;
+            if (idx == term_count_ - 1) {
+                term.action.action = RoutingPolicyActionConfig::ACCEPT;
+            } else if (idx % 5 == 0) {
+                prefix.prefix_to_match =
+                    "10." + lexical_cast<string>(idx % 16) + ".0.0/16";
+                prefix.prefix_match_type = "orlonger";
+                term.match.prefixes_to_match.push_back(prefix);
+                term.match.community_match.push_back("64512:1[0-9]");
+                term.action.update.local_pref = 100 + idx;
+            } else if (idx % 5 == 1) {
+                prefix.prefix_to_match = "10." +
+                    lexical_cast<string>(idx % 16) + "." +
+                    lexical_cast<string>(idx % 256) + ".0/24";
+                prefix.prefix_match_type = "exact";
+                term.match.prefixes_to_match.push_back(prefix);
+                term.action.update.med = idx;
+            } else if (idx % 5 == 2) {
+                term.match.community_match.push_back(
+                    CommunityString(idx % kAttrCount));
+                term.match.protocols_match.push_back("bgp");
+                term.action.update.local_pref = 100 + idx;
+            } else if (idx % 5 == 3) {
+                prefix.prefix_to_match = "10.0.0.0/8";
+                prefix.prefix_match_type = "longer";
+                term.match.prefixes_to_match.push_back(prefix);
+                term.match.community_match.push_back(
+                    CommunityString(idx % kAttrCount));
+                term.match.community_match.push_back("64512:1[0-9]");
+                term.match.community_match_all = true;
+                term.action.update.community_add.push_back(
+                    CommunityString(1000 + idx % 4));
+            } else {
+                term.match.protocols_match.push_back("xmpp");
+                term.action.action = RoutingPolicyActionConfig::REJECT;
+            }
+            config_.add_term(term);
+        }
+    }
+
+    void BuildRoutes() {
+        for (int idx = 0; idx < route_count_; ++idx) {
+            Ip4Prefix prefix(Ip4Address(0x0a000000 + ((idx << 4) & 0xffffff)),
+                28);
+            routes_.push_back(new InetRoute(prefix));
+        }
+    }
+
+    void BuildAttrs() {
+        for (int idx = 0; idx < kAttrCount; ++idx) {
+            BgpAttrSpec spec;
+            BgpAttrLocalPref local_pref(100);
+            spec.push_back(&local_pref);
+            CommunitySpec community;
+            community.communities.push_back(0xFC000000 + idx);
+            community.communities.push_back(0xFC000000 + 10 + idx % 10);
+            spec.push_back(&community);
+            attrs_.push_back(server_.attr_db()->Locate(spec));
+        }
+    }
+
+    const BgpAttr *GetAttr(int idx) const {
+        return attrs_[idx % kAttrCount].get();
+    }
+
+    void Verify() {
+        int count = std::min(route_count_, static_cast<int>(kVerifyCount));
+        for (int idx = 0; idx < count; ++idx) {
+            BgpPath path(NULL, BgpPath::BGP_XMPP, GetAttr(idx), 0, 0);
+            BgpAttr *compiled_attr = new BgpAttr(*GetAttr(idx));
+            BgpAttr *interpreted_attr = new BgpAttr(*GetAttr(idx));
+            RoutingPolicy::PolicyResult compiled_result =
+                (*policy_)(routes_[idx], &path, compiled_attr);
+            RoutingPolicy::PolicyResult interpreted_result =
+                policy_->ApplyTerms(routes_[idx], &path, interpreted_attr);
+            EXPECT_EQ(interpreted_result, compiled_result);
+            BgpAttrPtr compiled_ptr = server_.attr_db()->Locate(compiled_attr);
+            BgpAttrPtr interpreted_ptr =
+                server_.attr_db()->Locate(interpreted_attr);
+            EXPECT_EQ(interpreted_ptr, compiled_ptr);
+        }
+    }
+
+    void Run(const string &mode, bool compiled) {
+        int accepted = 0;
+        uint64_t start = ClockMonotonicUsec();
+        for (int idx = 0; idx < route_count_; ++idx) {
+            BgpPath path(NULL, BgpPath::BGP_XMPP, GetAttr(idx), 0, 0);
+            BgpAttr out_attr(*GetAttr(idx));
+            RoutingPolicy::PolicyResult result = compiled ?
+                (*policy_)(routes_[idx], &path, &out_attr) :
+                policy_->ApplyTerms(routes_[idx], &path, &out_attr);
+            if (result.second)
+                accepted++;
+        }
+        Report(mode, accepted, ClockMonotonicUsec() - start);
+    }
+
+    void Report(const string &mode, int accepted, uint64_t elapsed) {
+        cout << "Terms " << term_count_
+             << " Routes " << route_count_
+             << " Mode " << mode
+             << " Accepted " << accepted
+             << " Elapsed(usec) " << elapsed
+             << " Routes/sec "
+             << (elapsed ? route_count_ * 1000000ULL / elapsed : 0)
+             << endl;
+    }
+
+    EventManager evm_;
+    BgpServer server_;
+    BgpRoutingPolicyConfig config_;
+    RoutingPolicy *policy_;
+    vector<InetRoute *> routes_;
+    vector<BgpAttrPtr> attrs_;
+    int route_count_;
+    int term_count_;
+};
+
+TEST_F(RoutingPolicyPerfTest, Basic) {
+    ASSERT_TRUE(policy_ != NULL);
+    ASSERT_TRUE(policy_->program() != NULL);
+    EXPECT_EQ(static_cast<size_t>(term_count_),
+              policy_->program()->term_count());
+    Verify();
+    Run("Compiled", true);
+    Run("Interpreted", false);
+    EXPECT_GE(RoutingPolicyProgram::kMaxCommunityCacheSize,
+              policy_->program()->community_cache_size());
+}
+
+static void SetUp() {
+    bgp_log_test::init();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
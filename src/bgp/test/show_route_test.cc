@@ -8,6 +8,7 @@
 
 #include "bgp/bgp_config_parser.h"
 #include "bgp/bgp_factory.h"
+#include "bgp/bgp_peer_internal_types.h"
 #include "bgp/bgp_sandesh.h"
 #include "bgp/bgp_session_manager.h"
 #include "bgp/bgp_show_route.h"
@@ -361,6 +362,21 @@ protected:
         validate_done_ = true;
     }
 
+    static void ValidateShowRouteStreamResponse(Sandesh *sandesh,
+        set<string> *prefixes, string *next_batch) {
+        ShowRouteStreamResp *resp =
+            dynamic_cast<ShowRouteStreamResp *>(sandesh);
+        EXPECT_NE((ShowRouteStreamResp *)NULL, resp);
+
+        BOOST_FOREACH(const ShowRoute &show_route, resp->get_routes()) {
+            EXPECT_TRUE(prefixes->insert(show_route.prefix).second);
+        }
+        if (resp->get_more())
+            return;
+        *next_batch = resp->get_next_batch();
+        validate_done_ = true;
+    }
+
     static void ValidateShowRouteSandeshRespSubstr(Sandesh *sandesh,
         vector<int> &result, int called_from_line, string substring) {
         ShowRouteResp *resp = dynamic_cast<ShowRouteResp *>(sandesh);
@@ -2442,6 +2458,104 @@ TEST_F(ShowRouteTest3, SimulateClickingNextBatch) {
     }
 }
 
+//
+// Walk a table with the streaming show, resuming with the token until the
+// walk is done. Each route should be seen exactly once and the cursor should
+// get removed at the end.
+//
+TEST_F(ShowRouteTest3, Stream1) {
+    std::string plen = "/32";
+    in_addr src;
+    int ip1 = 0x01020000;
+    for (int i = 0; i < 400; ++i) {
+        src.s_addr = htonl(ip1 | i);
+        string ip = string(inet_ntoa(src)) + plen;
+        AddInetRoute(ip, peers_[0], "red");
+    }
+
+    set<string> prefixes;
+    string next_batch;
+    ShowRouteStreamReq *show_req = new ShowRouteStreamReq;
+    show_req->set_routing_table("red.inet.0");
+    show_req->set_count(100);
+    Sandesh::set_response_callback(boost::bind(
+        ValidateShowRouteStreamResponse, _1, &prefixes, &next_batch));
+    validate_done_ = false;
+    show_req->HandleRequest();
+    show_req->Release();
+    TASK_UTIL_EXPECT_EQ(true, validate_done_);
+    EXPECT_FALSE(next_batch.empty());
+    EXPECT_LE(100, prefixes.size());
+
+    string token = next_batch;
+    int batches = 1;
+    while (!next_batch.empty()) {
+        EXPECT_EQ(token, next_batch);
+        EXPECT_EQ(1, sandesh_context.show_route_cursor_mgr()->size());
+        ShowRouteStreamReqIterate *show_req_iterate =
+            new ShowRouteStreamReqIterate;
+        show_req_iterate->set_route_info(next_batch);
+        next_batch.clear();
+        validate_done_ = false;
+        show_req_iterate->HandleRequest();
+        show_req_iterate->Release();
+        TASK_UTIL_EXPECT_EQ(true, validate_done_);
+        batches++;
+    }
+    EXPECT_EQ(400, prefixes.size());
+    EXPECT_LE(4, batches);
+    EXPECT_EQ(0, sandesh_context.show_route_cursor_mgr()->size());
+
+    for (int i = 399; i >= 0; --i) {
+        src.s_addr = htonl(ip1 | i);
+        string ip = string(inet_ntoa(src)) + plen;
+        DeleteInetRoute(ip, peers_[0], i, "red");
+    }
+}
+
+//
+// A token for a cursor that doesn't exist, or a table that doesn't exist,
+// should return an empty response without a next_batch.
+//
+TEST_F(ShowRouteTest3, Stream2) {
+    AddInetRoute("10.1.1.0/24", peers_[0], "red");
+
+    set<string> prefixes;
+    string next_batch;
+    ShowRouteStreamReqIterate *show_req_iterate =
+        new ShowRouteStreamReqIterate;
+    show_req_iterate->set_route_info("12345");
+    Sandesh::set_response_callback(boost::bind(
+        ValidateShowRouteStreamResponse, _1, &prefixes, &next_batch));
+    validate_done_ = false;
+    show_req_iterate->HandleRequest();
+    show_req_iterate->Release();
+    TASK_UTIL_EXPECT_EQ(true, validate_done_);
+    EXPECT_TRUE(next_batch.empty());
+    EXPECT_TRUE(prefixes.empty());
+
+    ShowRouteStreamReq *show_req = new ShowRouteStreamReq;
+    show_req->set_routing_table("green.inet.0");
+    validate_done_ = false;
+    show_req->HandleRequest();
+    show_req->Release();
+    TASK_UTIL_EXPECT_EQ(true, validate_done_);
+    EXPECT_TRUE(next_batch.empty());
+    EXPECT_TRUE(prefixes.empty());
+
+    show_req = new ShowRouteStreamReq;
+    show_req->set_routing_table("red.inet.0");
+    validate_done_ = false;
+    show_req->HandleRequest();
+    show_req->Release();
+    TASK_UTIL_EXPECT_EQ(true, validate_done_);
+    EXPECT_TRUE(next_batch.empty());
+    EXPECT_EQ(1, prefixes.size());
+    EXPECT_EQ(0, sandesh_context.show_route_cursor_mgr()->size());
+
+    DeleteInetRoute("10.1.1.0/24", peers_[0], 0, "red");
+}
+
 class ShowRouteVrfTest : public ShowRouteTest2 {
 };
 
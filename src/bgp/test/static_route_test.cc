@@ -271,6 +271,19 @@ protected:
         rtinstance->static_route_mgr(family_)->EnableQueue();
     }
 
+    size_t GetQueueLength(const string &instance_name) {
+        RoutingInstance *rtinstance =
+            ri_mgr_->GetRoutingInstance(instance_name);
+        return rtinstance->static_route_mgr(family_)->GetQueueLength();
+    }
+
+    const ConditionMatchQueueStats &GetQueueStats(
+        const string &instance_name) {
+        RoutingInstance *rtinstance =
+            ri_mgr_->GetRoutingInstance(instance_name);
+        return rtinstance->static_route_mgr(family_)->queue_stats();
+    }
+
     void AddRoute(IPeer *peer, const string &instance_name,
         const string &prefix, int localpref, string nexthop_str = "",
         set<string> encap = set<string>(),
@@ -1874,6 +1887,54 @@ TYPED_TEST(StaticRouteTest, DeleteEntryReuse) {
     this->VerifyRouteNoExists("blue", this->BuildPrefix("192.168.1.0", 24));
 }
 
+//
+// Changes to the nexthop route while an add/change request for it is in the
+// queue get coalesced into the queued request. The static route should get
+// the attributes of the latest nexthop route when the queue is enabled.
+//
+TYPED_TEST(StaticRouteTest, CoalesceNexthopChanges) {
+    vector<string> instance_names = list_of("blue")("nat");
+    this->NetworkConfig(instance_names);
+
+    this->SetStaticRouteEntries("nat",
+        "controller/src/bgp/testdata/static_route_1.xml");
+
+    // Add Nexthop Route
+    this->AddRoute(NULL, "nat", this->BuildPrefix("192.168.1.254", 32), 100,
+        this->BuildNextHopAddress("2.3.4.5"));
+    this->VerifyRouteExists("blue", this->BuildPrefix("192.168.1.0", 24));
+    TASK_UTIL_EXPECT_TRUE(this->IsQueueEmpty("nat"));
+
+    const ConditionMatchQueueStats &stats = this->GetQueueStats("nat");
+    uint64_t enqueued = stats.enqueued();
+    uint64_t coalesced = stats.coalesced();
+    uint64_t processed = stats.processed();
+
+    this->DisableStaticRouteQ("nat");
+
+    // Update nexthop route a few times
+    this->AddRoute(NULL, "nat", this->BuildPrefix("192.168.1.254", 32), 100,
+        this->BuildNextHopAddress("2.3.4.6"));
+    this->AddRoute(NULL, "nat", this->BuildPrefix("192.168.1.254", 32), 100,
+        this->BuildNextHopAddress("2.3.4.7"));
+    this->AddRoute(NULL, "nat", this->BuildPrefix("192.168.1.254", 32), 100,
+        this->BuildNextHopAddress("2.3.4.8"));
+
+    TASK_UTIL_EXPECT_EQ(coalesced + 2, stats.coalesced());
+    TASK_UTIL_EXPECT_EQ(enqueued + 1, stats.enqueued());
+    TASK_UTIL_EXPECT_EQ(1, this->GetQueueLength("nat"));
+
+    this->EnableStaticRouteQ("nat");
+    TASK_UTIL_EXPECT_TRUE(this->IsQueueEmpty("nat"));
+    TASK_UTIL_EXPECT_EQ(processed + 1, stats.processed());
+
+    this->VerifyPathAttributes("blue", this->BuildPrefix("192.168.1.0", 24),
+        this->BuildNextHopAddress("2.3.4.8"), "blue");
+
+    this->DeleteRoute(NULL, "nat", this->BuildPrefix("192.168.1.254", 32));
+    this->VerifyRouteNoExists("blue", this->BuildPrefix("192.168.1.0", 24));
+}
+
 TYPED_TEST(StaticRouteTest, EntryAfterStop) {
     vector<string> instance_names = list_of("blue")("nat");
     this->NetworkConfig(instance_names);
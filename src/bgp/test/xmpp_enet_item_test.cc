@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <pugixml/pugixml.hpp>
+
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_log.h"
+#include "bgp/xmpp_enet_item.h"
+#include "bgp/test/xmpp_item_test.h"
+#include "control-node/control_node.h"
+
+using pugi::xml_document;
+using pugi::xml_node;
+using std::string;
+
+class XmppEnetItemTest : public XmppItemTestBase {
+protected:
+    //
+    // Verify that the decoder produces the same values as the autogen parser
+    // for the item in the document.
+    //
+    static void VerifyItem(const xml_document &doc) {
+        xml_node node = doc.child("item");
+        autogen::EnetItemType expected;
+        expected.Clear();
+        EXPECT_TRUE(expected.XmlParse(node));
+        XmppEnetItem item;
+        EXPECT_TRUE(item.Decode(node));
+
+        EXPECT_EQ(expected.entry.nlri.af, item.af());
+        EXPECT_EQ(expected.entry.nlri.safi, item.safi());
+        EXPECT_EQ(expected.entry.nlri.ethernet_tag, item.ethernet_tag());
+        EXPECT_EQ(expected.entry.nlri.mac, string(item.mac()));
+        EXPECT_EQ(expected.entry.nlri.address, string(item.address()));
+        EXPECT_EQ(expected.entry.next_hops.next_hop.size(),
+                  item.next_hop_count());
+        EXPECT_EQ(expected.entry.local_preference, item.local_preference());
+        EXPECT_EQ(expected.entry.med, item.med());
+        EXPECT_EQ(expected.entry.sequence_number, item.sequence_number());
+        EXPECT_EQ(expected.entry.mobility.seqno, item.mobility_seqno());
+        EXPECT_EQ(expected.entry.mobility.sticky, item.mobility_sticky());
+        EXPECT_TRUE(expected.entry.security_group_list.security_group ==
+            std::vector<int>(item.security_groups().begin(),
+                             item.security_groups().end()));
+        EXPECT_EQ(expected.entry.edge_replication_not_supported,
+                  item.edge_replication_not_supported());
+        EXPECT_EQ(expected.entry.assisted_replication_supported,
+                  item.assisted_replication_supported());
+        EXPECT_EQ(expected.entry.replicator_address,
+                  string(item.replicator_address()));
+        EXPECT_EQ(expected.entry.etree_leaf, item.etree_leaf());
+
+        if (expected.entry.next_hops.next_hop.empty())
+            return;
+        const autogen::EnetNextHopType &enh =
+            expected.entry.next_hops.next_hop[0];
+        const XmppEnetItem::NextHop &nh = item.next_hop();
+        EXPECT_EQ(enh.af, nh.af);
+        EXPECT_EQ(enh.address, string(nh.address_str));
+        EXPECT_TRUE(nh.address_valid);
+        EXPECT_EQ(enh.address, nh.address.to_string());
+        EXPECT_EQ(enh.mac, string(nh.mac));
+        EXPECT_EQ(enh.label, nh.label);
+        EXPECT_EQ(enh.l3_label, nh.l3_label);
+        EXPECT_EQ(enh.tunnel_encapsulation_list.tunnel_encapsulation.size(),
+                  nh.tunnel_encaps.size());
+        for (size_t idx = 0; idx < nh.tunnel_encaps.size(); ++idx) {
+            EXPECT_EQ(TunnelEncapType::TunnelEncapFromString(
+                enh.tunnel_encapsulation_list.tunnel_encapsulation[idx]),
+                nh.tunnel_encaps[idx]);
+        }
+        EXPECT_TRUE(enh.tag_list.tag ==
+            std::vector<int>(nh.tags.begin(), nh.tags.end()));
+    }
+
+    bool Decode(const string &data) {
+        xml_document doc;
+        EXPECT_TRUE(doc.load(data.c_str()));
+        XmppEnetItem item;
+        return item.Decode(doc.child("item"));
+    }
+};
+
+TEST_F(XmppEnetItemTest, Inet) {
+    xml_document doc;
+    for (int idx = 0; idx < 16; ++idx) {
+        autogen::EnetItemType item;
+        BuildItem(&item, BgpAf::IPv4, idx);
+        EncodeItem(item, &doc);
+        VerifyItem(doc);
+    }
+}
+
+TEST_F(XmppEnetItemTest, Inet6) {
+    xml_document doc;
+    for (int idx = 0; idx < 16; ++idx) {
+        autogen::EnetItemType item;
+        BuildItem(&item, BgpAf::IPv6, idx);
+        EncodeItem(item, &doc);
+        VerifyItem(doc);
+    }
+}
+
+TEST_F(XmppEnetItemTest, NoNextHops) {
+    xml_document doc;
+    autogen::EnetItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+    item.entry.next_hops.next_hop.clear();
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+}
+
+TEST_F(XmppEnetItemTest, MultipleNextHops) {
+    xml_document doc;
+    autogen::EnetItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+    item.entry.next_hops.next_hop.push_back(
+        item.entry.next_hops.next_hop.front());
+    item.entry.next_hops.next_hop.back().address = "junk";
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+}
+
+TEST_F(XmppEnetItemTest, Replication) {
+    xml_document doc;
+    autogen::EnetItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+    item.entry.nlri.mac = "ff:ff:ff:ff:ff:ff";
+    item.entry.nlri.address = "0.0.0.0/32";
+    item.entry.edge_replication_not_supported = true;
+    item.entry.assisted_replication_supported = true;
+    item.entry.replicator_address = "192.168.1.100";
+    item.entry.olist.next_hop.push_back(
+        item.entry.next_hops.next_hop.front());
+    item.entry.leaf_olist.next_hop.push_back(
+        item.entry.next_hops.next_hop.front());
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+}
+
+TEST_F(XmppEnetItemTest, Boolean) {
+    xml_document doc;
+    autogen::EnetItemType item;
+    BuildItem(&item, BgpAf::IPv4, 0);
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+
+    // Anything other than "true" is false.
+    xml_node entry = doc.child("item").child("entry");
+    entry.child("etree-leaf").text().set("True");
+    XmppEnetItem decoded_item;
+    EXPECT_TRUE(decoded_item.Decode(doc.child("item")));
+    EXPECT_FALSE(decoded_item.etree_leaf());
+    VerifyItem(doc);
+}
+
+TEST_F(XmppEnetItemTest, BadInteger) {
+    EXPECT_TRUE(Decode("<item><entry><nlri><af>25</af></nlri></entry></item>"));
+    EXPECT_TRUE(Decode(
+        "<item><entry><nlri><af>25 </af></nlri></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><nlri><af>some_junk</af></nlri></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><nlri><ethernet-tag>x</ethernet-tag></nlri>"
+        "</entry></item>"));
+    EXPECT_FALSE(Decode("<item><entry><med>1x</med></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><local-preference>x</local-preference></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><sequence-number>x</sequence-number></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><mobility seqno=\"x\"/></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><security-group-list><security-group>x"
+        "</security-group></security-group-list></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><next-hops><next-hop><label>x</label>"
+        "</next-hop></next-hops></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><next-hops><next-hop><l3-label>x</l3-label>"
+        "</next-hop></next-hops></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><next-hops><next-hop><tag-list><tag>x</tag>"
+        "</tag-list></next-hop></next-hops></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><olist><next-hop><label>x</label>"
+        "</next-hop></olist></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><leaf-olist><next-hop><label>x</label>"
+        "</next-hop></leaf-olist></entry></item>"));
+}
+
+TEST_F(XmppEnetItemTest, BadNextHopAddress) {
+    xml_document doc;
+    autogen::EnetItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+
+    item.entry.next_hops.next_hop[0].address = "192.168.1.1.1";
+    EncodeItem(item, &doc);
+    XmppEnetItem decoded_item;
+    EXPECT_TRUE(decoded_item.Decode(doc.child("item")));
+    EXPECT_FALSE(decoded_item.next_hop().address_valid);
+
+    item.entry.next_hops.next_hop[0].address = "0.0.0.0";
+    EncodeItem(item, &doc);
+    EXPECT_TRUE(decoded_item.Decode(doc.child("item")));
+    EXPECT_FALSE(decoded_item.next_hop().address_valid);
+
+    item.entry.next_hops.next_hop[0].address = "192.168.1.1";
+    item.entry.next_hops.next_hop[0].af = BgpAf::L2Vpn;
+    EncodeItem(item, &doc);
+    EXPECT_TRUE(decoded_item.Decode(doc.child("item")));
+    EXPECT_FALSE(decoded_item.next_hop().address_valid);
+}
+
+static void SetUp() {
+    bgp_log_test::init();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
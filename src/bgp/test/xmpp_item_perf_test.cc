@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <boost/scoped_array.hpp>
+#include <pugixml/pugixml.hpp>
+
+#include <iostream>
+
+#include "base/time_util.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_log.h"
+#include "bgp/xmpp_enet_item.h"
+#include "bgp/xmpp_mcast_item.h"
+#include "bgp/xmpp_unicast_item.h"
+#include "bgp/test/xmpp_item_test.h"
+#include "control-node/control_node.h"
+
+using pugi::xml_document;
+using pugi::xml_node;
+using std::cout;
+using std::endl;
+
+//
+// Count allocations made via operator new so that the benchmark can report
+// allocations per item.
+//
+static uint64_t allocation_count;
+
+void *operator new(size_t size) {
+    __sync_fetch_and_add(&allocation_count, 1);
+    void *ptr = malloc(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) throw() {
+    free(ptr);
+}
+
+//
+// Compare decode throughput of the autogen XmlParse methods with that of the
+// XmppUnicastItem, XmppEnetItem and XmppMcastItem decoders for the route
+// publish items of each family.
+//
+// Set DECODE_COUNT to change the number of items decoded in each test.
+//
+class XmppItemPerfTest : public XmppItemTestBase {
+protected:
+    XmppItemPerfTest() : decode_count_(16 * 1024) {
+    }
+
+    virtual void SetUp() {
+        char *str = getenv("DECODE_COUNT");
+        if (str)
+            decode_count_ = strtoul(str, NULL, 0);
+    }
+
+    template <typename AutogenItemT, typename ItemT>
+    void RunBenchmark(const char *name, int af, bool use_decoder) {
+        static const int kItemCount = 1024;
+        boost::scoped_array<xml_document> docs(new xml_document[kItemCount]);
+        for (int idx = 0; idx < kItemCount; ++idx) {
+            AutogenItemT item;
+            BuildItem(&item, af, idx);
+            EncodeItem(item, &docs[idx]);
+        }
+
+        uint64_t start_allocations = allocation_count;
+        uint64_t start = ClockMonotonicUsec();
+        for (int count = 0; count < decode_count_; ++count) {
+            xml_node node = docs[count % kItemCount].child("item");
+            if (use_decoder) {
+                ItemT item;
+                EXPECT_TRUE(item.Decode(node));
+            } else {
+                AutogenItemT item;
+                item.Clear();
+                EXPECT_TRUE(item.XmlParse(node));
+            }
+        }
+        uint64_t elapsed = ClockMonotonicUsec() - start;
+        uint64_t allocations = allocation_count - start_allocations;
+
+        cout << name
+             << " Items " << decode_count_
+             << " Elapsed(usec) " << elapsed
+             << " Items/sec "
+             << (elapsed ? decode_count_ * 1000000ULL / elapsed : 0)
+             << " Allocations/item "
+             << (decode_count_ ? allocations / decode_count_ : 0)
+             << endl;
+    }
+
+    int decode_count_;
+};
+
+TEST_F(XmppItemPerfTest, InetAutogen) {
+    RunBenchmark<autogen::ItemType, XmppUnicastItem>(
+        "InetAutogen", BgpAf::IPv4, false);
+}
+
+TEST_F(XmppItemPerfTest, InetDecoder) {
+    RunBenchmark<autogen::ItemType, XmppUnicastItem>(
+        "InetDecoder", BgpAf::IPv4, true);
+}
+
+TEST_F(XmppItemPerfTest, Inet6Autogen) {
+    RunBenchmark<autogen::ItemType, XmppUnicastItem>(
+        "Inet6Autogen", BgpAf::IPv6, false);
+}
+
+TEST_F(XmppItemPerfTest, Inet6Decoder) {
+    RunBenchmark<autogen::ItemType, XmppUnicastItem>(
+        "Inet6Decoder", BgpAf::IPv6, true);
+}
+
+TEST_F(XmppItemPerfTest, EnetAutogen) {
+    RunBenchmark<autogen::EnetItemType, XmppEnetItem>(
+        "EnetAutogen", BgpAf::IPv4, false);
+}
+
+TEST_F(XmppItemPerfTest, EnetDecoder) {
+    RunBenchmark<autogen::EnetItemType, XmppEnetItem>(
+        "EnetDecoder", BgpAf::IPv4, true);
+}
+
+TEST_F(XmppItemPerfTest, McastAutogen) {
+    RunBenchmark<autogen::McastItemType, XmppMcastItem>(
+        "McastAutogen", BgpAf::IPv4, false);
+}
+
+TEST_F(XmppItemPerfTest, McastDecoder) {
+    RunBenchmark<autogen::McastItemType, XmppMcastItem>(
+        "McastDecoder", BgpAf::IPv4, true);
+}
+
+static void SetUp() {
+    bgp_log_test::init();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_TEST_XMPP_ITEM_TEST_H_
+#define SRC_BGP_TEST_XMPP_ITEM_TEST_H_
+
+#include <pugixml/pugixml.hpp>
+#include <stdio.h>
+
+#include <string>
+
+#include "base/string_util.h"
+#include "net/bgp_af.h"
+#include "schema/xmpp_enet_types.h"
+#include "schema/xmpp_multicast_types.h"
+#include "schema/xmpp_unicast_types.h"
+#include "testing/gunit.h"
+
+class XmppItemTestBase : public ::testing::Test {
+protected:
+    //
+    // Build an item that looks like what agents publish for a vm interface
+    // route, with all commonly used fields.
+    //
+    static void BuildItem(autogen::ItemType *item, int af, int idx) {
+        item->Clear();
+        item->entry.nlri.af = af;
+        item->entry.nlri.safi = BgpAf::Unicast;
+        if (af == BgpAf::IPv4) {
+            item->entry.nlri.address = "10.1." + integerToString(idx / 256) +
+                "." + integerToString(idx % 256) + "/32";
+        } else {
+            item->entry.nlri.address = "2001:db8::" +
+                integerToString(idx % 10000) + "/128";
+        }
+        autogen::NextHopType nexthop;
+        nexthop.af = BgpAf::IPv4;
+        nexthop.address = "192.168.1." + integerToString(idx % 250 + 1);
+        nexthop.label = 16 + idx;
+        nexthop.tunnel_encapsulation_list.tunnel_encapsulation.push_back("gre");
+        nexthop.tunnel_encapsulation_list.tunnel_encapsulation.push_back("udp");
+        nexthop.tag_list.tag.push_back(1);
+        nexthop.tag_list.tag.push_back(0x20000 + idx);
+        item->entry.next_hops.next_hop.push_back(nexthop);
+        item->entry.virtual_network = "default-domain:admin:blue";
+        item->entry.version = 1;
+        item->entry.mobility.seqno = idx + 1;
+        item->entry.mobility.sticky = (idx % 2 == 0);
+        item->entry.security_group_list.security_group.push_back(8000001);
+        item->entry.security_group_list.security_group.push_back(8000002);
+        item->entry.community_tag_list.community_tag.push_back(
+            "no-reoriginate");
+        item->entry.local_preference = 200;
+    }
+
+    //
+    // Build an item that looks like what agents publish for a vm interface
+    // mac route. The af determines the family of the ip address in the nlri.
+    //
+    static void BuildItem(autogen::EnetItemType *item, int af, int idx) {
+        item->Clear();
+        item->entry.nlri.af = BgpAf::L2Vpn;
+        item->entry.nlri.safi = BgpAf::Enet;
+        item->entry.nlri.ethernet_tag = idx % 4;
+        item->entry.nlri.mac = "00:01:02:03:" + BuildHexByte(idx / 256) +
+            ":" + BuildHexByte(idx % 256);
+        if (af == BgpAf::IPv4) {
+            item->entry.nlri.address = "10.1." + integerToString(idx / 256) +
+                "." + integerToString(idx % 256) + "/32";
+        } else {
+            item->entry.nlri.address = "2001:db8::" +
+                integerToString(idx % 10000) + "/128";
+        }
+        autogen::EnetNextHopType nexthop;
+        nexthop.af = BgpAf::IPv4;
+        nexthop.address = "192.168.1." + integerToString(idx % 250 + 1);
+        nexthop.mac = "00:0a:0b:0c:0d:0e";
+        nexthop.label = 16 + idx;
+        nexthop.l3_label = 32 + idx;
+        nexthop.tunnel_encapsulation_list.tunnel_encapsulation.push_back("gre");
+        nexthop.tunnel_encapsulation_list.tunnel_encapsulation.push_back(
+            "vxlan");
+        nexthop.tag_list.tag.push_back(1);
+        nexthop.tag_list.tag.push_back(0x20000 + idx);
+        item->entry.next_hops.next_hop.push_back(nexthop);
+        item->entry.virtual_network = "default-domain:admin:blue";
+        item->entry.mobility.seqno = idx + 1;
+        item->entry.mobility.sticky = (idx % 2 == 0);
+        item->entry.security_group_list.security_group.push_back(8000001);
+        item->entry.security_group_list.security_group.push_back(8000002);
+        item->entry.local_preference = 200;
+        item->entry.etree_leaf = (idx % 3 == 0);
+    }
+
+    //
+    // Build an item that looks like what agents publish for a multicast
+    // route. Only IPv4 is supported, the af is set in the nlri as given.
+    //
+    static void BuildItem(autogen::McastItemType *item, int af, int idx) {
+        item->Clear();
+        item->entry.nlri.af = af;
+        item->entry.nlri.safi = BgpAf::Mcast;
+        item->entry.nlri.group = "224.1." + integerToString(idx / 256) +
+            "." + integerToString(idx % 256);
+        item->entry.nlri.source = "0.0.0.0";
+        autogen::McastNextHopType nexthop;
+        nexthop.af = BgpAf::IPv4;
+        nexthop.address = "192.168.1." + integerToString(idx % 250 + 1);
+        nexthop.label = integerToString(10000 + idx) + "-" +
+            integerToString(10999 + idx);
+        nexthop.tunnel_encapsulation_list.tunnel_encapsulation.push_back("gre");
+        nexthop.tunnel_encapsulation_list.tunnel_encapsulation.push_back("udp");
+        item->entry.next_hops.next_hop.push_back(nexthop);
+    }
+
+    template <typename ItemT>
+    static void EncodeItem(const ItemT &item, pugi::xml_document *doc) {
+        doc->reset();
+        pugi::xml_node node = doc->append_child("item");
+        item.Encode(&node);
+    }
+
+private:
+    static std::string BuildHexByte(int value) {
+        char buf[4];
+        snprintf(buf, sizeof(buf), "%02x", value & 0xff);
+        return buf;
+    }
+};
+
+#endif  // SRC_BGP_TEST_XMPP_ITEM_TEST_H_
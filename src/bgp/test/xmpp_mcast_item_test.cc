@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <pugixml/pugixml.hpp>
+
+#include <string>
+
+#include "base/logging.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_log.h"
+#include "bgp/xmpp_mcast_item.h"
+#include "bgp/test/xmpp_item_test.h"
+#include "control-node/control_node.h"
+
+using pugi::xml_document;
+using pugi::xml_node;
+using std::string;
+
+class XmppMcastItemTest : public XmppItemTestBase {
+protected:
+    //
+    // Verify that the decoder produces the same values as the autogen parser
+    // for the item in the document.
+    //
+    static void VerifyItem(const xml_document &doc) {
+        xml_node node = doc.child("item");
+        autogen::McastItemType expected;
+        expected.Clear();
+        EXPECT_TRUE(expected.XmlParse(node));
+        XmppMcastItem item;
+        EXPECT_TRUE(item.Decode(node));
+
+        EXPECT_EQ(expected.entry.nlri.af, item.af());
+        EXPECT_EQ(expected.entry.nlri.safi, item.safi());
+        EXPECT_EQ(expected.entry.nlri.group, string(item.group()));
+        EXPECT_EQ(expected.entry.nlri.source, string(item.source()));
+        EXPECT_EQ(expected.entry.next_hops.next_hop.size(),
+                  item.next_hop_count());
+
+        if (expected.entry.next_hops.next_hop.empty())
+            return;
+        const autogen::McastNextHopType &enh =
+            expected.entry.next_hops.next_hop[0];
+        const XmppMcastItem::NextHop &nh = item.next_hop();
+        EXPECT_EQ(enh.af, nh.af);
+        EXPECT_EQ(enh.address, string(nh.address_str));
+        EXPECT_TRUE(nh.address_valid);
+        EXPECT_EQ(enh.address, nh.address.to_string());
+        EXPECT_EQ(enh.label, string(nh.label));
+        EXPECT_EQ(enh.tunnel_encapsulation_list.tunnel_encapsulation.size(),
+                  nh.tunnel_encaps.size());
+        for (size_t idx = 0; idx < nh.tunnel_encaps.size(); ++idx) {
+            EXPECT_EQ(TunnelEncapType::TunnelEncapFromString(
+                enh.tunnel_encapsulation_list.tunnel_encapsulation[idx]),
+                nh.tunnel_encaps[idx]);
+        }
+    }
+
+    bool Decode(const string &data) {
+        xml_document doc;
+        EXPECT_TRUE(doc.load(data.c_str()));
+        XmppMcastItem item;
+        return item.Decode(doc.child("item"));
+    }
+};
+
+TEST_F(XmppMcastItemTest, Basic) {
+    xml_document doc;
+    for (int idx = 0; idx < 16; ++idx) {
+        autogen::McastItemType item;
+        BuildItem(&item, BgpAf::IPv4, idx);
+        EncodeItem(item, &doc);
+        VerifyItem(doc);
+    }
+}
+
+TEST_F(XmppMcastItemTest, NoNextHops) {
+    xml_document doc;
+    autogen::McastItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+    item.entry.next_hops.next_hop.clear();
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+}
+
+TEST_F(XmppMcastItemTest, MultipleNextHops) {
+    xml_document doc;
+    autogen::McastItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+    item.entry.next_hops.next_hop.push_back(
+        item.entry.next_hops.next_hop.front());
+    item.entry.next_hops.next_hop.back().address = "junk";
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+}
+
+TEST_F(XmppMcastItemTest, Olist) {
+    xml_document doc;
+    autogen::McastItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+    item.entry.olist.next_hop.push_back(
+        item.entry.next_hops.next_hop.front());
+    item.entry.olist.next_hop.back().address = "junk";
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+}
+
+TEST_F(XmppMcastItemTest, BadInteger) {
+    EXPECT_TRUE(Decode("<item><entry><nlri><af>1</af></nlri></entry></item>"));
+    EXPECT_TRUE(Decode("<item><entry><nlri><af>1 </af></nlri></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><nlri><af>some_junk</af></nlri></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><nlri><safi>x</safi></nlri></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><nlri><source-label>x</source-label></nlri>"
+        "</entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><next-hops><next-hop><af>x</af>"
+        "</next-hop></next-hops></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><olist><next-hop><af>x</af>"
+        "</next-hop></olist></entry></item>"));
+
+    // The label is a range, not an integer.
+    EXPECT_TRUE(Decode(
+        "<item><entry><next-hops><next-hop><label>10000-20000</label>"
+        "</next-hop></next-hops></entry></item>"));
+}
+
+TEST_F(XmppMcastItemTest, BadNextHopAddress) {
+    xml_document doc;
+    autogen::McastItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+
+    item.entry.next_hops.next_hop[0].address = "192.168.1.1.1";
+    EncodeItem(item, &doc);
+    XmppMcastItem decoded_item;
+    EXPECT_TRUE(decoded_item.Decode(doc.child("item")));
+    EXPECT_FALSE(decoded_item.next_hop().address_valid);
+
+    item.entry.next_hops.next_hop[0].address = "0.0.0.0";
+    EncodeItem(item, &doc);
+    EXPECT_TRUE(decoded_item.Decode(doc.child("item")));
+    EXPECT_FALSE(decoded_item.next_hop().address_valid);
+
+    item.entry.next_hops.next_hop[0].address = "192.168.1.1";
+    item.entry.next_hops.next_hop[0].af = BgpAf::L2Vpn;
+    EncodeItem(item, &doc);
+    EXPECT_TRUE(decoded_item.Decode(doc.child("item")));
+    EXPECT_FALSE(decoded_item.next_hop().address_valid);
+}
+
+static void SetUp() {
+    bgp_log_test::init();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <boost/scoped_ptr.hpp>
+
+#include <iostream>
+
+#include "base/time_util.h"
+#include "bgp/bgp_factory.h"
+#include "bgp/test/xmpp_message_builder_test.h"
+#include "control-node/control_node.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+
+//
+// Count allocations made via operator new so that the benchmark can report
+// allocations per message.
+//
+static uint64_t allocation_count;
+
+void *operator new(size_t size) {
+    __sync_fetch_and_add(&allocation_count, 1);
+    void *ptr = malloc(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) throw() {
+    free(ptr);
+}
+
+//
+// Report messages/sec and allocations/message for the stream and pugixml
+// encodings of route items.
+//
+// Set REPEAT_COUNT to change the number of messages built for each encoding.
+//
+class XmppMessageEncodingPerfTest : public XmppMessageEncodingTest {
+protected:
+    XmppMessageEncodingPerfTest() : repeat_count_(1024) {
+    }
+
+    virtual void SetUp() {
+        char *str = getenv("REPEAT_COUNT");
+        if (str)
+            repeat_count_ = strtoul(str, NULL, 0);
+        XmppMessageEncodingTest::SetUp();
+    }
+
+    void RunBenchmark(bool stream_encoding) {
+        boost::scoped_ptr<Message> message(CreateMessage(stream_encoding));
+        XmppTestPeer peer("agent.juniper.net");
+
+        uint64_t allocations = allocation_count;
+        uint64_t start = ClockMonotonicUsec();
+        for (int idx = 0; idx < repeat_count_; ++idx) {
+            BuildMessage(message.get());
+            size_t msgsize;
+            const string *msg_str = NULL;
+            const uint8_t *msg =
+                message->GetData(&peer, &msgsize, &msg_str);
+            peer.SendUpdate(msg, msgsize, msg_str);
+        }
+        uint64_t elapsed = ClockMonotonicUsec() - start;
+        allocations = allocation_count - allocations;
+
+        cout << "Family " << Address::FamilyToString(family_)
+             << " Encoding " << (stream_encoding ? "Stream" : "Pugixml")
+             << " Messages " << repeat_count_
+             << " Elapsed(usec) " << elapsed
+             << " Messages/sec "
+             << (elapsed ? repeat_count_ * 1000000ULL / elapsed : 0)
+             << " Allocations/message "
+             << (repeat_count_ ? allocations / repeat_count_ : 0)
+             << endl;
+    }
+
+    int repeat_count_;
+};
+
+TEST_P(XmppMessageEncodingPerfTest, Benchmark) {
+    RunBenchmark(false);
+    RunBenchmark(true);
+}
+
+INSTANTIATE_TEST_CASE_P(Family, XmppMessageEncodingPerfTest,
+    ::testing::Values(Address::INET, Address::INET6, Address::EVPN,
+                      Address::ERMVPN));
+
+static void SetUp() {
+    BgpServer::Initialize();
+    ControlNode::SetDefaultSchedulingPolicy();
+    BgpServerTest::GlobalSetUp();
+    BgpObjectFactory::Register<BgpXmppMessageBuilder>(
+        boost::factory<BgpXmppMessageBuilder *>());
+}
+
+static void TearDown() {
+    BgpServer::Terminate();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    bgp_log_test::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
@@ -2,54 +2,17 @@
  * Copyright (c) 2016 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <boost/scoped_ptr.hpp>
+
 #include "bgp/bgp_factory.h"
-#include "bgp/bgp_ribout.h"
-#include "bgp/bgp_ribout_updates.h"
-#include "bgp/xmpp_message_builder.h"
-#include "bgp/inet/inet_route.h"
-#include "bgp/test/bgp_server_test_util.h"
+#include "bgp/test/xmpp_message_builder_test.h"
 #include "control-node/control_node.h"
-#include "io/test/event_manager_test.h"
 
 using std::cout;
 using std::endl;
 using std::string;
 using std::vector;
 
-static const char *config = "\
-<config>\
-    <bgp-router name=\'X\'>\
-        <identifier>192.168.0.1</identifier>\
-        <autonomous-system>64512</autonomous-system>\
-        <address>127.0.0.1</address>\
-    </bgp-router>\
-    <routing-instance name='blue'>\
-        <vrf-target>target:64512:100</vrf-target>\
-    </routing-instance>\
-</config>\
-";
-
-class XmppTestPeer : public IPeerUpdate {
-public:
-    XmppTestPeer(const string &name) : name_(name) { }
-    const string &ToString() const { return name_; }
-    bool SendUpdate(const uint8_t *msg, size_t msgsize, const string *msg_str) {
-        string str;
-        if (!msg_str) {
-            str.append(reinterpret_cast<const char *>(msg), msgsize);
-            msg_str = &str;
-        }
-        EXPECT_TRUE(msg_str->size() >= msgsize);
-        return true;
-    }
-    bool SendUpdate(const uint8_t *msg, size_t msgsize) {
-        return SendUpdate(msg, msgsize, NULL);
-    }
-
-private:
-    string name_;
-};
-
 class XmppMessageBuilderTest : public ::testing::Test {
 protected:
     static const int kRepeatCount = 1024;
@@ -161,6 +124,28 @@ INSTANTIATE_TEST_CASE_P(LongPeerName, XmppMessageBuilderParamTest,
     ::testing::Combine(
         ::testing::Values(true), ::testing::Values(false), ::testing::Bool()));
 
+TEST_P(XmppMessageEncodingTest, Equivalence) {
+    boost::scoped_ptr<Message> dom_message(CreateMessage(false));
+    boost::scoped_ptr<Message> stream_message(CreateMessage(true));
+    BuildMessage(dom_message.get());
+    BuildMessage(stream_message.get());
+    string dom_str = GetMessageString(dom_message.get());
+    string stream_str = GetMessageString(stream_message.get());
+
+    pugi::xml_document dom_doc;
+    pugi::xml_document stream_doc;
+    EXPECT_TRUE(dom_doc.load_buffer(dom_str.c_str(), dom_str.size()));
+    EXPECT_TRUE(stream_doc.load_buffer(stream_str.c_str(), stream_str.size()));
+    EXPECT_TRUE(XmlNodeEqual(dom_doc.first_child(), stream_doc.first_child()));
+    EXPECT_EQ(kRouteCount, static_cast<int>(std::distance(
+        stream_doc.first_child().child("event").child("items").begin(),
+        stream_doc.first_child().child("event").child("items").end())));
+}
+
+INSTANTIATE_TEST_CASE_P(Family, XmppMessageEncodingTest,
+    ::testing::Values(Address::INET, Address::INET6, Address::EVPN,
+                      Address::ERMVPN));
+
 class TestEnvironment : public ::testing::Environment {
     virtual ~TestEnvironment() { }
     virtual void SetUp() {
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_TEST_XMPP_MESSAGE_BUILDER_TEST_H_
+#define SRC_BGP_TEST_XMPP_MESSAGE_BUILDER_TEST_H_
+
+#include <pugixml/pugixml.hpp>
+
+#include <string>
+#include <vector>
+
+#include "bgp/bgp_ribout.h"
+#include "bgp/bgp_ribout_updates.h"
+#include "bgp/xmpp_message_builder.h"
+#include "bgp/ermvpn/ermvpn_route.h"
+#include "bgp/evpn/evpn_route.h"
+#include "bgp/extended-community/mac_mobility.h"
+#include "bgp/inet/inet_route.h"
+#include "bgp/inet6/inet6_route.h"
+#include "bgp/security_group/security_group.h"
+#include "bgp/test/bgp_server_test_util.h"
+#include "io/test/event_manager_test.h"
+
+static const char *config = "\
+<config>\
+    <bgp-router name=\'X\'>\
+        <identifier>192.168.0.1</identifier>\
+        <autonomous-system>64512</autonomous-system>\
+        <address>127.0.0.1</address>\
+    </bgp-router>\
+    <routing-instance name='blue'>\
+        <vrf-target>target:64512:100</vrf-target>\
+    </routing-instance>\
+</config>\
+";
+
+class XmppTestPeer : public IPeerUpdate {
+public:
+    XmppTestPeer(const std::string &name) : name_(name) { }
+    const std::string &ToString() const { return name_; }
+    bool SendUpdate(const uint8_t *msg, size_t msgsize,
+                    const std::string *msg_str) {
+        std::string str;
+        if (!msg_str) {
+            str.append(reinterpret_cast<const char *>(msg), msgsize);
+            msg_str = &str;
+        }
+        EXPECT_TRUE(msg_str->size() >= msgsize);
+        return true;
+    }
+    bool SendUpdate(const uint8_t *msg, size_t msgsize) {
+        return SendUpdate(msg, msgsize, NULL);
+    }
+
+private:
+    std::string name_;
+};
+
+//
+// Compare stream encoding with pugixml encoding of route items.
+//
+// The messages built with the two encodings must be semantically equivalent
+// xml documents.
+//
+class XmppMessageEncodingTest :
+    public ::testing::TestWithParam<Address::Family> {
+protected:
+    static const int kRouteCount = 32;
+
+    XmppMessageEncodingTest()
+        : thread_(&evm_), family_(Address::UNSPEC), table_(NULL),
+          ribout_(NULL) {
+    }
+
+    virtual void SetUp() {
+        family_ = GetParam();
+        bs_x_.reset(new BgpServerTest(&evm_, "X"));
+        thread_.Start();
+        bs_x_->Configure(config);
+        task_util::WaitForIdle();
+
+        std::string table_name =
+            "blue." + Address::FamilyToTableString(family_) + ".0";
+        TASK_UTIL_EXPECT_TRUE(
+            bs_x_->database()->FindTable(table_name) != NULL);
+        table_ = static_cast<BgpTable *>(
+            bs_x_->database()->FindTable(table_name));
+        ribout_ = table_->RibOutLocate(bs_x_->update_sender(),
+            RibExportPolicy(BgpProto::XMPP, RibExportPolicy::XMPP, -1, 0));
+
+        BgpAttrSpec spec;
+        BgpAttrNextHop nexthop(0x0a0a0a0a);
+        spec.push_back(&nexthop);
+        BgpAttrLocalPref local_pref(200);
+        spec.push_back(&local_pref);
+        BgpAttrMultiExitDisc med(300);
+        spec.push_back(&med);
+
+        CommunitySpec community;
+        community.communities.push_back(0xFFFF0001);
+        community.communities.push_back(0xFC00FFFF);
+        spec.push_back(&community);
+
+        ExtCommunitySpec ext_community;
+        SecurityGroup sg(64512, 8000001);
+        ext_community.communities.push_back(sg.GetExtCommunityValue());
+        MacMobility mm(7, true);
+        ext_community.communities.push_back(mm.GetExtCommunityValue());
+        autogen::LoadBalanceType lb_type;
+        lb_type.load_balance_fields.load_balance_field_list.push_back(
+            "l3-source-address");
+        lb_type.load_balance_decision = "source-bias";
+        LoadBalance load_balance(lb_type);
+        ext_community.communities.push_back(
+            load_balance.GetExtCommunityValue());
+        spec.push_back(&ext_community);
+
+        BgpOListSpec olist(BgpAttribute::OList);
+        if (family_ == Address::ERMVPN) {
+            std::vector<std::string> encap;
+            encap.push_back("gre");
+            encap.push_back("udp");
+            for (int idx = 1; idx <= 4; ++idx) {
+                std::string addr_str = "10.1.1." + integerToString(idx);
+                olist.elements.push_back(BgpOListElem(
+                    Ip4Address::from_string(addr_str), 1000 * idx, encap));
+            }
+            spec.push_back(&olist);
+        }
+        attr_ = bs_x_->attr_db()->Locate(spec);
+
+        for (int idx = 0;  idx < kRouteCount; ++idx) {
+            routes_.push_back(CreateRoute(idx));
+            if (family_ == Address::ERMVPN) {
+                roattrs_.push_back(new RibOutAttr(table_, attr_.get(),
+                    100 + idx, 0, false));
+            } else {
+                roattrs_.push_back(new RibOutAttr(table_, attr_.get(),
+                    100 + idx, 0, true));
+            }
+        }
+    }
+
+    virtual void TearDown() {
+        STLDeleteValues(&roattrs_);
+        STLDeleteValues(&routes_);
+        table_->RibOutDelete(
+            RibExportPolicy(BgpProto::XMPP, RibExportPolicy::XMPP, -1, 0));
+        bs_x_->Shutdown();
+        evm_.Shutdown();
+        thread_.Join();
+        task_util::WaitForIdle();
+    }
+
+    BgpRoute *CreateRoute(int idx) {
+        std::string idx_str = integerToString(idx);
+        switch (family_) {
+        case Address::INET:
+            return new InetRoute(
+                Ip4Prefix::FromString("192.168.1." + idx_str + "/32"));
+        case Address::INET6:
+            return new Inet6Route(
+                Inet6Prefix::FromString("2001:db8::" + idx_str + "/128"));
+        case Address::EVPN: {
+            char mac_str[32];
+            snprintf(mac_str, sizeof(mac_str), "00:00:01:02:03:%02x", idx);
+            return new EvpnRoute(EvpnPrefix::FromString(
+                std::string("2-0:0-0-") + mac_str + ",192.168.1." + idx_str));
+        }
+        case Address::ERMVPN:
+            return new ErmVpnRoute(ErmVpnPrefix::FromString(
+                "2-10.1.1.1:65535-192.168.1.1,224.1.1." + idx_str +
+                ",0.0.0.0"));
+        default:
+            assert(false);
+        }
+        return NULL;
+    }
+
+    Message *CreateMessage(bool stream_encoding) {
+        BgpXmppMessageBuilder builder;
+        builder.set_stream_encoding(stream_encoding);
+        return builder.Create();
+    }
+
+    void BuildMessage(Message *message) {
+        message->Start(ribout_, false, roattrs_[0], routes_[0]);
+        for (int ridx = 1; ridx < kRouteCount; ++ridx) {
+            message->AddRoute(routes_[ridx], roattrs_[ridx]);
+        }
+        message->Finish();
+    }
+
+    std::string GetMessageString(Message *message) {
+        XmppTestPeer peer("agent.juniper.net");
+        size_t msgsize;
+        const std::string *msg_str = NULL;
+        const uint8_t *msg = message->GetData(&peer, &msgsize, &msg_str);
+        return std::string(reinterpret_cast<const char *>(msg), msgsize);
+    }
+
+    static bool XmlNodeEqual(const pugi::xml_node &lhs,
+                             const pugi::xml_node &rhs) {
+        if (strcmp(lhs.name(), rhs.name()) != 0)
+            return false;
+        if (strcmp(lhs.child_value(), rhs.child_value()) != 0)
+            return false;
+
+        pugi::xml_attribute lhs_attr = lhs.first_attribute();
+        pugi::xml_attribute rhs_attr = rhs.first_attribute();
+        for (; lhs_attr && rhs_attr; lhs_attr = lhs_attr.next_attribute(),
+             rhs_attr = rhs_attr.next_attribute()) {
+            if (strcmp(lhs_attr.name(), rhs_attr.name()) != 0)
+                return false;
+            if (strcmp(lhs_attr.value(), rhs_attr.value()) != 0)
+                return false;
+        }
+        if (lhs_attr || rhs_attr)
+            return false;
+
+        pugi::xml_node lhs_child = lhs.first_child();
+        pugi::xml_node rhs_child = rhs.first_child();
+        while (true) {
+            while (lhs_child && lhs_child.type() != pugi::node_element)
+                lhs_child = lhs_child.next_sibling();
+            while (rhs_child && rhs_child.type() != pugi::node_element)
+                rhs_child = rhs_child.next_sibling();
+            if (!lhs_child || !rhs_child)
+                break;
+            if (!XmlNodeEqual(lhs_child, rhs_child))
+                return false;
+            lhs_child = lhs_child.next_sibling();
+            rhs_child = rhs_child.next_sibling();
+        }
+        return !lhs_child && !rhs_child;
+    }
+
+    EventManager evm_;
+    ServerThread thread_;
+    BgpServerTestPtr bs_x_;
+    Address::Family family_;
+    BgpTable *table_;
+    RibOut *ribout_;
+    BgpAttrPtr attr_;
+    std::vector<BgpRoute *> routes_;
+    std::vector<RibOutAttr *> roattrs_;
+};
+
+#endif  // SRC_BGP_TEST_XMPP_MESSAGE_BUILDER_TEST_H_
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <pugixml/pugixml.hpp>
+
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_log.h"
+#include "bgp/xmpp_unicast_item.h"
+#include "bgp/test/xmpp_item_test.h"
+#include "control-node/control_node.h"
+#include "net/community_type.h"
+
+using pugi::xml_document;
+using pugi::xml_node;
+using std::string;
+
+class XmppUnicastItemTest : public XmppItemTestBase {
+protected:
+    //
+    // Verify that the decoder produces the same values as the autogen parser
+    // for the item in the document.
+    //
+    static void VerifyItem(const xml_document &doc) {
+        xml_node node = doc.child("item");
+        autogen::ItemType expected;
+        expected.Clear();
+        EXPECT_TRUE(expected.XmlParse(node));
+        XmppUnicastItem item;
+        EXPECT_TRUE(item.Decode(node));
+
+        EXPECT_EQ(expected.entry.nlri.af, item.af());
+        EXPECT_EQ(expected.entry.nlri.safi, item.safi());
+        EXPECT_EQ(expected.entry.nlri.address, string(item.address()));
+        EXPECT_EQ(expected.entry.next_hops.next_hop.size(),
+                  item.next_hop_count());
+        EXPECT_EQ(expected.entry.local_preference, item.local_preference());
+        EXPECT_EQ(expected.entry.med, item.med());
+        EXPECT_EQ(expected.entry.sequence_number, item.sequence_number());
+        EXPECT_EQ(expected.entry.mobility.seqno, item.mobility_seqno());
+        EXPECT_EQ(expected.entry.mobility.sticky, item.mobility_sticky());
+        EXPECT_TRUE(expected.entry.security_group_list.security_group ==
+            std::vector<int>(item.security_groups().begin(),
+                             item.security_groups().end()));
+        EXPECT_TRUE(LoadBalance(expected.entry.load_balance) ==
+                    item.load_balance());
+
+        const autogen::CommunityTagListType &ctl =
+            expected.entry.community_tag_list;
+        EXPECT_EQ(ctl.community_tag.size(), item.communities().size());
+        for (size_t idx = 0; idx < item.communities().size(); ++idx) {
+            EXPECT_EQ(
+                CommunityType::CommunityFromString(ctl.community_tag[idx]),
+                item.communities()[idx]);
+        }
+
+        if (expected.entry.next_hops.next_hop.empty())
+            return;
+        const autogen::NextHopType &enh = expected.entry.next_hops.next_hop[0];
+        const XmppUnicastItem::NextHop &nh = item.next_hop();
+        EXPECT_EQ(enh.af, nh.af);
+        EXPECT_EQ(enh.address, string(nh.address_str));
+        EXPECT_TRUE(nh.address_valid);
+        EXPECT_EQ(enh.address, nh.address.to_string());
+        EXPECT_EQ(enh.mac, string(nh.mac));
+        EXPECT_EQ(enh.label, nh.label);
+        EXPECT_EQ(enh.vni, nh.vni);
+        EXPECT_EQ(enh.tunnel_encapsulation_list.tunnel_encapsulation.size(),
+                  nh.tunnel_encaps.size());
+        for (size_t idx = 0; idx < nh.tunnel_encaps.size(); ++idx) {
+            EXPECT_EQ(TunnelEncapType::TunnelEncapFromString(
+                enh.tunnel_encapsulation_list.tunnel_encapsulation[idx]),
+                nh.tunnel_encaps[idx]);
+        }
+        EXPECT_TRUE(enh.tag_list.tag ==
+            std::vector<int>(nh.tags.begin(), nh.tags.end()));
+    }
+
+    bool Decode(const string &data) {
+        xml_document doc;
+        EXPECT_TRUE(doc.load(data.c_str()));
+        XmppUnicastItem item;
+        return item.Decode(doc.child("item"));
+    }
+};
+
+TEST_F(XmppUnicastItemTest, Inet) {
+    xml_document doc;
+    for (int idx = 0; idx < 16; ++idx) {
+        autogen::ItemType item;
+        BuildItem(&item, BgpAf::IPv4, idx);
+        EncodeItem(item, &doc);
+        VerifyItem(doc);
+    }
+}
+
+TEST_F(XmppUnicastItemTest, Inet6) {
+    xml_document doc;
+    for (int idx = 0; idx < 16; ++idx) {
+        autogen::ItemType item;
+        BuildItem(&item, BgpAf::IPv6, idx);
+        EncodeItem(item, &doc);
+        VerifyItem(doc);
+    }
+}
+
+TEST_F(XmppUnicastItemTest, NoNextHops) {
+    xml_document doc;
+    autogen::ItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+    item.entry.next_hops.next_hop.clear();
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+}
+
+TEST_F(XmppUnicastItemTest, MultipleNextHops) {
+    xml_document doc;
+    autogen::ItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+    item.entry.next_hops.next_hop.push_back(
+        item.entry.next_hops.next_hop.front());
+    item.entry.next_hops.next_hop.back().address = "junk";
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+}
+
+TEST_F(XmppUnicastItemTest, SequenceNumber) {
+    xml_document doc;
+    autogen::ItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+    item.entry.mobility.seqno = 0;
+    item.entry.sequence_number = 7;
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+}
+
+TEST_F(XmppUnicastItemTest, Communities) {
+    xml_document doc;
+    autogen::ItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+    item.entry.community_tag_list.community_tag.push_back("64512:100");
+    item.entry.community_tag_list.community_tag.push_back("accept-own");
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+
+    // Bad community tags are skipped.
+    xml_node node = doc.child("item");
+    xml_node ctl = node.child("entry").child("community-tag-list");
+    ctl.append_child("community-tag").text().set("junk");
+    XmppUnicastItem decoded_item;
+    EXPECT_TRUE(decoded_item.Decode(node));
+    EXPECT_EQ(3, decoded_item.communities().size());
+}
+
+TEST_F(XmppUnicastItemTest, LoadBalance) {
+    xml_document doc;
+    autogen::ItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+
+    // No load-balance fields.
+    item.entry.load_balance.load_balance_decision = "field-hash";
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+
+    // Some load-balance fields.
+    item.entry.load_balance.load_balance_fields.load_balance_field_list.
+        push_back("l3-source-address");
+    item.entry.load_balance.load_balance_fields.load_balance_field_list.
+        push_back("l4-protocol");
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+
+    // Source bias.
+    item.entry.load_balance.load_balance_fields.load_balance_field_list.
+        clear();
+    item.entry.load_balance.load_balance_decision = "source-bias";
+    EncodeItem(item, &doc);
+    VerifyItem(doc);
+}
+
+TEST_F(XmppUnicastItemTest, BadInteger) {
+    EXPECT_TRUE(Decode("<item><entry><nlri><af>1</af></nlri></entry></item>"));
+    EXPECT_TRUE(Decode("<item><entry><nlri><af>1 </af></nlri></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><nlri><af>some_junk</af></nlri></entry></item>"));
+    EXPECT_FALSE(Decode("<item><entry><version>1x</version></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><local-preference>x</local-preference></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><mobility seqno=\"x\"/></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><security-group-list><security-group>x"
+        "</security-group></security-group-list></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><next-hops><next-hop><label>x</label>"
+        "</next-hop></next-hops></entry></item>"));
+    EXPECT_FALSE(Decode(
+        "<item><entry><next-hops><next-hop><tag-list><tag>x</tag>"
+        "</tag-list></next-hop></next-hops></entry></item>"));
+}
+
+TEST_F(XmppUnicastItemTest, BadNextHopAddress) {
+    xml_document doc;
+    autogen::ItemType item;
+    BuildItem(&item, BgpAf::IPv4, 1);
+
+    item.entry.next_hops.next_hop[0].address = "192.168.1.1.1";
+    EncodeItem(item, &doc);
+    XmppUnicastItem decoded_item;
+    EXPECT_TRUE(decoded_item.Decode(doc.child("item")));
+    EXPECT_FALSE(decoded_item.next_hop().address_valid);
+
+    item.entry.next_hops.next_hop[0].address = "0.0.0.0";
+    EncodeItem(item, &doc);
+    EXPECT_TRUE(decoded_item.Decode(doc.child("item")));
+    EXPECT_FALSE(decoded_item.next_hop().address_valid);
+
+    item.entry.next_hops.next_hop[0].address = "192.168.1.1";
+    item.entry.next_hops.next_hop[0].af = BgpAf::L2Vpn;
+    EncodeItem(item, &doc);
+    EXPECT_TRUE(decoded_item.Decode(doc.child("item")));
+    EXPECT_FALSE(decoded_item.next_hop().address_valid);
+}
+
+static void SetUp() {
+    bgp_log_test::init();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
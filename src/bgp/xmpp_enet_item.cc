@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/xmpp_enet_item.h"
+
+#include "bgp/xmpp_item_parse.h"
+
+using pugi::xml_node;
+using xmpp_item::DecodeAddress;
+using xmpp_item::NameIs;
+using xmpp_item::ParseBoolean;
+using xmpp_item::ParseInteger;
+
+XmppEnetItem::NextHop::NextHop() {
+    Clear();
+}
+
+void XmppEnetItem::NextHop::Clear() {
+    af = 0;
+    address_str = "";
+    address = IpAddress(Ip4Address(0));
+    address_valid = false;
+    mac = "";
+    label = 0;
+    l3_label = 0;
+    tunnel_encaps.clear();
+    tags.clear();
+}
+
+XmppEnetItem::XmppEnetItem() {
+    Clear();
+}
+
+void XmppEnetItem::Clear() {
+    af_ = 0;
+    safi_ = 0;
+    ethernet_tag_ = 0;
+    mac_ = "";
+    address_ = "";
+    next_hop_count_ = 0;
+    next_hop_.Clear();
+    local_preference_ = 0;
+    med_ = 0;
+    sequence_number_ = 0;
+    mobility_seqno_ = 0;
+    mobility_sticky_ = false;
+    security_groups_.clear();
+    edge_replication_not_supported_ = false;
+    assisted_replication_supported_ = false;
+    replicator_address_ = "";
+    etree_leaf_ = false;
+}
+
+//
+// Decode the given item node. Return false if the item is malformed.
+//
+bool XmppEnetItem::Decode(const xml_node &node) {
+    Clear();
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NameIs(child, "entry") && !DecodeEntry(child))
+            return false;
+    }
+    return true;
+}
+
+bool XmppEnetItem::DecodeEntry(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        const char *name = child.name();
+        switch (name[0]) {
+        case 'a':
+            if (strcmp(name, "assisted-replication-supported") == 0)
+                assisted_replication_supported_ = ParseBoolean(child);
+            break;
+        case 'e':
+            if (strcmp(name, "edge-replication-not-supported") == 0) {
+                edge_replication_not_supported_ = ParseBoolean(child);
+            } else if (strcmp(name, "etree-leaf") == 0) {
+                etree_leaf_ = ParseBoolean(child);
+            }
+            break;
+        case 'l':
+            if (strcmp(name, "local-preference") == 0) {
+                if (!ParseInteger(child, &local_preference_))
+                    return false;
+            } else if (strcmp(name, "leaf-olist") == 0) {
+                if (!DecodeOlist(child))
+                    return false;
+            }
+            break;
+        case 'm':
+            if (strcmp(name, "med") == 0) {
+                if (!ParseInteger(child, &med_))
+                    return false;
+            } else if (strcmp(name, "mobility") == 0) {
+                if (!DecodeMobility(child))
+                    return false;
+            }
+            break;
+        case 'n':
+            if (strcmp(name, "nlri") == 0) {
+                if (!DecodeNlri(child))
+                    return false;
+            } else if (strcmp(name, "next-hops") == 0) {
+                if (!DecodeNextHops(child))
+                    return false;
+            }
+            break;
+        case 'o':
+            if (strcmp(name, "olist") == 0 && !DecodeOlist(child))
+                return false;
+            break;
+        case 'r':
+            if (strcmp(name, "replicator-address") == 0)
+                replicator_address_ = child.child_value();
+            break;
+        case 's':
+            if (strcmp(name, "security-group-list") == 0) {
+                if (!DecodeSecurityGroups(child))
+                    return false;
+            } else if (strcmp(name, "sequence-number") == 0) {
+                if (!ParseInteger(child, &sequence_number_))
+                    return false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+bool XmppEnetItem::DecodeNlri(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NameIs(child, "af")) {
+            if (!ParseInteger(child, &af_))
+                return false;
+        } else if (NameIs(child, "safi")) {
+            if (!ParseInteger(child, &safi_))
+                return false;
+        } else if (NameIs(child, "ethernet-tag")) {
+            if (!ParseInteger(child, &ethernet_tag_))
+                return false;
+        } else if (NameIs(child, "mac")) {
+            mac_ = child.child_value();
+        } else if (NameIs(child, "address")) {
+            address_ = child.child_value();
+        }
+    }
+    return true;
+}
+
+//
+// Agents publish a single next-hop per item. Only the first one is decoded,
+// but all of them are counted so that the caller can reject the item.
+//
+bool XmppEnetItem::DecodeNextHops(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (!NameIs(child, "next-hop"))
+            continue;
+        if (next_hop_count_++ == 0 && !DecodeNextHop(child, &next_hop_))
+            return false;
+    }
+    return true;
+}
+
+//
+// The olists are not used, but their next-hops are decoded so that an item
+// with a malformed value in them fails like it does with the autogen parser.
+//
+bool XmppEnetItem::DecodeOlist(const xml_node &node) {
+    NextHop next_hop;
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (!NameIs(child, "next-hop"))
+            continue;
+        next_hop.Clear();
+        if (!DecodeNextHop(child, &next_hop))
+            return false;
+    }
+    return true;
+}
+
+bool XmppEnetItem::DecodeNextHop(const xml_node &node, NextHop *next_hop) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NameIs(child, "af")) {
+            if (!ParseInteger(child, &next_hop->af))
+                return false;
+        } else if (NameIs(child, "address")) {
+            next_hop->address_str = child.child_value();
+        } else if (NameIs(child, "mac")) {
+            next_hop->mac = child.child_value();
+        } else if (NameIs(child, "label")) {
+            if (!ParseInteger(child, &next_hop->label))
+                return false;
+        } else if (NameIs(child, "l3-label")) {
+            if (!ParseInteger(child, &next_hop->l3_label))
+                return false;
+        } else if (NameIs(child, "tunnel-encapsulation-list")) {
+            for (xml_node encap = child.first_child(); encap;
+                 encap = encap.next_sibling()) {
+                if (!NameIs(encap, "tunnel-encapsulation"))
+                    continue;
+                next_hop->tunnel_encaps.push_back(
+                    TunnelEncapType::TunnelEncapFromString(
+                        encap.child_value()));
+            }
+        } else if (NameIs(child, "tag-list")) {
+            for (xml_node tag = child.first_child(); tag;
+                 tag = tag.next_sibling()) {
+                if (!NameIs(tag, "tag"))
+                    continue;
+                uint32_t value;
+                if (!ParseInteger(tag, &value))
+                    return false;
+                next_hop->tags.push_back(value);
+            }
+        }
+    }
+
+    // The af may follow the address, so decode the address at the end.
+    next_hop->address_valid = DecodeAddress(next_hop->af,
+        next_hop->address_str, &next_hop->address);
+    return true;
+}
+
+bool XmppEnetItem::DecodeMobility(const xml_node &node) {
+    mobility_sticky_ = ParseBoolean(node.attribute("sticky").value());
+    return ParseInteger(node.attribute("seqno").value(), &mobility_seqno_);
+}
+
+bool XmppEnetItem::DecodeSecurityGroups(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (!NameIs(child, "security-group"))
+            continue;
+        uint32_t value;
+        if (!ParseInteger(child, &value))
+            return false;
+        security_groups_.push_back(value);
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_XMPP_ENET_ITEM_H_
+#define SRC_BGP_XMPP_ENET_ITEM_H_
+
+#include <pugixml/pugixml.hpp>
+
+#include <vector>
+
+#include "base/util.h"
+#include "net/address.h"
+#include "net/tunnel_encap_type.h"
+
+//
+// Decoded form of an item in the xmpp enet schema (xmpp_enet.xsd), as
+// published by agents for evpn routes.
+//
+// Works the same way as XmppUnicastItem. String values that are only needed
+// for logging or that are converted by the caller point into the document,
+// so the item must not outlive the pugixml document it was decoded from.
+//
+// Decode fails if an integer value is malformed, same as EnetItemType::
+// XmlParse. This includes next-hops in the olists, which are otherwise
+// ignored, as are other elements and values not used by BgpXmppChannel.
+//
+class XmppEnetItem {
+public:
+    struct NextHop {
+        NextHop();
+        void Clear();
+
+        int af;
+        const char *address_str;
+        IpAddress address;
+        bool address_valid;
+        const char *mac;
+        uint32_t label;
+        uint32_t l3_label;
+        std::vector<TunnelEncapType::Encap> tunnel_encaps;
+        std::vector<uint32_t> tags;
+    };
+
+    XmppEnetItem();
+
+    bool Decode(const pugi::xml_node &node);
+    void Clear();
+
+    int af() const { return af_; }
+    int safi() const { return safi_; }
+    uint32_t ethernet_tag() const { return ethernet_tag_; }
+    const char *mac() const { return mac_; }
+    const char *address() const { return address_; }
+
+    size_t next_hop_count() const { return next_hop_count_; }
+    const NextHop &next_hop() const { return next_hop_; }
+
+    uint32_t local_preference() const { return local_preference_; }
+    uint32_t med() const { return med_; }
+    uint32_t sequence_number() const { return sequence_number_; }
+    uint32_t mobility_seqno() const { return mobility_seqno_; }
+    bool mobility_sticky() const { return mobility_sticky_; }
+    const std::vector<uint32_t> &security_groups() const {
+        return security_groups_;
+    }
+    bool edge_replication_not_supported() const {
+        return edge_replication_not_supported_;
+    }
+    bool assisted_replication_supported() const {
+        return assisted_replication_supported_;
+    }
+    const char *replicator_address() const { return replicator_address_; }
+    bool etree_leaf() const { return etree_leaf_; }
+
+private:
+    bool DecodeEntry(const pugi::xml_node &node);
+    bool DecodeNlri(const pugi::xml_node &node);
+    bool DecodeNextHops(const pugi::xml_node &node);
+    bool DecodeOlist(const pugi::xml_node &node);
+    bool DecodeNextHop(const pugi::xml_node &node, NextHop *next_hop);
+    bool DecodeMobility(const pugi::xml_node &node);
+    bool DecodeSecurityGroups(const pugi::xml_node &node);
+
+    int af_;
+    int safi_;
+    uint32_t ethernet_tag_;
+    const char *mac_;
+    const char *address_;
+    size_t next_hop_count_;
+    NextHop next_hop_;
+    uint32_t local_preference_;
+    uint32_t med_;
+    uint32_t sequence_number_;
+    uint32_t mobility_seqno_;
+    bool mobility_sticky_;
+    std::vector<uint32_t> security_groups_;
+    bool edge_replication_not_supported_;
+    bool assisted_replication_supported_;
+    const char *replicator_address_;
+    bool etree_leaf_;
+
+    DISALLOW_COPY_AND_ASSIGN(XmppEnetItem);
+};
+
+#endif  // SRC_BGP_XMPP_ENET_ITEM_H_
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_XMPP_ITEM_PARSE_H_
+#define SRC_BGP_XMPP_ITEM_PARSE_H_
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pugixml/pugixml.hpp>
+
+#include "net/address.h"
+#include "net/bgp_af.h"
+
+//
+// Helpers shared by the decoders for items published by agents. Values are
+// parsed with the same rules as the autogen XmlParse methods, so a decoder
+// accepts and rejects the same items as the autogen parser.
+//
+namespace xmpp_item {
+
+//
+// Same rules as autogen::ParseInteger - trailing whitespace is allowed and
+// an empty value is treated as 0.
+//
+inline bool ParseInteger(const char *str, uint32_t *valuep) {
+    char *endp;
+    *valuep = strtoul(str, &endp, 10);
+    while (isspace(*endp))
+        endp++;
+    return (endp[0] == '\0');
+}
+
+inline bool ParseInteger(const pugi::xml_node &node, uint32_t *valuep) {
+    return ParseInteger(node.child_value(), valuep);
+}
+
+inline bool ParseInteger(const pugi::xml_node &node, int *valuep) {
+    uint32_t value;
+    bool result = ParseInteger(node.child_value(), &value);
+    *valuep = value;
+    return result;
+}
+
+//
+// Same rules as autogen::ParseBoolean - anything but "true" is false.
+//
+inline bool ParseBoolean(const char *str) {
+    return strcmp(str, "true") == 0;
+}
+
+inline bool ParseBoolean(const pugi::xml_node &node) {
+    return ParseBoolean(node.child_value());
+}
+
+inline bool NameIs(const pugi::xml_node &node, const char *name) {
+    return strcmp(node.name(), name) == 0;
+}
+
+//
+// Same checks as BgpXmppChannel::XmppDecodeAddress, without requiring a
+// std::string for the address.
+//
+inline bool DecodeAddress(int af, const char *str, IpAddress *addrp,
+    bool zero_ok = false) {
+    if (af != BgpAf::IPv4 && af != BgpAf::IPv6)
+        return false;
+
+    boost::system::error_code error;
+    *addrp = IpAddress::from_string(str, error);
+    if (error)
+        return false;
+    return (zero_ok ? true : !addrp->is_unspecified());
+}
+
+}  // namespace xmpp_item
+
+#endif  // SRC_BGP_XMPP_ITEM_PARSE_H_
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/xmpp_mcast_item.h"
+
+#include "bgp/xmpp_item_parse.h"
+
+using pugi::xml_node;
+using xmpp_item::DecodeAddress;
+using xmpp_item::NameIs;
+using xmpp_item::ParseInteger;
+
+XmppMcastItem::NextHop::NextHop() {
+    Clear();
+}
+
+void XmppMcastItem::NextHop::Clear() {
+    af = 0;
+    address_str = "";
+    address = IpAddress(Ip4Address(0));
+    address_valid = false;
+    label = "";
+    tunnel_encaps.clear();
+}
+
+XmppMcastItem::XmppMcastItem() {
+    Clear();
+}
+
+void XmppMcastItem::Clear() {
+    af_ = 0;
+    safi_ = 0;
+    group_ = "";
+    source_ = "";
+    next_hop_count_ = 0;
+    next_hop_.Clear();
+}
+
+//
+// Decode the given item node. Return false if the item is malformed.
+//
+bool XmppMcastItem::Decode(const xml_node &node) {
+    Clear();
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NameIs(child, "entry") && !DecodeEntry(child))
+            return false;
+    }
+    return true;
+}
+
+bool XmppMcastItem::DecodeEntry(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NameIs(child, "nlri")) {
+            if (!DecodeNlri(child))
+                return false;
+        } else if (NameIs(child, "next-hops")) {
+            if (!DecodeNextHops(child))
+                return false;
+        } else if (NameIs(child, "olist")) {
+            if (!DecodeOlist(child))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool XmppMcastItem::DecodeNlri(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NameIs(child, "af")) {
+            if (!ParseInteger(child, &af_))
+                return false;
+        } else if (NameIs(child, "safi")) {
+            if (!ParseInteger(child, &safi_))
+                return false;
+        } else if (NameIs(child, "group")) {
+            group_ = child.child_value();
+        } else if (NameIs(child, "source")) {
+            source_ = child.child_value();
+        } else if (NameIs(child, "source-label")) {
+            uint32_t source_label;
+            if (!ParseInteger(child, &source_label))
+                return false;
+        }
+    }
+    return true;
+}
+
+//
+// Agents publish a single next-hop per item. Only the first one is decoded,
+// but all of them are counted so that the caller can reject the item.
+//
+bool XmppMcastItem::DecodeNextHops(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (!NameIs(child, "next-hop"))
+            continue;
+        if (next_hop_count_++ == 0 && !DecodeNextHop(child, &next_hop_))
+            return false;
+    }
+    return true;
+}
+
+//
+// The olist is not used, but its next-hops are decoded so that an item with
+// a malformed value in them fails like it does with the autogen parser.
+//
+bool XmppMcastItem::DecodeOlist(const xml_node &node) {
+    NextHop next_hop;
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (!NameIs(child, "next-hop"))
+            continue;
+        next_hop.Clear();
+        if (!DecodeNextHop(child, &next_hop))
+            return false;
+    }
+    return true;
+}
+
+bool XmppMcastItem::DecodeNextHop(const xml_node &node, NextHop *next_hop) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NameIs(child, "af")) {
+            if (!ParseInteger(child, &next_hop->af))
+                return false;
+        } else if (NameIs(child, "address")) {
+            next_hop->address_str = child.child_value();
+        } else if (NameIs(child, "label")) {
+            next_hop->label = child.child_value();
+        } else if (NameIs(child, "tunnel-encapsulation-list")) {
+            for (xml_node encap = child.first_child(); encap;
+                 encap = encap.next_sibling()) {
+                if (!NameIs(encap, "tunnel-encapsulation"))
+                    continue;
+                next_hop->tunnel_encaps.push_back(
+                    TunnelEncapType::TunnelEncapFromString(
+                        encap.child_value()));
+            }
+        }
+    }
+
+    // The af may follow the address, so decode the address at the end.
+    next_hop->address_valid = DecodeAddress(next_hop->af,
+        next_hop->address_str, &next_hop->address);
+    return true;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_XMPP_MCAST_ITEM_H_
+#define SRC_BGP_XMPP_MCAST_ITEM_H_
+
+#include <pugixml/pugixml.hpp>
+
+#include <vector>
+
+#include "base/util.h"
+#include "net/address.h"
+#include "net/tunnel_encap_type.h"
+
+//
+// Decoded form of an item in the xmpp multicast schema (xmpp_multicast.xsd),
+// as published by agents for ermvpn routes.
+//
+// Works the same way as XmppUnicastItem. The group and source addresses and
+// the label range are converted by the caller and point into the document,
+// so the item must not outlive the pugixml document it was decoded from.
+//
+// Decode fails if an integer value is malformed, same as McastItemType::
+// XmlParse. This includes next-hops in the olist, which is otherwise ignored.
+//
+class XmppMcastItem {
+public:
+    struct NextHop {
+        NextHop();
+        void Clear();
+
+        int af;
+        const char *address_str;
+        IpAddress address;
+        bool address_valid;
+        const char *label;
+        std::vector<TunnelEncapType::Encap> tunnel_encaps;
+    };
+
+    XmppMcastItem();
+
+    bool Decode(const pugi::xml_node &node);
+    void Clear();
+
+    int af() const { return af_; }
+    int safi() const { return safi_; }
+    const char *group() const { return group_; }
+    const char *source() const { return source_; }
+
+    size_t next_hop_count() const { return next_hop_count_; }
+    const NextHop &next_hop() const { return next_hop_; }
+
+private:
+    bool DecodeEntry(const pugi::xml_node &node);
+    bool DecodeNlri(const pugi::xml_node &node);
+    bool DecodeNextHops(const pugi::xml_node &node);
+    bool DecodeOlist(const pugi::xml_node &node);
+    bool DecodeNextHop(const pugi::xml_node &node, NextHop *next_hop);
+
+    int af_;
+    int safi_;
+    const char *group_;
+    const char *source_;
+    size_t next_hop_count_;
+    NextHop next_hop_;
+
+    DISALLOW_COPY_AND_ASSIGN(XmppMcastItem);
+};
+
+#endif  // SRC_BGP_XMPP_MCAST_ITEM_H_
@@ -65,8 +65,189 @@ static inline const char *XmppSafiName(uint8_t safi) {
     return NULL;
 }
 
-BgpXmppMessage::BgpXmppMessage()
+//
+// Writes xml elements directly into a string without building a pugixml DOM
+// or intermediate autogen objects.
+//
+// The output is formatted the same way as pugi::xml_document::print with
+// tab indentation, starting at the given depth. Text and attribute values
+// are escaped the same way as well.
+//
+class XmppItemWriter {
+public:
+    XmppItemWriter(string *repr, int depth) : repr_(repr), depth_(depth) {
+    }
+
+    void OpenItem(const string &id) {
+        Indent();
+        repr_->append("<item id=\"");
+        Escape(id);
+        repr_->append("\">\n");
+        depth_++;
+    }
+
+    void Open(const char *name) {
+        Indent();
+        repr_->push_back('<');
+        repr_->append(name);
+        repr_->append(">\n");
+        depth_++;
+    }
+
+    void Close(const char *name) {
+        depth_--;
+        Indent();
+        repr_->append("</");
+        repr_->append(name);
+        repr_->append(">\n");
+    }
+
+    void Empty(const char *name) {
+        Indent();
+        repr_->push_back('<');
+        repr_->append(name);
+        repr_->append(" />\n");
+    }
+
+    void Element(const char *name, const string &value) {
+        StartElement(name);
+        Escape(value);
+        EndElement(name);
+    }
+
+    void Element(const char *name, int value) {
+        StartElement(name);
+        AppendInt(value);
+        EndElement(name);
+    }
+
+    void Element(const char *name, bool value) {
+        StartElement(name);
+        repr_->append(value ? "true" : "false");
+        EndElement(name);
+    }
+
+    template <typename T>
+    void List(const char *name, const char *elem_name,
+              const vector<T> &values) {
+        if (values.empty()) {
+            Empty(name);
+            return;
+        }
+        Open(name);
+        for (typename vector<T>::const_iterator it = values.begin();
+             it != values.end(); ++it) {
+            Element(elem_name, *it);
+        }
+        Close(name);
+    }
+
+    void Mobility(bool sticky, int seqno) {
+        Indent();
+        repr_->append("<mobility sticky=\"");
+        repr_->append(sticky ? "true" : "false");
+        repr_->append("\" seqno=\"");
+        AppendInt(seqno);
+        repr_->append("\" />\n");
+    }
+
+private:
+    void Indent() {
+        repr_->append(depth_, '\t');
+    }
+
+    void StartElement(const char *name) {
+        Indent();
+        repr_->push_back('<');
+        repr_->append(name);
+        repr_->push_back('>');
+    }
+
+    void EndElement(const char *name) {
+        repr_->append("</");
+        repr_->append(name);
+        repr_->append(">\n");
+    }
+
+    void AppendInt(int value) {
+        char buf[16];
+        char *end = buf + sizeof(buf);
+        char *ptr = end;
+        uint64_t uvalue = value < 0 ? -static_cast<int64_t>(value) : value;
+        do {
+            *--ptr = '0' + uvalue % 10;
+            uvalue /= 10;
+        } while (uvalue);
+        if (value < 0)
+            *--ptr = '-';
+        repr_->append(ptr, end - ptr);
+    }
+
+    void Escape(const string &value) {
+        size_t start = 0;
+        for (size_t idx = 0; idx < value.size(); ++idx) {
+            const char *entity;
+            switch (value[idx]) {
+            case '&':
+                entity = "&amp;";
+                break;
+            case '<':
+                entity = "&lt;";
+                break;
+            case '>':
+                entity = "&gt;";
+                break;
+            case '"':
+                entity = "&quot;";
+                break;
+            default:
+                continue;
+            }
+            repr_->append(value, start, idx - start);
+            repr_->append(entity);
+            start = idx + 1;
+        }
+        repr_->append(value, start, string::npos);
+    }
+
+    string *repr_;
+    int depth_;
+};
+
+//
+// Stream encode an olist for an enet item.
+//
+static void StreamEnetOList(XmppItemWriter *writer, const char *name,
+    const BgpOList *olist, uint8_t subcode) {
+    if (!olist) {
+        writer->Empty(name);
+        return;
+    }
+
+    assert(olist->olist().subcode == subcode);
+    if (olist->elements().empty()) {
+        writer->Empty(name);
+        return;
+    }
+    writer->Open(name);
+    BOOST_FOREACH(const BgpOListElem *elem, olist->elements()) {
+        writer->Open("next-hop");
+        writer->Element("af", static_cast<int>(BgpAf::IPv4));
+        writer->Element("address", elem->address.to_string());
+        writer->Element("mac", string());
+        writer->Element("label", static_cast<int>(elem->label));
+        writer->Element("l3-label", 0);
+        writer->List("tunnel-encapsulation-list", "tunnel-encapsulation",
+            elem->encap);
+        writer->Empty("tag-list");
+        writer->Close("next-hop");
+    }
+    writer->Close(name);
+}
+
+BgpXmppMessage::BgpXmppMessage(bool stream_encoding)
     : table_(NULL),
+      stream_encoding_(stream_encoding),
       writer_(XmlWriter(&repr_)),
       is_reachable_(false),
       cache_routes_(false),
@@ -74,6 +255,8 @@ BgpXmppMessage::BgpXmppMessage()
       mobility_(0, false),
       etree_leaf_(false) {
     msg_begin_.reserve(kMaxFromToLength);
+    if (stream_encoding_)
+        repr_.reserve(kReserveSize);
 }
 
 BgpXmppMessage::~BgpXmppMessage() {
@@ -188,13 +371,8 @@ void BgpXmppMessage::EncodeNextHop(const BgpRoute *route,
     item->entry.next_hops.next_hop.push_back(item_nexthop);
 }
 
-void BgpXmppMessage::AddIpReach(const BgpRoute *route,
-                                const RibOutAttr *roattr) {
-    if (!roattr->repr().empty()) {
-        repr_ += roattr->repr();
-        return;
-    }
-
+void BgpXmppMessage::EncodeIpReach(const BgpRoute *route,
+                                   const RibOutAttr *roattr) {
     autogen::ItemType item;
     item.entry.nlri.af = route->Afi();
     item.entry.nlri.safi = route->XmppSafi();
@@ -231,16 +409,109 @@ void BgpXmppMessage::AddIpReach(const BgpRoute *route,
     xml_node node = doc_.append_child("item");
     node.append_attribute("id") = route->ToXmppIdString().c_str();
 
-    // Remember the previous size.
     // Using remove_child instead of reset allows memory pages allocated for
     // the xml_document to be reused during the lifetime of the xml_document.
-    size_t pos = repr_.size();
     item.Encode(&node);
     doc_.print(writer_, "\t", pugi::format_default, pugi::encoding_auto, 3);
     doc_.remove_child(node);
+}
 
-    // Cache the substring starting at the previous size.
-    if (cache_routes_)
+//
+// Stream encoded equivalent of EncodeIpReach.
+//
+void BgpXmppMessage::StreamIpReach(const BgpRoute *route,
+                                   const RibOutAttr *roattr) {
+    assert(!roattr->nexthop_list().empty());
+
+    XmppItemWriter writer(&repr_, 3);
+    writer.OpenItem(route->ToXmppIdString());
+    writer.Open("entry");
+
+    writer.Open("nlri");
+    writer.Element("af", static_cast<int>(route->Afi()));
+    writer.Element("safi", static_cast<int>(route->XmppSafi()));
+    writer.Element("address", route->ToString());
+    writer.Close("nlri");
+
+    writer.Open("next-hops");
+    BOOST_FOREACH(const RibOutAttr::NextHop &nexthop, roattr->nexthop_list()) {
+        const IpAddress &address = nexthop.address();
+        writer.Open("next-hop");
+        if (address.is_v4()) {
+            writer.Element("af", static_cast<int>(BgpAf::IPv4));
+            writer.Element("address", address.to_v4().to_string());
+        } else {
+            writer.Element("af", static_cast<int>(BgpAf::IPv6));
+            writer.Element("address", address.to_v6().to_string());
+        }
+        writer.Element("mac", string());
+        writer.Element("label", static_cast<int>(nexthop.label()));
+        writer.Element("vni", 0);
+
+        // If there's a non-zero label and encap list is empty use mpls over
+        // gre as default encap.
+        if (!nexthop.label()) {
+            writer.Empty("tunnel-encapsulation-list");
+        } else if (nexthop.encap().empty()) {
+            writer.Open("tunnel-encapsulation-list");
+            writer.Element("tunnel-encapsulation", string("gre"));
+            writer.Close("tunnel-encapsulation-list");
+        } else {
+            writer.List("tunnel-encapsulation-list", "tunnel-encapsulation",
+                nexthop.encap());
+        }
+        writer.Element("virtual-network", GetVirtualNetwork(nexthop));
+        writer.List("tag-list", "tag", nexthop.tag_list());
+        writer.Close("next-hop");
+    }
+    writer.Close("next-hops");
+
+    writer.Element("version", 1);
+    writer.Element("virtual-network", GetVirtualNetwork(route, roattr));
+    writer.Mobility(mobility_.sticky,
+        static_cast<int>(mobility_.sequence_number));
+    writer.Element("sequence-number",
+        static_cast<int>(mobility_.sequence_number));
+    writer.List("security-group-list", "security-group",
+        security_group_list_);
+    writer.List("community-tag-list", "community-tag", community_list_);
+    writer.Element("local-preference",
+        static_cast<int>(roattr->attr()->local_pref()));
+    writer.Element("med", static_cast<int>(roattr->attr()->med()));
+
+    // Encode load balance attribute.
+    autogen::LoadBalanceType load_balance;
+    if (!load_balance_attribute_.IsDefault())
+        load_balance_attribute_.Encode(&load_balance);
+    writer.Open("load-balance");
+    writer.List("load-balance-fields", "load-balance-field-list",
+        load_balance.load_balance_fields.load_balance_field_list);
+    writer.Element("load-balance-decision",
+        load_balance.load_balance_decision);
+    writer.Close("load-balance");
+
+    writer.Close("entry");
+    writer.Close("item");
+}
+
+void BgpXmppMessage::AddIpReach(const BgpRoute *route,
+                                const RibOutAttr *roattr) {
+    if (!roattr->repr().empty()) {
+        repr_ += roattr->repr();
+        return;
+    }
+
+    // Remember the previous size.
+    size_t pos = repr_.size();
+    if (stream_encoding_) {
+        StreamIpReach(route, roattr);
+    } else {
+        EncodeIpReach(route, roattr);
+    }
+
+    // Cache the substring starting at the previous size. Always do this if
+    // the representation is shared with other RibOuts for the table.
+    if (cache_routes_ || roattr->is_repr_shared())
         roattr->set_repr(repr_, pos);
 }
 
@@ -296,13 +567,8 @@ void BgpXmppMessage::EncodeEnetNextHop(const BgpRoute *route,
     item->entry.next_hops.next_hop.push_back(item_nexthop);
 }
 
-void BgpXmppMessage::AddEnetReach(const BgpRoute *route,
-                                  const RibOutAttr *roattr) {
-    if (!roattr->repr().empty()) {
-        repr_ += roattr->repr();
-        return;
-    }
-
+void BgpXmppMessage::EncodeEnetReach(const BgpRoute *route,
+                                     const RibOutAttr *roattr) {
     autogen::EnetItemType item;
     item.entry.nlri.af = route->Afi();
     item.entry.nlri.safi = route->XmppSafi();
@@ -364,16 +630,108 @@ void BgpXmppMessage::AddEnetReach(const BgpRoute *route,
     xml_node node = doc_.append_child("item");
     node.append_attribute("id") = route->ToXmppIdString().c_str();
 
-    // Remember the previous size.
     // Using remove_child instead of reset allows memory pages allocated for
     // the xml_document to be reused during the lifetime of the xml_document.
-    size_t pos = repr_.size();
     item.Encode(&node);
     doc_.print(writer_, "\t", pugi::format_default, pugi::encoding_auto, 3);
     doc_.remove_child(node);
+}
 
-    // Cache the substring starting at the previous size.
-    if (cache_routes_)
+//
+// Stream encoded equivalent of EncodeEnetReach.
+//
+void BgpXmppMessage::StreamEnetReach(const BgpRoute *route,
+                                     const RibOutAttr *roattr) {
+    const BgpOList *olist = roattr->attr()->olist().get();
+    assert((olist == NULL) != roattr->nexthop_list().empty());
+    const BgpOList *leaf_olist = roattr->attr()->leaf_olist().get();
+    assert((leaf_olist == NULL) != roattr->nexthop_list().empty());
+
+    XmppItemWriter writer(&repr_, 3);
+    writer.OpenItem(route->ToXmppIdString());
+    writer.Open("entry");
+
+    EvpnRoute *evpn_route =
+        static_cast<EvpnRoute *>(const_cast<BgpRoute *>(route));
+    const EvpnPrefix &evpn_prefix = evpn_route->GetPrefix();
+    writer.Open("nlri");
+    writer.Element("af", static_cast<int>(route->Afi()));
+    writer.Element("safi", static_cast<int>(route->XmppSafi()));
+    writer.Element("ethernet-tag", static_cast<int>(evpn_prefix.tag()));
+    writer.Element("mac", evpn_prefix.mac_addr().ToString());
+    writer.Element("address", evpn_prefix.ip_address().to_string() + "/" +
+        integerToString(evpn_prefix.ip_address_length()));
+    writer.Close("nlri");
+
+    if (roattr->nexthop_list().empty()) {
+        writer.Empty("next-hops");
+    } else {
+        writer.Open("next-hops");
+    }
+    BOOST_FOREACH(const RibOutAttr::NextHop &nexthop, roattr->nexthop_list()) {
+        writer.Open("next-hop");
+        writer.Element("af", static_cast<int>(BgpAf::IPv4));
+        writer.Element("address", nexthop.address().to_v4().to_string());
+        writer.Element("mac", nexthop.mac().IsZero() ?
+            string() : nexthop.mac().ToString());
+        writer.Element("label", static_cast<int>(nexthop.label()));
+        writer.Element("l3-label", static_cast<int>(nexthop.l3_label()));
+
+        // If encap list is empty use mpls over gre as default encap.
+        if (nexthop.encap().empty()) {
+            writer.Open("tunnel-encapsulation-list");
+            writer.Element("tunnel-encapsulation", string("gre"));
+            writer.Close("tunnel-encapsulation-list");
+        } else {
+            writer.List("tunnel-encapsulation-list", "tunnel-encapsulation",
+                nexthop.encap());
+        }
+        writer.List("tag-list", "tag", nexthop.tag_list());
+        writer.Close("next-hop");
+    }
+    if (!roattr->nexthop_list().empty())
+        writer.Close("next-hops");
+
+    StreamEnetOList(&writer, "olist", olist, BgpAttribute::OList);
+    writer.Element("virtual-network", GetVirtualNetwork(route, roattr));
+    writer.Mobility(mobility_.sticky,
+        static_cast<int>(mobility_.sequence_number));
+    writer.Element("sequence-number",
+        static_cast<int>(mobility_.sequence_number));
+    writer.List("security-group-list", "security-group",
+        security_group_list_);
+    writer.Element("local-preference",
+        static_cast<int>(roattr->attr()->local_pref()));
+    writer.Element("med", static_cast<int>(roattr->attr()->med()));
+    writer.Element("edge-replication-not-supported", false);
+    writer.Element("assisted-replication-supported", false);
+    StreamEnetOList(&writer, "leaf-olist", leaf_olist,
+        BgpAttribute::LeafOList);
+    writer.Element("replicator-address", string());
+    writer.Element("etree-leaf", etree_leaf_);
+
+    writer.Close("entry");
+    writer.Close("item");
+}
+
+void BgpXmppMessage::AddEnetReach(const BgpRoute *route,
+                                  const RibOutAttr *roattr) {
+    if (!roattr->repr().empty()) {
+        repr_ += roattr->repr();
+        return;
+    }
+
+    // Remember the previous size.
+    size_t pos = repr_.size();
+    if (stream_encoding_) {
+        StreamEnetReach(route, roattr);
+    } else {
+        EncodeEnetReach(route, roattr);
+    }
+
+    // Cache the substring starting at the previous size. Always do this if
+    // the representation is shared with other RibOuts for the table.
+    if (cache_routes_ || roattr->is_repr_shared())
         roattr->set_repr(repr_, pos);
 }
 
@@ -393,12 +751,8 @@ bool BgpXmppMessage::AddEnetRoute(const BgpRoute *route,
     return true;
 }
 
-//
-// Note that there's no need to cache the string representation since a given
-// mcast route is sent to exactly one xmpp peer.
-//
-void BgpXmppMessage::AddMcastReach(const BgpRoute *route,
-                                   const RibOutAttr *roattr) {
+void BgpXmppMessage::EncodeMcastReach(const BgpRoute *route,
+                                      const RibOutAttr *roattr) {
     autogen::McastItemType item;
     item.entry.nlri.af = route->Afi();
     item.entry.nlri.safi = route->XmppSafi();
@@ -429,6 +783,63 @@ void BgpXmppMessage::AddMcastReach(const BgpRoute *route,
     doc_.remove_child(node);
 }
 
+//
+// Stream encoded equivalent of EncodeMcastReach.
+//
+void BgpXmppMessage::StreamMcastReach(const BgpRoute *route,
+                                      const RibOutAttr *roattr) {
+    const BgpOList *olist = roattr->attr()->olist().get();
+    assert(olist->olist().subcode == BgpAttribute::OList);
+
+    XmppItemWriter writer(&repr_, 3);
+    writer.OpenItem(route->ToXmppIdString());
+    writer.Open("entry");
+
+    ErmVpnRoute *ermvpn_route =
+        static_cast<ErmVpnRoute *>(const_cast<BgpRoute *>(route));
+    writer.Open("nlri");
+    writer.Element("af", static_cast<int>(route->Afi()));
+    writer.Element("safi", static_cast<int>(route->XmppSafi()));
+    writer.Element("group", ermvpn_route->GetPrefix().group().to_string());
+    writer.Element("source", ermvpn_route->GetPrefix().source().to_string());
+    writer.Element("source-label", static_cast<int>(roattr->label()));
+    writer.Close("nlri");
+
+    writer.Empty("next-hops");
+    if (olist->elements().empty()) {
+        writer.Empty("olist");
+    } else {
+        writer.Open("olist");
+    }
+    BOOST_FOREACH(const BgpOListElem *elem, olist->elements()) {
+        writer.Open("next-hop");
+        writer.Element("af", static_cast<int>(BgpAf::IPv4));
+        writer.Element("address", elem->address.to_string());
+        writer.Element("label", integerToString(elem->label));
+        writer.List("tunnel-encapsulation-list", "tunnel-encapsulation",
+            elem->encap);
+        writer.Close("next-hop");
+    }
+    if (!olist->elements().empty())
+        writer.Close("olist");
+
+    writer.Close("entry");
+    writer.Close("item");
+}
+
+//
+// Note that there's no need to cache the string representation since a given
+// mcast route is sent to exactly one xmpp peer.
+//
+void BgpXmppMessage::AddMcastReach(const BgpRoute *route,
+                                   const RibOutAttr *roattr) {
+    if (stream_encoding_) {
+        StreamMcastReach(route, roattr);
+    } else {
+        EncodeMcastReach(route, roattr);
+    }
+}
+
 void BgpXmppMessage::AddMcastUnreach(const BgpRoute *route) {
     repr_ += "\t\t\t<retract id=\"" + route->ToXmppIdString() + "\" />\n";
 }
@@ -558,9 +969,9 @@ string BgpXmppMessage::GetVirtualNetwork(const BgpRoute *route,
     }
 }
 
-BgpXmppMessageBuilder::BgpXmppMessageBuilder() {
+BgpXmppMessageBuilder::BgpXmppMessageBuilder() : stream_encoding_(true) {
 }
 
 Message *BgpXmppMessageBuilder::Create() const {
-    return new BgpXmppMessage;
+    return new BgpXmppMessage(stream_encoding_);
 }
@@ -21,18 +21,32 @@ class EnetItemType;
 class Community;
 class ExtCommunity;
 
+//
+// Builder for BgpXmppMessages.
+//
+// Stream encoding, which is the default, writes route items directly into
+// the message buffer. The alternative encodes each item via autogen types
+// and a pugixml document. Both produce equivalent xml.
+//
 class BgpXmppMessageBuilder : public MessageBuilder {
 public:
     BgpXmppMessageBuilder();
     virtual Message *Create() const;
 
+    bool stream_encoding() const { return stream_encoding_; }
+    void set_stream_encoding(bool stream_encoding) {
+        stream_encoding_ = stream_encoding;
+    }
+
 private:
+    bool stream_encoding_;
+
     DISALLOW_COPY_AND_ASSIGN(BgpXmppMessageBuilder);
 };
 
 class BgpXmppMessage : public Message {
 public:
-    BgpXmppMessage();
+    explicit BgpXmppMessage(bool stream_encoding = false);
     virtual ~BgpXmppMessage();
 
     virtual bool Start(const RibOut *ribout, bool cache_routes,
@@ -46,6 +60,7 @@ private:
     static const size_t kMaxFromToLength = 192;
     static const uint32_t kMaxReachCount = 32;
     static const uint32_t kMaxUnreachCount = 256;
+    static const size_t kReserveSize = 32 * 1024;
 
     class XmlWriter : public pugi::xml_writer {
     public:
@@ -71,6 +86,8 @@ private:
     void EncodeNextHop(const BgpRoute *route,
                        const RibOutAttr::NextHop &nexthop,
                        autogen::ItemType *item);
+    void EncodeIpReach(const BgpRoute *route, const RibOutAttr *roattr);
+    void StreamIpReach(const BgpRoute *route, const RibOutAttr *roattr);
     void AddIpReach(const BgpRoute *route, const RibOutAttr *roattr);
     void AddIpUnreach(const BgpRoute *route);
     bool AddInetRoute(const BgpRoute *route, const RibOutAttr *roattr);
@@ -80,10 +97,14 @@ private:
     void EncodeEnetNextHop(const BgpRoute *route,
                            const RibOutAttr::NextHop &nexthop,
                            autogen::EnetItemType *item);
+    void EncodeEnetReach(const BgpRoute *route, const RibOutAttr *roattr);
+    void StreamEnetReach(const BgpRoute *route, const RibOutAttr *roattr);
     void AddEnetReach(const BgpRoute *route, const RibOutAttr *roattr);
     void AddEnetUnreach(const BgpRoute *route);
     bool AddEnetRoute(const BgpRoute *route, const RibOutAttr *roattr);
 
+    void EncodeMcastReach(const BgpRoute *route, const RibOutAttr *roattr);
+    void StreamMcastReach(const BgpRoute *route, const RibOutAttr *roattr);
     void AddMcastReach(const BgpRoute *route, const RibOutAttr *roattr);
     void AddMcastUnreach(const BgpRoute *route);
     bool AddMcastRoute(const BgpRoute *route, const RibOutAttr *roattr);
@@ -95,6 +116,7 @@ private:
                                   const RibOutAttr *roattr) const;
 
     const BgpTable *table_;
+    bool stream_encoding_;
     XmlWriter writer_;
     bool is_reachable_;
     bool cache_routes_;
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/xmpp_unicast_item.h"
+
+#include "bgp/xmpp_item_parse.h"
+#include "net/community_type.h"
+
+using boost::system::error_code;
+using pugi::xml_node;
+using xmpp_item::DecodeAddress;
+using xmpp_item::NameIs;
+using xmpp_item::ParseInteger;
+
+XmppUnicastItem::NextHop::NextHop() {
+    Clear();
+}
+
+void XmppUnicastItem::NextHop::Clear() {
+    af = 0;
+    address_str = "";
+    address = IpAddress(Ip4Address(0));
+    address_valid = false;
+    mac = "";
+    label = 0;
+    vni = 0;
+    tunnel_encaps.clear();
+    tags.clear();
+}
+
+XmppUnicastItem::XmppUnicastItem() {
+    Clear();
+}
+
+void XmppUnicastItem::Clear() {
+    af_ = 0;
+    safi_ = 0;
+    address_ = "";
+    next_hop_count_ = 0;
+    next_hop_.Clear();
+    local_preference_ = 0;
+    med_ = 0;
+    sequence_number_ = 0;
+    mobility_seqno_ = 0;
+    mobility_sticky_ = false;
+    security_groups_.clear();
+    communities_.clear();
+    load_balance_ = LoadBalance();
+}
+
+//
+// Decode the given item node. Return false if the item is malformed.
+//
+bool XmppUnicastItem::Decode(const xml_node &node) {
+    Clear();
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NameIs(child, "entry") && !DecodeEntry(child))
+            return false;
+    }
+    return true;
+}
+
+bool XmppUnicastItem::DecodeEntry(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        const char *name = child.name();
+        switch (name[0]) {
+        case 'c':
+            if (strcmp(name, "community-tag-list") == 0)
+                DecodeCommunities(child);
+            break;
+        case 'l':
+            if (strcmp(name, "local-preference") == 0) {
+                if (!ParseInteger(child, &local_preference_))
+                    return false;
+            } else if (strcmp(name, "load-balance") == 0) {
+                DecodeLoadBalance(child);
+            }
+            break;
+        case 'm':
+            if (strcmp(name, "med") == 0) {
+                if (!ParseInteger(child, &med_))
+                    return false;
+            } else if (strcmp(name, "mobility") == 0) {
+                if (!DecodeMobility(child))
+                    return false;
+            }
+            break;
+        case 'n':
+            if (strcmp(name, "nlri") == 0) {
+                if (!DecodeNlri(child))
+                    return false;
+            } else if (strcmp(name, "next-hops") == 0) {
+                if (!DecodeNextHops(child))
+                    return false;
+            }
+            break;
+        case 's':
+            if (strcmp(name, "security-group-list") == 0) {
+                if (!DecodeSecurityGroups(child))
+                    return false;
+            } else if (strcmp(name, "sequence-number") == 0) {
+                if (!ParseInteger(child, &sequence_number_))
+                    return false;
+            }
+            break;
+        case 'v':
+            if (strcmp(name, "version") == 0) {
+                uint32_t version;
+                if (!ParseInteger(child, &version))
+                    return false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+bool XmppUnicastItem::DecodeNlri(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NameIs(child, "af")) {
+            if (!ParseInteger(child, &af_))
+                return false;
+        } else if (NameIs(child, "safi")) {
+            if (!ParseInteger(child, &safi_))
+                return false;
+        } else if (NameIs(child, "address")) {
+            address_ = child.child_value();
+        }
+    }
+    return true;
+}
+
+//
+// Agents publish a single next-hop per item. Only the first one is decoded,
+// but all of them are counted so that the caller can reject the item.
+//
+bool XmppUnicastItem::DecodeNextHops(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (!NameIs(child, "next-hop"))
+            continue;
+        if (next_hop_count_++ == 0 && !DecodeNextHop(child))
+            return false;
+    }
+    return true;
+}
+
+bool XmppUnicastItem::DecodeNextHop(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (NameIs(child, "af")) {
+            if (!ParseInteger(child, &next_hop_.af))
+                return false;
+        } else if (NameIs(child, "address")) {
+            next_hop_.address_str = child.child_value();
+        } else if (NameIs(child, "mac")) {
+            next_hop_.mac = child.child_value();
+        } else if (NameIs(child, "label")) {
+            if (!ParseInteger(child, &next_hop_.label))
+                return false;
+        } else if (NameIs(child, "vni")) {
+            if (!ParseInteger(child, &next_hop_.vni))
+                return false;
+        } else if (NameIs(child, "tunnel-encapsulation-list")) {
+            for (xml_node encap = child.first_child(); encap;
+                 encap = encap.next_sibling()) {
+                if (!NameIs(encap, "tunnel-encapsulation"))
+                    continue;
+                next_hop_.tunnel_encaps.push_back(
+                    TunnelEncapType::TunnelEncapFromString(
+                        encap.child_value()));
+            }
+        } else if (NameIs(child, "tag-list")) {
+            for (xml_node tag = child.first_child(); tag;
+                 tag = tag.next_sibling()) {
+                if (!NameIs(tag, "tag"))
+                    continue;
+                uint32_t value;
+                if (!ParseInteger(tag, &value))
+                    return false;
+                next_hop_.tags.push_back(value);
+            }
+        }
+    }
+
+    // The af may follow the address, so decode the address at the end.
+    next_hop_.address_valid = DecodeAddress(next_hop_.af,
+        next_hop_.address_str, &next_hop_.address);
+    return true;
+}
+
+bool XmppUnicastItem::DecodeMobility(const xml_node &node) {
+    mobility_sticky_ = strcmp(node.attribute("sticky").value(), "true") == 0;
+    return ParseInteger(node.attribute("seqno").value(), &mobility_seqno_);
+}
+
+bool XmppUnicastItem::DecodeSecurityGroups(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (!NameIs(child, "security-group"))
+            continue;
+        uint32_t value;
+        if (!ParseInteger(child, &value))
+            return false;
+        security_groups_.push_back(value);
+    }
+    return true;
+}
+
+//
+// Community tags that can't be parsed are skipped.
+//
+void XmppUnicastItem::DecodeCommunities(const xml_node &node) {
+    for (xml_node child = node.first_child(); child;
+         child = child.next_sibling()) {
+        if (!NameIs(child, "community-tag"))
+            continue;
+        error_code error;
+        uint32_t community =
+            CommunityType::CommunityFromString(child.child_value(), &error);
+        if (error)
+            continue;
+        communities_.push_back(community);
+    }
+}
+
+//
+// Same rules as LoadBalance(const autogen::LoadBalanceType &). An empty
+// list of fields implies the standard 5-tuple unless source-bias is set.
+//
+void XmppUnicastItem::DecodeLoadBalance(const xml_node &node) {
+    LoadBalance::LoadBalanceAttribute attr;
+    xml_node fields = node.child("load-balance-fields");
+    attr.source_bias = strcmp(
+        node.child("load-balance-decision").child_value(), "source-bias") == 0;
+
+    bool load_balance_default =
+        !attr.source_bias && !fields.child("load-balance-field-list");
+    attr.l3_source_address = load_balance_default;
+    attr.l3_destination_address = load_balance_default;
+    attr.l4_protocol = load_balance_default;
+    attr.l4_source_port = load_balance_default;
+    attr.l4_destination_port = load_balance_default;
+
+    for (xml_node child = fields.child("load-balance-field-list"); child;
+         child = child.next_sibling("load-balance-field-list")) {
+        attr.SetField(child.child_value());
+    }
+    load_balance_ = LoadBalance(attr);
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef SRC_BGP_XMPP_UNICAST_ITEM_H_
+#define SRC_BGP_XMPP_UNICAST_ITEM_H_
+
+#include <pugixml/pugixml.hpp>
+
+#include <vector>
+
+#include "base/util.h"
+#include "bgp/extended-community/load_balance.h"
+#include "net/address.h"
+#include "net/tunnel_encap_type.h"
+
+//
+// Decoded form of an item in the xmpp unicast schema (xmpp_unicast.xsd),
+// as published by agents for inet and inet6 routes.
+//
+// The decoder walks the pugixml nodes of the item directly and converts
+// the values that BgpXmppChannel needs into native types. Unlike the
+// autogen ItemType, no strings or lists of strings are copied out of the
+// document. String values that are only needed for logging point into the
+// document, so the item must not outlive the pugixml document it was
+// decoded from.
+//
+// Decode fails if an integer value is malformed, same as ItemType::XmlParse.
+// Elements and values that are not used by BgpXmppChannel are ignored.
+//
+class XmppUnicastItem {
+public:
+    struct NextHop {
+        NextHop();
+        void Clear();
+
+        int af;
+        const char *address_str;
+        IpAddress address;
+        bool address_valid;
+        const char *mac;
+        uint32_t label;
+        uint32_t vni;
+        std::vector<TunnelEncapType::Encap> tunnel_encaps;
+        std::vector<uint32_t> tags;
+    };
+
+    XmppUnicastItem();
+
+    bool Decode(const pugi::xml_node &node);
+    void Clear();
+
+    int af() const { return af_; }
+    int safi() const { return safi_; }
+    const char *address() const { return address_; }
+
+    size_t next_hop_count() const { return next_hop_count_; }
+    const NextHop &next_hop() const { return next_hop_; }
+
+    uint32_t local_preference() const { return local_preference_; }
+    uint32_t med() const { return med_; }
+    uint32_t sequence_number() const { return sequence_number_; }
+    uint32_t mobility_seqno() const { return mobility_seqno_; }
+    bool mobility_sticky() const { return mobility_sticky_; }
+    const std::vector<uint32_t> &security_groups() const {
+        return security_groups_;
+    }
+    const std::vector<uint32_t> &communities() const { return communities_; }
+    const LoadBalance &load_balance() const { return load_balance_; }
+
+private:
+    bool DecodeEntry(const pugi::xml_node &node);
+    bool DecodeNlri(const pugi::xml_node &node);
+    bool DecodeNextHops(const pugi::xml_node &node);
+    bool DecodeNextHop(const pugi::xml_node &node);
+    bool DecodeMobility(const pugi::xml_node &node);
+    bool DecodeSecurityGroups(const pugi::xml_node &node);
+    void DecodeCommunities(const pugi::xml_node &node);
+    void DecodeLoadBalance(const pugi::xml_node &node);
+
+    int af_;
+    int safi_;
+    const char *address_;
+    size_t next_hop_count_;
+    NextHop next_hop_;
+    uint32_t local_preference_;
+    uint32_t med_;
+    uint32_t sequence_number_;
+    uint32_t mobility_seqno_;
+    bool mobility_sticky_;
+    std::vector<uint32_t> security_groups_;
+    std::vector<uint32_t> communities_;
+    LoadBalance load_balance_;
+
+    DISALLOW_COPY_AND_ASSIGN(XmppUnicastItem);
+};
+
+#endif  // SRC_BGP_XMPP_UNICAST_ITEM_H_
@@ -26,6 +26,7 @@
 #include "bgp/bgp_sandesh.h"
 #include "bgp/bgp_xmpp_sandesh.h"
 #include "bgp/bgp_server.h"
+#include "bgp/bgp_update_recorder.h"
 #include "bgp/bgp_session_manager.h"
 #include "bgp/bgp_xmpp_channel.h"
 #include "bgp/xmpp_message_builder.h"
@@ -258,6 +259,8 @@ int main(int argc, char *argv[]) {
     sandesh_context.set_test_mode(ControlNode::GetTestMode());
     sandesh_context.bgp_server = bgp_server.get();
     bgp_server->set_gr_helper_disable(options.gr_helper_bgp_disable());
+    if (!options.update_record_file().empty())
+        bgp_server->update_recorder()->Open(options.update_record_file());
 
     ConnectionStateManager::GetInstance();
 
@@ -137,6 +137,9 @@ void Options::Initialize(EventManager &evm,
              "Enable control-node to run in test-mode")
         ("DEFAULT.tcp_hold_time", opt::value<int>()->default_value(30),
              "Configurable TCP hold time")
+        ("DEFAULT.update_record_file",
+             opt::value<string>()->default_value(""),
+             "File to record received BGP and XMPP route updates to")
         ("DEFAULT.optimize_snat", opt::bool_switch(&optimize_snat_),
              "Enable control-node optimizations for SNAT (deprecated)")
         ("DEFAULT.xmpp_server_port",
@@ -298,6 +301,8 @@ bool Options::Process(int argc, char *argv[],
     GetOptValue<string>(var_map, log_level_, "DEFAULT.log_level");
     GetOptValue<string>(var_map, syslog_facility_, "DEFAULT.syslog_facility");
     GetOptValue<int>(var_map, tcp_hold_time_, "DEFAULT.tcp_hold_time");
+    GetOptValue<string>(var_map, update_record_file_,
+                        "DEFAULT.update_record_file");
     GetOptValue<uint16_t>(var_map, xmpp_port_, "DEFAULT.xmpp_server_port");
     GetOptValue<string>(var_map, xmpp_server_cert_, "DEFAULT.xmpp_server_cert");
     GetOptValue<string>(var_map, xmpp_server_key_, "DEFAULT.xmpp_server_key");
@@ -38,6 +38,7 @@ public:
     bool use_syslog() const { return use_syslog_; }
     std::string syslog_facility() const { return syslog_facility_; }
     bool task_track_run_time() const { return task_track_run_time_; }
+    std::string update_record_file() const { return update_record_file_; }
     std::string config_db_user() const {
         return configdb_options_.config_db_username;
     }
@@ -118,6 +119,7 @@ private:
     bool use_syslog_;
     std::string syslog_facility_;
     bool task_track_run_time_;
+    std::string update_record_file_;
     IFMapConfigOptions configdb_options_;
     uint16_t xmpp_port_;
     bool xmpp_auth_enable_;
@@ -248,6 +248,11 @@ public:
                            msg.length());
     }
 
+    void SendMessage(const string &msg) {
+        Peer()->SendUpdate(reinterpret_cast<const uint8_t *>(msg.data()),
+                           msg.length());
+    }
+
 private:
     NetworkAgentMock *parent_;
 };
@@ -1023,6 +1028,11 @@ void NetworkAgentMock::SendEorMarker() {
     peer->SendDocument(impl_->AddEorMarker());
 }
 
+void NetworkAgentMock::SendRawMessage(const string &msg) {
+    AgentPeer *peer = GetAgent();
+    peer->SendMessage(msg);
+}
+
 void NetworkAgentMock::AddRoute(const string &network_name,
                                 const string &prefix, const string nexthop,
                                 int local_pref, int med) {
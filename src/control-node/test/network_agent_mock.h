@@ -522,6 +522,7 @@ public:
     }
 
     void SendEorMarker();
+    void SendRawMessage(const std::string &msg);
     void AddRoute(const std::string &network, const std::string &prefix,
                   const std::string nexthop = "",
                   int local_pref = 0, int med = 0);
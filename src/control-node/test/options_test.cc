@@ -84,6 +84,7 @@ TEST_F(OptionsTest, NoArguments) {
   
     EXPECT_EQ(options_.xmpp_port(), default_xmpp_port);
     EXPECT_EQ(options_.test_mode(), false);
+    EXPECT_EQ(options_.update_record_file(), "");
     EXPECT_EQ(options_.sandesh_config().system_logs_rate_limit,
               g_sandesh_constants.DEFAULT_SANDESH_SEND_RATELIMIT);
     EXPECT_EQ(options_.gr_helper_bgp_disable(), false);
@@ -236,6 +237,7 @@ TEST_F(OptionsTest, CustomConfigFile) {
         "log_local=false\n"
         "test_mode=0\n"
         "task_track_run_time=0\n"
+        "update_record_file=/var/tmp/updates.rec\n"
         "optimize_snat=1\n"
         "gr_helper_bgp_disable=1\n"
         "gr_helper_xmpp_disable=1\n"
@@ -294,6 +296,7 @@ TEST_F(OptionsTest, CustomConfigFile) {
     EXPECT_EQ(options_.log_local(), false);
     EXPECT_EQ(options_.xmpp_port(), 100);
     EXPECT_EQ(options_.task_track_run_time(), false);
+    EXPECT_EQ(options_.update_record_file(), "/var/tmp/updates.rec");
     EXPECT_EQ(options_.test_mode(), false);
     EXPECT_EQ(options_.optimize_snat(), true);
     EXPECT_EQ(options_.gr_helper_bgp_disable(), true);
@@ -4,6 +4,8 @@
 
 #include "route/route.h"
 
+#include <algorithm>
+
 #include "base/time_util.h"
 
 Route::Route() {
@@ -45,3 +47,40 @@ void Route::Sort(Compare compare, const Path *prev_front) {
         set_last_change_at_to_now();
     }
 }
+
+//
+// Insert a path at its position in a list that is already sorted based on
+// the compare function, instead of sorting the whole list again.
+//
+// The position is the upper bound of the path, which is where a stable sort
+// would have placed a path appended to the list. The list iterators are not
+// random access, so this still walks the list but only does O(log n) calls
+// to the compare function.
+//
+void Route::InsertSorted(const Path *ipath, Compare compare,
+                         const Path *prev_front) {
+    Path *path = const_cast<Path *> (ipath);
+
+    path->set_time_stamp_usecs(UTCTimestampUsec());
+    PathList::iterator it =
+        std::upper_bound(path_.begin(), path_.end(), *path, compare);
+    path_.insert(it, *path);
+
+    // If the best path changes, update route's time stamp.
+    if (prev_front != front()) {
+        set_last_change_at_to_now();
+    }
+}
+
+//
+// Remove a path from a sorted list. Removal doesn't change the relative
+// order of the remaining paths, so there's no need to sort again.
+//
+void Route::RemoveSorted(const Path *path, const Path *prev_front) {
+    remove(path);
+
+    // If the best path changes, update route's time stamp.
+    if (prev_front != front()) {
+        set_last_change_at_to_now();
+    }
+}
@@ -43,6 +43,14 @@ public:
     // Sort paths based on compare function.
     void Sort(Compare compare, const Path *prev_front);
 
+    // Insert a path at its position in a list already sorted based on
+    // compare function.
+    void InsertSorted(const Path *path, Compare compare,
+                      const Path *prev_front);
+
+    // Remove a path from a sorted list.
+    void RemoveSorted(const Path *path, const Path *prev_front);
+
     const PathList &GetPathList() const {
         return path_;
     }
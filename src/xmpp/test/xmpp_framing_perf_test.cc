@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <boost/regex.hpp>
+
+#include <iostream>
+#include <string>
+
+#include "base/logging.h"
+#include "base/string_util.h"
+#include "base/time_util.h"
+#include "base/test/task_test_util.h"
+#include "control-node/control_node.h"
+#include "testing/gunit.h"
+#include "xmpp/xmpp_stanza_scanner.h"
+#include "xmpp/xmpp_str.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+
+//
+// Measure framing throughput for a stream of route publish iq stanzas that
+// is split into fixed size reads. The regex based framing mimics what
+// XmppSession does before the session is established. The scanner based
+// framing is what's used once the session is established.
+//
+// Set STANZA_COUNT to change the number of stanzas in the stream.
+// Set READ_SIZE to change the number of bytes in each read.
+//
+class XmppFramingPerfTest : public ::testing::Test {
+protected:
+    XmppFramingPerfTest()
+        : stanza_count_(4 * 1024), read_size_(4096),
+          frame_count_(0), byte_count_(0) {
+    }
+
+    virtual void SetUp() {
+        char *str = getenv("STANZA_COUNT");
+        if (str)
+            stanza_count_ = strtoul(str, NULL, 0);
+        str = getenv("READ_SIZE");
+        if (str)
+            read_size_ = strtoul(str, NULL, 0);
+
+        for (int idx = 0; idx < stanza_count_; ++idx) {
+            string prefix = "10.1." + integerToString(idx / 256 % 256) + "." +
+                integerToString(idx % 256) + "/32";
+            stream_ += "<iq type=\"set\""
+                " from=\"agent@vnsw.contrailsystems.com\""
+                " to=\"network-control@contrailsystems.com/bgp-peer\""
+                " id=\"pubsub" + integerToString(idx) + "\">"
+                "<pubsub xmlns=\"http://jabber.org/protocol/pubsub\">"
+                "<publish node=\"1/1/blue/" + prefix + "\">"
+                "<item><entry><nlri><af>1</af><safi>1</safi>"
+                "<address>" + prefix + "</address></nlri>"
+                "<next-hops><next-hop><af>1</af><address>192.168.1.1"
+                "</address><label>16</label><tunnel-encapsulation-list>"
+                "<tunnel-encapsulation>gre</tunnel-encapsulation>"
+                "</tunnel-encapsulation-list></next-hop></next-hops>"
+                "<virtual-network>blue</virtual-network>"
+                "</entry></item></publish></pubsub></iq>";
+            if (idx % 16 == 0)
+                stream_ += " ";
+        }
+    }
+
+    virtual void TearDown() {
+    }
+
+    void ReceiveMsg(const string &msg) {
+        frame_count_++;
+        byte_count_ += msg.size();
+    }
+
+    static boost::regex TagToPattern(const string &tag) {
+        return boost::regex("</" + tag.substr(1) + "[\\s\\t\\r\\n]*>");
+    }
+
+    //
+    // Same sequence of copies and regex searches as XmppSession::OnRead
+    // and XmppSession::Match for the established state.
+    //
+    void RegexRead(const uint8_t *data, size_t size) {
+        static const boost::regex patt(rXMPP_MESSAGE);
+        buf_ += string(data, data + size);
+        size_t offset = 0;
+        while (!buf_.empty()) {
+            if (begin_tag_.empty()) {
+                size_t pos = buf_.find_first_not_of(sXMPP_VALIDWS);
+                if (pos != 0) {
+                    if (pos == string::npos)
+                        pos = buf_.size();
+                    ReceiveMsg(string(buf_.begin(), buf_.begin() + pos));
+                    buf_ = string(buf_.begin() + pos, buf_.end());
+                    offset = 0;
+                    continue;
+                }
+            }
+
+            boost::match_results<string::const_iterator> res;
+            boost::regex end_patt;
+            if (!begin_tag_.empty())
+                end_patt = TagToPattern(begin_tag_);
+            const boost::regex &regex = begin_tag_.empty() ? patt : end_patt;
+            string::const_iterator start = buf_.begin() + offset;
+            if (!regex_search(start, string::const_iterator(buf_.end()), res,
+                    regex, boost::match_default | boost::match_partial)) {
+                break;
+            }
+            if (!res[0].matched) {
+                break;
+            }
+            offset = res[0].second - buf_.begin();
+            if (begin_tag_.empty()) {
+                begin_tag_ = string(res[0].first, res[0].second);
+                continue;
+            }
+            begin_tag_.clear();
+            ReceiveMsg(string(buf_.begin(), buf_.begin() + offset));
+            buf_ = string(buf_.begin() + offset, buf_.end());
+            offset = 0;
+        }
+    }
+
+    //
+    // Same as XmppSession::ProcessFrames.
+    //
+    void ScannerRead(const uint8_t *data, size_t size) {
+        while (size > 0) {
+            size_t len;
+            XmppStanzaScanner::FrameType type =
+                scanner_.Scan(data, size, &len);
+            const char *cp = reinterpret_cast<const char *>(data);
+            if (type == XmppStanzaScanner::NONE) {
+                partial_.append(cp, size);
+                return;
+            }
+            if (partial_.empty()) {
+                ReceiveMsg(string(cp, len));
+            } else {
+                partial_.append(cp, len);
+                ReceiveMsg(partial_);
+                partial_.clear();
+            }
+            data += len;
+            size -= len;
+        }
+    }
+
+    void RunTest(const char *name, bool use_scanner) {
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(stream_.data());
+        uint64_t start = ClockMonotonicUsec();
+        for (size_t offset = 0; offset < stream_.size();
+             offset += read_size_) {
+            size_t size = std::min(static_cast<size_t>(read_size_),
+                                   stream_.size() - offset);
+            if (use_scanner) {
+                ScannerRead(data + offset, size);
+            } else {
+                RegexRead(data + offset, size);
+            }
+        }
+        uint64_t elapsed = ClockMonotonicUsec() - start;
+
+        EXPECT_EQ(stream_.size(), byte_count_);
+        cout << name
+             << " Stanzas " << stanza_count_
+             << " Frames " << frame_count_
+             << " ReadSize " << read_size_
+             << " Elapsed(usec) " << elapsed
+             << " MBytes/sec "
+             << (elapsed ? stream_.size() / elapsed : 0)
+             << " Frames/sec "
+             << (elapsed ? frame_count_ * 1000000 / elapsed : 0)
+             << endl;
+    }
+
+    int stanza_count_;
+    int read_size_;
+    uint64_t frame_count_;
+    uint64_t byte_count_;
+    string stream_;
+    string buf_;
+    string begin_tag_;
+    XmppStanzaScanner scanner_;
+    string partial_;
+};
+
+TEST_F(XmppFramingPerfTest, Regex) {
+    RunTest("Regex", false);
+}
+
+TEST_F(XmppFramingPerfTest, Scanner) {
+    RunTest("Scanner", true);
+}
+
+static void SetUp() {
+    LoggingInit();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "xmpp/xmpp_stanza_scanner.h"
+
+#include <string>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/test/task_test_util.h"
+#include "control-node/control_node.h"
+#include "testing/gunit.h"
+
+using std::string;
+using std::vector;
+
+class XmppStanzaScannerTest : public ::testing::Test {
+protected:
+    typedef std::pair<XmppStanzaScanner::FrameType, string> Frame;
+
+    //
+    // Feed the data to the scanner in chunks of the given size, the same
+    // way XmppSession::ProcessFrames does, and return the list of frames.
+    // Consecutive whitespace frames are merged since the number of them
+    // depends on the chunk size.
+    //
+    vector<Frame> Scan(const string &data, size_t chunk_size) {
+        XmppStanzaScanner scanner;
+        vector<Frame> frames;
+        string partial;
+        for (size_t offset = 0; offset < data.size(); offset += chunk_size) {
+            const uint8_t *cp =
+                reinterpret_cast<const uint8_t *>(data.data()) + offset;
+            size_t size = std::min(chunk_size, data.size() - offset);
+            while (size > 0) {
+                size_t len;
+                XmppStanzaScanner::FrameType type =
+                    scanner.Scan(cp, size, &len);
+                if (type == XmppStanzaScanner::NONE) {
+                    partial.append(reinterpret_cast<const char *>(cp), size);
+                    break;
+                }
+                partial.append(reinterpret_cast<const char *>(cp), len);
+                if (type == XmppStanzaScanner::WHITESPACE &&
+                    !frames.empty() &&
+                    frames.back().first == XmppStanzaScanner::WHITESPACE) {
+                    frames.back().second += partial;
+                } else {
+                    frames.push_back(std::make_pair(type, partial));
+                }
+                partial.clear();
+                cp += len;
+                size -= len;
+            }
+        }
+        partial_ = partial;
+        in_frame_ = scanner.InFrame();
+        return frames;
+    }
+
+    //
+    // Verify that the frames are the same regardless of how the data is
+    // split across reads.
+    //
+    void ScanAllChunkSizes(const string &data, const vector<Frame> &expected) {
+        for (size_t chunk_size = 1; chunk_size <= data.size(); ++chunk_size) {
+            vector<Frame> frames = Scan(data, chunk_size);
+            EXPECT_EQ(expected.size(), frames.size()) << chunk_size;
+            EXPECT_TRUE(expected == frames) << chunk_size;
+        }
+    }
+
+    Frame Stanza(const string &str) {
+        return std::make_pair(XmppStanzaScanner::STANZA, str);
+    }
+
+    Frame Whitespace(const string &str) {
+        return std::make_pair(XmppStanzaScanner::WHITESPACE, str);
+    }
+
+    string partial_;
+    bool in_frame_;
+};
+
+TEST_F(XmppStanzaScannerTest, Basic) {
+    string iq("<iq type='set'><pubsub> blah blah </pubsub></iq>");
+    string msg("<message to='x'><body>hello</body></message>");
+    vector<Frame> expected;
+    expected.push_back(Stanza(iq));
+    expected.push_back(Stanza(msg));
+    expected.push_back(Stanza(iq));
+    ScanAllChunkSizes(iq + msg + iq, expected);
+    EXPECT_TRUE(partial_.empty());
+    EXPECT_FALSE(in_frame_);
+}
+
+TEST_F(XmppStanzaScannerTest, Whitespace) {
+    string iq("<iq> blah blah </iq>");
+    vector<Frame> expected;
+    expected.push_back(Whitespace(" \n\t"));
+    expected.push_back(Stanza(iq));
+    expected.push_back(Whitespace("\xC8\x80"));
+    expected.push_back(Stanza(iq));
+    expected.push_back(Whitespace("\r\n "));
+    ScanAllChunkSizes(" \n\t" + iq + "\xC8\x80" + iq + "\r\n ", expected);
+    EXPECT_TRUE(partial_.empty());
+    EXPECT_FALSE(in_frame_);
+}
+
+//
+// Whitespace inside a stanza or after garbage is part of the stanza.
+//
+TEST_F(XmppStanzaScannerTest, Garbage) {
+    vector<Frame> expected;
+    expected.push_back(Stanza("abc  <i<iq> \n </iq>"));
+    expected.push_back(Whitespace(" "));
+    expected.push_back(Stanza("<<message></message>"));
+    ScanAllChunkSizes("abc  <i<iq> \n </iq> <<message></message>", expected);
+}
+
+//
+// End tag must match the start tag and may have whitespace before the '>'.
+//
+TEST_F(XmppStanzaScannerTest, EndTag) {
+    string msg("<message><iq></iq></message \t\r\n>");
+    string iq("<iq><message></message></iqx></i q></iq\n>");
+    vector<Frame> expected;
+    expected.push_back(Stanza(msg));
+    expected.push_back(Stanza(iq));
+    ScanAllChunkSizes(msg + iq, expected);
+}
+
+TEST_F(XmppStanzaScannerTest, Partial) {
+    string iq("<iq> blah blah </iq>");
+    vector<Frame> expected;
+    expected.push_back(Stanza(iq));
+    expected.push_back(Whitespace(" "));
+    ScanAllChunkSizes(iq + " <iq> blah </i", expected);
+    EXPECT_EQ("<iq> blah </i", partial_);
+    EXPECT_TRUE(in_frame_);
+
+    expected.clear();
+    ScanAllChunkSizes("abc<i", expected);
+    EXPECT_EQ("abc<i", partial_);
+    EXPECT_TRUE(in_frame_);
+}
+
+TEST_F(XmppStanzaScannerTest, Empty) {
+    XmppStanzaScanner scanner;
+    size_t len = 1;
+    EXPECT_EQ(XmppStanzaScanner::NONE, scanner.Scan(NULL, 0, &len));
+    EXPECT_EQ(0, len);
+    EXPECT_FALSE(scanner.InFrame());
+}
+
+static void SetUp() {
+    LoggingInit();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
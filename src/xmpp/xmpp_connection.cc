@@ -5,6 +5,7 @@
 #include "xmpp/xmpp_connection.h"
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/functional/hash.hpp>
 #include <sstream>
 
 #include "base/lifetime.h"
@@ -144,7 +145,10 @@ int XmppConnection::GetTaskInstance(bool is_client) const {
     if (address.is_v4()) {
         return address.to_v4().to_ulong() % thread_count;
     } else {
-        return 0;
+        // Spread IPv6 peers across task instances as well, instead of
+        // funneling all of them through instance 0.
+        Ip6Address::bytes_type bytes = address.to_v6().to_bytes();
+        return boost::hash_range(bytes.begin(), bytes.end()) % thread_count;
     }
 }
 
@@ -188,8 +188,9 @@ bool XmppSession::Match(Buffer buffer, int *result, bool NewBuf) {
         connection->GetStateMcOpenConfirmState();
 
     if (NewBuf) {
+        // Only used before the session is established, so the copy is not
+        // a concern.
         const uint8_t *cp = BufferData(buffer);
-        // TODO Avoid this copy
         std::string str(cp, cp + BufferSize(buffer));
         XmppSession::SetBuf(str);
     }
@@ -266,9 +267,47 @@ bool XmppSession::Match(Buffer buffer, int *result, bool NewBuf) {
     return true;
 }
 
+//
+// Find frames in the data using the XmppStanzaScanner and send them to the
+// connection object. Frames that are contained in the data are copied once,
+// directly into the message passed to the connection. Only the incomplete
+// frame at the end of the data, if any, is saved in partial_.
+//
+void XmppSession::ProcessFrames(const uint8_t *data, size_t size) {
+    while (size > 0) {
+        if (!connection_)
+            return;
+
+        size_t len;
+        XmppStanzaScanner::FrameType type = scanner_.Scan(data, size, &len);
+        const char *cp = reinterpret_cast<const char *>(data);
+        if (type == XmppStanzaScanner::NONE) {
+            partial_.append(cp, size);
+            return;
+        }
+
+        if (partial_.empty()) {
+            connection_->ReceiveMsg(this, string(cp, len));
+        } else {
+            partial_.append(cp, len);
+            connection_->ReceiveMsg(this, partial_);
+            partial_.clear();
+        }
+        data += len;
+        size -= len;
+    }
+}
+
+//
 // Read the socket stream and send messages to the connection object.
-// The buffer is copied to local string for regex match. 
-// TODO Code need to change st Match() is done on buffer itself.
+//
+// Once the session is established, stanza boundaries are found in place in
+// the buffer using the XmppStanzaScanner. Any data left over from the open
+// and TLS negotiation phase gets fed through the scanner first.
+//
+// Before that, the buffer is copied to a local string for regex match, as
+// the tags to be matched depend on the state.
+//
 void XmppSession::OnRead(Buffer buffer) {
     if (this->Connection() == NULL || !connection_) {
         // Connection is deleted. Session is being deleted as well
@@ -285,6 +324,23 @@ void XmppSession::OnRead(Buffer buffer) {
         return;
     }
 
+    if (connection_->GetStateMcState() == xmsm::ESTABLISHED) {
+        if (!buf_.empty()) {
+            std::string leftover;
+            leftover.swap(buf_);
+            offset_ = buf_.begin();
+            tag_known_ = 0;
+            ProcessFrames(
+                reinterpret_cast<const uint8_t *>(leftover.data()),
+                leftover.size());
+        }
+        ProcessFrames(BufferData(buffer), BufferSize(buffer));
+        ReleaseBuffer(buffer);
+        if (connection_)
+            connection_->state_machine()->DeferReaderIfBacklogged(this);
+        return;
+    }
+
     int result = 0;
     bool more = Match(buffer, &result, true);
     do {
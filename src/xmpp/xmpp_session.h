@@ -9,6 +9,7 @@
 #include <boost/regex.hpp>
 #include "io/ssl_server.h"
 #include "io/ssl_session.h"
+#include "xmpp/xmpp_stanza_scanner.h"
 
 class XmppServer;
 class XmppConnection;
@@ -58,6 +59,7 @@ private:
     void SetBuf(const std::string &);
     void ReplaceBuf(const std::string &);
     bool LeftOver() const;
+    void ProcessFrames(const uint8_t *data, size_t size);
 
     XmppConnectionManager *manager_;
     XmppConnection *connection_;
@@ -74,6 +76,8 @@ private:
     int keepalive_probes_;
     int tcp_user_timeout_;
     bool stream_open_matched_;
+    XmppStanzaScanner scanner_;
+    std::string partial_;
 
     static const boost::regex patt_;
     static const boost::regex stream_patt_;
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "xmpp/xmpp_stanza_scanner.h"
+
+static const char kIqTag[] = "iq";
+static const char kMessageTag[] = "message";
+
+XmppStanzaScanner::XmppStanzaScanner()
+    : state_(FRAME_START), tag_(NULL), tag_len_(0), match_len_(0) {
+}
+
+void XmppStanzaScanner::Reset() {
+    state_ = FRAME_START;
+    tag_ = NULL;
+    tag_len_ = 0;
+    match_len_ = 0;
+}
+
+//
+// Whitespace between stanzas, same as sXMPP_VALIDWS. The last two bytes
+// are the UTF-8 encoding of U+0200, which is used as whitespace keepalive.
+//
+bool XmppStanzaScanner::IsWhitespace(uint8_t c) {
+    switch (c) {
+    case ' ':
+    case '\n':
+    case '\r':
+    case '\t':
+    case 0xC8:
+    case 0x80:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//
+// Whitespace allowed between the tag name and the '>' of an end tag.
+//
+static inline bool IsTagWhitespace(uint8_t c) {
+    return (c == ' ' || c == '\n' || c == '\r' || c == '\t' ||
+            c == '\f' || c == '\v');
+}
+
+//
+// Look for <iq or <message. The value of match_len_ is the number of bytes
+// of the candidate start tag (including the '<') matched so far.
+//
+const uint8_t *XmppStanzaScanner::ScanStartTag(const uint8_t *cp,
+                                               const uint8_t *end) {
+    for (; cp < end; ++cp) {
+        uint8_t c = *cp;
+        if (match_len_ == 0) {
+            if (c == '<')
+                match_len_ = 1;
+            continue;
+        }
+
+        if (match_len_ == 1) {
+            if (c == kIqTag[0]) {
+                tag_ = kIqTag;
+                tag_len_ = sizeof(kIqTag) - 1;
+            } else if (c == kMessageTag[0]) {
+                tag_ = kMessageTag;
+                tag_len_ = sizeof(kMessageTag) - 1;
+            } else {
+                match_len_ = (c == '<') ? 1 : 0;
+                continue;
+            }
+        } else if (c != static_cast<uint8_t>(tag_[match_len_ - 1])) {
+            match_len_ = (c == '<') ? 1 : 0;
+            continue;
+        }
+
+        if (++match_len_ == tag_len_ + 1) {
+            state_ = END_TAG;
+            match_len_ = 0;
+            return cp + 1;
+        }
+    }
+    return cp;
+}
+
+//
+// Look for </tag followed by optional whitespace and '>'. The value of
+// match_len_ is the number of bytes of "</tag" matched so far.
+//
+const uint8_t *XmppStanzaScanner::ScanEndTag(const uint8_t *cp,
+                                             const uint8_t *end) {
+    for (; cp < end; ++cp) {
+        uint8_t c = *cp;
+        if (match_len_ == 0) {
+            if (c == '<')
+                match_len_ = 1;
+        } else if (match_len_ == 1) {
+            match_len_ = (c == '/') ? 2 : ((c == '<') ? 1 : 0);
+        } else if (match_len_ < tag_len_ + 2) {
+            if (c == static_cast<uint8_t>(tag_[match_len_ - 2])) {
+                match_len_++;
+            } else {
+                match_len_ = (c == '<') ? 1 : 0;
+            }
+        } else if (c == '>') {
+            Reset();
+            return cp + 1;
+        } else if (!IsTagWhitespace(c)) {
+            match_len_ = (c == '<') ? 1 : 0;
+        }
+    }
+    return cp;
+}
+
+XmppStanzaScanner::FrameType XmppStanzaScanner::Scan(const uint8_t *data,
+                                                     size_t size,
+                                                     size_t *len) {
+    const uint8_t *cp = data;
+    const uint8_t *end = data + size;
+
+    // Whitespace is only recognized at the beginning of a frame.
+    if (state_ == FRAME_START) {
+        while (cp < end && IsWhitespace(*cp))
+            ++cp;
+        if (cp != data) {
+            *len = cp - data;
+            return WHITESPACE;
+        }
+        if (cp == end) {
+            *len = 0;
+            return NONE;
+        }
+        state_ = START_TAG;
+        match_len_ = 0;
+    }
+
+    if (state_ == START_TAG) {
+        cp = ScanStartTag(cp, end);
+        if (state_ == START_TAG) {
+            *len = size;
+            return NONE;
+        }
+    }
+
+    cp = ScanEndTag(cp, end);
+    if (state_ == END_TAG) {
+        *len = size;
+        return NONE;
+    }
+
+    *len = cp - data;
+    return STANZA;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2017 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef __XMPP_STANZA_SCANNER_H__
+#define __XMPP_STANZA_SCANNER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "base/util.h"
+
+//
+// Incremental scanner to find stanza boundaries in an established XMPP
+// stream without copying the data or using regular expressions.
+//
+// Data is fed to the scanner in arbitrary chunks as it is read from the
+// socket. The scanner remembers how much of a start or end tag has been
+// matched so far, so a tag that is split across reads does not require
+// the previous data to be scanned again. The caller only needs to hold on
+// to the bytes of the frame that is currently incomplete.
+//
+// A frame is either a run of whitespace (used as keepalive) or all data
+// up to and including the end tag that matches the first <iq or <message
+// start tag. Any garbage before the start tag is part of the frame. This
+// is the same framing as the regex based matching in XmppSession.
+//
+class XmppStanzaScanner {
+public:
+    enum FrameType {
+        NONE,
+        WHITESPACE,
+        STANZA
+    };
+
+    XmppStanzaScanner();
+
+    // Scan the data and return the type of the frame that ends *len bytes
+    // into the data. Returns NONE if all the data was consumed without
+    // finding the end of a frame.
+    FrameType Scan(const uint8_t *data, size_t size, size_t *len);
+    void Reset();
+
+    bool InFrame() const { return state_ != FRAME_START; }
+
+    static bool IsWhitespace(uint8_t c);
+
+private:
+    enum State {
+        FRAME_START,
+        START_TAG,
+        END_TAG
+    };
+
+    const uint8_t *ScanStartTag(const uint8_t *cp, const uint8_t *end);
+    const uint8_t *ScanEndTag(const uint8_t *cp, const uint8_t *end);
+
+    State state_;
+    const char *tag_;
+    size_t tag_len_;
+    size_t match_len_;
+
+    DISALLOW_COPY_AND_ASSIGN(XmppStanzaScanner);
+};
+
+#endif // __XMPP_STANZA_SCANNER_H__
@@ -1105,6 +1105,7 @@ XmppStateMachine::XmppStateMachine(XmppConnection *connection, bool active,
       hold_time_(GetConfiguredHoldTime()),
       attempts_(0),
       keepalive_count_(0),
+      reader_defer_count_(0),
       deleted_(false),
       in_dequeue_(false),
       is_active_(active),
@@ -1433,6 +1434,53 @@ void XmppStateMachine::OnMessage(XmppSession *session,
         delete msg;
 }
 
+const size_t XmppStateMachine::kReaderHighWaterMark;
+const size_t XmppStateMachine::kReaderLowWaterMark;
+size_t XmppStateMachine::reader_high_water_mark_ = kReaderHighWaterMark;
+size_t XmppStateMachine::reader_low_water_mark_ = kReaderLowWaterMark;
+
+void XmppStateMachine::SetReaderWaterMarks(size_t high_water,
+                                           size_t low_water) {
+    assert(low_water < high_water);
+    reader_high_water_mark_ = high_water;
+    reader_low_water_mark_ = low_water;
+}
+
+//
+// Called by the session after it has processed a buffer in the io::Reader
+// task. Stop reading from the socket if the peer has gotten too far ahead
+// of the state machine, so that the work queue does not grow without bound
+// when a large number of peers reconnect and publish all their routes at
+// the same time. The reader is resumed from ResumeReaderIfDrained once the
+// backlog has been worked down.
+//
+// Only done for server side sessions. The scheduling policy that prevents
+// io::ReaderTask and xmpp::StateMachine tasks with the same instance from
+// running concurrently is what guarantees that the reader is not started
+// twice, and that's only set up in the control node.
+//
+// Only the current session is deferred since that's the one that gets
+// resumed. A session that has been replaced is on its way out anyway.
+//
+void XmppStateMachine::DeferReaderIfBacklogged(XmppSession *session) {
+    if (IsActiveChannel() || session != session_)
+        return;
+    if (session->IsReaderDeferred())
+        return;
+    if (work_queue_.Length() < reader_high_water_mark_)
+        return;
+    reader_defer_count_++;
+    session->SetDeferReader(true);
+}
+
+void XmppStateMachine::ResumeReaderIfDrained() {
+    if (!session_ || !session_->IsReaderDeferred())
+        return;
+    if (work_queue_.Length() > reader_low_water_mark_)
+        return;
+    session_->SetDeferReader(false);
+}
+
 void XmppStateMachine::ProcessMessage(XmppSession *session,
                                       const XmppStanza::XmppMessage *msg) {
     // Bail if session is already reset and disassociated from the connection.
@@ -1603,6 +1651,7 @@ bool XmppStateMachine::DequeueEvent(
         ProcessEvent(*event);
         event.reset();
     }
+    ResumeReaderIfDrained();
     return true;
 }
 
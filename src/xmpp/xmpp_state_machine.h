@@ -65,6 +65,8 @@ public:
     static const int kHoldTime = 90;         // seconds
     static const int kMaxAttempts = 4;
     static const int kJitter = 10;           // percentage
+    static const size_t kReaderHighWaterMark = 1024;  // events
+    static const size_t kReaderLowWaterMark = 256;    // events
 
     XmppStateMachine(XmppConnection *connection, bool active, bool auth_enabled = false);
     ~XmppStateMachine();
@@ -101,6 +103,11 @@ public:
     void ProcessMessage(XmppSession *session,
                         const XmppStanza::XmppMessage *msg);
 
+    // Flow control for incoming messages.
+    void DeferReaderIfBacklogged(XmppSession *session);
+    static void SetReaderWaterMarks(size_t high_water, size_t low_water);
+    uint64_t reader_defer_count() const { return reader_defer_count_; }
+
     // Receive incoming ssl events
     //void OnEvent(XmppSession *session, xmsm::SslHandShakeResponse);
     void OnEvent(SslSession *session, xmsm::SslHandShakeResponse);
@@ -187,6 +194,7 @@ private:
     bool OpenTimerExpired();
     bool Enqueue(const sc::event_base &ev);
     bool DequeueEvent(boost::intrusive_ptr<const sc::event_base> &event);
+    void ResumeReaderIfDrained();
     void ProcessEvent(const sc::event_base &event);
     void ProcessStreamHeaderMessage(XmppSession *session,
                                     const XmppStanza::XmppMessage *msg);
@@ -201,6 +209,7 @@ private:
     int hold_time_;
     uint32_t attempts_;
     uint32_t keepalive_count_;
+    uint64_t reader_defer_count_;
     bool deleted_;
     bool in_dequeue_;
     bool is_active_;
@@ -213,6 +222,9 @@ private:
     uint64_t last_event_at_;
     SslHandShakeCallbackHandler handshake_cb_;
 
+    static size_t reader_high_water_mark_;
+    static size_t reader_low_water_mark_;
+
     DISALLOW_COPY_AND_ASSIGN(XmppStateMachine);
 };
 